@@ -236,20 +236,28 @@ static inline AABB rotate(const AABB& aabb, const Matrix3f& t)
   const std::size_t bit[3] = { 1, 2, 4 };
   for (std::size_t ic = 1; ic < 8; ++ic) { // ic = 0 corresponds to aabb.min_. Skip it.
     for (std::size_t i = 0; i < 3; ++i) {
-      corner[i] = (ic && bit[i]) ? aabb.max_[i] : aabb.min_[i];
+      corner[i] = (ic & bit[i]) ? aabb.max_[i] : aabb.min_[i];
     }
     res += t * corner;
   }
   return res;
 }
 
-/// @brief Check collision between two aabbs, b1 is in configuration (R0, T0) and b2 is in identity.
+/// @brief Check collision between two aabbs, b2 is in configuration (R0, T0)
+/// in the frame of b1. The aabbs are tested as oriented boxes, so that the
+/// models do not need to be transformed.
 bool overlap(const Matrix3f& R0, const Vec3f& T0, const AABB& b1, const AABB& b2);
 
-/// @brief Check collision between two aabbs, b1 is in configuration (R0, T0) and b2 is in identity.
+/// @brief Check collision between two aabbs, b2 is in configuration (R0, T0)
+/// in the frame of b1.
 bool overlap(const Matrix3f& R0, const Vec3f& T0, const AABB& b1,
 	     const AABB& b2, const CollisionRequest& request,
              FCL_REAL& sqrDistLowerBound);
+
+/// @brief Lower bound of the distance between two aabbs, b2 is in
+/// configuration (R0, T0) in the frame of b1. P and Q are not computed.
+FCL_REAL distance(const Matrix3f& R0, const Vec3f& T0, const AABB& b1,
+                  const AABB& b2, Vec3f* P = NULL, Vec3f* Q = NULL);
 }
 
 } // namespace hpp
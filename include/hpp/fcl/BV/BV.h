@@ -126,7 +126,8 @@ public:
   static void convert(const RSS& bv1, const Transform3f& tf1, OBB& bv2)
   {
     bv2.extent.noalias() = Vec3f(bv1.length[0] * 0.5 + bv1.radius, bv1.length[1] * 0.5 + bv1.radius, bv1.radius);
-    bv2.To.noalias() = tf1.transform(bv1.Tr);
+    /// Tr is a corner of the rectangle, not its center.
+    bv2.To.noalias() = tf1.transform(bv1.Tr + bv1.axes * Vec3f(bv1.length[0] * 0.5, bv1.length[1] * 0.5, 0));
     bv2.axes.noalias() = tf1.getRotation() * bv1.axes;
   }
 };
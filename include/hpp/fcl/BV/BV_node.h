@@ -42,6 +42,7 @@
 #include <hpp/fcl/data_types.h>
 
 #include <hpp/fcl/BV/BV.h>
+#include <hpp/fcl/BV/float_BV.h>
 #include <iostream>
 
 namespace hpp
@@ -132,6 +133,72 @@ inline const Matrix3f& BVNode<OBBRSS>::getOrientation() const
   return bv.obb.axes;
 }
 
+/// @brief Bounding volume stored in the compact layout of BVHModel, which
+///        contains the part of BV tested by the collision traversal.
+///
+/// AABB, OBB and OBBRSS are stored in single precision.
+template<typename BV>
+struct CompactBV
+{
+  typedef BV type;
+  /// @brief Alignment of the nodes of the compact layout
+  enum { alignment = 64 };
+  static type make(const BV& bv) { return bv; }
+};
+
+template<>
+struct CompactBV<AABB>
+{
+  typedef FloatAABB type;
+  enum { alignment = 32 };
+  static type make(const AABB& bv) { return type(bv); }
+};
+
+template<>
+struct CompactBV<OBB>
+{
+  typedef FloatOBB type;
+  enum { alignment = 64 };
+  static type make(const OBB& bv) { return type(bv); }
+};
+
+/// @brief Only the OBB of an OBBRSS is used to test collision.
+template<>
+struct CompactBV<OBBRSS>
+{
+  typedef FloatOBB type;
+  enum { alignment = 64 };
+  static type make(const OBBRSS& bv) { return type(bv.obb); }
+};
+
+/// @brief A node of the compact layout of BVHModel.
+///
+/// It stores only what the collision traversal reads, i.e. the index of the
+/// first child (or of the primitive) and the bounding volume used to cull the
+/// pairs of nodes. Nodes are aligned on cache lines, or on half cache lines
+/// when they fit in it.
+template<typename BV>
+struct EIGEN_ALIGN_TO_BOUNDARY(CompactBV<BV>::alignment) CompactBVNode
+{
+  /// @brief bounding volume tested by the collision traversal
+  typename CompactBV<BV>::type bv;
+
+  /// @brief Same as BVNodeBase::first_child
+  int first_child;
+
+  CompactBVNode(const BVNode<BV>& node) :
+    bv(CompactBV<BV>::make(node.bv)), first_child(node.first_child)
+  {}
+
+  inline bool isLeaf() const { return first_child < 0; }
+
+  inline int primitiveId() const { return -(first_child + 1); }
+
+  inline int leftChild() const { return first_child; }
+
+  inline int rightChild() const { return first_child + 1; }
+};
+
 
 }
 
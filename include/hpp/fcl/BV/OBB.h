@@ -142,6 +142,11 @@ bool overlap(const Matrix3f& R0, const Vec3f& T0, const OBB& b1,
 	     const OBB& b2, const CollisionRequest& request,
              FCL_REAL& sqrDistLowerBound);
 
+/// @brief Lower bound of the distance between two obbs, b2 is in
+/// configuration (R0, T0) in the frame of b1. P and Q are not computed.
+FCL_REAL distance(const Matrix3f& R0, const Vec3f& T0, const OBB& b1,
+                  const OBB& b2, Vec3f* P = NULL, Vec3f* Q = NULL);
+
 
 /// Check collision between two boxes
 /// @param B, T orientation and position of first box,
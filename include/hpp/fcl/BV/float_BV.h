@@ -0,0 +1,162 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_FLOAT_BV_H
+#define HPP_FCL_FLOAT_BV_H
+
+#include <hpp/fcl/BV/AABB.h>
+#include <hpp/fcl/BV/OBB.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @addtogroup Bounding_Volume
+/// @{
+
+/// @brief AABB stored in single precision.
+///
+/// The bounds are rounded outward so that the box contains the AABB it is
+/// built from. The tests are done in single precision: they may only report
+/// boxes as overlapping when they are slightly apart.
+class FloatAABB
+{
+public:
+  typedef Eigen::Matrix<float, 3, 1> Vector;
+
+  /// @brief The min point of the AABB, rounded down
+  Vector min_;
+  /// @brief The max point of the AABB, rounded up
+  Vector max_;
+
+  explicit FloatAABB(const AABB& bv);
+
+  /// @brief The AABB in double precision
+  inline AABB toAABB() const
+  {
+    AABB bv;
+    bv.min_ = min_.cast<FCL_REAL>();
+    bv.max_ = max_.cast<FCL_REAL>();
+    return bv;
+  }
+
+  inline bool overlap(const FloatAABB& other) const
+  {
+    if(min_[0] > other.max_[0]) return false;
+    if(min_[1] > other.max_[1]) return false;
+    if(min_[2] > other.max_[2]) return false;
+
+    if(max_[0] < other.min_[0]) return false;
+    if(max_[1] < other.min_[1]) return false;
+    if(max_[2] < other.min_[2]) return false;
+
+    return true;
+  }
+
+  bool overlap(const FloatAABB& other, const CollisionRequest& request,
+               FCL_REAL& sqrDistLowerBound) const;
+
+  inline FCL_REAL size() const
+  {
+    return (max_ - min_).cast<FCL_REAL>().squaredNorm();
+  }
+};
+
+/// @brief OBB stored in single precision.
+///
+/// The extents are enlarged by the rounding errors of the center and of the
+/// axes, which are thus not exactly orthonormal, so that the box contains the
+/// OBB it is built from. The separating axis tests are done in single
+/// precision, the separations being reduced by a bound of the rounding errors.
+/// The distance lower bounds are thus lower bounds for the original OBB.
+class FloatOBB
+{
+public:
+  typedef Eigen::Matrix<float, 3, 1> Vector;
+  typedef Eigen::Matrix<float, 3, 3> Matrix;
+
+  Matrix axes;
+  Vector To;
+  Vector extent;
+
+  explicit FloatOBB(const OBB& bv);
+
+  /// @brief The OBB in double precision
+  inline OBB toOBB() const
+  {
+    OBB bv;
+    bv.axes = axes.cast<FCL_REAL>();
+    bv.To = To.cast<FCL_REAL>();
+    bv.extent = extent.cast<FCL_REAL>();
+    return bv;
+  }
+
+  bool overlap(const FloatOBB& other) const;
+
+  bool overlap(const FloatOBB& other, const CollisionRequest& request,
+               FCL_REAL& sqrDistLowerBound) const;
+
+  inline FCL_REAL size() const
+  {
+    return extent.cast<FCL_REAL>().squaredNorm();
+  }
+};
+
+/// @brief Check collision between two FloatAABB, b1 is in configuration
+///        (R0, T0) and b2 is in identity.
+bool overlap(const Matrix3f& R0, const Vec3f& T0, const FloatAABB& b1,
+             const FloatAABB& b2);
+
+bool overlap(const Matrix3f& R0, const Vec3f& T0, const FloatAABB& b1,
+             const FloatAABB& b2, const CollisionRequest& request,
+             FCL_REAL& sqrDistLowerBound);
+
+/// @brief Check collision between two FloatOBB, b1 is in configuration
+///        (R0, T0) and b2 is in identity.
+bool overlap(const Matrix3f& R0, const Vec3f& T0, const FloatOBB& b1,
+             const FloatOBB& b2);
+
+bool overlap(const Matrix3f& R0, const Vec3f& T0, const FloatOBB& b1,
+             const FloatOBB& b2, const CollisionRequest& request,
+             FCL_REAL& sqrDistLowerBound);
+
+/// @}
+
+}
+
+} // namespace hpp
+
+#endif
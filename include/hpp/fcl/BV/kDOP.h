@@ -178,20 +178,27 @@ public:
 
 };
 
+/// @brief Check collision between two KDOPs, b2 is in configuration (R0, T0)
+/// in the frame of b1. The diagonal planes are not invariant by rotation:
+/// the KDOPs are conservatively tested as the oriented boxes of their
+/// first six planes.
 template<size_t N>
-bool overlap(const Matrix3f& /*R0*/, const Vec3f& /*T0*/,
-             const KDOP<N>& /*b1*/, const KDOP<N>& /*b2*/)
-{
-  throw std::logic_error ("not implemented");
-}
+bool overlap(const Matrix3f& R0, const Vec3f& T0,
+             const KDOP<N>& b1, const KDOP<N>& b2);
 
+/// @brief Check collision between two KDOPs, b2 is in configuration (R0, T0)
+/// in the frame of b1.
 template<size_t N>
-bool overlap(const Matrix3f& /*R0*/, const Vec3f& /*T0*/,
-             const KDOP<N>& /*b1*/, const KDOP<N>& /*b2*/,
-             const CollisionRequest& /*request*/, FCL_REAL& /*sqrDistLowerBound*/)
-{
-  throw std::logic_error ("not implemented");
-}
+bool overlap(const Matrix3f& R0, const Vec3f& T0,
+             const KDOP<N>& b1, const KDOP<N>& b2,
+             const CollisionRequest& request, FCL_REAL& sqrDistLowerBound);
+
+/// @brief Lower bound of the distance between two KDOPs, b2 is in
+/// configuration (R0, T0) in the frame of b1. P and Q are not computed.
+template<size_t N>
+FCL_REAL distance(const Matrix3f& R0, const Vec3f& T0,
+                  const KDOP<N>& b1, const KDOP<N>& b2,
+                  Vec3f* P = NULL, Vec3f* Q = NULL);
 
 /// @brief translate the KDOP BV
 template<size_t N>
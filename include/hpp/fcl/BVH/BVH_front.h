@@ -39,7 +39,8 @@
 #define HPP_FCL_BVH_FRONT_H
 
 
-#include <list>
+#include <vector>
+#include <hpp/fcl/fwd.hh>
 
 namespace hpp
 {
@@ -65,8 +66,8 @@ struct BVHFrontNode
   }
 };
 
-/// @brief BVH front list is a list of front nodes.
-typedef std::list<BVHFrontNode> BVHFrontList;
+/// @brief BVH front list is a list of front nodes, stored contiguously.
+typedef std::vector<BVHFrontNode> BVHFrontList;
 
 /// @brief Add new front node into the front list
 inline void updateFrontList(BVHFrontList* front_list, int b1, int b2)
@@ -74,6 +75,65 @@ inline void updateFrontList(BVHFrontList* front_list, int b1, int b2)
   if(front_list) front_list->push_back(BVHFrontNode(b1, b2));
 }
 
+/// @brief Front list of a pair of objects kept between successive queries.
+///
+/// When CollisionRequest::front or DistanceRequest::front points to a
+/// BVHFront, the collision and distance between BVH models, and between a
+/// BVH model and a shape, start the traversal from the front of the previous
+/// query on the same pair instead of the roots. This pays off when the same
+/// pair is queried repeatedly with small relative motions.
+///
+/// The front is reset when the pair of objects changes. It refers to the
+/// nodes of the bounding volume hierarchies, so clear must be called when
+/// the hierarchy of one of the models is rebuilt. Refitting the hierarchy
+/// keeps the front valid.
+///
+/// A front only deepens as the objects move. Calling clear from time to
+/// time, e.g. after a large motion, restarts from the roots.
+class BVHFront
+{
+public:
+  BVHFront() : o1_(NULL), o2_(NULL) {}
+
+  /// @brief Forget the front
+  void clear()
+  {
+    nodes_.clear();
+    o1_ = o2_ = NULL;
+  }
+
+  /// @brief Front list for the pair (o1, o2). It is emptied if the
+  ///        previous query was on another pair.
+  BVHFrontList* get(const CollisionGeometry* o1, const CollisionGeometry* o2)
+  {
+    if(o1 != o1_ || o2 != o2_)
+    {
+      nodes_.clear();
+      o1_ = o1;
+      o2_ = o2;
+    }
+    return &nodes_;
+  }
+
+  /// @brief Number of nodes of the front
+  std::size_t size() const { return nodes_.size(); }
+
+  bool empty() const { return nodes_.empty(); }
+
+private:
+  BVHFrontList nodes_;
+  const CollisionGeometry* o1_;
+  const CollisionGeometry* o2_;
+};
+
+/// @brief Front list kept by front for the pair (o1, o2), NULL if front is NULL.
+inline BVHFrontList* getFrontList(BVHFront* front,
+                                  const CollisionGeometry* o1,
+                                  const CollisionGeometry* o2)
+{
+  return front ? front->get(o1, o2) : NULL;
+}
+
 
 }
 
@@ -54,6 +54,12 @@ namespace fcl
 /// @{
 
 class ConvexBase;
+class ThreadPool;
+
+namespace internal
+{
+template <typename BV> struct BVHModelSerializer;
+}
 
 template <typename BV> class BVFitter;
 template <typename BV> class BVSplitter;
@@ -103,7 +109,8 @@ public:
                    build_state(BVH_BUILD_STATE_EMPTY),
                    num_tris_allocated(0),
                    num_vertices_allocated(0),
-                   num_vertex_updated(0)
+                   num_vertex_updated(0),
+                   own_storage_(true)
   {
   }
 
@@ -113,11 +120,21 @@ public:
   /// @brief deconstruction, delete mesh data related.
   virtual ~BVHModelBase ()
   {
-    delete [] vertices;
-    delete [] tri_indices;
+    if(own_storage_)
+    {
+      delete [] vertices;
+      delete [] tri_indices;
+    }
     delete [] prev_vertices;
   }
 
+  /// @brief Whether the vertices, the triangles and the hierarchy are owned
+  ///        by this object.
+  ///
+  /// They are not when the model is loaded from a mapped file, see
+  /// loadBinary. Such a model cannot be replaced or updated.
+  bool ownStorage() const { return own_storage_; }
+
   /// @brief Get the object type: it is a BVH
   OBJECT_TYPE getObjectType() const { return OT_BVH; }
 
@@ -142,6 +159,14 @@ public:
   /// @brief End BVH model construction, will build the bounding volume hierarchy
   int endModel();
 
+  /// @brief End BVH model construction, the bounding volume hierarchy being
+  ///        built by the threads of pool.
+  ///
+  /// The independent subtrees are built concurrently and the nodes at the top
+  /// of the hierarchy are fitted by all the threads. The hierarchy is the
+  /// same as the one built by endModel.
+  int endModel(ThreadPool& pool);
+
   /// @brief Replace the geometry information of current frame (i.e. should have the same mesh topology with the previous frame)
   int beginReplaceModel();
 
@@ -174,9 +199,13 @@ public:
   int endUpdateModel(bool refit = true, bool bottomup = true);
 
   /// @brief Build this Convex<Triangle> representation of this model.
-  /// \note this only takes the points of this model. It does not check that the
-  ///       object is convex. It does not compute a convex hull.
-  void buildConvexRepresentation(bool share_memory);
+  /// \param share_memory whether the representation uses the points and
+  ///        triangles of this model. It is ignored when computing the hull.
+  /// \param compute_hull whether the representation is the convex hull of
+  ///        the points, see ConvexBase::convexHull.
+  /// \note Unless compute_hull is true, this only takes the points of this
+  ///       model. It does not check that the object is convex.
+  void buildConvexRepresentation(bool share_memory, bool compute_hull = false);
 
   virtual int memUsage(int msg) const = 0;
 
@@ -241,12 +270,23 @@ protected:
   /// @brief Build the bounding volume hierarchy
   virtual int buildTree() = 0;
 
+  /// @brief Build the bounding volume hierarchy with the threads of pool
+  virtual int buildTree(ThreadPool& pool) = 0;
+
   /// @brief Refit the bounding volume hierarchy
   virtual int refitTree(bool bottomup) = 0;
 
   int num_tris_allocated;
   int num_vertices_allocated;
   int num_vertex_updated; /// for ccd vertex update
+
+  /// @brief See ownStorage
+  bool own_storage_;
+
+private:
+  /// @brief Implementation of endModel, the hierarchy being built by the
+  ///        threads of pool if it is not NULL.
+  int endModel(ThreadPool* pool);
 };
 
 /// @brief A class describing the bounding hierarchy of a mesh model or a point cloud model (which is viewed as a degraded version of mesh)
@@ -270,8 +310,12 @@ public:
   /// @brief deconstruction, delete mesh data related.
   ~BVHModel()
   {
-    delete [] bvs;
-    delete [] primitive_indices;
+    if(own_storage_)
+    {
+      delete [] bvs;
+      delete [] primitive_indices;
+    }
+    delete [] compact_memory;
   }
 
   /// @brief We provide getBV() and getNumBVs() because BVH may be compressed (in future), so we must provide some flexibility here
@@ -302,15 +346,37 @@ public:
   /// @brief Check the number of memory used
   int memUsage(int msg) const;
 
+  /// @brief Build the compact layout of the hierarchy.
+  ///
+  /// The collision traversal between two models reads the compact layouts
+  /// instead of the BV nodes when both models have one. The bounding volumes
+  /// may be stored in single precision (see CompactBV), rounded outward, so
+  /// that the traversal may only test more nodes. The layout is updated when
+  /// the hierarchy is refitted and removed by beginModel. It must be rebuilt
+  /// if the nodes are modified through getBV.
+  void buildCompactLayout();
+
+  /// @brief Remove the compact layout of the hierarchy
+  void clearCompactLayout();
+
+  /// @brief Access the compact layout, NULL if it has not been built
+  const CompactBVNode<BV>* getCompactBVs() const
+  {
+    return compact_bvs;
+  }
+
   /// @brief This is a special acceleration: BVH_model default stores the BV's transform in world coordinate. However, we can also store each BV's transform related to its parent 
   /// BV node. When traversing the BVH, this can save one matrix transformation.
   void makeParentRelative()
   {
     Matrix3f I (Matrix3f::Identity());
     makeParentRelativeRecurse(0, I, Vec3f());
+    if(compact_bvs) buildCompactLayout();
   }
 
 private:
+  friend struct internal::BVHModelSerializer<BV>;
+
   void deleteBVs();
   bool allocateBVs();
 
@@ -323,9 +389,19 @@ private:
   /// @brief Number of BV nodes in bounding volume hierarchy
   int num_bvs;
 
+  /// @brief Compact layout of the hierarchy, NULL if it has not been built.
+  /// The nodes are in the same order as in bvs.
+  CompactBVNode<BV>* compact_bvs;
+
+  /// @brief Memory of compact_bvs, allocated with room for the alignment
+  char* compact_memory;
+
   /// @brief Build the bounding volume hierarchy
   int buildTree();
 
+  /// @brief Build the bounding volume hierarchy with the threads of pool
+  int buildTree(ThreadPool& pool);
+
   /// @brief Refit the bounding volume hierarchy
   int refitTree(bool bottomup);
 
@@ -335,8 +411,27 @@ private:
   /// @brief Refit the bounding volume hierarchy in a bottom-up way (fast but less compact)
   int refitTree_bottomup();
 
+  /// @brief Fit the BV node bv_id to its primitives and, if there are more
+  ///        than one, split them among the children first_child and
+  ///        first_child + 1.
+  /// @return the number of primitives of the first child.
+  int buildNode(BVFitter<BV>& fitter, BVSplitter<BV>& splitter, int bv_id,
+                int first_primitive, int num_primitives, int first_child);
+
+  /// @brief Same as buildNode, the BV node bv_id being already fitted.
+  int splitNode(BVSplitter<BV>& splitter, int bv_id, int first_primitive,
+                int num_primitives, int first_child);
+
   /// @brief Recursive kernel for hierarchy construction
-  int recursiveBuildTree(int bv_id, int first_primitive, int num_primitives);
+  ///
+  /// The 2 * num_primitives - 2 descendants of bv_id are stored from
+  /// first_child, so that independent subtrees can be built concurrently.
+  void recursiveBuildTree(BVFitter<BV>& fitter, BVSplitter<BV>& splitter,
+                          int bv_id, int first_primitive, int num_primitives,
+                          int first_child);
+
+  /// @brief Construction of the subtrees in buildTree(ThreadPool&)
+  struct BuildTask;
 
   /// @brief Recursive kernel for bottomup refitting 
   int recursiveRefitTree_bottomup(int bv_id);
@@ -0,0 +1,123 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_BVH_WIDE_H
+#define HPP_FCL_BVH_WIDE_H
+
+#include <vector>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/collision_data.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @addtogroup Construction_Of_BVH
+/// @{
+
+/// @brief Hierarchy of AABB with up to 4 children per node, collapsed from
+///        the binary hierarchy of a BVHModel<AABB>.
+///
+/// A node stores the bounds of its children in single precision, one lane
+/// per child, so that a bounding volume is tested against the 4 children at
+/// once with vector instructions. The tests are done in single precision, the
+/// distances being reduced by a bound of the rounding errors. The leaves are
+/// the leaves of the binary hierarchy. The model is not copied: it must
+/// outlive the WideBVH and the WideBVH must be rebuilt when the model is
+/// modified.
+class WideBVH
+{
+public:
+  typedef Eigen::Array<float, 4, 1> Lanes;
+
+  struct Node
+  {
+    /// @brief Min and max corners of the AABB of the children, rounded
+    ///        outward. Empty lanes hold zeros.
+    Lanes min_[3];
+    Lanes max_[3];
+
+    /// @brief Children: the index of a node if positive, -(index of a leaf of
+    ///        the BVHModel + 1) if negative, 0 if the lane is empty.
+    int children[4];
+
+    /// @brief Node with 4 empty lanes
+    Node();
+
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+  };
+
+  explicit WideBVH(const BVHModel<AABB>& model);
+
+  const BVHModel<AABB>& getModel() const { return model_; }
+
+  /// @brief Access a node. The root is node 0.
+  const Node& getNode(std::size_t i) const { return nodes_[i]; }
+
+  std::size_t getNumNodes() const { return nodes_.size(); }
+
+private:
+  /// @brief Build the node whose children are collapsed from the subtree of
+  ///        bv_id, and its descendants.
+  /// @return the index of the node.
+  int build(int bv_id);
+
+  const BVHModel<AABB>& model_;
+  std::vector<Node, Eigen::aligned_allocator<Node> > nodes_;
+};
+
+/// @brief Collision between a mesh and a shape, the mesh being traversed
+///        through its wide hierarchy.
+///
+/// The contacts are the same as with collide(const CollisionGeometry*, ...)
+/// on the model of mesh.
+std::size_t collide(const WideBVH& mesh, const Transform3f& tf1,
+                    const CollisionGeometry* shape, const Transform3f& tf2,
+                    const CollisionRequest& request, CollisionResult& result);
+
+/// @brief Collision between two meshes traversed through their wide
+///        hierarchies.
+std::size_t collide(const WideBVH& mesh1, const Transform3f& tf1,
+                    const WideBVH& mesh2, const Transform3f& tf2,
+                    const CollisionRequest& request, CollisionResult& result);
+
+/// @}
+
+}
+
+} // namespace hpp
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_BROADPHASE_SAP_H
+#define HPP_FCL_BROADPHASE_SAP_H
+
+#include <map>
+#include <set>
+#include <hpp/fcl/broadphase/broadphase_collision_manager.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Incremental sweep and prune collision manager.
+///
+/// The endpoints of the AABBs of the objects are kept sorted along the three
+/// axes, together with the set of pairs of objects whose AABB overlap. When
+/// objects move, their endpoints are moved by insertion sort and the set of
+/// overlapping pairs is modified only when two endpoints are swapped. For
+/// temporally coherent scenes, the cost of an update is proportional to the
+/// motion of the objects, not to the size of the scene, and self collision
+/// only visits the overlapping pairs.
+class SaPCollisionManager : public BroadPhaseCollisionManager
+{
+public:
+  /// @brief Pair of objects, the lowest address first
+  typedef std::pair<CollisionObject*, CollisionObject*> ObjectPair;
+  typedef std::set<ObjectPair> ObjectPairSet;
+
+  using BroadPhaseCollisionManager::collide;
+  using BroadPhaseCollisionManager::distance;
+
+  SaPCollisionManager() {}
+
+  void registerObjects(const std::vector<CollisionObject*>& other_objs);
+
+  void registerObject(CollisionObject* obj);
+
+  void unregisterObject(CollisionObject* obj);
+
+  void setup() {}
+
+  /// @brief update all the objects
+  void update();
+
+  void update(CollisionObject* updated_obj);
+
+  void update(const std::vector<CollisionObject*>& updated_objs);
+
+  /// @brief update the given objects and report the changes in the set of
+  /// overlapping pairs.
+  /// @param updated_objs objects that have moved since the last update,
+  ///        CollisionObject::computeAABB must have been called.
+  /// @retval created pairs which overlap now and did not before the update
+  /// @retval destroyed pairs which overlapped before the update and do not now
+  void update(const std::vector<CollisionObject*>& updated_objs,
+              std::vector<ObjectPair>& created,
+              std::vector<ObjectPair>& destroyed);
+
+  void clear();
+
+  void getObjects(std::vector<CollisionObject*>& objs) const;
+
+  void collide(CollisionObject* obj, void* cdata, CollisionCallBack callback) const;
+
+  void distance(CollisionObject* obj, void* cdata, DistanceCallBack callback) const;
+
+  /// @note only the current overlapping pairs are visited.
+  void collide(void* cdata, CollisionCallBack callback) const;
+
+  void distance(void* cdata, DistanceCallBack callback) const;
+
+  bool empty() const { return proxies.empty(); }
+
+  std::size_t size() const { return proxies.size(); }
+
+  /// @brief pairs of objects whose AABB overlap
+  const ObjectPairSet& getOverlappingPairs() const { return overlap_pairs; }
+
+protected:
+  /// @brief Lower or upper bound of an AABB along one axis
+  struct EndPoint
+  {
+    FCL_REAL value;
+    std::size_t proxy;
+    /// @brief 0 for the lower bound, 1 for the upper bound
+    int is_max;
+
+    /// @brief Order by value, lower bounds first in case of equality so that
+    /// touching AABBs overlap, as with AABB::overlap.
+    inline bool operator< (const EndPoint& other) const
+    {
+      return value < other.value || (value == other.value && is_max < other.is_max);
+    }
+  };
+
+  /// @brief Registered object
+  struct Proxy
+  {
+    CollisionObject* obj;
+    /// @brief AABB of the object at the last update
+    AABB aabb;
+    /// @brief position of the endpoints in the axis arrays
+    std::size_t endpoints[3][2];
+  };
+
+  /// @brief Changes of the set of overlapping pairs during an update:
+  /// whether each modified pair was overlapping before the update.
+  typedef std::map<ObjectPair, bool> PairChanges;
+
+  static ObjectPair makePair(CollisionObject* a, CollisionObject* b)
+  {
+    return (a < b) ? ObjectPair(a, b) : ObjectPair(b, a);
+  }
+
+  void updateProxy(std::size_t i, PairChanges* changes);
+
+  /// @brief insertion sort of one endpoint
+  void moveEndPoint(int axis, std::size_t i, PairChanges* changes);
+
+  /// @brief endpoint m has just been swapped with endpoint p
+  void handleSwap(const EndPoint& m, const EndPoint& p, bool m_moved_left, PairChanges* changes);
+
+  void addPair(CollisionObject* a, CollisionObject* b, PairChanges* changes);
+
+  void removePair(CollisionObject* a, CollisionObject* b, PairChanges* changes);
+
+  /// @brief recompute the positions of the endpoints from index begin
+  void renumber(int axis, std::size_t begin);
+
+  std::vector<EndPoint> axes[3];
+  std::vector<Proxy> proxies;
+  std::map<CollisionObject*, std::size_t> proxy_index;
+  ObjectPairSet overlap_pairs;
+};
+
+}
+
+} // namespace hpp
+
+#endif
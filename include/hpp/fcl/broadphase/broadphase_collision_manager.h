@@ -0,0 +1,167 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_BROADPHASE_COLLISION_MANAGER_H
+#define HPP_FCL_BROADPHASE_COLLISION_MANAGER_H
+
+#include <vector>
+#include <hpp/fcl/collision_object.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Callback for collision between two objects. Return value is whether
+/// the broadphase can stop now.
+typedef bool (*CollisionCallBack)(CollisionObject* o1, CollisionObject* o2, void* cdata);
+
+/// @brief Callback for distance between two objects. Return value is whether
+/// the broadphase can stop now, dist must be set to the current minimal
+/// distance so that the managers can prune the pairs that are further away.
+typedef bool (*DistanceCallBack)(CollisionObject* o1, CollisionObject* o2, void* cdata, FCL_REAL& dist);
+
+/// @brief Base class for broadphase collision managers.
+///
+/// A manager stores a set of objects and finds the pairs of objects whose
+/// AABB overlap, either within the manager (self collision) or with a query
+/// object or another manager. The narrowphase is left to the user through
+/// the callbacks. The manager does not own the objects, it uses
+/// CollisionObject::getAABB, so CollisionObject::computeAABB must be called
+/// on moved objects before update.
+class BroadPhaseCollisionManager
+{
+public:
+  virtual ~BroadPhaseCollisionManager() {}
+
+  /// @brief add objects to the manager
+  virtual void registerObjects(const std::vector<CollisionObject*>& other_objs);
+
+  /// @brief add one object to the manager
+  virtual void registerObject(CollisionObject* obj) = 0;
+
+  /// @brief remove one object from the manager
+  virtual void unregisterObject(CollisionObject* obj) = 0;
+
+  /// @brief initialize the manager, related with the specific type of manager
+  virtual void setup() = 0;
+
+  /// @brief update the condition of manager after the objects have moved
+  virtual void update() = 0;
+
+  /// @brief update the manager by explicitly given the object updated
+  virtual void update(CollisionObject* updated_obj);
+
+  /// @brief update the manager by explicitly given the set of objects updated
+  virtual void update(const std::vector<CollisionObject*>& updated_objs);
+
+  /// @brief clear the manager
+  virtual void clear() = 0;
+
+  /// @brief return the objects managed by the manager
+  virtual void getObjects(std::vector<CollisionObject*>& objs) const = 0;
+
+  /// @brief perform collision test between one object and all the objects belonging to the manager
+  virtual void collide(CollisionObject* obj, void* cdata, CollisionCallBack callback) const = 0;
+
+  /// @brief perform distance computation between one object and all the objects belonging to the manager
+  virtual void distance(CollisionObject* obj, void* cdata, DistanceCallBack callback) const = 0;
+
+  /// @brief perform collision test for the objects belonging to the manager (i.e., N^2 self collision)
+  virtual void collide(void* cdata, CollisionCallBack callback) const = 0;
+
+  /// @brief perform distance test for the objects belonging to the manager (i.e., N^2 self distance)
+  virtual void distance(void* cdata, DistanceCallBack callback) const = 0;
+
+  /// @brief perform collision test with objects belonging to another manager
+  virtual void collide(BroadPhaseCollisionManager* other_manager, void* cdata, CollisionCallBack callback) const;
+
+  /// @brief perform distance test with objects belonging to another manager
+  virtual void distance(BroadPhaseCollisionManager* other_manager, void* cdata, DistanceCallBack callback) const;
+
+  /// @brief whether the manager is empty
+  virtual bool empty() const = 0;
+  
+  /// @brief the number of objects managed by the manager
+  virtual std::size_t size() const = 0;
+};
+
+/// @brief Brute force N-body collision manager, mostly useful as a reference
+/// for the other managers.
+class NaiveCollisionManager : public BroadPhaseCollisionManager
+{
+public:
+  NaiveCollisionManager() {}
+
+  void registerObjects(const std::vector<CollisionObject*>& other_objs);
+
+  void registerObject(CollisionObject* obj);
+
+  void unregisterObject(CollisionObject* obj);
+
+  void setup() {}
+
+  void update() {}
+
+  void clear();
+
+  void getObjects(std::vector<CollisionObject*>& objs) const;
+
+  void collide(CollisionObject* obj, void* cdata, CollisionCallBack callback) const;
+
+  void distance(CollisionObject* obj, void* cdata, DistanceCallBack callback) const;
+
+  void collide(void* cdata, CollisionCallBack callback) const;
+
+  void distance(void* cdata, DistanceCallBack callback) const;
+
+  void collide(BroadPhaseCollisionManager* other_manager, void* cdata, CollisionCallBack callback) const;
+
+  void distance(BroadPhaseCollisionManager* other_manager, void* cdata, DistanceCallBack callback) const;
+
+  bool empty() const { return objs.empty(); }
+
+  std::size_t size() const { return objs.size(); }
+
+protected:
+  /// @brief objects belonging to the manager
+  std::vector<CollisionObject*> objs;
+};
+
+}
+
+} // namespace hpp
+
+#endif
@@ -0,0 +1,132 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_BROADPHASE_DYNAMIC_AABB_TREE_H
+#define HPP_FCL_BROADPHASE_DYNAMIC_AABB_TREE_H
+
+#include <map>
+#include <hpp/fcl/broadphase/broadphase_collision_manager.h>
+#include <hpp/fcl/broadphase/detail/hierarchy_tree.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Broadphase collision manager based on a dynamic AABB tree.
+///
+/// Each object is a leaf of the tree, bounded by a fat AABB: the world AABB
+/// of the object enlarged by fat_margin times its extent along each axis.
+/// update only moves the leaves of the objects that left their fat AABB.
+class DynamicAABBTreeCollisionManager : public BroadPhaseCollisionManager
+{
+public:
+  typedef detail::HierarchyTree::NodeIndex NodeIndex;
+  typedef std::map<CollisionObject*, NodeIndex> ObjectLeafMap;
+
+  /// @brief Construction of the tree when objects are registered all at
+  /// once or when the tree is rebuilt. See HierarchyTree::rebuild.
+  int tree_init_level;
+
+  /// @brief Relative enlargement of the leaf AABBs
+  FCL_REAL fat_margin;
+
+  /// @brief setup rebuilds the tree when its height exceeds
+  /// max_tree_nonbalanced_level times the height of a perfectly balanced tree
+  FCL_REAL max_tree_nonbalanced_level;
+
+  DynamicAABBTreeCollisionManager() : tree_init_level (1),
+                                      fat_margin (0.1),
+                                      max_tree_nonbalanced_level (2)
+  {
+  }
+
+  void registerObjects(const std::vector<CollisionObject*>& other_objs);
+
+  void registerObject(CollisionObject* obj);
+
+  void unregisterObject(CollisionObject* obj);
+
+  /// @brief rebuild the tree if it is unbalanced
+  void setup();
+
+  void update();
+
+  void update(CollisionObject* updated_obj);
+
+  void update(const std::vector<CollisionObject*>& updated_objs);
+
+  void clear();
+
+  void getObjects(std::vector<CollisionObject*>& objs) const;
+
+  void collide(CollisionObject* obj, void* cdata, CollisionCallBack callback) const;
+
+  void distance(CollisionObject* obj, void* cdata, DistanceCallBack callback) const;
+
+  void collide(void* cdata, CollisionCallBack callback) const;
+
+  void distance(void* cdata, DistanceCallBack callback) const;
+
+  /// @note when other_manager is a DynamicAABBTreeCollisionManager, both
+  /// trees are traversed simultaneously.
+  void collide(BroadPhaseCollisionManager* other_manager, void* cdata, CollisionCallBack callback) const;
+
+  /// @note when other_manager is a DynamicAABBTreeCollisionManager, both
+  /// trees are traversed simultaneously.
+  void distance(BroadPhaseCollisionManager* other_manager, void* cdata, DistanceCallBack callback) const;
+
+  bool empty() const { return dtree.empty(); }
+
+  std::size_t size() const { return dtree.size(); }
+
+  const detail::HierarchyTree& getTree() const { return dtree; }
+
+protected:
+  /// @brief AABB of the object enlarged by fat_margin
+  AABB fatAABB(const CollisionObject* obj) const;
+
+  /// @brief update the leaf of one object, return whether the tree changed
+  bool updateObject(CollisionObject* obj);
+
+  detail::HierarchyTree dtree;
+  ObjectLeafMap table;
+};
+
+}
+
+} // namespace hpp
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HPP_FCL_BROADPHASE_DETAIL_HIERARCHY_TREE_H
+#define HPP_FCL_BROADPHASE_DETAIL_HIERARCHY_TREE_H
+
+#include <vector>
+#include <hpp/fcl/BV/AABB.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+class CollisionObject;
+
+namespace detail
+{
+
+/// @brief Dynamic AABB tree used by the broadphase managers.
+///
+/// Nodes are stored in a contiguous array and refer to each other by index,
+/// released nodes are recycled through a free list. Leaves store the object
+/// they bound and a fat AABB, i.e. an AABB enlarged by a margin so that small
+/// motions of the object do not require to modify the tree. The tree is kept
+/// balanced with AVL rotations on insertion and removal.
+class HierarchyTree
+{
+public:
+  typedef std::size_t NodeIndex;
+
+  /// @brief Index of a non existing node
+  static const NodeIndex NULL_NODE = (NodeIndex) -1;
+
+  struct Node
+  {
+    /// @brief bounding volume of the subtree (the fat AABB for leaves)
+    AABB bv;
+
+    /// @brief parent node, or next free node when the node is released
+    NodeIndex parent;
+
+    /// @brief children nodes, NULL_NODE for leaves
+    NodeIndex children[2];
+
+    /// @brief height of the subtree: 0 for leaves, -1 for released nodes
+    int height;
+
+    /// @brief object bound by a leaf, NULL for internal nodes
+    CollisionObject* data;
+
+    inline bool isLeaf() const { return children[0] == NULL_NODE; }
+  };
+
+  HierarchyTree();
+
+  /// @brief Remove all the nodes
+  void clear();
+
+  /// @brief Insert a leaf with the given (fat) bounding volume
+  /// @return the index of the leaf, which stays valid until it is removed.
+  NodeIndex insert(const AABB& bv, CollisionObject* data);
+
+  /// @brief Remove a leaf returned by insert
+  void remove(NodeIndex leaf);
+
+  /// @brief Move a leaf whose fat bounding volume does not contain bv
+  ///        anymore. The leaf is reinserted with bounding volume fat_bv.
+  /// @return whether the tree has been modified.
+  bool update(NodeIndex leaf, const AABB& bv, const AABB& fat_bv);
+
+  /// @brief Rebuild the tree from its leaves.
+  /// @param level 0: incremental insertion, 1: top-down build splitting at
+  ///        the median of the leaf centers, 2: top-down build splitting at
+  ///        the middle of the extent of the leaf centers.
+  /// Leaf indices are preserved.
+  void rebuild(int level);
+
+  /// @brief Root of the tree, NULL_NODE if the tree is empty
+  inline NodeIndex getRoot() const { return root_; }
+
+  inline const Node& getNode(NodeIndex i) const { return nodes_[i]; }
+
+  /// @brief Number of leaves
+  inline std::size_t size() const { return n_leaves_; }
+
+  inline bool empty() const { return n_leaves_ == 0; }
+
+  /// @brief Height of the tree, -1 if empty
+  inline int getHeight() const
+  {
+    return (root_ == NULL_NODE) ? -1 : nodes_[root_].height;
+  }
+
+private:
+  NodeIndex allocateNode();
+  void releaseNode(NodeIndex i);
+
+  void insertLeaf(NodeIndex leaf);
+  void removeLeaf(NodeIndex leaf);
+
+  /// @brief Rotate the subtree rooted at i if it is unbalanced.
+  /// @return the new root of the subtree.
+  NodeIndex balance(NodeIndex i);
+
+  /// @brief Recompute bounding volumes and heights from i up to the root.
+  void refitUpward(NodeIndex i);
+
+  NodeIndex buildTopDown(std::vector<NodeIndex>::iterator begin,
+                         std::vector<NodeIndex>::iterator end, int level);
+
+  std::vector<Node> nodes_;
+  NodeIndex root_;
+  NodeIndex free_list_;
+  std::size_t n_leaves_;
+};
+
+/// @brief Surface area of an AABB, used as cost when inserting leaves
+inline FCL_REAL surfaceArea(const AABB& bv)
+{
+  Vec3f d (bv.max_ - bv.min_);
+  return 2 * (d[0] * d[1] + d[1] * d[2] + d[2] * d[0]);
+}
+
+} // namespace detail
+
+}
+
+} // namespace hpp
+
+#endif
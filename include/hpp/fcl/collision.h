@@ -39,6 +39,8 @@
 #ifndef HPP_FCL_COLLISION_H
 #define HPP_FCL_COLLISION_H
 
+#include <vector>
+#include <hpp/fcl/fwd.hh>
 #include <hpp/fcl/data_types.h>
 #include <hpp/fcl/collision_object.h>
 #include <hpp/fcl/collision_data.h>
@@ -59,6 +61,55 @@ std::size_t collide(const CollisionObject* o1, const CollisionObject* o2,
 std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1,
                     const CollisionGeometry* o2, const Transform3f& tf2,
                     const CollisionRequest& request, CollisionResult& result);
+
+/// @brief Collision test between two geometries for a sequence of
+///        configurations of the first one, e.g. along a path.
+///
+/// This is equivalent to calling collide for each configuration tf1[i], but
+/// the collision function and the narrow phase solver are set up once. The
+/// solver is initialized at each configuration with the separating
+/// direction found at the previous one (or with request.cached_gjk_guess
+/// for the first one, if request.enable_cached_gjk_guess is set).
+/// @param results resized to the number of tested configurations,
+///        results[i] is the result of the test at configuration tf1[i]. The
+///        vector can be reused between calls to avoid allocations.
+/// @param stopAtFirstCollision whether to stop at the first configuration
+///        in collision.
+/// @return the index of the first configuration in collision, tf1.size()
+///         if there is none.
+std::size_t collide(const CollisionGeometry* o1,
+                    const std::vector<Transform3f>& tf1,
+                    const CollisionGeometry* o2, const Transform3f& tf2,
+                    const CollisionRequest& request,
+                    std::vector<CollisionResult>& results,
+                    bool stopAtFirstCollision = false);
+
+/// @brief Collision tests between many pairs of objects, run in parallel by
+///        the threads of pool.
+///
+/// Each thread uses its own narrow phase solver. results[i] is the result
+/// of the test between pairs[i].first and pairs[i].second, which does not
+/// depend on the number of threads.
+/// @param results resized to the number of pairs.
+/// @return the number of pairs in collision.
+std::size_t collide(const std::vector<CollisionObjectPair>& pairs,
+                    const CollisionRequest& request,
+                    std::vector<CollisionResult>& results,
+                    ThreadPool& pool);
+
+/// @brief Collision test between two geometries, run by the threads of pool.
+///
+/// Between two BVHModel with the same type of bounding volume, the bounding
+/// volume test tree is split into subtrees that the threads traverse with
+/// work stealing. The other pairs of geometries are tested by the calling
+/// thread, as by collide.
+/// @note The contacts are the same as with collide, up to their order,
+///       unless request.num_max_contacts is reached: which contacts are then
+///       returned depends on the scheduling of the threads.
+std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1,
+                    const CollisionGeometry* o2, const Transform3f& tf2,
+                    const CollisionRequest& request, CollisionResult& result,
+                    ThreadPool& pool);
 }
 
 } // namespace hpp
@@ -39,6 +39,7 @@
 #ifndef HPP_FCL_COLLISION_DATA_H
 #define HPP_FCL_COLLISION_DATA_H
 
+#include <hpp/fcl/fwd.hh>
 #include <hpp/fcl/collision_object.h>
 
 #include <hpp/fcl/data_types.h>
@@ -68,6 +69,7 @@ struct Contact
   /// if object 1 is mesh or point cloud, it is the triangle or point id
   /// if object 1 is geometry shape, it is NONE (-1),
   /// if object 1 is octree, it is the id of the cell
+  /// if object 1 is height field, it is the triangle id, see HeightField::getTriangle
   int b1;
 
 
@@ -75,6 +77,7 @@ struct Contact
   /// if object 2 is mesh or point cloud, it is the triangle or point id
   /// if object 2 is geometry shape, it is NONE (-1),
   /// if object 2 is octree, it is the id of the cell
+  /// if object 2 is height field, it is the triangle id, see HeightField::getTriangle
   int b2;
  
   /// @brief contact normal, pointing from o1 to o2
@@ -168,6 +171,14 @@ struct CollisionRequest
   /// @brief Distance below which bounding volumes are break down
   FCL_REAL break_distance;
 
+  /// @brief Front list kept between successive queries on the same pair of
+  ///        objects, see BVHFront. NULL to traverse from the roots.
+  BVHFront* front;
+
+  /// @brief GJK simplex kept between successive queries on the same pair of
+  ///        shapes, see GJKCache. NULL to start GJK from the initial guess.
+  GJKCache* gjk_cache;
+
   explicit CollisionRequest(size_t num_max_contacts_,
                    bool enable_contact_ = false,
 		   bool enable_distance_lower_bound_ = false,
@@ -183,7 +194,9 @@ struct CollisionRequest
     enable_distance_lower_bound (flag & DISTANCE_LOWER_BOUND),
     gjk_solver_type(GST_INDEP),
     security_margin (0),
-    break_distance (1e-3)
+    break_distance (1e-3),
+    front (NULL),
+    gjk_cache (NULL)
   {
     enable_cached_gjk_guess = false;
     cached_gjk_guess = Vec3f(1, 0, 0);
@@ -195,7 +208,9 @@ struct CollisionRequest
       enable_distance_lower_bound (false),
       gjk_solver_type(GST_INDEP),
       security_margin (0),
-      break_distance (1e-3)
+      break_distance (1e-3),
+      front (NULL),
+      gjk_cache (NULL)
     {
       enable_cached_gjk_guess = false;
       cached_gjk_guess = Vec3f(1, 0, 0);
@@ -292,7 +307,13 @@ struct DistanceRequest
   /// @brief narrow phase solver type
   GJKSolverType gjk_solver_type;
 
+  /// @brief Front list kept between successive queries on the same pair of
+  ///        objects, see BVHFront. NULL to traverse from the roots.
+  BVHFront* front;
 
+  /// @brief GJK simplex kept between successive queries on the same pair of
+  ///        shapes, see GJKCache. NULL to start GJK from the initial guess.
+  GJKCache* gjk_cache;
 
   DistanceRequest(bool enable_nearest_points_ = false,
                   FCL_REAL rel_err_ = 0.0,
@@ -300,7 +321,9 @@ struct DistanceRequest
                   GJKSolverType gjk_solver_type_ = GST_INDEP) : enable_nearest_points(enable_nearest_points_),
                                                                 rel_err(rel_err_),
                                                                 abs_err(abs_err_),
-                                                                gjk_solver_type(gjk_solver_type_)
+                                                                gjk_solver_type(gjk_solver_type_),
+                                                                front(NULL),
+                                                                gjk_cache(NULL)
   {
   }
 
@@ -333,12 +356,14 @@ public:
   /// if object 1 is mesh or point cloud, it is the triangle or point id
   /// if object 1 is geometry shape, it is NONE (-1),
   /// if object 1 is octree, it is the id of the cell
+  /// if object 1 is height field, it is the triangle id, see HeightField::getTriangle
   int b1;
 
   /// @brief information about the nearest point in object 2
   /// if object 2 is mesh or point cloud, it is the triangle or point id
   /// if object 2 is geometry shape, it is NONE (-1),
   /// if object 2 is octree, it is the id of the cell
+  /// if object 2 is height field, it is the triangle id, see HeightField::getTriangle
   int b2;
 
   /// @brief invalid contact primitive information
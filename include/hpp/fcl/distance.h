@@ -38,6 +38,8 @@
 #ifndef HPP_FCL_DISTANCE_H
 #define HPP_FCL_DISTANCE_H
 
+#include <vector>
+#include <hpp/fcl/fwd.hh>
 #include <hpp/fcl/collision_object.h>
 #include <hpp/fcl/collision_data.h>
 
@@ -54,6 +56,52 @@ FCL_REAL distance(const CollisionObject* o1, const CollisionObject* o2, const Di
 FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1,
                   const CollisionGeometry* o2, const Transform3f& tf2,
                   const DistanceRequest& request, DistanceResult& result);
+
+/// @brief Distance computation between two geometries for a sequence of
+///        configurations of the first one, e.g. along a path.
+///
+/// This is equivalent to calling distance for each configuration tf1[i],
+/// but the distance function and the narrow phase solver are set up once.
+/// The solver is initialized at each configuration with the separating
+/// direction found at the previous one.
+/// @param results resized to the number of tested configurations,
+///        results[i] is the result at configuration tf1[i]. The vector can
+///        be reused between calls to avoid allocations.
+/// @param stopAtFirstCollision whether to stop at the first configuration
+///        where the distance is not positive.
+/// @return the minimal distance over the tested configurations.
+FCL_REAL distance(const CollisionGeometry* o1,
+                  const std::vector<Transform3f>& tf1,
+                  const CollisionGeometry* o2, const Transform3f& tf2,
+                  const DistanceRequest& request,
+                  std::vector<DistanceResult>& results,
+                  bool stopAtFirstCollision = false);
+
+/// @brief Distance computations between many pairs of objects, run in
+///        parallel by the threads of pool.
+///
+/// Each thread uses its own narrow phase solver. results[i] is the result
+/// of the computation between pairs[i].first and pairs[i].second, which
+/// does not depend on the number of threads.
+/// @param results resized to the number of pairs.
+/// @return the minimal distance over all the pairs.
+FCL_REAL distance(const std::vector<CollisionObjectPair>& pairs,
+                  const DistanceRequest& request,
+                  std::vector<DistanceResult>& results,
+                  ThreadPool& pool);
+
+/// @brief Distance computation between two geometries, run by the threads
+///        of pool.
+///
+/// Between two BVHModel with the same type of bounding volume, among AABB,
+/// OBB, RSS, kIOS and OBBRSS, the bounding volume test tree is split into
+/// subtrees that the threads traverse with work stealing. The threads share
+/// the minimal distance found so far to prune the subtrees. The other pairs
+/// of geometries are handled by the calling thread, as by distance.
+FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1,
+                  const CollisionGeometry* o2, const Transform3f& tf2,
+                  const DistanceRequest& request, DistanceResult& result,
+                  ThreadPool& pool);
 }
 
 } // namespace hpp
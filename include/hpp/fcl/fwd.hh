@@ -37,6 +37,7 @@
 #ifndef HPP_FCL_FWD_HH
 #define HPP_FCL_FWD_HH
 
+#include <utility>
 #include <boost/shared_ptr.hpp>
 
 namespace hpp {
@@ -54,6 +55,14 @@ namespace fcl {
 
   class BVHModelBase;
   typedef boost::shared_ptr<BVHModelBase> BVHModelPtr_t;
+
+  typedef std::pair<const CollisionObject*, const CollisionObject*>
+  CollisionObjectPair;
+
+  class ThreadPool;
+
+  class BVHFront;
+  class GJKCache;
 }
 } // namespace hpp
 
@@ -0,0 +1,185 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_HFIELD_H
+#define HPP_FCL_HFIELD_H
+
+#include <vector>
+#include <algorithm>
+
+#include <hpp/fcl/collision_object.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Height field: a surface defined by its heights on a regular grid.
+///
+/// The samples cover a rectangle of the xy plane centered at the origin of
+/// the frame of the geometry. Each cell of the grid is split into two
+/// triangles, which are the same as the triangles of a BVHModel built from
+/// the grid, but are generated on the fly when a query reaches them.
+///
+/// The bounding volume hierarchy is implicit: a node of level l covers
+/// 2^l x 2^l cells and only stores the minimum and maximum heights of these
+/// cells. A node (l, i, j) has the nodes (l-1, 2i + a, 2j + b), for a and b
+/// in {0, 1}, as children, and the last level has a single node covering
+/// the whole grid.
+class HeightField : public CollisionGeometry
+{
+public:
+  /// @brief Build a height field from its samples
+  /// @param x_dim, y_dim size of the grid along the x and y axes
+  /// @param nx, ny number of samples along each axis, at least 2
+  /// @param heights the heights, the one of sample (i, j) being
+  ///        heights[i + nx * j], at x = -x_dim/2 + i x_dim / (nx - 1)
+  ///        and y = -y_dim/2 + j y_dim / (ny - 1).
+  /// \throw std::invalid_argument if the size of heights does not match.
+  HeightField(FCL_REAL x_dim, FCL_REAL y_dim, int nx, int ny,
+              const std::vector<FCL_REAL>& heights);
+
+  /// @brief compute the AABB of the surface in its local coordinate system
+  void computeLocalAABB();
+
+  /// @brief get the object type: it is a height field
+  OBJECT_TYPE getObjectType() const { return OT_HFIELD; }
+
+  /// @brief get the node type: it is a height field
+  NODE_TYPE getNodeType() const { return GEOM_HFIELD; }
+
+  /// @brief size of the grid along the x axis
+  FCL_REAL getXDim() const { return x_dim; }
+
+  /// @brief size of the grid along the y axis
+  FCL_REAL getYDim() const { return y_dim; }
+
+  /// @brief number of samples along the x (0) or y (1) axis
+  int getSize(int axis) const { return dims[axis]; }
+
+  /// @brief the heights, see HeightField::HeightField
+  const std::vector<FCL_REAL>& getHeights() const { return heights; }
+
+  /// @brief height of sample (i, j)
+  FCL_REAL getHeight(int i, int j) const { return heights[index(i, j)]; }
+
+  /// @brief position of sample (i, j)
+  Vec3f getPoint(int i, int j) const
+  {
+    return Vec3f(coordinate(0, i), coordinate(1, j), getHeight(i, j));
+  }
+
+  /// @brief number of triangles, two per cell
+  int getNumTriangles() const { return 2 * (dims[0] - 1) * (dims[1] - 1); }
+
+  /// @brief Vertices of a triangle
+  ///
+  /// Triangles 2 c and 2 c + 1 split the cell c = i + (nx - 1) j, whose
+  /// lowest corner is sample (i, j), along its diagonal from (i, j) to
+  /// (i + 1, j + 1). Both are oriented toward the positive z.
+  void getTriangle(int id, Vec3f& P1, Vec3f& P2, Vec3f& P3) const
+  {
+    const int cell = id / 2;
+    const int i = cell % (dims[0] - 1);
+    const int j = cell / (dims[0] - 1);
+    P1 = getPoint(i, j);
+    P3 = getPoint(i + 1, j + 1);
+    if(id % 2 == 0)
+      P2 = getPoint(i + 1, j);
+    else
+    {
+      P2 = P3;
+      P3 = getPoint(i, j + 1);
+    }
+  }
+
+  /// @brief number of levels of the hierarchy, the level 0 being the cells
+  int getNumLevels() const { return (int) levels.size(); }
+
+  /// @brief number of nodes of a level along the x (0) or y (1) axis
+  int getLevelSize(int level, int axis) const
+  {
+    return levels[level].dims[axis];
+  }
+
+  /// @brief bounding box of node (i, j) of a level
+  void getNodeBV(int level, int i, int j, AABB& bv) const
+  {
+    const Level& l = levels[level];
+    const std::size_t n = l.offset + (std::size_t) i +
+      (std::size_t) l.dims[0] * (std::size_t) j;
+    bv.min_ << coordinate(0, i << level), coordinate(1, j << level),
+               min_heights[n];
+    bv.max_ << coordinate(0, std::min((i + 1) << level, dims[0] - 1)),
+               coordinate(1, std::min((j + 1) << level, dims[1] - 1)),
+               max_heights[n];
+  }
+
+private:
+  std::size_t index(int i, int j) const
+  {
+    return (std::size_t) i + (std::size_t) dims[0] * (std::size_t) j;
+  }
+
+  /// @brief position of a sample along the x (0) or y (1) axis
+  FCL_REAL coordinate(int axis, int i) const
+  {
+    return origin[axis] + i * step[axis];
+  }
+
+  struct Level
+  {
+    int dims[2];
+    std::size_t offset;
+  };
+
+  FCL_REAL x_dim, y_dim;
+  FCL_REAL origin[2];
+  FCL_REAL step[2];
+  int dims[2];
+  std::vector<FCL_REAL> heights;
+
+  /// @brief levels of the hierarchy, from the cells to the root
+  std::vector<Level> levels;
+
+  /// @brief bounds of the heights of the nodes, level after level
+  std::vector<FCL_REAL> min_heights, max_heights;
+};
+
+}
+
+} // namespace hpp
+
+#endif
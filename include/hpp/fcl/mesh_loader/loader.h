@@ -37,7 +37,12 @@
 #ifndef HPP_FCL_MESH_LOADER_LOADER_H
 #define HPP_FCL_MESH_LOADER_LOADER_H
 
+#include <map>
+#include <set>
+#include <vector>
 #include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
 #include <hpp/fcl/fwd.hh>
 #include <hpp/fcl/config.hh>
 #include <hpp/fcl/data_types.h>
@@ -66,8 +71,26 @@ namespace fcl {
       virtual BVHModelPtr_t load (const std::string& filename,
           const Vec3f& scale);
 
+      /// Load several files with the threads of pool.
+      ///
+      /// The files are parsed and the hierarchies built concurrently, by
+      /// calling load for each file. This method is only safe if load is.
+      /// \param filenames the files to load.
+      /// \param scales the scale of each file.
+      /// \return the model of each file.
+      /// \throw std::invalid_argument if the sizes of filenames and scales
+      ///        differ.
+      /// \throw std::runtime_error if a file could not be loaded.
+      std::vector<BVHModelPtr_t> loadMany (
+          const std::vector<std::string>& filenames,
+          const std::vector<Vec3f>& scales,
+          ThreadPool& pool);
+
       MeshLoader (const NODE_TYPE& bvType = BV_OBBRSS) : bvType_ (bvType) {}
 
+      /// Bounding volume type of the models
+      NODE_TYPE getBVType () const { return bvType_; }
+
     private:
       const NODE_TYPE bvType_;
   };
@@ -76,6 +99,14 @@ namespace fcl {
   /// This class builds a new object for each different file.
   /// If method CachedMeshLoader::load is called twice with the same arguments,
   /// the second call returns the result of the first call.
+  ///
+  /// The loader is thread safe. When several threads load the same file with
+  /// the same scale, the file is loaded once: the other threads wait for the
+  /// result.
+  ///
+  /// Optionally, the built models are saved in a directory, see
+  /// setCacheDirectory, so that the next processes load them with
+  /// loadBinary instead of parsing the files and building the hierarchies.
   class CachedMeshLoader : public MeshLoader
   {
     public:
@@ -86,6 +117,18 @@ namespace fcl {
       virtual BVHModelPtr_t load (const std::string& filename,
           const Vec3f& scale);
 
+      /// Set the directory of the models saved on disk. Empty, which is the
+      /// default, disables the cache on disk.
+      ///
+      /// A model is identified by the FNV-1a hash of the content of the file,
+      /// the scale and the bounding volume type, and the names of the files
+      /// contain a version of this format. Models loaded from the disk do
+      /// not own their storage, see BVHModelBase::ownStorage.
+      void setCacheDirectory (const std::string& directory);
+
+      /// Directory of the models saved on disk, see setCacheDirectory.
+      std::string getCacheDirectory () const;
+
       struct Key {
         std::string filename;
         Vec3f scale;
@@ -97,9 +140,23 @@ namespace fcl {
       };
       typedef std::map <Key, BVHModelPtr_t> Cache_t;
 
-      const Cache_t cache () const { return cache_; }
+      const Cache_t cache () const
+      {
+        boost::mutex::scoped_lock lock (lock_);
+        return cache_;
+      }
     private:
+      /// Load a model from the disk cache, or from the file and save it in
+      /// the disk cache.
+      BVHModelPtr_t build (const std::string& filename, const Vec3f& scale);
+
+      mutable boost::mutex lock_;
+      /// Notified when a model is loaded
+      boost::condition_variable loaded_;
       Cache_t cache_;
+      /// Keys of the models being loaded
+      std::set<Key> loading_;
+      std::string cache_directory_;
   };
 }
 
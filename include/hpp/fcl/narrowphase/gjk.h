@@ -75,7 +75,17 @@ struct MinkowskiDiff
       const Vec3f& dir, bool dirIsNormalized, Vec3f& support0, Vec3f& support1);
   GetSupportFunction getSupportFunc;
 
-  MinkowskiDiff() : getSupportFunc (NULL) {}
+  /// @brief Index of the last support point of each shape, for the shapes
+  ///        that hill climb to the support point (ConvexBase), -1 if none.
+  ///
+  /// Successive support directions of GJK and EPA are close to each other,
+  /// so that the next support point is close to the last one.
+  mutable int support_hints[2];
+
+  MinkowskiDiff() : getSupportFunc (NULL)
+  {
+    support_hints[0] = support_hints[1] = -1;
+  }
 
   /// Set the two shapes,
   /// assuming the relative transformation between them is identity.
@@ -116,6 +126,8 @@ struct GJK
     Vec3f w0, w1; 
     /// @brief support vector (i.e., the furthest point on the shape along the support direction)
     Vec3f w;
+    /// @brief direction along which the support vectors were computed
+    Vec3f d;
   };
 
   typedef unsigned char vertex_id_t;
@@ -132,6 +144,23 @@ struct GJK
 
   enum Status {Valid, Inside, Failed};
 
+  /// @brief Support directions of the vertices of the simplex found by a
+  ///        run of GJK.
+  ///
+  /// The directions are expressed in the frame of the first shape, so that
+  /// the simplex can be rebuilt by a later run on the same pair of shapes in
+  /// another relative configuration. When the configurations are close, the
+  /// rebuilt simplex is close to the solution and GJK needs few iterations.
+  struct WarmStart
+  {
+    Vec3f directions[4];
+    vertex_id_t rank;
+    /// @brief status of the run
+    Status status;
+
+    WarmStart() : rank(0), status(Failed) {}
+  };
+
   MinkowskiDiff const* shape;
   Vec3f ray;
   FCL_REAL distance;
@@ -147,13 +176,20 @@ struct GJK
   void initialize();
 
   /// @brief GJK algorithm, given the initial value guess
-  Status evaluate(const MinkowskiDiff& shape, const Vec3f& guess);
+  /// @param warm_start if not NULL and not empty, the initial simplex is
+  ///        rebuilt from it and guess is ignored.
+  Status evaluate(const MinkowskiDiff& shape, const Vec3f& guess,
+                  const WarmStart* warm_start = NULL);
+
+  /// @brief Store the support directions of the current simplex
+  void getWarmStart(WarmStart& warm_start) const;
 
   /// @brief apply the support function along a direction, the result is return in sv
   inline void getSupport(const Vec3f& d, bool dIsNormalized, SimplexV& sv) const
   {
     shape->support(d, dIsNormalized, sv.w0, sv.w1);
     sv.w.noalias() = sv.w0 - sv.w1;
+    sv.d = d;
   }
 
   /// @brief whether the simplex enclose the origin
@@ -181,6 +217,9 @@ struct GJK
     distance_upper_bound = dup;
   }
 
+  /// @brief Number of iterations of the last call to evaluate
+  unsigned int getIterations() const { return iterations; }
+
 private:
   SimplexV store_v[4];
   SimplexV* free_v[4];
@@ -192,6 +231,13 @@ private:
   unsigned int max_iterations;
   FCL_REAL tolerance;
   FCL_REAL distance_upper_bound;
+  unsigned int iterations;
+
+  /// @brief Build the initial simplex from the support directions of
+  ///        warm_start and project the origin onto it.
+  /// @return false if the simplex is degenerated, in which case it is
+  ///         emptied.
+  bool initializeSimplex(const WarmStart& warm_start);
 
   /// @brief discard one vertex from the simplex
   inline void removeVertex(Simplex& simplex);
@@ -292,11 +338,39 @@ public:
   EPA(unsigned int max_face_num_, unsigned int max_vertex_num_, unsigned int max_iterations_, FCL_REAL tolerance_) : max_face_num(max_face_num_),
                                                                                                                      max_vertex_num(max_vertex_num_),
                                                                                                                      max_iterations(max_iterations_),
-                                                                                                                     tolerance(tolerance_)
+                                                                                                                     tolerance(tolerance_),
+                                                                                                                     sv_store(NULL),
+                                                                                                                     fc_store(NULL)
   {
     initialize();
   }
 
+  /// @brief Build an EPA without memory. reset must be called before
+  ///        evaluate.
+  EPA() : max_face_num(0), max_vertex_num(0), max_iterations(0), tolerance(0),
+    sv_store(NULL), fc_store(NULL)
+  {
+    initialize();
+  }
+
+  /// @brief Copy the parameters but not the memory, which is allocated
+  ///        by the next call to reset.
+  EPA(const EPA& other) : max_face_num(0), max_vertex_num(0),
+    max_iterations(other.max_iterations), tolerance(other.tolerance),
+    sv_store(NULL), fc_store(NULL)
+  {
+    initialize();
+  }
+
+  EPA& operator= (const EPA& other)
+  {
+    if (this != &other) {
+      max_iterations = other.max_iterations;
+      tolerance = other.tolerance;
+    }
+    return *this;
+  }
+
   ~EPA()
   {
     delete [] sv_store;
@@ -305,6 +379,12 @@ public:
 
   void initialize();
 
+  /// @brief Set the parameters of the algorithm.
+  /// Memory is only allocated when the number of faces or vertices changes,
+  /// so that an EPA can be reused by successive queries without allocating.
+  void reset(unsigned int max_face_num_, unsigned int max_vertex_num_,
+             unsigned int max_iterations_, FCL_REAL tolerance_);
+
   Status evaluate(GJK& gjk, const Vec3f& guess);
 
 private:
@@ -319,10 +399,66 @@ private:
   bool expand(size_t pass, SimplexV* w, SimplexF* f, size_t e, SimplexHorizon& horizon);  
 };
 
+/// @brief EPA workspace of the calling thread.
+///
+/// It is allocated at the first call in each thread and released when the
+/// thread exits. EPA::reset sets up its parameters without allocating as
+/// long as the numbers of faces and vertices do not change.
+EPA& getThreadEPA();
 
 } // details
 
+/// @brief GJK simplex of a pair of shapes kept between successive queries.
+///
+/// When CollisionRequest::gjk_cache or DistanceRequest::gjk_cache points to
+/// a GJKCache, the collision and distance between two shapes computed by GJK
+/// start from the simplex of the previous query on the same pair, which
+/// saves iterations when the pair moves little between the queries.
+///
+/// The cache is reset when the pair of objects changes. The shapes must not
+/// be modified between queries, or clear must be called.
+class GJKCache
+{
+public:
+  GJKCache() : o1_(NULL), o2_(NULL) {}
 
+  /// @brief Forget the simplex
+  void clear()
+  {
+    warm_start_ = details::GJK::WarmStart();
+    o1_ = o2_ = NULL;
+  }
+
+  /// @brief Simplex of the pair (o1, o2). It is emptied if the previous
+  ///        query was on another pair.
+  details::GJK::WarmStart* get(const CollisionGeometry* o1,
+                               const CollisionGeometry* o2)
+  {
+    if(o1 != o1_ || o2 != o2_)
+    {
+      warm_start_ = details::GJK::WarmStart();
+      o1_ = o1;
+      o2_ = o2;
+    }
+    return &warm_start_;
+  }
+
+  /// @brief Status of GJK at the last query
+  details::GJK::Status status() const { return warm_start_.status; }
+
+private:
+  details::GJK::WarmStart warm_start_;
+  const CollisionGeometry* o1_;
+  const CollisionGeometry* o2_;
+};
+
+/// @brief Simplex kept by cache for the pair (o1, o2), NULL if cache is NULL.
+inline details::GJK::WarmStart* getWarmStart(GJKCache* cache,
+                                             const CollisionGeometry* o1,
+                                             const CollisionGeometry* o2)
+{
+  return cache ? cache->get(o1, o2) : NULL;
+}
 
 }
 
@@ -53,10 +53,14 @@ namespace fcl
   struct GJKSolver
   {
     /// @brief intersection checking between two shapes
+    /// @param warm_start if not NULL, GJK starts from this simplex of a
+    ///        previous query on the pair and stores its final simplex in
+    ///        it, see GJKCache.
     template<typename S1, typename S2>
       bool shapeIntersect(const S1& s1, const Transform3f& tf1,
                           const S2& s2, const Transform3f& tf2,
-                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal,
+                          details::GJK::WarmStart* warm_start = NULL) const
     {
       Vec3f guess(1, 0, 0);
       if(enable_cached_guess) guess = cached_guess;
@@ -65,14 +69,15 @@ namespace fcl
       shape.set (&s1, &s2, tf1, tf2);
   
       details::GJK gjk((unsigned int )gjk_max_iterations, gjk_tolerance);
-      details::GJK::Status gjk_status = gjk.evaluate(shape, -guess);
+      details::GJK::Status gjk_status = gjk.evaluate(shape, -guess, warm_start);
       if(enable_cached_guess) cached_guess = gjk.getGuessFromSimplex();
+      if(warm_start) gjk.getWarmStart(*warm_start);
     
       switch(gjk_status)
         {
         case details::GJK::Inside:
           {
-            details::EPA epa(epa_max_face_num, epa_max_vertex_num, epa_max_iterations, epa_tolerance);
+            details::EPA& epa = getEPA();
             details::EPA::Status epa_status = epa.evaluate(gjk, -guess);
             if(epa_status != details::EPA::Failed)
               {
@@ -124,7 +129,7 @@ namespace fcl
         case details::GJK::Inside:
           {
             col = true;
-            details::EPA epa(epa_max_face_num, epa_max_vertex_num, epa_max_iterations, epa_tolerance);
+            details::EPA& epa = getEPA();
             details::EPA::Status epa_status = epa.evaluate(gjk, -guess);
             assert (epa_status != details::EPA::Failed); (void) epa_status;
             Vec3f w0, w1;
@@ -159,11 +164,13 @@ namespace fcl
     }
 
     /// @brief distance computation between two shapes
+    /// @param warm_start see shapeIntersect.
     template<typename S1, typename S2>
       bool shapeDistance(const S1& s1, const Transform3f& tf1,
                          const S2& s2, const Transform3f& tf2,
                          FCL_REAL& distance, Vec3f& p1, Vec3f& p2,
-                         Vec3f& normal) const
+                         Vec3f& normal,
+                         details::GJK::WarmStart* warm_start = NULL) const
     {
 #ifndef NDEBUG
       FCL_REAL eps (sqrt(std::numeric_limits<FCL_REAL>::epsilon()));
@@ -176,8 +183,9 @@ namespace fcl
       shape.set (&s1, &s2, tf1, tf2);
 
       details::GJK gjk((unsigned int) gjk_max_iterations, gjk_tolerance);
-      details::GJK::Status gjk_status = gjk.evaluate(shape, -guess);
+      details::GJK::Status gjk_status = gjk.evaluate(shape, -guess, warm_start);
       if(enable_cached_guess) cached_guess = gjk.getGuessFromSimplex();
+      if(warm_start) gjk.getWarmStart(*warm_start);
 
       if(gjk_status == details::GJK::Failed)
       {
@@ -207,8 +215,7 @@ namespace fcl
           assert (gjk_status == details::GJK::Inside);
           if (compute_normal)
             {
-              details::EPA epa(epa_max_face_num, epa_max_vertex_num,
-                               epa_max_iterations, epa_tolerance);
+              details::EPA& epa = getEPA();
               details::EPA::Status epa_status = epa.evaluate(gjk, -guess);
               if(epa_status != details::EPA::Failed)
                 {
@@ -245,6 +252,22 @@ namespace fcl
       cached_guess = Vec3f(1, 0, 0);
     }
 
+    /// @brief EPA workspace of the calling thread, set up with the EPA
+    ///        parameters of the solver.
+    ///
+    /// The workspace is shared by all the solvers of a thread, see
+    /// details::getThreadEPA: its memory is reused by the following queries
+    /// as long as epa_max_face_num and epa_max_vertex_num do not change.
+    /// The solver itself is not modified, so that a const solver can be used
+    /// by several threads.
+    details::EPA& getEPA() const
+    {
+      details::EPA& epa = details::getThreadEPA();
+      epa.reset(epa_max_face_num, epa_max_vertex_num, epa_max_iterations,
+                epa_tolerance);
+      return epa;
+    }
+
     void enableCachedGuess(bool if_enable) const
     {
       enable_cached_guess = if_enable;
@@ -289,144 +312,144 @@ namespace fcl
   template<>
     bool GJKSolver::shapeIntersect<Sphere, Capsule>(const Sphere& s1, const Transform3f& tf1,
                                                           const Capsule& s2, const Transform3f& tf2,
-                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Capsule, Sphere>(const Capsule &s1, const Transform3f& tf1,
                                                           const Sphere &s2, const Transform3f& tf2,
-                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   /// @brief Fast implementation for sphere-sphere collision
   template<>
     bool GJKSolver::shapeIntersect<Sphere, Sphere>(const Sphere& s1, const Transform3f& tf1,
                                                          const Sphere& s2, const Transform3f& tf2,
-                                                         Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                         Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   /// @brief Fast implementation for box-box collision
   template<>
     bool GJKSolver::shapeIntersect<Box, Box>(const Box& s1, const Transform3f& tf1,
                                                    const Box& s2, const Transform3f& tf2,
-                                                   Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                   Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Sphere, Halfspace>(const Sphere& s1, const Transform3f& tf1,
                                                             const Halfspace& s2, const Transform3f& tf2,
-                                                            Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                            Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Halfspace, Sphere>(const Halfspace& s1, const Transform3f& tf1,
                                                             const Sphere& s2, const Transform3f& tf2,
-                                                            Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                            Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Box, Halfspace>(const Box& s1, const Transform3f& tf1,
                                                          const Halfspace& s2, const Transform3f& tf2,
-                                                         Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                         Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Halfspace, Box>(const Halfspace& s1, const Transform3f& tf1,
                                                          const Box& s2, const Transform3f& tf2,
-                                                         Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                         Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Capsule, Halfspace>(const Capsule& s1, const Transform3f& tf1,
                                                              const Halfspace& s2, const Transform3f& tf2,
-                                                             Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                             Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Halfspace, Capsule>(const Halfspace& s1, const Transform3f& tf1,
                                                              const Capsule& s2, const Transform3f& tf2,
-                                                             Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                             Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Cylinder, Halfspace>(const Cylinder& s1, const Transform3f& tf1,
                                                               const Halfspace& s2, const Transform3f& tf2,
-                                                              Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                              Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Halfspace, Cylinder>(const Halfspace& s1, const Transform3f& tf1,
                                                               const Cylinder& s2, const Transform3f& tf2,
-                                                              Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                              Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Cone, Halfspace>(const Cone& s1, const Transform3f& tf1,
                                                           const Halfspace& s2, const Transform3f& tf2,
-                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Halfspace, Cone>(const Halfspace& s1, const Transform3f& tf1,
                                                           const Cone& s2, const Transform3f& tf2,
-                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Halfspace, Halfspace>(const Halfspace& s1, const Transform3f& tf1,
                                                                const Halfspace& s2, const Transform3f& tf2,
-                                                               Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                               Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Plane, Halfspace>(const Plane& s1, const Transform3f& tf1,
                                                            const Halfspace& s2, const Transform3f& tf2,
-                                                           Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                           Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Halfspace, Plane>(const Halfspace& s1, const Transform3f& tf1,
                                                            const Plane& s2, const Transform3f& tf2,
-                                                           Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                           Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Sphere, Plane>(const Sphere& s1, const Transform3f& tf1,
                                                         const Plane& s2, const Transform3f& tf2,
-                                                        Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                        Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Plane, Sphere>(const Plane& s1, const Transform3f& tf1,
                                                         const Sphere& s2, const Transform3f& tf2,
-                                                        Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                        Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Box, Plane>(const Box& s1, const Transform3f& tf1,
                                                      const Plane& s2, const Transform3f& tf2,
-                                                     Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                     Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Plane, Box>(const Plane& s1, const Transform3f& tf1,
                                                      const Box& s2, const Transform3f& tf2,
-                                                     Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                     Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Capsule, Plane>(const Capsule& s1, const Transform3f& tf1,
                                                          const Plane& s2, const Transform3f& tf2,
-                                                         Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                         Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Plane, Capsule>(const Plane& s1, const Transform3f& tf1,
                                                          const Capsule& s2, const Transform3f& tf2,
-                                                         Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                         Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Cylinder, Plane>(const Cylinder& s1, const Transform3f& tf1,
                                                           const Plane& s2, const Transform3f& tf2,
-                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Plane, Cylinder>(const Plane& s1, const Transform3f& tf1,
                                                           const Cylinder& s2, const Transform3f& tf2,
-                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                          Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Cone, Plane>(const Cone& s1, const Transform3f& tf1,
                                                       const Plane& s2, const Transform3f& tf2,
-                                                      Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                      Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Plane, Cone>(const Plane& s1, const Transform3f& tf1,
                                                       const Cone& s2, const Transform3f& tf2,
-                                                      Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                      Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeIntersect<Plane, Plane>(const Plane& s1, const Transform3f& tf1,
                                                        const Plane& s2, const Transform3f& tf2,
-                                                       Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const;
+                                                       Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart* warm_start) const;
 
   /// @brief Fast implementation for sphere-triangle collision
   template<>
@@ -452,40 +475,40 @@ namespace fcl
     bool GJKSolver::shapeDistance<Sphere, Capsule>
     (const Sphere& s1, const Transform3f& tf1,
      const Capsule& s2, const Transform3f& tf2,
-     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const;
+     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeDistance<Capsule, Sphere>
     (const Capsule& s1, const Transform3f& tf1,
      const Sphere& s2, const Transform3f& tf2,
-     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const;
+     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart* warm_start) const;
 
   /// @brief Fast implementation for sphere-cylinder distance
   template<>
     bool GJKSolver::shapeDistance<Sphere, Cylinder>
     (const Sphere& s1, const Transform3f& tf1,
      const Cylinder& s2, const Transform3f& tf2,
-     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const;
+     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart* warm_start) const;
 
   template<>
     bool GJKSolver::shapeDistance<Cylinder, Sphere>
     (const Cylinder& s1, const Transform3f& tf1,
      const Sphere& s2, const Transform3f& tf2,
-     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const;
+     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart* warm_start) const;
 
   /// @brief Fast implementation for sphere-sphere distance
   template<>
     bool GJKSolver::shapeDistance<Sphere, Sphere>
     (const Sphere& s1, const Transform3f& tf1,
      const Sphere& s2, const Transform3f& tf2,
-     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const;
+     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart* warm_start) const;
 
   // @brief Computation of the distance result for capsule capsule. Closest points are based on two line-segments.
   template<>
     bool GJKSolver::shapeDistance<Capsule, Capsule>
     (const Capsule& s1, const Transform3f& tf1,
      const Capsule& s2, const Transform3f& tf2,
-     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const;
+     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart* warm_start) const;
 
   // Distance computation between two triangles
   //
@@ -495,7 +518,7 @@ namespace fcl
     bool GJKSolver::shapeDistance<TriangleP, TriangleP>
     (const TriangleP& s1, const Transform3f& tf1,
      const TriangleP& s2, const Transform3f& tf2,
-     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const;
+     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart* warm_start) const;
 
 }
 
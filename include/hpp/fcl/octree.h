@@ -40,8 +40,11 @@
 #define HPP_FCL_OCTREE_H
 
 
+#include <utility>
+#include <vector>
 #include <boost/shared_ptr.hpp>
 #include <boost/array.hpp>
+#include <boost/cstdint.hpp>
 
 #include <octomap/octomap.h>
 #include <hpp/fcl/BV/AABB.h>
@@ -67,8 +70,39 @@ public:
 
   typedef octomap::OcTreeNode OcTreeNode;
 
+  /// @brief Node of the compiled octree, see compile.
+  ///
+  /// compile stores the nodes in breadth-first order. The children of a node
+  /// are contiguous and sorted by child index. update appends the children
+  /// of the nodes whose children changed at the end of the array.
+  struct CompiledNode
+  {
+    enum { OCCUPIED = 1, FREE = 2 };
+
+    /// @brief Morton code of the node: the 3 * depth bits of the child
+    /// indices along the path from the root. The bounding volume of the node
+    /// is deduced from it.
+    boost::uint64_t code;
+    /// @brief index of the first child
+    boost::uint32_t first_child;
+    /// @brief bit i is set if child i exists
+    boost::uint8_t child_mask;
+    /// @brief combination of OCCUPIED and FREE
+    boost::uint8_t occupancy;
+    /// @brief depth of the node, 0 for the root
+    boost::uint8_t depth;
+  };
+
+private:
+  boost::shared_ptr<std::vector<CompiledNode> > compiled;
+  /// @brief number of compiled nodes dropped by update
+  std::size_t compiled_garbage;
+
+public:
+
   /// @brief construct octree with a given resolution
-  OcTree(FCL_REAL resolution) : tree(boost::shared_ptr<const octomap::OcTree>(new octomap::OcTree(resolution)))                               
+  OcTree(FCL_REAL resolution) : tree(boost::shared_ptr<const octomap::OcTree>(new octomap::OcTree(resolution))),
+    compiled_garbage (0)
   {
     default_occupancy = tree->getOccupancyThres();
 
@@ -78,7 +112,8 @@ public:
   }
 
   /// @brief construct octree from octomap
-  OcTree(const boost::shared_ptr<const octomap::OcTree>& tree_) : tree(tree_)
+  OcTree(const boost::shared_ptr<const octomap::OcTree>& tree_) : tree(tree_),
+    compiled_garbage (0)
   {
     default_occupancy = tree->getOccupancyThres();
 
@@ -87,6 +122,12 @@ public:
     free_threshold = 0;
   }
 
+  /// @brief the octomap tree
+  const boost::shared_ptr<const octomap::OcTree>& getTree() const
+  {
+    return tree;
+  }
+
   /// @brief compute the AABB for the octree in its local coordinate system
   void computeLocalAABB() 
   {
@@ -110,6 +151,80 @@ public:
     return tree->getRoot();
   }
 
+  /// @brief Build a compiled snapshot of the octree.
+  ///
+  /// The collision and distance queries on a compiled octree traverse flat
+  /// arrays instead of the nodes of octomap, see CompiledNode. The snapshot
+  /// is read-only: call update or compile after modifying the octomap tree.
+  /// It is rebuilt when the occupancy or the free threshold changes.
+  void compile();
+
+  /// @brief Update the compiled octree after changes of the octomap tree.
+  ///
+  /// Only the nodes on the paths from the root to the changed leaves are
+  /// visited, so the cost depends on the number of changes and not on the
+  /// size of the tree. The inner occupancy of the octomap tree must be up
+  /// to date. The octree is compiled again when the nodes dropped by the
+  /// updates outnumber the others. Does nothing if the octree is not
+  /// compiled, since queries then read the octomap tree.
+  ///
+  /// @param begin, end keys of the changed leaves, as octomap::OcTreeKey or
+  ///        as the pairs of octomap::KeyBoolMap. With change detection
+  ///        enabled, octomap::OcTree::changedKeysBegin and changedKeysEnd
+  ///        provide them.
+  template<typename KeyIterator>
+  void update(KeyIterator begin, KeyIterator end);
+
+  /// @brief Update the compiled octree after changes of the given leaves.
+  void update(const octomap::KeySet& keys)
+  {
+    update(keys.begin(), keys.end());
+  }
+
+  /// @brief whether compile was called
+  bool isCompiled() const { return compiled.get() != NULL; }
+
+  /// @brief root of the compiled octree
+  ///
+  /// @return NULL if compile was not called or if the octree is empty.
+  const CompiledNode* getCompiledRoot() const
+  {
+    return compiled && !compiled->empty() ? &(*compiled)[0] : NULL;
+  }
+
+  /// @brief number of nodes of the compiled octree
+  std::size_t getCompiledSize() const
+  {
+    return compiled ? compiled->size() - compiled_garbage : 0;
+  }
+
+  /// @brief index of a node, used to identify it in the results
+  int nodeIndex(const OcTreeNode* node) const
+  {
+    return (int) (node - getRoot());
+  }
+
+  /// @brief index of a compiled node in the array of nodes
+  int nodeIndex(const CompiledNode* node) const
+  {
+    return (int) (node - &(*compiled)[0]);
+  }
+
+  /// @brief get the bounding volume of a compiled node, from its code
+  AABB getNodeBV(const CompiledNode* node) const
+  {
+    return getNodeBV(node->code, node->depth);
+  }
+
+  /// @brief compute the bounding volume of the i-th child of a node
+  void computeChildBV(const OcTreeNode* node, const AABB& bv, unsigned int i,
+                      AABB& child_bv) const;
+
+  /// @brief compute the bounding volume of the i-th child of a compiled
+  ///        node, from its code. The child does not need to exist.
+  void computeChildBV(const CompiledNode* node, const AABB& bv,
+                      unsigned int i, AABB& child_bv) const;
+
   /// @brief whether one node is completely occupied
   bool isNodeOccupied(const OcTreeNode* node) const
   {
@@ -130,6 +245,24 @@ public:
     return (!isNodeOccupied(node)) && (!isNodeFree(node));
   }
 
+  /// @brief whether one compiled node is completely occupied
+  bool isNodeOccupied(const CompiledNode* node) const
+  {
+    return node->occupancy & CompiledNode::OCCUPIED;
+  }
+
+  /// @brief whether one compiled node is completely free
+  bool isNodeFree(const CompiledNode* node) const
+  {
+    return node->occupancy & CompiledNode::FREE;
+  }
+
+  /// @brief whether one compiled node is uncertain
+  bool isNodeUncertain(const CompiledNode* node) const
+  {
+    return node->occupancy == 0;
+  }
+
   /// @brief transform the octree into a bunch of boxes; uncertainty information is kept in the boxes. However, we
   /// only keep the occupied boxes (i.e., the boxes whose occupied probability is higher enough).
   std::vector<boost::array<FCL_REAL, 6> > toBoxes() const
@@ -183,11 +316,13 @@ public:
   void setOccupancyThres(FCL_REAL d)
   {
     occupancy_threshold = d;
+    if(compiled) compile();
   }
 
   void setFreeThres(FCL_REAL d)
   {
     free_threshold = d;
+    if(compiled) compile();
   }
 
   /// @return ptr to child number childIdx of node
@@ -230,11 +365,88 @@ public:
 #endif
   }
 
+  /// @return const ptr to child number childIdx of a compiled node
+  const CompiledNode* getNodeChild(const CompiledNode* node, unsigned int childIdx) const
+  {
+    return &(*compiled)[node->first_child +
+      countChildren((boost::uint8_t) (node->child_mask & ((1u << childIdx) - 1)))];
+  }
+
+  /// @brief return true if the child at childIdx of a compiled node exists
+  bool nodeChildExists(const CompiledNode* node, unsigned int childIdx) const
+  {
+    return node->child_mask & (1u << childIdx);
+  }
+
+  /// @brief return true if a compiled node has at least one child
+  bool nodeHasChildren(const CompiledNode* node) const
+  {
+    return node->child_mask != 0;
+  }
+
   /// @brief return object type, it is an octree
   OBJECT_TYPE getObjectType() const { return OT_OCTREE; }
 
   /// @brief return node type, it is an octree
   NODE_TYPE getNodeType() const { return GEOM_OCTREE; }
+
+private:
+  /// @brief compiled node and the octomap node it is built from
+  typedef std::pair<std::size_t, const OcTreeNode*> CompileItem_t;
+
+  /// @brief Append the descendants of the nodes in queue to nodes, and set
+  ///        the occupancy and the children of all of them.
+  void compileDescendants(std::vector<CompiledNode>& nodes,
+                          std::vector<CompileItem_t>& queue) const;
+
+  /// @brief Set the occupancy and the children of a compiled node from
+  ///        parent, and compile the new children.
+  void updateNode(std::size_t index, const OcTreeNode* parent);
+
+  /// @brief number of compiled nodes in the subtree of index
+  std::size_t compiledSubtreeSize(std::size_t index) const;
+
+  /// @brief number of bits set in a child mask
+  static unsigned int countChildren(boost::uint8_t mask)
+  {
+    mask = (boost::uint8_t) (mask - ((mask >> 1) & 0x55));
+    mask = (boost::uint8_t) ((mask & 0x33) + ((mask >> 2) & 0x33));
+    return (mask + (mask >> 4)) & 0x0f;
+  }
+
+  static const octomap::OcTreeKey& getKey(const octomap::OcTreeKey& key)
+  {
+    return key;
+  }
+
+  template<typename T>
+  static const octomap::OcTreeKey& getKey(const std::pair<const octomap::OcTreeKey, T>& item)
+  {
+    return item.first;
+  }
+
+  /// @brief bounding volume of the node of a given Morton code and depth
+  AABB getNodeBV(boost::uint64_t code, unsigned int depth) const
+  {
+    AABB root_bv (getRootBV());
+    FCL_REAL size = (root_bv.max_[0] - root_bv.min_[0]) / (FCL_REAL) (1 << depth);
+    Vec3f corner (root_bv.min_);
+    for(int k = 0; k < 3; ++k)
+      corner[k] += size * (FCL_REAL) compactMortonBits(code >> k);
+    return AABB(corner, Vec3f(corner.array() + size));
+  }
+
+  /// @brief keep one bit out of three of a Morton code
+  static boost::uint64_t compactMortonBits(boost::uint64_t x)
+  {
+    x &= 0x1249249249249249ULL;
+    x = (x ^ (x >>  2)) & 0x10c30c30c30c30c3ULL;
+    x = (x ^ (x >>  4)) & 0x100f00f00f00f00fULL;
+    x = (x ^ (x >>  8)) & 0x001f0000ff0000ffULL;
+    x = (x ^ (x >> 16)) & 0x001f00000000ffffULL;
+    x = (x ^ (x >> 32)) & 0x00000000001fffffULL;
+    return x;
+  }
 };
 
 /// @brief compute the bounding volume of an octree node's i-th child
@@ -274,7 +486,167 @@ static inline void computeChildBV(const AABB& root_bv, unsigned int i, AABB& chi
   }
 }
 
+inline void OcTree::computeChildBV(const OcTreeNode*, const AABB& bv,
+                                   unsigned int i, AABB& child_bv) const
+{
+  fcl::computeChildBV(bv, i, child_bv);
+}
+
+inline void OcTree::computeChildBV(const CompiledNode* node, const AABB&,
+                                   unsigned int i, AABB& child_bv) const
+{
+  child_bv = getNodeBV((node->code << 3) | i, node->depth + 1u);
+}
+
+inline void OcTree::compileDescendants(std::vector<CompiledNode>& nodes,
+                                       std::vector<CompileItem_t>& queue) const
+{
+  CompiledNode node;
+  for(std::size_t k = 0; k < queue.size(); ++k)
+  {
+    const std::size_t index = queue[k].first;
+    const OcTreeNode* parent = queue[k].second;
+    nodes[index].occupancy = (boost::uint8_t)
+      ((isNodeOccupied(parent) ? CompiledNode::OCCUPIED : 0) |
+       (isNodeFree(parent) ? CompiledNode::FREE : 0));
+    nodes[index].first_child = (boost::uint32_t) nodes.size();
+    nodes[index].child_mask = 0;
+    if(!nodeHasChildren(parent)) continue;
+
+    node.depth = (boost::uint8_t) (nodes[index].depth + 1);
+    boost::uint64_t code = nodes[index].code << 3;
+    for(unsigned int i = 0; i < 8; ++i)
+    {
+      if(!nodeChildExists(parent, i)) continue;
+      nodes[index].child_mask |= (boost::uint8_t) (1 << i);
+      node.code = code | i;
+      queue.push_back(CompileItem_t(nodes.size(), getNodeChild(parent, i)));
+      nodes.push_back(node);
+    }
+  }
+}
+
+inline void OcTree::compile()
+{
+  boost::shared_ptr<std::vector<CompiledNode> > nodes
+    (new std::vector<CompiledNode>);
+  const OcTreeNode* root = getRoot();
+  if(root)
+  {
+    std::vector<CompileItem_t> queue;
+    queue.reserve(tree->size());
+    nodes->reserve(tree->size());
+
+    CompiledNode node;
+    node.code = 0;
+    node.depth = 0;
+    queue.push_back(CompileItem_t(0, root));
+    nodes->push_back(node);
+    compileDescendants(*nodes, queue);
+  }
+  compiled = nodes;
+  compiled_garbage = 0;
+}
+
+inline std::size_t OcTree::compiledSubtreeSize(std::size_t index) const
+{
+  const CompiledNode& node = (*compiled)[index];
+  std::size_t size = 1;
+  for(unsigned int i = 0, n = countChildren(node.child_mask); i < n; ++i)
+    size += compiledSubtreeSize(node.first_child + i);
+  return size;
+}
+
+inline void OcTree::updateNode(std::size_t index, const OcTreeNode* parent)
+{
+  std::vector<CompiledNode>& nodes = *compiled;
+  nodes[index].occupancy = (boost::uint8_t)
+    ((isNodeOccupied(parent) ? CompiledNode::OCCUPIED : 0) |
+     (isNodeFree(parent) ? CompiledNode::FREE : 0));
+
+  boost::uint8_t mask = 0;
+  if(nodeHasChildren(parent))
+  {
+    for(unsigned int i = 0; i < 8; ++i)
+      if(nodeChildExists(parent, i)) mask |= (boost::uint8_t) (1 << i);
+  }
+  const boost::uint8_t old_mask = nodes[index].child_mask;
+  if(mask == old_mask) return;
+
+  // Move the children to the end of the array: the children which still
+  // exist keep their descendants, the new ones are compiled.
+  const std::size_t old_first = nodes[index].first_child;
+  const std::size_t first = nodes.size();
+  std::vector<CompileItem_t> queue;
+  CompiledNode node;
+  node.depth = (boost::uint8_t) (nodes[index].depth + 1);
+  for(unsigned int i = 0; i < 8; ++i)
+  {
+    const boost::uint8_t bit = (boost::uint8_t) (1 << i);
+    if(old_mask & bit)
+    {
+      std::size_t old_child = old_first +
+        countChildren((boost::uint8_t) (old_mask & (bit - 1)));
+      if(mask & bit)
+      {
+        node = nodes[old_child];
+        nodes.push_back(node);
+        ++compiled_garbage;
+      }
+      else
+        compiled_garbage += compiledSubtreeSize(old_child);
+    }
+    else if(mask & bit)
+    {
+      node.code = (nodes[index].code << 3) | i;
+      node.depth = (boost::uint8_t) (nodes[index].depth + 1);
+      queue.push_back(CompileItem_t(nodes.size(), getNodeChild(parent, i)));
+      nodes.push_back(node);
+    }
+  }
+  nodes[index].first_child = (boost::uint32_t) first;
+  nodes[index].child_mask = mask;
+  compileDescendants(nodes, queue);
+}
+
+template<typename KeyIterator>
+void OcTree::update(KeyIterator begin, KeyIterator end)
+{
+  if(!compiled) return;
+  const OcTreeNode* root = getRoot();
+  if(!root || compiled->empty())
+  {
+    compile();
+    return;
+  }
+  // The snapshot may be used by copies of this octree.
+  if(!compiled.unique())
+    compiled.reset(new std::vector<CompiledNode>(*compiled));
+
+  const int depth = (int) tree->getTreeDepth();
+  for(KeyIterator it = begin; it != end; ++it)
+  {
+    const octomap::OcTreeKey& key = getKey(*it);
+    std::size_t index = 0;
+    const OcTreeNode* node = root;
+    for(int d = depth - 1; ; --d)
+    {
+      updateNode(index, node);
+      if(d < 0 || !nodeHasChildren(node)) break;
+      unsigned int i = 0;
+      if(key[0] & (1 << d)) i |= 1;
+      if(key[1] & (1 << d)) i |= 2;
+      if(key[2] & (1 << d)) i |= 4;
+      if(!nodeChildExists(node, i)) break;
+      const CompiledNode& compiled_node = (*compiled)[index];
+      index = compiled_node.first_child +
+        countChildren((boost::uint8_t) (compiled_node.child_mask & ((1u << i) - 1)));
+      node = getNodeChild(node, i);
+    }
+  }
 
+  if(compiled_garbage > compiled->size() / 2) compile();
+}
 
 }
 
@@ -0,0 +1,231 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#ifndef HPP_FCL_SDF_H
+#define HPP_FCL_SDF_H
+
+#include <vector>
+#include <algorithm>
+
+#include <hpp/fcl/collision_object.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+class BVHModelBase;
+#ifdef HPP_FCL_HAVE_OCTOMAP
+class OcTree;
+#endif
+
+/// @brief Signed distance field of an object, sampled on a regular grid.
+///
+/// The distances to the surface of the object are sampled at the nodes of
+/// a regular grid, aligned with the axes of the frame of the geometry. They
+/// are negative inside the object. Between the nodes, the distance and its
+/// gradient are interpolated trilinearly, so that a query costs one memory
+/// access to 8 neighbouring samples whatever the complexity of the object.
+///
+/// Outside of the grid, the distance at the closest point of the grid is
+/// increased by the distance to the grid, which overestimates the distance
+/// to the object: the grid should cover the object with some padding.
+///
+/// Collision and distance queries against shapes and meshes are
+/// approximate: the minimum of the field on the other geometry is searched
+/// by branch and bound, and the distance is not overestimated by more than
+/// the resolution, except outside of the grid.
+class SignedDistanceField : public CollisionGeometry
+{
+public:
+  /// @brief Build a field from its samples
+  /// @param origin position of the sample (0, 0, 0)
+  /// @param resolution distance between two neighbouring samples
+  /// @param nx, ny, nz number of samples along each axis, at least 2
+  /// @param values the samples, the one at node (i, j, k) being
+  ///        values[i + nx * (j + ny * k)]
+  /// \throw std::invalid_argument if the size of values does not match.
+  SignedDistanceField(const Vec3f& origin, FCL_REAL resolution,
+                      int nx, int ny, int nz,
+                      const std::vector<FCL_REAL>& values);
+
+  /// @brief Compute the field of a triangle mesh
+  ///
+  /// The distances to the triangles are computed exactly near the surface
+  /// and propagated to the rest of the grid from neighbour to neighbour.
+  /// The sign is given by the parity of the number of triangles crossed
+  /// along the x axis from outside the grid: the mesh must be closed.
+  /// @param model the mesh, which does not need to be built
+  /// @param resolution distance between two neighbouring samples
+  /// @param padding minimum distance between the bounding box of the mesh and the
+  ///        border of the grid
+  SignedDistanceField(const BVHModelBase& model, FCL_REAL resolution,
+                      FCL_REAL padding);
+
+#ifdef HPP_FCL_HAVE_OCTOMAP
+  /// @brief Compute the field of the occupied cells of an octree
+  ///
+  /// A sample is inside if it lies in an occupied leaf. The distances are
+  /// the euclidean distances between the samples inside and outside, so
+  /// that they are exact up to the resolution of the grid.
+  /// @param tree the octree
+  /// @param resolution distance between two neighbouring samples, the
+  ///        resolution of the octree is a good choice
+  /// @param padding minimum distance between the bounding box of the occupied
+  ///        cells and the border of the grid
+  SignedDistanceField(const OcTree& tree, FCL_REAL resolution,
+                      FCL_REAL padding);
+#endif
+
+  /// @brief compute the AABB of the grid in its local coordinate system
+  void computeLocalAABB();
+
+  /// @brief get the object type: it is a signed distance field
+  OBJECT_TYPE getObjectType() const { return OT_SDF; }
+
+  /// @brief get the node type: it is a signed distance field
+  NODE_TYPE getNodeType() const { return GEOM_SDF; }
+
+  /// @brief position of the sample (0, 0, 0)
+  const Vec3f& getOrigin() const { return origin; }
+
+  /// @brief distance between two neighbouring samples
+  FCL_REAL getResolution() const { return resolution; }
+
+  /// @brief number of samples along an axis
+  int getSize(int axis) const { return dims[axis]; }
+
+  /// @brief the samples, see SignedDistanceField::SignedDistanceField
+  const std::vector<FCL_REAL>& getValues() const { return values; }
+
+  /// @brief sample at node (i, j, k)
+  FCL_REAL getValue(int i, int j, int k) const
+  {
+    return values[index(i, j, k)];
+  }
+
+  /// @brief interpolated distance of a point to the object
+  FCL_REAL distance(const Vec3f& point) const
+  {
+    return interpolate(point, NULL);
+  }
+
+  /// @brief interpolated distance of a point to the object and its gradient
+  FCL_REAL distance(const Vec3f& point, Vec3f& gradient) const
+  {
+    return interpolate(point, &gradient);
+  }
+
+private:
+  std::size_t index(int i, int j, int k) const
+  {
+    return (std::size_t) i + (std::size_t) dims[0] *
+      ((std::size_t) j + (std::size_t) dims[1] * (std::size_t) k);
+  }
+
+  FCL_REAL interpolate(const Vec3f& point, Vec3f* gradient) const;
+
+  /// @brief Choose the grid covering a box with some padding
+  void initGrid(const AABB& box, FCL_REAL resolution, FCL_REAL padding);
+
+  Vec3f origin;
+  FCL_REAL resolution;
+  int dims[3];
+  std::vector<FCL_REAL> values;
+};
+
+inline FCL_REAL SignedDistanceField::interpolate(const Vec3f& point,
+                                                 Vec3f* gradient) const
+{
+  const Vec3f q ((point - origin) / resolution);
+  Vec3f c;
+  int id[3];
+  FCL_REAL t[3];
+  for(int a = 0; a < 3; ++a)
+  {
+    c[a] = std::min(std::max(q[a], (FCL_REAL) 0), (FCL_REAL) (dims[a] - 1));
+    id[a] = std::min((int) c[a], dims[a] - 2);
+    t[a] = c[a] - id[a];
+  }
+
+  const FCL_REAL* v = &values[index(id[0], id[1], id[2])];
+  const std::size_t dy = (std::size_t) dims[0];
+  const std::size_t dz = dy * (std::size_t) dims[1];
+  const FCL_REAL
+    dx00 = v[1] - v[0],
+    dx10 = v[dy + 1] - v[dy],
+    dx01 = v[dz + 1] - v[dz],
+    dx11 = v[dz + dy + 1] - v[dz + dy],
+    v00 = v[0] + t[0] * dx00,
+    v10 = v[dy] + t[0] * dx10,
+    v01 = v[dz] + t[0] * dx01,
+    v11 = v[dz + dy] + t[0] * dx11,
+    v0 = v00 + t[1] * (v10 - v00),
+    v1 = v01 + t[1] * (v11 - v01);
+  FCL_REAL d = v0 + t[2] * (v1 - v0);
+
+  if(gradient)
+  {
+    const FCL_REAL
+      dx0 = dx00 + t[1] * (dx10 - dx00),
+      dx1 = dx01 + t[1] * (dx11 - dx01),
+      dy0 = v10 - v00,
+      dy1 = v11 - v01;
+    (*gradient) << dx0 + t[2] * (dx1 - dx0),
+                   dy0 + t[2] * (dy1 - dy0),
+                   v1 - v0;
+    (*gradient) /= resolution;
+  }
+
+  const Vec3f delta ((q - c) * resolution);
+  const FCL_REAL outside = delta.norm();
+  if(outside > 0)
+  {
+    d += outside;
+    if(gradient)
+    {
+      for(int a = 0; a < 3; ++a)
+        if(delta[a] != 0) (*gradient)[a] = delta[a] / outside;
+    }
+  }
+  return d;
+}
+
+}
+
+} // namespace hpp
+
+#endif
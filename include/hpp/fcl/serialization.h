@@ -0,0 +1,86 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#ifndef HPP_FCL_SERIALIZATION_H
+#define HPP_FCL_SERIALIZATION_H
+
+#include <string>
+#include <hpp/fcl/fwd.hh>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Save a geometry in the binary format of hpp-fcl.
+///
+/// The supported geometries are BVHModel of known bounding volumes,
+/// Convex<Triangle> and, when hpp-fcl is built with octomap, OcTree. Other
+/// convex polytopes are not: the type of their polygons is a template
+/// parameter, which the file cannot name. The
+/// bounding volume hierarchy of a BVHModel is saved, so that it is not
+/// rebuilt when the model is loaded, but its convex representation and
+/// compact layout are not.
+///
+/// The data are saved as they are in memory: a file can only be loaded on
+/// a machine with the same representation of numbers as the one that
+/// wrote it.
+/// \throw std::invalid_argument if the geometry is not supported.
+/// \throw std::runtime_error if the file cannot be written.
+void saveBinary(const CollisionGeometry& geometry, const std::string& filename);
+
+/// @brief Load a geometry saved by saveBinary.
+///
+/// The file is mapped in memory. The vertices, triangles and hierarchy of a
+/// BVHModel and the points and polygons of a Convex point into the mapping
+/// instead of being copied, so that processes loading the same file share
+/// the pages of the file cache. The mapping is private: a page is copied
+/// when it is modified (for instance by BVHModel::makeParentRelative). A
+/// loaded BVHModel cannot be replaced or updated, see
+/// BVHModelBase::ownStorage. The mapping is released with the geometry.
+///
+/// The indices of the triangles and of the hierarchy are checked before
+/// the geometry is built, so that a corrupted file is rejected instead of
+/// being read out of bounds by the queries.
+/// \throw std::runtime_error if the file cannot be read, is corrupted, or
+///        was not written by saveBinary on a compatible machine.
+CollisionGeometryPtr_t loadBinary(const std::string& filename);
+
+}
+
+} // namespace hpp
+
+#endif
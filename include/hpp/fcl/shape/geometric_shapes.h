@@ -44,6 +44,7 @@
 #include <hpp/fcl/collision_object.h>
 #include <hpp/fcl/data_types.h>
 #include <string.h>
+#include <vector>
 
 namespace hpp
 {
@@ -294,6 +295,23 @@ public:
   /// @brief Get node type: a conex polytope 
   NODE_TYPE getNodeType() const { return GEOM_CONVEX; }
 
+  /// @brief Build the convex hull of a set of points with the quickhull
+  ///        algorithm.
+  ///
+  /// The coplanar faces of the hull are merged and the points which are not
+  /// corners of the merged faces are discarded, so that the returned
+  /// Convex<Triangle> has as few points as possible.
+  /// \param points the points, which are copied.
+  /// \param num_points the number of points, at least 4.
+  /// \param tolerance the distance below which a point is considered on a
+  ///        face, relative to the diagonal of the bounding box of the points.
+  /// \return a new Convex<Triangle>, which owns its storage.
+  /// \throw std::invalid_argument if the points are all in a plane.
+  /// \throw std::runtime_error if rounding errors prevent to compute the
+  ///        hull.
+  static ConvexBase* convexHull(const Vec3f* points, int num_points,
+                                FCL_REAL tolerance = 1e-6);
+
   /// @brief An array of the points of the polygon.
   Vec3f* points;
   int num_points;
@@ -315,6 +333,41 @@ public:
   /// @brief center of the convex polytope, this is used for collision: center is guaranteed in the internal of the polytope (as it is convex) 
   Vec3f center;
 
+  /// @brief Resolution of the lookup table of support starts, see
+  ///        supportStart.
+  static const int support_start_resolution = 4;
+
+  /// @brief Minimal number of points of a polytope for which the lookup
+  ///        table of support starts is built.
+  static const int support_start_min_points = 32;
+
+  /// @brief For each cell of a cube map of directions, the index of the
+  ///        support point along the direction at the center of the cell.
+  ///
+  /// The cube map has support_start_resolution x support_start_resolution
+  /// cells per face. The table is empty when the polytope has less than
+  /// support_start_min_points points.
+  std::vector<unsigned int> support_starts;
+
+  /// @brief Index of a point close to the support point along dir.
+  ///
+  /// The support function hill climbs the neighbor graph from this point,
+  /// which is much faster than starting from an arbitrary point on large
+  /// polytopes.
+  inline unsigned int supportStart(const Vec3f& dir) const
+  {
+    if(support_starts.empty()) return 0;
+    const int N = support_start_resolution;
+    int a;
+    FCL_REAL m = dir.cwiseAbs().maxCoeff(&a);
+    if(m == 0) return 0;
+    int b = (a + 1) % 3, c = (a + 2) % 3;
+    int i = std::min(N - 1, (int)((dir[b] / m + 1) * N / 2)),
+        j = std::min(N - 1, (int)((dir[c] / m + 1) * N / 2));
+    int face = 2 * a + (dir[a] < 0);
+    return support_starts[(face * N + i) * N + j];
+  }
+
 protected:
   /// @brief Constructing a convex, providing normal and offset of each polytype surface, and the points and shape topology information 
   /// \param points_ list of 3D points
@@ -331,6 +384,9 @@ protected:
 
 private:
   void computeCenter();
+
+  /// @brief Fill the lookup table support_starts
+  void computeSupportStarts();
 };
 
 template <typename PolygonT> class Convex;
@@ -0,0 +1,188 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_THREAD_POOL_H
+#define HPP_FCL_THREAD_POOL_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace hpp
+{
+namespace fcl
+{
+
+/// @brief Pool of threads running parallel loops with work stealing.
+///
+/// The indices of a loop are split in as many contiguous ranges as there
+/// are threads. Each thread processes its own range by chunks of a given
+/// size, from its beginning. When its range is empty, a thread steals the
+/// second half of the range of another thread. The calling thread takes
+/// part to the loop, as thread 0.
+///
+/// A pool runs one loop at a time: parallelFor must not be called
+/// concurrently, nor from a task.
+class ThreadPool : private boost::noncopyable
+{
+public:
+  /// @brief Body of a parallel loop
+  class Task
+  {
+  public:
+    virtual ~Task() {}
+
+    /// @brief Process the indices in [begin, end).
+    /// @param thread_id index of the thread, lower than ThreadPool::size,
+    ///        to access data owned by the thread.
+    virtual void run(std::size_t begin, std::size_t end,
+                     std::size_t thread_id) = 0;
+  };
+
+  /// @brief Start the threads of the pool.
+  /// @param num_threads number of threads, including the calling thread.
+  ///        0 means the number of hardware threads.
+  explicit ThreadPool(std::size_t num_threads = 0);
+
+  /// @brief Stop and join the threads.
+  ~ThreadPool();
+
+  /// @brief Number of threads, including the calling thread
+  inline std::size_t size() const { return num_threads_; }
+
+  /// @brief Call task.run on chunks of [0, n) in parallel and wait for the
+  ///        completion of the loop.
+  /// @param grain size of the chunks processed at once.
+  /// @throw std::runtime_error if a task threw an exception. The message is
+  ///        the one of the first exception.
+  void parallelFor(std::size_t n, Task& task, std::size_t grain = 1);
+
+private:
+  /// @brief Indices remaining to be processed by a thread
+  struct Range
+  {
+    boost::mutex lock;
+    std::size_t begin, end;
+  };
+
+  void workerLoop(std::size_t id);
+
+  /// @brief Process the range of thread id, then steal work from the others
+  void work(std::size_t id);
+
+  /// @brief Move part of the range of another thread into the one of thief
+  /// @return false if all the ranges are empty.
+  bool steal(std::size_t thief);
+
+  void runTask(std::size_t begin, std::size_t end, std::size_t id);
+
+  std::size_t num_threads_;
+  boost::scoped_array<Range> ranges_;
+  boost::thread_group threads_;
+
+  boost::mutex lock_;
+  boost::condition_variable job_cond_;
+  boost::condition_variable done_cond_;
+  Task* task_;
+  std::size_t grain_;
+  std::size_t generation_;
+  std::size_t active_;
+  bool stop_;
+  bool failed_;
+  std::string error_;
+};
+
+namespace details
+{
+/// @brief Task reducing chunks of indices, see reduce
+template<typename Reduction>
+struct ReduceTask : ThreadPool::Task
+{
+  ReduceTask(const Reduction& reduction_, std::size_t n_,
+             std::size_t chunk_size_) :
+    reduction(reduction_), n(n_), chunk_size(chunk_size_),
+    results((n_ + chunk_size_ - 1) / chunk_size_)
+  {}
+
+  void run(std::size_t begin, std::size_t end, std::size_t)
+  {
+    for(std::size_t i = begin; i < end; ++i)
+      results[i] = reduction(i * chunk_size,
+                             std::min(n, (i + 1) * chunk_size));
+  }
+
+  const Reduction& reduction;
+  std::size_t n, chunk_size;
+  std::vector<typename Reduction::Result> results;
+};
+}
+
+/// @brief Reduce [0, n) by chunks of chunk_size indices, in parallel if pool
+///        is not NULL.
+///
+/// The results of the chunks are merged in order, so that the result does not
+/// depend on the number of threads, even if the merge is not associative, as
+/// a floating point sum.
+///
+/// Reduction provides the type Result, the reduction of the indices in
+/// [begin, end) by Result operator()(std::size_t begin, std::size_t end) const
+/// and the merge of two results by
+/// void merge(Result& result, const Result& other) const.
+template<typename Reduction>
+typename Reduction::Result reduce(const Reduction& reduction, std::size_t n,
+                                  std::size_t chunk_size, ThreadPool* pool)
+{
+  if(n <= chunk_size) return reduction(0, n);
+
+  details::ReduceTask<Reduction> task(reduction, n, chunk_size);
+  if(pool) pool->parallelFor(task.results.size(), task);
+  else task.run(0, task.results.size(), 0);
+
+  typename Reduction::Result result(task.results[0]);
+  for(std::size_t i = 1; i < task.results.size(); ++i)
+    reduction.merge(result, task.results[i]);
+  return result;
+}
+
+}
+
+} // namespace hpp
+
+#endif
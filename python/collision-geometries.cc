@@ -62,6 +62,10 @@ struct BVHModelBaseWrapper
   }
 };
 
+BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(buildConvexRepresentation_overloads,
+                                       BVHModelBase::buildConvexRepresentation,
+                                       1, 2)
+
 template <typename BV>
 void exposeBVHModel (const std::string& bvname)
 {
@@ -186,6 +190,8 @@ void exposeCollisionGeometries ()
     .value ("OT_BVH"    , OT_BVH)
     .value ("OT_GEOM"   , OT_GEOM)
     .value ("OT_OCTREE" , OT_OCTREE)
+    .value ("OT_SDF"    , OT_SDF)
+    .value ("OT_HFIELD" , OT_HFIELD)
     ;
   enum_<NODE_TYPE>("NODE_TYPE")
     .value ("BV_UNKNOWN", BV_UNKNOWN)
@@ -207,6 +213,8 @@ void exposeCollisionGeometries ()
     .value ("GEOM_HALFSPACE", GEOM_HALFSPACE)
     .value ("GEOM_TRIANGLE" , GEOM_TRIANGLE)
     .value ("GEOM_OCTREE"   , GEOM_OCTREE)
+    .value ("GEOM_SDF"      , GEOM_SDF)
+    .value ("GEOM_HFIELD"   , GEOM_HFIELD)
     ;
 
   class_ <CollisionGeometry, CollisionGeometryPtr_t, noncopyable>
@@ -233,7 +241,8 @@ void exposeCollisionGeometries ()
 
     .def_readonly ("convex", &BVHModelBase::convex)
 
-    .def ("buildConvexRepresentation", &BVHModelBase::buildConvexRepresentation)
+    .def ("buildConvexRepresentation", &BVHModelBase::buildConvexRepresentation,
+          buildConvexRepresentation_overloads())
     ;
   exposeBVHModel<OBB    >("OBB"    );
   exposeBVHModel<OBBRSS >("OBBRSS" );
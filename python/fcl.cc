@@ -56,7 +56,9 @@ void exposeMeshLoader ()
     .def ("load", static_cast <BVHModelPtr_t (MeshLoader::*) (const std::string&, const Vec3f&)> (&MeshLoader::load))
     ;
 
-  class_ <CachedMeshLoader, bases<MeshLoader> > ("CachedMeshLoader", init< optional< NODE_TYPE> >())
+  class_ <CachedMeshLoader, bases<MeshLoader>, noncopyable> ("CachedMeshLoader", init< optional< NODE_TYPE> >())
+    .def ("setCacheDirectory", &CachedMeshLoader::setCacheDirectory)
+    .def ("getCacheDirectory", &CachedMeshLoader::getCacheDirectory)
     ;
 }
 
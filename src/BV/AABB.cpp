@@ -39,6 +39,7 @@
 
 #include <limits>
 #include <hpp/fcl/collision_data.h>
+#include "OBB.h"
 
 namespace hpp
 {
@@ -145,16 +146,25 @@ FCL_REAL AABB::distance(const AABB& other) const
 
 bool overlap(const Matrix3f& R0, const Vec3f& T0, const AABB& b1, const AABB& b2)
 {
-  AABB bb1 (translate (rotate (b1, R0), T0));
-  return bb1.overlap (b2);
+  Vec3f T (R0 * b2.center() + T0 - b1.center());
+  return !obbDisjoint(R0, T, (b1.max_ - b1.min_) / 2, (b2.max_ - b2.min_) / 2);
 }
 
 bool overlap(const Matrix3f& R0, const Vec3f& T0, const AABB& b1,
 	     const AABB& b2, const CollisionRequest& request,
              FCL_REAL& sqrDistLowerBound)
 {
-  AABB bb1 (translate (rotate (b1, R0), T0));
-  return bb1.overlap (b2, request, sqrDistLowerBound);
+  Vec3f T (R0 * b2.center() + T0 - b1.center());
+  return !obbDisjointAndLowerBoundDistance (R0, T, (b1.max_ - b1.min_) / 2,
+                                            (b2.max_ - b2.min_) / 2,
+                                            request, sqrDistLowerBound);
+}
+
+FCL_REAL distance(const Matrix3f& R0, const Vec3f& T0, const AABB& b1,
+                  const AABB& b2, Vec3f* /*P*/, Vec3f* /*Q*/)
+{
+  AABB bb2 (translate (rotate (b2, R0), T0));
+  return b1.distance (bb2);
 }
 
 }
@@ -505,6 +505,21 @@ bool overlap(const Matrix3f& R0, const Vec3f& T0, const OBB& b1, const OBB& b2,
 					    request, sqrDistLowerBound);
 }
 
+FCL_REAL distance(const Matrix3f& R0, const Vec3f& T0, const OBB& b1,
+                  const OBB& b2, Vec3f* /*P*/, Vec3f* /*Q*/)
+{
+  Vec3f Ttemp (R0 * b2.To + T0 - b1.To);
+  Vec3f T (b1.axes.transpose() * Ttemp);
+  Matrix3f R (b1.axes.transpose() * R0 * b2.axes);
+
+  CollisionRequest request (DISTANCE_LOWER_BOUND, 0);
+  FCL_REAL sqrDistLowerBound;
+  if (obbDisjointAndLowerBoundDistance (R, T, b1.extent, b2.extent,
+                                        request, sqrDistLowerBound))
+    return sqrt (sqrDistLowerBound);
+  return 0;
+}
+
 OBB translate(const OBB& bv, const Vec3f& t)
 {
   OBB res(bv);
@@ -0,0 +1,259 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <hpp/fcl/BV/float_BV.h>
+
+#include <cmath>
+#include <limits>
+#include <hpp/fcl/collision_data.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace
+{
+  /// Smallest float greater than or equal to x
+  inline float roundUp(FCL_REAL x)
+  {
+    float f = (float)x;
+    if(f < x) f = nextafterf(f, std::numeric_limits<float>::infinity());
+    return f;
+  }
+
+  /// Largest float less than or equal to x
+  inline float roundDown(FCL_REAL x)
+  {
+    float f = (float)x;
+    if(f > x) f = nextafterf(f, -std::numeric_limits<float>::infinity());
+    return f;
+  }
+
+  typedef FloatOBB::Vector Vector;
+  typedef FloatOBB::Matrix Matrix;
+
+  const FCL_REAL eps = std::numeric_limits<float>::epsilon();
+
+  /// Same as obbDisjointAndLowerBoundDistance in single precision, the box of
+  /// half dimensions b being in configuration (B, T) in the frame of the box
+  /// of half dimensions a.
+  ///
+  /// B and T are known up to a few eps and the projections on each axis are
+  /// sums of a few terms, so their errors are lower than 16 eps times the
+  /// sizes of the boxes plus the distance between their centers. The
+  /// separations are reduced by this bound, and the squared norms of the
+  /// cross product axes increased by 32 eps, so that the lower bound holds.
+  bool disjoint(const Matrix& B, const Vector& T, const Vector& a,
+                const Vector& b, FCL_REAL breakDistance2,
+                FCL_REAL& squaredLowerBoundDistance)
+  {
+    const Matrix Bf (B.cwiseAbs());
+    const float tol =
+      (float)(16 * eps) * (T.cwiseAbs().sum() + a.sum() + b.sum());
+
+    // Ai
+    Vector s (T.cwiseAbs() - a - Bf * b - Vector::Constant(tol));
+    squaredLowerBoundDistance =
+      s.cwiseMax(Vector::Zero()).cast<FCL_REAL>().squaredNorm();
+    if(squaredLowerBoundDistance > breakDistance2)
+      return true;
+
+    // Bj
+    s = (B.transpose() * T).cwiseAbs() - Bf.transpose() * a - b
+      - Vector::Constant(tol);
+    squaredLowerBoundDistance =
+      s.cwiseMax(Vector::Zero()).cast<FCL_REAL>().squaredNorm();
+    if(squaredLowerBoundDistance > breakDistance2)
+      return true;
+
+    // Ai x Bj
+    for(int ia = 0; ia < 3; ++ia)
+    {
+      const int ja = (ia + 1) % 3, ka = (ia + 2) % 3;
+      for(int ib = 0; ib < 3; ++ib)
+      {
+        const int jb = (ib + 1) % 3, kb = (ib + 2) % 3;
+        const float diff = std::abs(T[ka] * B(ja, ib) - T[ja] * B(ka, ib))
+          - (a[ja] * Bf(ka, ib) + a[ka] * Bf(ja, ib)
+             + b[jb] * Bf(ia, kb) + b[kb] * Bf(ia, jb)) - tol;
+        if(diff > 0)
+        {
+          FCL_REAL sinus2 = 1 - (FCL_REAL)Bf(ia, ib) * Bf(ia, ib);
+          if(sinus2 > 1e-6)
+          {
+            squaredLowerBoundDistance =
+              (FCL_REAL)diff * diff / (sinus2 + 32 * eps);
+            if(squaredLowerBoundDistance > breakDistance2)
+              return true;
+          }
+        }
+      }
+    }
+
+    return false;
+  }
+
+  inline FCL_REAL squaredBreakDistance(const CollisionRequest& request)
+  {
+    const FCL_REAL breakDistance (request.break_distance +
+                                  request.security_margin);
+    return breakDistance * breakDistance;
+  }
+
+  /// Test b2, in configuration (R0, T0) in the frame of b1
+  bool disjoint(const Matrix3f& R0, const Vec3f& T0, const FloatAABB& b1,
+                const FloatAABB& b2, FCL_REAL breakDistance2,
+                FCL_REAL& squaredLowerBoundDistance)
+  {
+    // The centers are subtracted in double precision since they may be far
+    // from the origin.
+    const Vec3f c1 ((b1.min_.cast<FCL_REAL>() + b1.max_.cast<FCL_REAL>()) / 2);
+    const Vec3f c2 ((b2.min_.cast<FCL_REAL>() + b2.max_.cast<FCL_REAL>()) / 2);
+    const Vector a (((b1.max_.cast<FCL_REAL>() - b1.min_.cast<FCL_REAL>()) / 2)
+                    .cast<float>());
+    const Vector b (((b2.max_.cast<FCL_REAL>() - b2.min_.cast<FCL_REAL>()) / 2)
+                    .cast<float>());
+    const Vec3f T (R0 * c2 + T0 - c1);
+    return disjoint(R0.cast<float>(), T.cast<float>(), a, b, breakDistance2,
+                    squaredLowerBoundDistance);
+  }
+
+  /// Test b2, in configuration (R0, T0) in the frame of b1
+  bool disjoint(const Matrix3f& R0, const Vec3f& T0, const FloatOBB& b1,
+                const FloatOBB& b2, FCL_REAL breakDistance2,
+                FCL_REAL& squaredLowerBoundDistance)
+  {
+    const Vec3f Ttemp (R0 * b2.To.cast<FCL_REAL>() + T0
+                       - b1.To.cast<FCL_REAL>());
+    const Vector T (b1.axes.transpose() * Ttemp.cast<float>());
+    const Matrix B (b1.axes.transpose() * R0.cast<float>() * b2.axes);
+    return disjoint(B, T, b1.extent, b2.extent, breakDistance2,
+                    squaredLowerBoundDistance);
+  }
+}
+
+FloatAABB::FloatAABB(const AABB& bv)
+{
+  for(int i = 0; i < 3; ++i)
+  {
+    min_[i] = roundDown(bv.min_[i]);
+    max_[i] = roundUp(bv.max_[i]);
+  }
+}
+
+FloatOBB::FloatOBB(const OBB& bv) :
+  axes(bv.axes.cast<float>()), To(bv.To.cast<float>())
+{
+  // Rounding moves the center by at most eps |To|, and the corners by at
+  // most eps (e_0 + e_1 + e_2) through the axes. The separating axis test
+  // assumes orthonormal axes, which adds an error of the same order on the
+  // projections of the box. The factor 4 covers these errors.
+  const FCL_REAL eps = std::numeric_limits<float>::epsilon();
+  FCL_REAL margin = 4 * eps *
+    (bv.To.lpNorm<Eigen::Infinity>() + bv.extent.sum());
+  for(int i = 0; i < 3; ++i)
+    extent[i] = roundUp(bv.extent[i] + margin);
+}
+
+bool FloatAABB::overlap(const FloatAABB& other,
+                        const CollisionRequest& request,
+                        FCL_REAL& sqrDistLowerBound) const
+{
+  const FCL_REAL breakDistance2 = squaredBreakDistance(request);
+
+  // The differences are rounded by at most eps / 2 relatively, so the factor
+  // 1 - 2 eps keeps a lower bound.
+  sqrDistLowerBound = (1 - 2 * eps) * (min_ - other.max_)
+    .cwiseMax(Vector::Zero()).cast<FCL_REAL>().squaredNorm();
+  if(sqrDistLowerBound > breakDistance2) return false;
+
+  sqrDistLowerBound = (1 - 2 * eps) * (other.min_ - max_)
+    .cwiseMax(Vector::Zero()).cast<FCL_REAL>().squaredNorm();
+  if(sqrDistLowerBound > breakDistance2) return false;
+
+  return true;
+}
+
+bool FloatOBB::overlap(const FloatOBB& other) const
+{
+  FCL_REAL sqrDistLowerBound;
+  const Vector T (axes.transpose() * (other.To - To));
+  const Matrix B (axes.transpose() * other.axes);
+  return !disjoint(B, T, extent, other.extent, 0, sqrDistLowerBound);
+}
+
+bool FloatOBB::overlap(const FloatOBB& other, const CollisionRequest& request,
+                       FCL_REAL& sqrDistLowerBound) const
+{
+  const Vector T (axes.transpose() * (other.To - To));
+  const Matrix B (axes.transpose() * other.axes);
+  return !disjoint(B, T, extent, other.extent, squaredBreakDistance(request),
+                   sqrDistLowerBound);
+}
+
+bool overlap(const Matrix3f& R0, const Vec3f& T0, const FloatAABB& b1,
+             const FloatAABB& b2)
+{
+  FCL_REAL sqrDistLowerBound;
+  return !disjoint(R0, T0, b1, b2, 0, sqrDistLowerBound);
+}
+
+bool overlap(const Matrix3f& R0, const Vec3f& T0, const FloatAABB& b1,
+             const FloatAABB& b2, const CollisionRequest& request,
+             FCL_REAL& sqrDistLowerBound)
+{
+  return !disjoint(R0, T0, b1, b2, squaredBreakDistance(request),
+                   sqrDistLowerBound);
+}
+
+bool overlap(const Matrix3f& R0, const Vec3f& T0, const FloatOBB& b1,
+             const FloatOBB& b2)
+{
+  FCL_REAL sqrDistLowerBound;
+  return !disjoint(R0, T0, b1, b2, 0, sqrDistLowerBound);
+}
+
+bool overlap(const Matrix3f& R0, const Vec3f& T0, const FloatOBB& b1,
+             const FloatOBB& b2, const CollisionRequest& request,
+             FCL_REAL& sqrDistLowerBound)
+{
+  return !disjoint(R0, T0, b1, b2, squaredBreakDistance(request),
+                   sqrDistLowerBound);
+}
+
+}
+
+} // namespace hpp
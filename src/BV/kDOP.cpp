@@ -36,6 +36,7 @@
 /** \author Jia Pan */
 
 #include <hpp/fcl/BV/kDOP.h>
+#include <hpp/fcl/BV/AABB.h>
 #include <limits>
 #include <iostream>
 
@@ -250,6 +251,40 @@ KDOP<N> translate(const KDOP<N>& bv, const Vec3f& t)
   return res;
 }
 
+namespace details
+{
+/// @brief AABB made of the first six planes of a KDOP
+template<size_t N>
+inline AABB toAABB(const KDOP<N>& bv)
+{
+  return AABB(Vec3f(bv.dist(0), bv.dist(1), bv.dist(2)),
+              Vec3f(bv.dist(N / 2), bv.dist(N / 2 + 1), bv.dist(N / 2 + 2)));
+}
+}
+
+template<size_t N>
+bool overlap(const Matrix3f& R0, const Vec3f& T0,
+             const KDOP<N>& b1, const KDOP<N>& b2)
+{
+  return overlap(R0, T0, details::toAABB(b1), details::toAABB(b2));
+}
+
+template<size_t N>
+bool overlap(const Matrix3f& R0, const Vec3f& T0,
+             const KDOP<N>& b1, const KDOP<N>& b2,
+             const CollisionRequest& request, FCL_REAL& sqrDistLowerBound)
+{
+  return overlap(R0, T0, details::toAABB(b1), details::toAABB(b2),
+                 request, sqrDistLowerBound);
+}
+
+template<size_t N>
+FCL_REAL distance(const Matrix3f& R0, const Vec3f& T0,
+                  const KDOP<N>& b1, const KDOP<N>& b2, Vec3f* P, Vec3f* Q)
+{
+  return distance(R0, T0, details::toAABB(b1), details::toAABB(b2), P, Q);
+}
+
 
 template class KDOP<16>;
 template class KDOP<18>;
@@ -259,6 +294,18 @@ template KDOP<16> translate<16>(const KDOP<16>&, const Vec3f&);
 template KDOP<18> translate<18>(const KDOP<18>&, const Vec3f&);
 template KDOP<24> translate<24>(const KDOP<24>&, const Vec3f&);
 
+template bool overlap<16>(const Matrix3f&, const Vec3f&, const KDOP<16>&, const KDOP<16>&);
+template bool overlap<18>(const Matrix3f&, const Vec3f&, const KDOP<18>&, const KDOP<18>&);
+template bool overlap<24>(const Matrix3f&, const Vec3f&, const KDOP<24>&, const KDOP<24>&);
+
+template bool overlap<16>(const Matrix3f&, const Vec3f&, const KDOP<16>&, const KDOP<16>&, const CollisionRequest&, FCL_REAL&);
+template bool overlap<18>(const Matrix3f&, const Vec3f&, const KDOP<18>&, const KDOP<18>&, const CollisionRequest&, FCL_REAL&);
+template bool overlap<24>(const Matrix3f&, const Vec3f&, const KDOP<24>&, const KDOP<24>&, const CollisionRequest&, FCL_REAL&);
+
+template FCL_REAL distance<16>(const Matrix3f&, const Vec3f&, const KDOP<16>&, const KDOP<16>&, Vec3f*, Vec3f*);
+template FCL_REAL distance<18>(const Matrix3f&, const Vec3f&, const KDOP<18>&, const KDOP<18>&, Vec3f*, Vec3f*);
+template FCL_REAL distance<24>(const Matrix3f&, const Vec3f&, const KDOP<24>&, const KDOP<24>&, Vec3f*, Vec3f*);
+
 }
 
 } // namespace hpp
@@ -38,10 +38,12 @@
 #include <hpp/fcl/BVH/BVH_model.h>
 
 #include <iostream>
+#include <new>
 #include <string.h>
 
 #include <hpp/fcl/BV/BV.h>
 #include <hpp/fcl/shape/convex.h>
+#include <hpp/fcl/thread_pool.h>
 
 #include "../../src/BVH/BV_splitter.h"
 #include "../../src/BVH/BV_fitter.h"
@@ -57,7 +59,8 @@ BVHModelBase::BVHModelBase(const BVHModelBase& other) :
   num_vertices(other.num_vertices),
   build_state(other.build_state),
   num_tris_allocated(other.num_tris),
-  num_vertices_allocated(other.num_vertices)
+  num_vertices_allocated(other.num_vertices),
+  own_storage_(true)
 {
   if(other.vertices)
   {
@@ -84,9 +87,12 @@ BVHModelBase::BVHModelBase(const BVHModelBase& other) :
     prev_vertices = NULL;
 }
 
-void BVHModelBase::buildConvexRepresentation(bool share_memory)
+void BVHModelBase::buildConvexRepresentation(bool share_memory,
+                                             bool compute_hull)
 {
-  if (!convex) {
+  if (!convex && compute_hull) {
+    convex.reset(ConvexBase::convexHull(vertices, num_vertices));
+  } else if (!convex) {
     Vec3f* points = vertices;
     Triangle* polygons = tri_indices;
     if (!share_memory) {
@@ -96,7 +102,7 @@ void BVHModelBase::buildConvexRepresentation(bool share_memory)
       polygons = new Triangle[num_tris];
       memcpy(polygons, tri_indices, sizeof(Triangle) * num_tris);
     }
-    convex.reset(new Convex<Triangle>(!share_memory, points, num_vertices, polygons, num_vertices));
+    convex.reset(new Convex<Triangle>(!share_memory, points, num_vertices, polygons, num_tris));
   }
 }
 
@@ -134,6 +140,11 @@ BVHModel<BV>::BVHModel(const BVHModel<BV>& other) : BVHModelBase(other),
   }
   else
     bvs = NULL;
+
+  compact_bvs = NULL;
+  compact_memory = NULL;
+  if(other.compact_bvs)
+    buildCompactLayout();
 }
 
 
@@ -141,12 +152,18 @@ int BVHModelBase::beginModel(int num_tris_, int num_vertices_)
 {
   if(build_state != BVH_BUILD_STATE_EMPTY)
   {
-    delete [] vertices; vertices = NULL;
-    delete [] tri_indices; tri_indices = NULL;
+    if(own_storage_)
+    {
+      delete [] vertices;
+      delete [] tri_indices;
+    }
+    vertices = NULL;
+    tri_indices = NULL;
     delete [] prev_vertices; prev_vertices = NULL;
 
     num_vertices_allocated = num_vertices = num_tris_allocated = num_tris = 0;
     deleteBVs();
+    own_storage_ = true;
   }
 
   if(num_tris_ <= 0) num_tris_ = 8;
@@ -359,6 +376,16 @@ int BVHModelBase::addSubModel(const std::vector<Vec3f>& ps, const std::vector<Tr
 }
 
 int BVHModelBase::endModel()
+{
+  return endModel(NULL);
+}
+
+int BVHModelBase::endModel(ThreadPool& pool)
+{
+  return endModel(&pool);
+}
+
+int BVHModelBase::endModel(ThreadPool* pool)
 {
   if(build_state != BVH_BUILD_STATE_BEGUN)
   {
@@ -404,7 +431,10 @@ int BVHModelBase::endModel()
   if (!allocateBVs ())
     return BVH_ERR_MODEL_OUT_OF_MEMORY;
 
-  buildTree();
+  if(pool)
+    buildTree(*pool);
+  else
+    buildTree();
 
   // finish constructing
   build_state = BVH_BUILD_STATE_PROCESSED;
@@ -422,6 +452,12 @@ int BVHModelBase::beginReplaceModel()
     return BVH_ERR_BUILD_EMPTY_PREVIOUS_FRAME;
   }
 
+  if(!own_storage_)
+  {
+    std::cerr << "BVH Error! Call beginReplaceModel() on a BVHModel loaded from a mapped file." << std::endl;
+    return BVH_ERR_UNSUPPORTED_FUNCTION;
+  }
+
   if(prev_vertices) delete [] prev_vertices; prev_vertices = NULL;
 
   num_vertex_updated = 0;
@@ -515,6 +551,12 @@ int BVHModelBase::beginUpdateModel()
     return BVH_ERR_BUILD_EMPTY_PREVIOUS_FRAME;
   }
 
+  if(!own_storage_)
+  {
+    std::cerr << "BVH Error! Call beginUpdateModel() on a BVHModel loaded from a mapped file." << std::endl;
+    return BVH_ERR_UNSUPPORTED_FUNCTION;
+  }
+
   if(prev_vertices)
   {
     Vec3f* temp = prev_vertices;
@@ -645,16 +687,24 @@ BVHModel<BV>::BVHModel() :
   num_bvs_allocated(0),
   primitive_indices(NULL),
   bvs(NULL),
-  num_bvs(0)
+  num_bvs(0),
+  compact_bvs(NULL),
+  compact_memory(NULL)
 {
 }
 
 template<typename BV>
 void BVHModel<BV>::deleteBVs()
 {
-  delete [] bvs; bvs = NULL;
-  delete [] primitive_indices; primitive_indices = NULL;
+  if(own_storage_)
+  {
+    delete [] bvs;
+    delete [] primitive_indices;
+  }
+  bvs = NULL;
+  primitive_indices = NULL;
   num_bvs_allocated = num_bvs = 0;
+  clearCompactLayout();
 }
 
 template<typename BV>
@@ -683,16 +733,23 @@ bool BVHModel<BV>::allocateBVs()
 template<typename BV>
 int BVHModel<BV>::memUsage(int msg) const
 {
-  int mem_bv_list = (int)sizeof(BV) * num_bvs;
+  int mem_bv_list = (int)sizeof(BVNode<BV>) * num_bvs;
+  int mem_compact_list = compact_bvs ?
+    (int)sizeof(CompactBVNode<BV>) * num_bvs : 0;
   int mem_tri_list = (int)sizeof(Triangle) * num_tris;
   int mem_vertex_list = (int)sizeof(Vec3f) * num_vertices;
 
-  int total_mem = mem_bv_list + mem_tri_list + mem_vertex_list +
-    (int)sizeof(BVHModel<BV>);
+  int total_mem = mem_bv_list + mem_compact_list + mem_tri_list +
+    mem_vertex_list + (int)sizeof(BVHModel<BV>);
   if(msg)
   {
     std::cerr << "Total for model " << total_mem << " bytes." << std::endl;
-    std::cerr << "BVs: " << num_bvs << " allocated." << std::endl;
+    std::cerr << "BVs: " << num_bvs << " allocated, " << mem_bv_list
+              << " bytes." << std::endl;
+    if(compact_bvs)
+      std::cerr << "Compact layout: " << mem_compact_list << " bytes, "
+                << mem_bv_list - mem_compact_list << " bytes less than the BVs."
+                << std::endl;
     std::cerr << "Tris: " << num_tris << " allocated." << std::endl;
     std::cerr << "Vertices: " << num_vertices << " allocated." << std::endl;
   }
@@ -708,7 +765,105 @@ int BVHModel<BV>::buildTree()
   // set SplitRule
   bv_splitter->set(vertices, tri_indices, getModelType());
 
-  num_bvs = 1;
+  int num_primitives = 0;
+  switch(getModelType())
+  {
+    case BVH_MODEL_TRIANGLES:
+      num_primitives = num_tris;
+      break;
+    case BVH_MODEL_POINTCLOUD:
+      num_primitives = num_vertices;
+      break;
+    default:
+      std::cerr << "BVH Error: Model type not supported!" << std::endl;
+      return BVH_ERR_UNSUPPORTED_FUNCTION;
+  }
+
+  for(int i = 0; i < num_primitives; ++i)
+    primitive_indices[i] = i;
+  recursiveBuildTree(*bv_fitter, *bv_splitter, 0, 0, num_primitives, 1);
+  num_bvs = 2 * num_primitives - 1;
+
+  bv_fitter->clear();
+  bv_splitter->clear();
+
+  if(compact_bvs) buildCompactLayout();
+  return BVH_OK;
+}
+
+namespace
+{
+  /// Number of subtrees of the hierarchy given to each thread, so that work
+  /// stealing can balance the load.
+  const int subtreesPerThread = 16;
+
+  /// A node of the hierarchy with its primitives, its descendants being
+  /// stored from first_child.
+  struct Subtree
+  {
+    int bv_id, first_primitive, num_primitives, first_child;
+  };
+}
+
+/// Each subtree of the current level is either built entirely, if it is
+/// small, or split in two subtrees of the next level.
+template<typename BV>
+struct BVHModel<BV>::BuildTask : ThreadPool::Task
+{
+  BuildTask(BVHModel<BV>& model_, std::size_t num_threads, int max_size_) :
+    model(model_), fitters(num_threads, *model_.bv_fitter),
+    splitters(num_threads, *model_.bv_splitter), max_size(max_size_),
+    fitted(false)
+  {}
+
+  void run(std::size_t begin, std::size_t end, std::size_t thread_id)
+  {
+    for(std::size_t i = begin; i < end; ++i)
+    {
+      const Subtree& s = level[i];
+      Subtree* children = &next_level[2 * i];
+      if(s.num_primitives <= max_size)
+      {
+        model.recursiveBuildTree(fitters[thread_id], splitters[thread_id],
+                                 s.bv_id, s.first_primitive, s.num_primitives,
+                                 s.first_child);
+        children[0].num_primitives = children[1].num_primitives = 0;
+        continue;
+      }
+
+      if(!fitted)
+        model.bvs[s.bv_id].bv = fitters[thread_id].fit
+          (model.primitive_indices + s.first_primitive, s.num_primitives);
+      int num_first_half = model.splitNode
+        (splitters[thread_id], s.bv_id, s.first_primitive, s.num_primitives,
+         s.first_child);
+      children[0].bv_id = s.first_child;
+      children[0].first_primitive = s.first_primitive;
+      children[0].num_primitives = num_first_half;
+      children[0].first_child = s.first_child + 2;
+      children[1].bv_id = s.first_child + 1;
+      children[1].first_primitive = s.first_primitive + num_first_half;
+      children[1].num_primitives = s.num_primitives - num_first_half;
+      children[1].first_child = s.first_child + 2 * num_first_half;
+    }
+  }
+
+  BVHModel<BV>& model;
+  std::vector<BVFitter<BV> > fitters;
+  std::vector<BVSplitter<BV> > splitters;
+  int max_size;
+  /// Whether the nodes of the level that are split have already been fitted
+  bool fitted;
+  std::vector<Subtree> level, next_level;
+};
+
+template<typename BV>
+int BVHModel<BV>::buildTree(ThreadPool& pool)
+{
+  if(pool.size() == 1) return buildTree();
+
+  bv_fitter->set(vertices, tri_indices, getModelType());
+  bv_splitter->set(vertices, tri_indices, getModelType());
 
   int num_primitives = 0;
   switch(getModelType())
@@ -726,97 +881,174 @@ int BVHModel<BV>::buildTree()
 
   for(int i = 0; i < num_primitives; ++i)
     primitive_indices[i] = i;
-  recursiveBuildTree(0, 0, num_primitives);
+
+  // The nodes are built level by level, the nodes of a level being
+  // independent, until the subtrees are small enough to be built by one
+  // thread. As long as there are fewer nodes than threads, each node is
+  // fitted by all the threads. The fitter reduces the primitives by chunks
+  // of fixed size merged in order, so that the hierarchy is the same as the
+  // one of buildTree() whatever the number of threads.
+  BuildTask task(*this, pool.size(), std::max(1, num_primitives /
+                 (subtreesPerThread * (int)pool.size())));
+  Subtree root = { 0, 0, num_primitives, 1 };
+  task.level.push_back(root);
+  while(!task.level.empty())
+  {
+    task.fitted = task.level.size() < pool.size();
+    if(task.fitted)
+    {
+      for(std::size_t i = 0; i < task.level.size(); ++i)
+      {
+        const Subtree& s = task.level[i];
+        if(s.num_primitives > task.max_size)
+          bvs[s.bv_id].bv = bv_fitter->fit
+            (primitive_indices + s.first_primitive, s.num_primitives, &pool);
+      }
+    }
+    task.next_level.resize(2 * task.level.size());
+    pool.parallelFor(task.level.size(), task);
+
+    task.level.clear();
+    for(std::size_t i = 0; i < task.next_level.size(); ++i)
+      if(task.next_level[i].num_primitives > 0)
+        task.level.push_back(task.next_level[i]);
+  }
+  num_bvs = 2 * num_primitives - 1;
 
   bv_fitter->clear();
   bv_splitter->clear();
 
+  if(compact_bvs) buildCompactLayout();
   return BVH_OK;
 }
 
 template<typename BV>
-int BVHModel<BV>::recursiveBuildTree(int bv_id, int first_primitive, int num_primitives)
+int BVHModel<BV>::buildNode(BVFitter<BV>& fitter, BVSplitter<BV>& splitter,
+                            int bv_id, int first_primitive,
+                            int num_primitives, int first_child)
+{
+  bvs[bv_id].bv = fitter.fit(primitive_indices + first_primitive,
+                             num_primitives);
+  return splitNode(splitter, bv_id, first_primitive, num_primitives,
+                   first_child);
+}
+
+template<typename BV>
+int BVHModel<BV>::splitNode(BVSplitter<BV>& splitter, int bv_id,
+                            int first_primitive, int num_primitives,
+                            int first_child)
 {
   BVHModelType type = getModelType();
   BVNode<BV>* bvnode = bvs + bv_id;
   unsigned int* cur_primitive_indices = primitive_indices + first_primitive;
 
-  // constructing BV
-  BV bv = bv_fitter->fit(cur_primitive_indices, num_primitives);
-  bv_splitter->computeRule(bv, cur_primitive_indices, num_primitives);
+  splitter.computeRule(bvnode->bv, cur_primitive_indices, num_primitives);
 
-  bvnode->bv = bv;
   bvnode->first_primitive = first_primitive;
   bvnode->num_primitives = num_primitives;
 
   if(num_primitives == 1)
   {
     bvnode->first_child = -((*cur_primitive_indices) + 1);
+    return 0;
   }
-  else
-  {
-    bvnode->first_child = num_bvs;
-    num_bvs += 2;
 
-    int c1 = 0;
-    for(int i = 0; i < num_primitives; ++i)
+  bvnode->first_child = first_child;
+
+  int c1 = 0;
+  for(int i = 0; i < num_primitives; ++i)
+  {
+    Vec3f p;
+    if(type == BVH_MODEL_POINTCLOUD) p = vertices[cur_primitive_indices[i]];
+    else
     {
-      Vec3f p;
-      if(type == BVH_MODEL_POINTCLOUD) p = vertices[cur_primitive_indices[i]];
-      else if(type == BVH_MODEL_TRIANGLES)
-      {
-        const Triangle& t = tri_indices[cur_primitive_indices[i]];
-        const Vec3f& p1 = vertices[t[0]];
-        const Vec3f& p2 = vertices[t[1]];
-        const Vec3f& p3 = vertices[t[2]];
+      const Triangle& t = tri_indices[cur_primitive_indices[i]];
+      const Vec3f& p1 = vertices[t[0]];
+      const Vec3f& p2 = vertices[t[1]];
+      const Vec3f& p3 = vertices[t[2]];
 
-        p = (p1 + p2 + p3) / 3.;
-      }
-      else
-      {
-        std::cerr << "BVH Error: Model type not supported!" << std::endl;
-        return BVH_ERR_UNSUPPORTED_FUNCTION;
-      }
+      p = (p1 + p2 + p3) / 3.;
+    }
 
 
-      // loop invariant: up to (but not including) index c1 in group 1,
-      // then up to (but not including) index i in group 2
-      //
-      //  [1] [1] [1] [1] [2] [2] [2] [x] [x] ... [x]
-      //                   c1          i
-      //
-      if(bv_splitter->apply(p)) // in the right side
-      {
-        // do nothing
-      }
-      else
-      {
-        unsigned int temp = cur_primitive_indices[i];
-        cur_primitive_indices[i] = cur_primitive_indices[c1];
-        cur_primitive_indices[c1] = temp;
-        c1++;
-      }
+    // loop invariant: up to (but not including) index c1 in group 1,
+    // then up to (but not including) index i in group 2
+    //
+    //  [1] [1] [1] [1] [2] [2] [2] [x] [x] ... [x]
+    //                   c1          i
+    //
+    if(splitter.apply(p)) // in the right side
+    {
+      // do nothing
     }
+    else
+    {
+      unsigned int temp = cur_primitive_indices[i];
+      cur_primitive_indices[i] = cur_primitive_indices[c1];
+      cur_primitive_indices[c1] = temp;
+      c1++;
+    }
+  }
+
 
+  if((c1 == 0) || (c1 == num_primitives)) c1 = num_primitives / 2;
 
-    if((c1 == 0) || (c1 == num_primitives)) c1 = num_primitives / 2;
+  return c1;
+}
 
-    int num_first_half = c1;
+template<typename BV>
+void BVHModel<BV>::recursiveBuildTree(BVFitter<BV>& fitter,
+                                      BVSplitter<BV>& splitter, int bv_id,
+                                      int first_primitive, int num_primitives,
+                                      int first_child)
+{
+  int num_first_half = buildNode(fitter, splitter, bv_id, first_primitive,
+                                 num_primitives, first_child);
+  if(num_primitives == 1) return;
+
+  // The subtree of the first child has 2 * num_first_half - 1 nodes.
+  recursiveBuildTree(fitter, splitter, first_child, first_primitive,
+                     num_first_half, first_child + 2);
+  recursiveBuildTree(fitter, splitter, first_child + 1,
+                     first_primitive + num_first_half,
+                     num_primitives - num_first_half,
+                     first_child + 2 * num_first_half);
+}
 
-    recursiveBuildTree(bvnode->leftChild(), first_primitive, num_first_half);
-    recursiveBuildTree(bvnode->rightChild(), first_primitive + num_first_half, num_primitives - num_first_half);
-  }
+template<typename BV>
+void BVHModel<BV>::buildCompactLayout()
+{
+  clearCompactLayout();
+  if(num_bvs == 0) return;
+
+  const std::size_t alignment = CompactBV<BV>::alignment;
+  compact_memory = new char[sizeof(CompactBVNode<BV>) * num_bvs + alignment];
+  std::size_t offset = reinterpret_cast<std::size_t>(compact_memory) % alignment;
+  compact_bvs = reinterpret_cast<CompactBVNode<BV>*>
+    (compact_memory + (offset ? alignment - offset : 0));
+  for(int i = 0; i < num_bvs; ++i)
+    new (compact_bvs + i) CompactBVNode<BV>(bvs[i]);
+}
 
-  return BVH_OK;
+template<typename BV>
+void BVHModel<BV>::clearCompactLayout()
+{
+  delete [] compact_memory;
+  compact_memory = NULL;
+  compact_bvs = NULL;
 }
 
 template<typename BV>
 int BVHModel<BV>::refitTree(bool bottomup)
 {
+  int res;
   if(bottomup)
-    return refitTree_bottomup();
+    res = refitTree_bottomup();
   else
-    return refitTree_topdown();
+    res = refitTree_topdown();
+
+  if(compact_bvs) buildCompactLayout();
+  return res;
 }
 
 template<typename BV>
@@ -38,6 +38,7 @@
 
 #include <hpp/fcl/BVH/BVH_utility.h>
 #include <hpp/fcl/narrowphase/narrowphase.h>
+#include <hpp/fcl/thread_pool.h>
 #include "../src/shape/geometric_shapes_utility.h"
 
 namespace hpp
@@ -133,76 +134,122 @@ template BVHModel<KDOP<16> >* BVHExtract(const BVHModel<KDOP<16> >& model, const
 template BVHModel<KDOP<18> >* BVHExtract(const BVHModel<KDOP<18> >& model, const Transform3f& pose, const AABB& aabb);
 template BVHModel<KDOP<24> >* BVHExtract(const BVHModel<KDOP<24> >& model, const Transform3f& pose, const AABB& aabb);
 
-void getCovariance(Vec3f* ps, Vec3f* ps2, Triangle* ts, unsigned int* indices, int n, Matrix3f& M)
+namespace
 {
-  Vec3f S1 (Vec3f::Zero());
-  Vec3f S2[3] = { Vec3f::Zero(), Vec3f::Zero(), Vec3f::Zero() };
+  /// Sums of the coordinates of the points and of their products
+  struct Moments
+  {
+    Vec3f S1;
+    Vec3f S2[3];
+  };
 
-  if(ts)
+  /// Reduction of primitives to the moments of their points
+  struct MomentsReduction
   {
-    for(int i = 0; i < n; ++i)
+    typedef Moments Result;
+
+    MomentsReduction(Vec3f* ps_, Vec3f* ps2_, Triangle* ts_,
+                     unsigned int* indices_) :
+      ps(ps_), ps2(ps2_), ts(ts_), indices(indices_)
+    {}
+
+    Moments operator()(std::size_t begin, std::size_t end) const
     {
-      const Triangle& t = (indices) ? ts[indices[i]] : ts[i];
-
-      const Vec3f& p1 = ps[t[0]];
-      const Vec3f& p2 = ps[t[1]];
-      const Vec3f& p3 = ps[t[2]];
-
-      S1[0] += (p1[0] + p2[0] + p3[0]);
-      S1[1] += (p1[1] + p2[1] + p3[1]);
-      S1[2] += (p1[2] + p2[2] + p3[2]);
-      S2[0][0] += (p1[0] * p1[0] + p2[0] * p2[0] + p3[0] * p3[0]);
-      S2[1][1] += (p1[1] * p1[1] + p2[1] * p2[1] + p3[1] * p3[1]);
-      S2[2][2] += (p1[2] * p1[2] + p2[2] * p2[2] + p3[2] * p3[2]);
-      S2[0][1] += (p1[0] * p1[1] + p2[0] * p2[1] + p3[0] * p3[1]);
-      S2[0][2] += (p1[0] * p1[2] + p2[0] * p2[2] + p3[0] * p3[2]);
-      S2[1][2] += (p1[1] * p1[2] + p2[1] * p2[2] + p3[1] * p3[2]);
-
-      if(ps2)
+      Moments moments;
+      Vec3f& S1 = moments.S1;
+      Vec3f* S2 = moments.S2;
+      S1.setZero();
+      S2[0].setZero(); S2[1].setZero(); S2[2].setZero();
+
+      if(ts)
       {
-        const Vec3f& p1 = ps2[t[0]];
-        const Vec3f& p2 = ps2[t[1]];
-        const Vec3f& p3 = ps2[t[2]];
-
-        S1[0] += (p1[0] + p2[0] + p3[0]);
-        S1[1] += (p1[1] + p2[1] + p3[1]);
-        S1[2] += (p1[2] + p2[2] + p3[2]);
-
-        S2[0][0] += (p1[0] * p1[0] + p2[0] * p2[0] + p3[0] * p3[0]);
-        S2[1][1] += (p1[1] * p1[1] + p2[1] * p2[1] + p3[1] * p3[1]);
-        S2[2][2] += (p1[2] * p1[2] + p2[2] * p2[2] + p3[2] * p3[2]);
-        S2[0][1] += (p1[0] * p1[1] + p2[0] * p2[1] + p3[0] * p3[1]);
-        S2[0][2] += (p1[0] * p1[2] + p2[0] * p2[2] + p3[0] * p3[2]);
-        S2[1][2] += (p1[1] * p1[2] + p2[1] * p2[2] + p3[1] * p3[2]);
+        for(std::size_t i = begin; i < end; ++i)
+        {
+          const Triangle& t = (indices) ? ts[indices[i]] : ts[i];
+
+          const Vec3f& p1 = ps[t[0]];
+          const Vec3f& p2 = ps[t[1]];
+          const Vec3f& p3 = ps[t[2]];
+
+          S1[0] += (p1[0] + p2[0] + p3[0]);
+          S1[1] += (p1[1] + p2[1] + p3[1]);
+          S1[2] += (p1[2] + p2[2] + p3[2]);
+          S2[0][0] += (p1[0] * p1[0] + p2[0] * p2[0] + p3[0] * p3[0]);
+          S2[1][1] += (p1[1] * p1[1] + p2[1] * p2[1] + p3[1] * p3[1]);
+          S2[2][2] += (p1[2] * p1[2] + p2[2] * p2[2] + p3[2] * p3[2]);
+          S2[0][1] += (p1[0] * p1[1] + p2[0] * p2[1] + p3[0] * p3[1]);
+          S2[0][2] += (p1[0] * p1[2] + p2[0] * p2[2] + p3[0] * p3[2]);
+          S2[1][2] += (p1[1] * p1[2] + p2[1] * p2[2] + p3[1] * p3[2]);
+
+          if(ps2)
+          {
+            const Vec3f& p1 = ps2[t[0]];
+            const Vec3f& p2 = ps2[t[1]];
+            const Vec3f& p3 = ps2[t[2]];
+
+            S1[0] += (p1[0] + p2[0] + p3[0]);
+            S1[1] += (p1[1] + p2[1] + p3[1]);
+            S1[2] += (p1[2] + p2[2] + p3[2]);
+
+            S2[0][0] += (p1[0] * p1[0] + p2[0] * p2[0] + p3[0] * p3[0]);
+            S2[1][1] += (p1[1] * p1[1] + p2[1] * p2[1] + p3[1] * p3[1]);
+            S2[2][2] += (p1[2] * p1[2] + p2[2] * p2[2] + p3[2] * p3[2]);
+            S2[0][1] += (p1[0] * p1[1] + p2[0] * p2[1] + p3[0] * p3[1]);
+            S2[0][2] += (p1[0] * p1[2] + p2[0] * p2[2] + p3[0] * p3[2]);
+            S2[1][2] += (p1[1] * p1[2] + p2[1] * p2[2] + p3[1] * p3[2]);
+          }
+        }
       }
-    }
-  }
-  else
-  {
-    for(int i = 0; i < n; ++i)
-    {
-      const Vec3f& p = (indices) ? ps[indices[i]] : ps[i];
-      S1 += p;
-      S2[0][0] += (p[0] * p[0]);
-      S2[1][1] += (p[1] * p[1]);
-      S2[2][2] += (p[2] * p[2]);
-      S2[0][1] += (p[0] * p[1]);
-      S2[0][2] += (p[0] * p[2]);
-      S2[1][2] += (p[1] * p[2]);
-
-      if(ps2) // another frame
+      else
       {
-        const Vec3f& p = (indices) ? ps2[indices[i]] : ps2[i];
-        S1 += p;
-        S2[0][0] += (p[0] * p[0]);
-        S2[1][1] += (p[1] * p[1]);
-        S2[2][2] += (p[2] * p[2]);
-        S2[0][1] += (p[0] * p[1]);
-        S2[0][2] += (p[0] * p[2]);
-        S2[1][2] += (p[1] * p[2]);
+        for(std::size_t i = begin; i < end; ++i)
+        {
+          const Vec3f& p = (indices) ? ps[indices[i]] : ps[i];
+          S1 += p;
+          S2[0][0] += (p[0] * p[0]);
+          S2[1][1] += (p[1] * p[1]);
+          S2[2][2] += (p[2] * p[2]);
+          S2[0][1] += (p[0] * p[1]);
+          S2[0][2] += (p[0] * p[2]);
+          S2[1][2] += (p[1] * p[2]);
+
+          if(ps2) // another frame
+          {
+            const Vec3f& p = (indices) ? ps2[indices[i]] : ps2[i];
+            S1 += p;
+            S2[0][0] += (p[0] * p[0]);
+            S2[1][1] += (p[1] * p[1]);
+            S2[2][2] += (p[2] * p[2]);
+            S2[0][1] += (p[0] * p[1]);
+            S2[0][2] += (p[0] * p[2]);
+            S2[1][2] += (p[1] * p[2]);
+          }
+        }
       }
+
+      return moments;
     }
-  }
+
+    void merge(Moments& moments, const Moments& other) const
+    {
+      moments.S1 += other.S1;
+      for(int i = 0; i < 3; ++i)
+        moments.S2[i] += other.S2[i];
+    }
+
+    Vec3f* ps;
+    Vec3f* ps2;
+    Triangle* ts;
+    unsigned int* indices;
+  };
+}
+
+void getCovariance(Vec3f* ps, Vec3f* ps2, Triangle* ts, unsigned int* indices, int n, Matrix3f& M, ThreadPool* pool)
+{
+  Moments moments = reduce(MomentsReduction(ps, ps2, ts, indices),
+                           (std::size_t)n, primitivesPerChunk, pool);
+  const Vec3f& S1 = moments.S1;
+  const Vec3f* S2 = moments.S2;
 
   int n_points = ((ps2) ? 2 : 1) * ((ts) ? 3 : 1) * n;
 
@@ -218,78 +265,102 @@ void getCovariance(Vec3f* ps, Vec3f* ps2, Triangle* ts, unsigned int* indices, i
 }
 
 
-/** @brief Compute the RSS bounding volume parameters: radius, rectangle size and the origin.
- * The bounding volume axes are known.
- */
-void getRadiusAndOriginAndRectangleSize(Vec3f* ps, Vec3f* ps2, Triangle* ts, unsigned int* indices, int n, const Matrix3f& axes, Vec3f& origin, FCL_REAL l[2], FCL_REAL& r)
+namespace
 {
-  bool indirect_index = true;
-  if(!indices) indirect_index = false;
-
-  int size_P = ((ps2) ? 2 : 1) * ((ts) ? 3 : 1) * n;
-
-  FCL_REAL (*P)[3] = new FCL_REAL[size_P][3];
-
-  int P_id = 0;
-  
-  if(ts)
+  /// Projection of the points of primitives on the axes of a RSS
+  struct ProjectionTask : ThreadPool::Task
   {
-    for(int i = 0; i < n; ++i)
+    ProjectionTask(Vec3f* ps_, Vec3f* ps2_, Triangle* ts_,
+                   unsigned int* indices_, const Matrix3f& axes_,
+                   FCL_REAL (*P_)[3]) :
+      ps(ps_), ps2(ps2_), ts(ts_), indices(indices_), axes(axes_), P(P_)
+    {}
+
+    void run(std::size_t begin, std::size_t end, std::size_t)
     {
-      int index = indirect_index ? indices[i] : i;
-      const Triangle& t = ts[index];
+      std::size_t P_id = ((ps2) ? 2 : 1) * ((ts) ? 3 : 1) * begin;
 
-      for(int j = 0; j < 3; ++j)
+      if(ts)
       {
-        int point_id = (int) t[j];
-        const Vec3f& p = ps[point_id];
-        Vec3f v(p[0], p[1], p[2]);
-        P[P_id][0] = axes.col(0).dot(v);
-        P[P_id][1] = axes.col(1).dot(v);
-        P[P_id][2] = axes.col(2).dot(v);
-        P_id++;
+        for(std::size_t i = begin; i < end; ++i)
+        {
+          std::size_t index = indices ? indices[i] : i;
+          const Triangle& t = ts[index];
+
+          for(int j = 0; j < 3; ++j)
+          {
+            int point_id = (int) t[j];
+            const Vec3f& p = ps[point_id];
+            Vec3f v(p[0], p[1], p[2]);
+            P[P_id][0] = axes.col(0).dot(v);
+            P[P_id][1] = axes.col(1).dot(v);
+            P[P_id][2] = axes.col(2).dot(v);
+            P_id++;
+          }
+
+          if(ps2)
+          {
+            for(int j = 0; j < 3; ++j)
+            {
+              int point_id = (int) t[j];
+              const Vec3f& p = ps2[point_id];
+              // FIXME Is this right ?????
+              Vec3f v(p[0], p[1], p[2]);
+              P[P_id][0] = axes.col(0).dot(v);
+              P[P_id][1] = axes.col(0).dot(v);
+              P[P_id][2] = axes.col(1).dot(v);
+              P_id++;
+            }
+          }
+        }
       }
-
-      if(ps2)
+      else
       {
-        for(int j = 0; j < 3; ++j)
+        for(std::size_t i = begin; i < end; ++i)
         {
-          int point_id = (int) t[j];
-          const Vec3f& p = ps2[point_id];
-          // FIXME Is this right ?????
+          std::size_t index = indices ? indices[i] : i;
+
+          const Vec3f& p = ps[index];
           Vec3f v(p[0], p[1], p[2]);
           P[P_id][0] = axes.col(0).dot(v);
-          P[P_id][1] = axes.col(0).dot(v);
-          P[P_id][2] = axes.col(1).dot(v);
+          P[P_id][1] = axes.col(1).dot(v);
+          P[P_id][2] = axes.col(2).dot(v);
           P_id++;
+
+          if(ps2)
+          {
+            const Vec3f& v = ps2[index];
+            P[P_id][0] = axes.col(0).dot(v);
+            P[P_id][1] = axes.col(1).dot(v);
+            P[P_id][2] = axes.col(2).dot(v);
+            P_id++;
+          }
         }
       }
     }
-  }
-  else
-  {
-    for(int i = 0; i < n; ++i)
-    {
-      int index = indirect_index ? indices[i] : i;
 
-      const Vec3f& p = ps[index];
-      Vec3f v(p[0], p[1], p[2]);
-      P[P_id][0] = axes.col(0).dot(v);
-      P[P_id][1] = axes.col(1).dot(v);
-      P[P_id][2] = axes.col(2).dot(v);
-      P_id++;
+    Vec3f* ps;
+    Vec3f* ps2;
+    Triangle* ts;
+    unsigned int* indices;
+    const Matrix3f& axes;
+    FCL_REAL (*P)[3];
+  };
+}
+
+/** @brief Compute the RSS bounding volume parameters: radius, rectangle size and the origin.
+ * The bounding volume axes are known.
+ */
+void getRadiusAndOriginAndRectangleSize(Vec3f* ps, Vec3f* ps2, Triangle* ts, unsigned int* indices, int n, const Matrix3f& axes, Vec3f& origin, FCL_REAL l[2], FCL_REAL& r, ThreadPool* pool)
+{
+  int size_P = ((ps2) ? 2 : 1) * ((ts) ? 3 : 1) * n;
+
+  FCL_REAL (*P)[3] = new FCL_REAL[size_P][3];
+
+  ProjectionTask task(ps, ps2, ts, indices, axes, P);
+  if(pool) pool->parallelFor(n, task, primitivesPerChunk);
+  else task.run(0, n, 0);
 
-      if(ps2)
-      {
-        const Vec3f& v = ps2[index];
-        P[P_id][0] = axes.col(0).dot(v);
-        P[P_id][1] = axes.col(1).dot(v);
-        P[P_id][2] = axes.col(2).dot(v);
-        P_id++;
-      }
-    }
-  }
-    
   FCL_REAL minx, maxx, miny, maxy, minz, maxz;
 
   FCL_REAL cz, radsqr;
@@ -499,113 +570,143 @@ void getRadiusAndOriginAndRectangleSize(Vec3f* ps, Vec3f* ps2, Triangle* ts, uns
 }
 
 
-/** @brief Compute the bounding volume extent and center for a set or subset of points.
- * The bounding volume axes are known.
- */
-static inline void getExtentAndCenter_pointcloud(Vec3f* ps, Vec3f* ps2, unsigned int* indices, int n, Matrix3f& axes, Vec3f& center, Vec3f& extent)
+namespace
 {
-  bool indirect_index = true;
-  if(!indices) indirect_index = false;
-
-  FCL_REAL real_max = std::numeric_limits<FCL_REAL>::max();
-
-  Vec3f min_coord (real_max, real_max, real_max);
-  Vec3f max_coord (-real_max, -real_max, -real_max);
-
-  for(int i = 0; i < n; ++i)
+  /// Bounds of the projections of points on axes
+  struct Bounds
   {
-    int index = indirect_index ? indices[i] : i;
+    Vec3f min_coord, max_coord;
+  };
 
-    const Vec3f& p = ps[index];
-    Vec3f proj (axes.transpose() * p);
+  /// Reduction of primitives to the bounds of the projections of their points
+  struct BoundsReduction
+  {
+    typedef Bounds Result;
 
-    for(int j = 0; j < 3; ++j)
-    {
-      if(proj[j] > max_coord[j]) max_coord[j] = proj[j];
-      if(proj[j] < min_coord[j]) min_coord[j] = proj[j];
-    }
+    BoundsReduction(Vec3f* ps_, Vec3f* ps2_, Triangle* ts_,
+                    unsigned int* indices_, const Matrix3f& axes_) :
+      ps(ps_), ps2(ps2_), ts(ts_), indices(indices_), axes(axes_)
+    {}
 
-    if(ps2)
+    void add(Bounds& bounds, const Vec3f& p) const
     {
-      const Vec3f& v = ps2[index];
-      proj.noalias() = axes.transpose() * v;
+      Vec3f proj(axes.transpose() * p);
 
-      for(int j = 0; j < 3; ++j)
+      for(int k = 0; k < 3; ++k)
       {
-        if(proj[j] > max_coord[j]) max_coord[j] = proj[j];
-        if(proj[j] < min_coord[j]) min_coord[j] = proj[j];
+        if(proj[k] > bounds.max_coord[k]) bounds.max_coord[k] = proj[k];
+        if(proj[k] < bounds.min_coord[k]) bounds.min_coord[k] = proj[k];
       }
     }
-  }
 
-  center.noalias() = axes * (max_coord + min_coord) / 2;
+    Bounds operator()(std::size_t begin, std::size_t end) const
+    {
+      FCL_REAL real_max = std::numeric_limits<FCL_REAL>::max();
 
-  extent.noalias() = (max_coord - min_coord) / 2;
-}
+      Bounds bounds;
+      bounds.min_coord.setConstant(real_max);
+      bounds.max_coord.setConstant(-real_max);
 
+      for(std::size_t i = begin; i < end; ++i)
+      {
+        std::size_t index = indices ? indices[i] : i;
+        if(ts)
+        {
+          const Triangle& t = ts[index];
+          for(int j = 0; j < 3; ++j)
+          {
+            add(bounds, ps[t[j]]);
+            if(ps2) add(bounds, ps2[t[j]]);
+          }
+        }
+        else
+        {
+          add(bounds, ps[index]);
+          if(ps2) add(bounds, ps2[index]);
+        }
+      }
 
-/** @brief Compute the bounding volume extent and center for a set or subset of points.
- * The bounding volume axes are known.
- */
-static inline void getExtentAndCenter_mesh(Vec3f* ps, Vec3f* ps2, Triangle* ts, unsigned int* indices, int n, Matrix3f& axes, Vec3f& center, Vec3f& extent)
-{
-  bool indirect_index = true;
-  if(!indices) indirect_index = false;
+      return bounds;
+    }
 
-  FCL_REAL real_max = std::numeric_limits<FCL_REAL>::max();
+    void merge(Bounds& bounds, const Bounds& other) const
+    {
+      bounds.min_coord = bounds.min_coord.cwiseMin(other.min_coord);
+      bounds.max_coord = bounds.max_coord.cwiseMax(other.max_coord);
+    }
 
-  Vec3f min_coord (real_max, real_max, real_max);
-  Vec3f max_coord (-real_max, -real_max, -real_max);
+    Vec3f* ps;
+    Vec3f* ps2;
+    Triangle* ts;
+    unsigned int* indices;
+    const Matrix3f& axes;
+  };
 
-  for(int i = 0; i < n; ++i)
+  /// Reduction of primitives to the maximum squared distance of their points
+  /// to a query point
+  struct DistanceReduction
   {
-    unsigned int index = indirect_index? indices[i] : i;
-    const Triangle& t = ts[index];
+    typedef FCL_REAL Result;
 
-    for(int j = 0; j < 3; ++j)
-    {
-      int point_id = (int) t[j];
-      const Vec3f& p = ps[point_id];
-      Vec3f proj(axes.transpose() * p);
+    DistanceReduction(Vec3f* ps_, Vec3f* ps2_, Triangle* ts_,
+                      unsigned int* indices_, const Vec3f& query_) :
+      ps(ps_), ps2(ps2_), ts(ts_), indices(indices_), query(query_)
+    {}
 
-      for(int k = 0; k < 3; ++k)
-      {
-        if(proj[k] > max_coord[k]) max_coord[k] = proj[k];
-        if(proj[k] < min_coord[k]) min_coord[k] = proj[k];
-      }
+    void add(FCL_REAL& maxD, const Vec3f& p) const
+    {
+      FCL_REAL d = (p - query).squaredNorm();
+      if(d > maxD) maxD = d;
     }
 
-    if(ps2)
+    FCL_REAL operator()(std::size_t begin, std::size_t end) const
     {
-      for(int j = 0; j < 3; ++j)
+      FCL_REAL maxD = 0;
+      for(std::size_t i = begin; i < end; ++i)
       {
-        int point_id = (int) t[j];
-        const Vec3f& p = ps2[point_id];
-        Vec3f proj(axes.transpose() * p);
-
-        for(int k = 0; k < 3; ++k)
+        std::size_t index = indices ? indices[i] : i;
+        if(ts)
+        {
+          const Triangle& t = ts[index];
+          for(int j = 0; j < 3; ++j)
+          {
+            add(maxD, ps[t[j]]);
+            if(ps2) add(maxD, ps2[t[j]]);
+          }
+        }
+        else
         {
-          if(proj[k] > max_coord[k]) max_coord[k] = proj[k];
-          if(proj[k] < min_coord[k]) min_coord[k] = proj[k];
+          add(maxD, ps[index]);
+          if(ps2) add(maxD, ps2[index]);
         }
       }
-    }
-  }
 
-  Vec3f o((max_coord + min_coord) / 2);
-
-  center.noalias() = axes * o;
+      return maxD;
+    }
 
-  extent.noalias() = (max_coord - min_coord) / 2;
+    void merge(FCL_REAL& maxD, const FCL_REAL& other) const
+    {
+      if(other > maxD) maxD = other;
+    }
 
+    Vec3f* ps;
+    Vec3f* ps2;
+    Triangle* ts;
+    unsigned int* indices;
+    const Vec3f& query;
+  };
 }
 
-void getExtentAndCenter(Vec3f* ps, Vec3f* ps2, Triangle* ts, unsigned int* indices, int n, Matrix3f& axes, Vec3f& center, Vec3f& extent)
+void getExtentAndCenter(Vec3f* ps, Vec3f* ps2, Triangle* ts, unsigned int* indices, int n, Matrix3f& axes, Vec3f& center, Vec3f& extent, ThreadPool* pool)
 {
-  if(ts)
-    getExtentAndCenter_mesh(ps, ps2, ts, indices, n, axes, center, extent);
-  else
-    getExtentAndCenter_pointcloud(ps, ps2, indices, n, axes, center, extent);
+  Bounds bounds = reduce(BoundsReduction(ps, ps2, ts, indices, axes),
+                         (std::size_t)n, primitivesPerChunk, pool);
+
+  Vec3f o((bounds.max_coord + bounds.min_coord) / 2);
+
+  center.noalias() = axes * o;
+
+  extent.noalias() = (bounds.max_coord - bounds.min_coord) / 2;
 }
 
 void circumCircleComputation(const Vec3f& a, const Vec3f& b, const Vec3f& c, Vec3f& center, FCL_REAL& radius)
@@ -623,73 +724,10 @@ void circumCircleComputation(const Vec3f& a, const Vec3f& b, const Vec3f& c, Vec
 }
 
 
-static inline FCL_REAL maximumDistance_mesh(Vec3f* ps, Vec3f* ps2, Triangle* ts, unsigned int* indices, int n, const Vec3f& query)
-{
-  bool indirect_index = true;
-  if(!indices) indirect_index = false;
-  
-  FCL_REAL maxD = 0;
-  for(int i = 0; i < n; ++i)
-  {
-    unsigned int index = indirect_index ? indices[i] : i;
-    const Triangle& t = ts[index];
-
-    for(int j = 0; j < 3; ++j)
-    {
-      int point_id = (int) t[j];
-      const Vec3f& p = ps[point_id];
-      
-      FCL_REAL d = (p - query).squaredNorm();
-      if(d > maxD) maxD = d;
-    }
-
-    if(ps2)
-    {
-      for(int j = 0; j < 3; ++j)
-      {
-        int point_id = (int) t[j];
-        const Vec3f& p = ps2[point_id];
-        
-        FCL_REAL d = (p - query).squaredNorm();
-        if(d > maxD) maxD = d;
-      }
-    }
-  }
-
-  return std::sqrt(maxD);
-}
-
-static inline FCL_REAL maximumDistance_pointcloud(Vec3f* ps, Vec3f* ps2, unsigned int* indices, int n, const Vec3f& query)
-{
-  bool indirect_index = true;
-  if(!indices) indirect_index = false;
-
-  FCL_REAL maxD = 0;
-  for(int i = 0; i < n; ++i)
-  {
-    int index = indirect_index ? indices[i] : i;
-
-    const Vec3f& p = ps[index];
-    FCL_REAL d = (p - query).squaredNorm();
-    if(d > maxD) maxD = d;
-
-    if(ps2)
-    {
-      const Vec3f& v = ps2[index];
-      FCL_REAL d = (v - query).squaredNorm();
-      if(d > maxD) maxD = d;
-    }
-  }
-
-  return std::sqrt(maxD);
-}
-
-FCL_REAL maximumDistance(Vec3f* ps, Vec3f* ps2, Triangle* ts, unsigned int* indices, int n, const Vec3f& query)
+FCL_REAL maximumDistance(Vec3f* ps, Vec3f* ps2, Triangle* ts, unsigned int* indices, int n, const Vec3f& query, ThreadPool* pool)
 {
-  if(ts)
-    return maximumDistance_mesh(ps, ps2, ts, indices, n, query);
-  else
-    return maximumDistance_pointcloud(ps, ps2, indices, n, query);
+  return std::sqrt(reduce(DistanceReduction(ps, ps2, ts, indices, query),
+                          (std::size_t)n, primitivesPerChunk, pool));
 }
 
 
@@ -0,0 +1,383 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <hpp/fcl/BVH/BVH_wide.h>
+
+#include <limits>
+#include <hpp/fcl/BV/float_BV.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/narrowphase/narrowphase.h>
+
+#include "../traversal/traversal_node_setup.h"
+
+namespace hpp
+{
+namespace fcl
+{
+
+WideBVH::Node::Node()
+{
+  for(int i = 0; i < 3; ++i)
+  {
+    min_[i].setZero();
+    max_[i].setZero();
+  }
+  for(int i = 0; i < 4; ++i)
+    children[i] = 0;
+}
+
+WideBVH::WideBVH(const BVHModel<AABB>& model) : model_(model)
+{
+  if(model.getNumBVs() > 0)
+    build(0);
+}
+
+int WideBVH::build(int bv_id)
+{
+  int id = (int)nodes_.size();
+  nodes_.push_back(Node());
+
+  // Replace the largest internal child by its children until there are 4.
+  int bvs[4] = { bv_id, 0, 0, 0 };
+  int n = 1;
+  if(!model_.getBV(bv_id).isLeaf())
+  {
+    bvs[0] = model_.getBV(bv_id).leftChild();
+    bvs[1] = model_.getBV(bv_id).rightChild();
+    n = 2;
+  }
+  while(n < 4)
+  {
+    int largest = -1;
+    FCL_REAL size = -1;
+    for(int i = 0; i < n; ++i)
+    {
+      const BVNode<AABB>& node = model_.getBV(bvs[i]);
+      if(!node.isLeaf() && node.bv.size() > size)
+      {
+        largest = i;
+        size = node.bv.size();
+      }
+    }
+    if(largest < 0) break;
+    const BVNode<AABB>& node = model_.getBV(bvs[largest]);
+    bvs[largest] = node.leftChild();
+    bvs[n++] = node.rightChild();
+  }
+
+  int children[4] = { 0, 0, 0, 0 };
+  for(int i = 0; i < n; ++i)
+  {
+    if(model_.getBV(bvs[i]).isLeaf())
+      children[i] = -(bvs[i] + 1);
+    else
+      children[i] = build(bvs[i]);
+  }
+
+  // nodes_ may have been reallocated by the recursive calls.
+  Node& node = nodes_[id];
+  for(int i = 0; i < n; ++i)
+  {
+    node.children[i] = children[i];
+    FloatAABB bv(model_.getBV(bvs[i]).bv);
+    for(int j = 0; j < 3; ++j)
+    {
+      node.min_[j][i] = bv.min_[j];
+      node.max_[j][i] = bv.max_[j];
+    }
+  }
+  return id;
+}
+
+namespace
+{
+  typedef WideBVH::Lanes Lanes;
+  typedef FloatAABB::Vector Vector;
+  typedef Eigen::Matrix<float, 3, 3> Matrix;
+  const float eps = std::numeric_limits<float>::epsilon();
+
+  /// Squared lower bounds of the distance between the children of node and
+  /// bv, computed on the 4 lanes at once.
+  inline Lanes sqrDistances(const WideBVH::Node& node, const FloatAABB& bv)
+  {
+    Lanes sqrDist (Lanes::Zero());
+    for(int i = 0; i < 3; ++i)
+    {
+      Lanes gap ((node.min_[i] - bv.max_[i])
+                 .max(bv.min_[i] - node.max_[i]).max(0));
+      sqrDist += gap * gap;
+    }
+    // The gaps, their squares and their sum are rounded by eps / 2
+    // relatively at each operation.
+    return sqrDist * (1 - 4 * eps);
+  }
+
+  /// Squared lower bounds of the distance between the children of node and
+  /// bv moved by (R, T) in the frame of node. The children are separated from
+  /// the moved box along the axes of both, the cross products of the axes
+  /// are not tested.
+  inline Lanes sqrDistances(const WideBVH::Node& node, const FloatAABB& bv,
+                            const Matrix& R, const Vector& T)
+  {
+    const Vector center (R * ((bv.min_ + bv.max_) / 2) + T),
+                 half ((bv.max_ - bv.min_) / 2),
+                 aabb_half (R.cwiseAbs() * half);
+    // The gaps are reduced by a bound of the rounding errors, which are
+    // relative to the magnitude of the values.
+    Lanes scale (Lanes::Constant(bv.min_.cwiseAbs().cwiseMax(
+            bv.max_.cwiseAbs()).sum() + T.cwiseAbs().sum()));
+    for(int i = 0; i < 3; ++i)
+      scale += node.min_[i].abs().max(node.max_[i].abs());
+    const Lanes tol ((16 * eps) * scale);
+
+    Lanes sqrDist (Lanes::Zero());
+    Lanes c[3], h[3];
+    for(int i = 0; i < 3; ++i)
+    {
+      const Lanes& lo = node.min_[i];
+      const Lanes& hi = node.max_[i];
+      Lanes gap (((lo - (center[i] + aabb_half[i]))
+                  .max((center[i] - aabb_half[i]) - hi) - tol).max(0));
+      sqrDist += gap * gap;
+      c[i] = (lo + hi) / 2 - center[i];
+      h[i] = (hi - lo) / 2;
+    }
+    for(int k = 0; k < 3; ++k)
+    {
+      const float u0 = R(0, k), u1 = R(1, k), u2 = R(2, k);
+      Lanes gap (((u0 * c[0] + u1 * c[1] + u2 * c[2]).abs()
+                  - std::abs(u0) * h[0] - std::abs(u1) * h[1]
+                  - std::abs(u2) * h[2] - half[k] - tol).max(0));
+      sqrDist = sqrDist.max(gap * gap);
+    }
+    return sqrDist * (1 - 4 * eps);
+  }
+
+  /// Set bv to the AABB of the child c of node
+  inline void childBV(const WideBVH::Node& node, int c, FloatAABB& bv)
+  {
+    for(int i = 0; i < 3; ++i)
+    {
+      bv.min_[i] = node.min_[i][c];
+      bv.max_[i] = node.max_[i][c];
+    }
+  }
+
+  template<typename S>
+  std::size_t wideMeshShapeCollide(const WideBVH& mesh, const Transform3f& tf1,
+                                   const CollisionGeometry* o2,
+                                   const Transform3f& tf2,
+                                   const CollisionRequest& request,
+                                   CollisionResult& result)
+  {
+    const S& shape = static_cast<const S&>(*o2);
+    GJKSolver solver;
+    MeshShapeCollisionTraversalNode<AABB, S, 0> node (request);
+    if(!initialize(node, mesh.getModel(), tf1, shape, tf2, &solver, result))
+      return 0;
+
+    AABB bv;
+    computeBV(shape, tf1.inverseTimes(tf2), bv);
+    const FloatAABB query (bv);
+    const FCL_REAL breakDistance (request.break_distance +
+                                  request.security_margin);
+    const FCL_REAL breakDistance2 = breakDistance * breakDistance;
+
+    FCL_REAL sqrDistLowerBound = std::numeric_limits<FCL_REAL>::infinity();
+    FCL_REAL sdlb = sqrDistLowerBound;
+    std::vector<int> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+    while(!stack.empty())
+    {
+      const WideBVH::Node& n = mesh.getNode((std::size_t)stack.back());
+      stack.pop_back();
+
+      Lanes sqrDist (sqrDistances(n, query));
+      for(int c = 3; c >= 0; --c)
+      {
+        if(n.children[c] == 0) continue;
+        if(sqrDist[c] > breakDistance2)
+        {
+          if(sqrDist[c] < sqrDistLowerBound) sqrDistLowerBound = sqrDist[c];
+          continue;
+        }
+        if(n.children[c] > 0)
+        {
+          stack.push_back(n.children[c]);
+          continue;
+        }
+        node.leafCollides(-(n.children[c] + 1), 0, sdlb);
+        if(sdlb < sqrDistLowerBound) sqrDistLowerBound = sdlb;
+        if(node.canStop())
+        {
+          stack.clear();
+          break;
+        }
+      }
+    }
+    result.distance_lower_bound = result.isCollision() ? 0 :
+      sqrt(sqrDistLowerBound);
+    return result.numContacts();
+  }
+
+  /// A pair of subtrees whose bounding volumes overlap, each AABB being
+  /// expressed in the frame of its mesh. Subtrees are encoded as
+  /// WideBVH::Node::children.
+  struct SubtreePair
+  {
+    int a, b;
+    FloatAABB bv_a, bv_b;
+
+    SubtreePair(const AABB& bv1, const AABB& bv2)
+      : a(0), b(0), bv_a(bv1), bv_b(bv2) {}
+  };
+}
+
+std::size_t collide(const WideBVH& mesh, const Transform3f& tf1,
+                    const CollisionGeometry* shape, const Transform3f& tf2,
+                    const CollisionRequest& request, CollisionResult& result)
+{
+  if(request.isSatisfied(result)) return result.numContacts();
+  if(mesh.getNumNodes() == 0) return 0;
+
+  switch(shape->getNodeType())
+  {
+    case GEOM_BOX:
+      return wideMeshShapeCollide<Box>(mesh, tf1, shape, tf2, request, result);
+    case GEOM_SPHERE:
+      return wideMeshShapeCollide<Sphere>(mesh, tf1, shape, tf2, request,
+                                          result);
+    case GEOM_CAPSULE:
+      return wideMeshShapeCollide<Capsule>(mesh, tf1, shape, tf2, request,
+                                           result);
+    case GEOM_CONE:
+      return wideMeshShapeCollide<Cone>(mesh, tf1, shape, tf2, request, result);
+    case GEOM_CYLINDER:
+      return wideMeshShapeCollide<Cylinder>(mesh, tf1, shape, tf2, request,
+                                            result);
+    case GEOM_CONVEX:
+      return wideMeshShapeCollide<ConvexBase>(mesh, tf1, shape, tf2, request,
+                                              result);
+    case GEOM_PLANE:
+      return wideMeshShapeCollide<Plane>(mesh, tf1, shape, tf2, request,
+                                         result);
+    case GEOM_HALFSPACE:
+      return wideMeshShapeCollide<Halfspace>(mesh, tf1, shape, tf2, request,
+                                             result);
+    default:
+      std::cerr << "Warning: collision function between a wide BVH and node type "
+                << shape->getNodeType() << " is not supported" << std::endl;
+      return 0;
+  }
+}
+
+std::size_t collide(const WideBVH& mesh1, const Transform3f& tf1,
+                    const WideBVH& mesh2, const Transform3f& tf2,
+                    const CollisionRequest& request, CollisionResult& result)
+{
+  if(request.isSatisfied(result)) return result.numContacts();
+  if(mesh1.getNumNodes() == 0 || mesh2.getNumNodes() == 0) return 0;
+
+  MeshCollisionTraversalNode<AABB, 0> node (request);
+  if(!initialize(node, mesh1.getModel(), tf1, mesh2.getModel(), tf2, result))
+    return 0;
+  // (R, T) moves the second mesh in the frame of the first one.
+  const Matrix3f& R = node.RT._R();
+  const Vec3f& T = node.RT._T();
+  // (Rt, Tt) moves the first mesh in the frame of the second one.
+  const Matrix Rf (R.cast<float>()), Rt (R.transpose().cast<float>());
+  const Vector Tf (T.cast<float>()), Tt ((-R.transpose() * T).cast<float>());
+
+  const FCL_REAL breakDistance (request.break_distance +
+                                request.security_margin);
+  const FCL_REAL breakDistance2 = breakDistance * breakDistance;
+
+  FCL_REAL sqrDistLowerBound = std::numeric_limits<FCL_REAL>::infinity();
+  FCL_REAL sdlb = sqrDistLowerBound;
+  std::vector<SubtreePair> stack;
+  stack.reserve(64);
+  stack.push_back(SubtreePair(mesh1.getModel().getBV(0).bv,
+                              mesh2.getModel().getBV(0).bv));
+  while(!stack.empty())
+  {
+    SubtreePair pair (stack.back());
+    stack.pop_back();
+
+    if(pair.a < 0 && pair.b < 0)
+    {
+      node.leafCollides(-(pair.a + 1), -(pair.b + 1), sdlb);
+      if(sdlb < sqrDistLowerBound) sqrDistLowerBound = sdlb;
+      if(node.canStop()) break;
+      continue;
+    }
+
+    // Test the children of the largest subtree against the other one.
+    bool first = pair.b < 0 ||
+      (pair.a >= 0 && pair.bv_a.size() > pair.bv_b.size());
+    const WideBVH::Node& n = first ? mesh1.getNode((std::size_t)pair.a)
+                                   : mesh2.getNode((std::size_t)pair.b);
+    Lanes sqrDist (first ? sqrDistances(n, pair.bv_b, Rf, Tf)
+                         : sqrDistances(n, pair.bv_a, Rt, Tt));
+    for(int c = 3; c >= 0; --c)
+    {
+      if(n.children[c] == 0) continue;
+      if(sqrDist[c] > breakDistance2)
+      {
+        if(sqrDist[c] < sqrDistLowerBound) sqrDistLowerBound = sqrDist[c];
+        continue;
+      }
+      SubtreePair child (pair);
+      if(first)
+      {
+        child.a = n.children[c];
+        childBV(n, c, child.bv_a);
+      }
+      else
+      {
+        child.b = n.children[c];
+        childBV(n, c, child.bv_b);
+      }
+      stack.push_back(child);
+    }
+  }
+  result.distance_lower_bound = result.isCollision() ? 0 :
+    sqrt(sqrDistLowerBound);
+  return result.numContacts();
+}
+
+}
+
+} // namespace hpp
@@ -502,7 +502,7 @@ void fit(Vec3f* ps, int n, AABB& bv)
   }
 }
 
-OBB BVFitter<OBB>::fit(unsigned int* primitive_indices, int num_primitives)
+OBB BVFitter<OBB>::fit(unsigned int* primitive_indices, int num_primitives, ThreadPool* pool)
 {
   OBB bv;
 
@@ -510,36 +510,36 @@ OBB BVFitter<OBB>::fit(unsigned int* primitive_indices, int num_primitives)
   Vec3f E[3]; // row first eigen-vectors
   Matrix3f::Scalar s[3]; // three eigen values
 
-  getCovariance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, M);
+  getCovariance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, M, pool);
   eigen(M, s, E);
 
   axisFromEigen(E, s, bv.axes);
 
   // set obb centers and extensions
-  getExtentAndCenter(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.axes, bv.To, bv.extent);
+  getExtentAndCenter(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.axes, bv.To, bv.extent, pool);
 
   return bv;
 }
 
-OBBRSS BVFitter<OBBRSS>::fit(unsigned int* primitive_indices, int num_primitives)
+OBBRSS BVFitter<OBBRSS>::fit(unsigned int* primitive_indices, int num_primitives, ThreadPool* pool)
 {
   OBBRSS bv;
   Matrix3f M;
   Vec3f E[3];
   Matrix3f::Scalar s[3];
 
-  getCovariance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, M);
+  getCovariance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, M, pool);
   eigen(M, s, E);
 
   axisFromEigen(E, s, bv.obb.axes);
   bv.rss.axes.noalias() = bv.obb.axes;
 
-  getExtentAndCenter(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.obb.axes, bv.obb.To, bv.obb.extent);
+  getExtentAndCenter(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.obb.axes, bv.obb.To, bv.obb.extent, pool);
 
   Vec3f origin;
   FCL_REAL l[2];
   FCL_REAL r;
-  getRadiusAndOriginAndRectangleSize(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.rss.axes, origin, l, r);
+  getRadiusAndOriginAndRectangleSize(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.rss.axes, origin, l, r, pool);
 
   bv.rss.Tr = origin;
   bv.rss.length[0] = l[0];
@@ -549,14 +549,14 @@ OBBRSS BVFitter<OBBRSS>::fit(unsigned int* primitive_indices, int num_primitives
   return bv;
 }
 
-RSS BVFitter<RSS>::fit(unsigned int* primitive_indices, int num_primitives)
+RSS BVFitter<RSS>::fit(unsigned int* primitive_indices, int num_primitives, ThreadPool* pool)
 {
   RSS bv;
 
   Matrix3f M; // row first matrix
   Vec3f E[3]; // row first eigen-vectors
   Matrix3f::Scalar s[3]; // three eigen values
-  getCovariance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, M);
+  getCovariance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, M, pool);
   eigen(M, s, E);
   axisFromEigen(E, s, bv.axes);
 
@@ -565,7 +565,7 @@ RSS BVFitter<RSS>::fit(unsigned int* primitive_indices, int num_primitives)
   Vec3f origin;
   FCL_REAL l[2];
   FCL_REAL r;
-  getRadiusAndOriginAndRectangleSize(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.axes, origin, l, r);
+  getRadiusAndOriginAndRectangleSize(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.axes, origin, l, r, pool);
 
   bv.Tr = origin;
   bv.length[0] = l[0];
@@ -576,7 +576,7 @@ RSS BVFitter<RSS>::fit(unsigned int* primitive_indices, int num_primitives)
   return bv;
 }
 
-kIOS BVFitter<kIOS>::fit(unsigned int* primitive_indices, int num_primitives)
+kIOS BVFitter<kIOS>::fit(unsigned int* primitive_indices, int num_primitives, ThreadPool* pool)
 {
   kIOS bv;
 
@@ -584,18 +584,18 @@ kIOS BVFitter<kIOS>::fit(unsigned int* primitive_indices, int num_primitives)
   Vec3f E[3]; // row first eigen-vectors
   Matrix3f::Scalar s[3];
   
-  getCovariance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, M);
+  getCovariance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, M, pool);
   eigen(M, s, E);
 
   Matrix3f& axes = bv.obb.axes;
   axisFromEigen(E, s, axes);
 
   // get centers and extensions
-  getExtentAndCenter(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, axes, bv.obb.To, bv.obb.extent);
+  getExtentAndCenter(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, axes, bv.obb.To, bv.obb.extent, pool);
 
   const Vec3f& center = bv.obb.To;
   const Vec3f& extent = bv.obb.extent;
-  FCL_REAL r0 = maximumDistance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, center);
+  FCL_REAL r0 = maximumDistance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, center, pool);
 
   // decide k in kIOS
   if(extent[0] > kIOS_RATIO * extent[2])
@@ -615,8 +615,8 @@ kIOS BVFitter<kIOS>::fit(unsigned int* primitive_indices, int num_primitives)
     bv.spheres[1].o = center - delta;
     bv.spheres[2].o = center + delta;
 
-    FCL_REAL r11 = maximumDistance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.spheres[1].o);
-    FCL_REAL r12 = maximumDistance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.spheres[2].o);
+    FCL_REAL r11 = maximumDistance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.spheres[1].o, pool);
+    FCL_REAL r12 = maximumDistance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.spheres[2].o, pool);
 
     bv.spheres[1].o += axes.col(2) * (-r10 + r11);
     bv.spheres[2].o += axes.col(2) * (r10 - r12);
@@ -633,8 +633,8 @@ kIOS BVFitter<kIOS>::fit(unsigned int* primitive_indices, int num_primitives)
     bv.spheres[4].o = bv.spheres[0].o + delta;
     
     FCL_REAL r21 = 0, r22 = 0;
-    r21 = maximumDistance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.spheres[3].o);
-    r22 = maximumDistance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.spheres[4].o);
+    r21 = maximumDistance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.spheres[3].o, pool);
+    r22 = maximumDistance(vertices, prev_vertices, tri_indices, primitive_indices, num_primitives, bv.spheres[4].o, pool);
 
     bv.spheres[3].o += axes.col(1) * (-r10 + r21);
     bv.spheres[4].o += axes.col(1) * (r10 - r22);
@@ -688,6 +688,12 @@ AABB BVFitter<AABB>::fit(unsigned int* primitive_indices, int num_primitives)
   return bv;
 }
 
+AABB BVFitter<AABB>::fit(unsigned int* primitive_indices, int num_primitives, ThreadPool* pool)
+{
+  return reduce(details::UnionReduction<AABB>(*this, primitive_indices),
+                (std::size_t)num_primitives, primitivesPerChunk, pool);
+}
+
 }
 
 } // namespace hpp
@@ -39,6 +39,8 @@
 #define HPP_FCL_BV_FITTER_H
 
 #include <hpp/fcl/BVH/BVH_internal.h>
+#include <hpp/fcl/BVH/BVH_utility.h>
+#include <hpp/fcl/thread_pool.h>
 #include <hpp/fcl/BV/kIOS.h>
 #include <hpp/fcl/BV/OBBRSS.h>
 #include <hpp/fcl/BV/AABB.h>
@@ -164,6 +166,10 @@ public:
     return bv;
   }
 
+  /// @brief Same as fit, the primitives being processed in parallel by the
+  ///        threads of pool if it is not NULL.
+  BV fit(unsigned int* primitive_indices, int num_primitives, ThreadPool* pool);
+
 protected:
   using BVFitterTpl<BV>::vertices;
   using BVFitterTpl<BV>::prev_vertices;
@@ -178,7 +184,14 @@ class BVFitter<OBB> : public BVFitterTpl<OBB>
 public:
   /// @brief Compute a bounding volume that fits a set of primitives (points or triangles).
   /// The primitive data was set by set function and primitive_indices is the primitive index relative to the data.
-  OBB fit(unsigned int* primitive_indices, int num_primitives);
+  OBB fit(unsigned int* primitive_indices, int num_primitives)
+  {
+    return fit(primitive_indices, num_primitives, NULL);
+  }
+
+  /// @brief Same as fit, the primitives being processed in parallel by the
+  ///        threads of pool if it is not NULL.
+  OBB fit(unsigned int* primitive_indices, int num_primitives, ThreadPool* pool);
 };
 
 /// @brief Specification of BVFitter for RSS bounding volume
@@ -188,7 +201,14 @@ class BVFitter<RSS> : public BVFitterTpl<RSS>
 public:
   /// @brief Compute a bounding volume that fits a set of primitives (points or triangles).
   /// The primitive data was set by set function and primitive_indices is the primitive index relative to the data.
-  RSS fit(unsigned int* primitive_indices, int num_primitives);
+  RSS fit(unsigned int* primitive_indices, int num_primitives)
+  {
+    return fit(primitive_indices, num_primitives, NULL);
+  }
+
+  /// @brief Same as fit, the primitives being processed in parallel by the
+  ///        threads of pool if it is not NULL.
+  RSS fit(unsigned int* primitive_indices, int num_primitives, ThreadPool* pool);
 };
 
 /// @brief Specification of BVFitter for kIOS bounding volume
@@ -198,7 +218,14 @@ class BVFitter<kIOS> : public BVFitterTpl<kIOS>
 public:
   /// @brief Compute a bounding volume that fits a set of primitives (points or triangles).
   /// The primitive data was set by set function and primitive_indices is the primitive index relative to the data.
-  kIOS fit(unsigned int* primitive_indices, int num_primitives);
+  kIOS fit(unsigned int* primitive_indices, int num_primitives)
+  {
+    return fit(primitive_indices, num_primitives, NULL);
+  }
+
+  /// @brief Same as fit, the primitives being processed in parallel by the
+  ///        threads of pool if it is not NULL.
+  kIOS fit(unsigned int* primitive_indices, int num_primitives, ThreadPool* pool);
 };
 
 /// @brief Specification of BVFitter for OBBRSS bounding volume
@@ -208,7 +235,14 @@ class BVFitter<OBBRSS> : public BVFitterTpl<OBBRSS>
 public:
   /// @brief Compute a bounding volume that fits a set of primitives (points or triangles).
   /// The primitive data was set by set function and primitive_indices is the primitive index relative to the data.
-  OBBRSS fit(unsigned int* primitive_indices, int num_primitives);
+  OBBRSS fit(unsigned int* primitive_indices, int num_primitives)
+  {
+    return fit(primitive_indices, num_primitives, NULL);
+  }
+
+  /// @brief Same as fit, the primitives being processed in parallel by the
+  ///        threads of pool if it is not NULL.
+  OBBRSS fit(unsigned int* primitive_indices, int num_primitives, ThreadPool* pool);
 };
 
 /// @brief Specification of BVFitter for AABB bounding volume
@@ -219,7 +253,47 @@ public:
   /// @brief Compute a bounding volume that fits a set of primitives (points or triangles).
   /// The primitive data was set by set function and primitive_indices is the primitive index relative to the data.
   AABB fit(unsigned int* primitive_indices, int num_primitives);
+
+  /// @brief Same as fit, the primitives being processed in parallel by the
+  ///        threads of pool if it is not NULL.
+  AABB fit(unsigned int* primitive_indices, int num_primitives, ThreadPool* pool);
+};
+
+namespace details
+{
+/// @brief Reduction of primitives to the union of the bounding volumes fitted
+///        to chunks of primitives
+template<typename BV>
+struct UnionReduction
+{
+  typedef BV Result;
+
+  UnionReduction(BVFitter<BV>& fitter_, unsigned int* primitive_indices_) :
+    fitter(fitter_), primitive_indices(primitive_indices_)
+  {}
+
+  BV operator()(std::size_t begin, std::size_t end) const
+  {
+    return fitter.fit(primitive_indices + begin, (int)(end - begin));
+  }
+
+  void merge(BV& bv, const BV& other) const
+  {
+    bv += other;
+  }
+
+  BVFitter<BV>& fitter;
+  unsigned int* primitive_indices;
 };
+}
+
+template<typename BV>
+BV BVFitter<BV>::fit(unsigned int* primitive_indices, int num_primitives,
+                     ThreadPool* pool)
+{
+  return reduce(details::UnionReduction<BV>(*this, primitive_indices),
+                (std::size_t)num_primitives, primitivesPerChunk, pool);
+}
 
 }
 
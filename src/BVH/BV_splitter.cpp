@@ -37,12 +37,104 @@
 
 #include "BV_splitter.h"
 
+#include <algorithm>
+#include <limits>
+#include <hpp/fcl/BV/AABB.h>
+
 namespace hpp
 {
 namespace fcl
 {
 
 
+namespace
+{
+  /// Number of bins along each axis for the surface area heuristic
+  const int sahBins = 16;
+
+  FCL_REAL surfaceArea(const AABB& box)
+  {
+    return box.width() * box.height() + box.height() * box.depth()
+      + box.depth() * box.width();
+  }
+}
+
+void computeSplitRule_sah(const Matrix3f& frame, Vec3f* vertices,
+                          Triangle* triangles, unsigned int* primitive_indices,
+                          int num_primitives, BVHModelType type,
+                          int& split_axis, FCL_REAL& split_value)
+{
+  // Bounding boxes and centroids of the primitives, in frame.
+  std::vector<AABB> boxes(num_primitives);
+  std::vector<Vec3f> centroids(num_primitives);
+  AABB centroid_bounds;
+  for(int i = 0; i < num_primitives; ++i)
+  {
+    if(type == BVH_MODEL_TRIANGLES)
+    {
+      const Triangle& t = triangles[primitive_indices[i]];
+      Vec3f p1 (frame.transpose() * vertices[t[0]]);
+      Vec3f p2 (frame.transpose() * vertices[t[1]]);
+      Vec3f p3 (frame.transpose() * vertices[t[2]]);
+      boxes[i] = AABB(p1, p2, p3);
+      centroids[i] = (p1 + p2 + p3) / 3;
+    }
+    else
+    {
+      centroids[i].noalias() = frame.transpose() * vertices[primitive_indices[i]];
+      boxes[i] = AABB(centroids[i]);
+    }
+    centroid_bounds += centroids[i];
+  }
+
+  split_axis = 0;
+  split_value = centroid_bounds.center()[0];
+  FCL_REAL best_cost = std::numeric_limits<FCL_REAL>::max();
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    FCL_REAL lower = centroid_bounds.min_[axis];
+    FCL_REAL extent = centroid_bounds.max_[axis] - lower;
+    if(extent <= 0) continue;
+
+    AABB bins[sahBins];
+    int counts[sahBins] = {0};
+    for(int i = 0; i < num_primitives; ++i)
+    {
+      int b = std::min(sahBins - 1,
+                       (int)(sahBins * (centroids[i][axis] - lower) / extent));
+      bins[b] += boxes[i];
+      ++counts[b];
+    }
+
+    // right_costs[b] is the cost of the bins b to sahBins - 1.
+    FCL_REAL right_costs[sahBins];
+    AABB side;
+    int count = 0;
+    for(int b = sahBins - 1; b > 0; --b)
+    {
+      side += bins[b];
+      count += counts[b];
+      right_costs[b] = (count > 0) ? count * surfaceArea(side) : 0;
+    }
+
+    side = AABB();
+    count = 0;
+    for(int b = 0; b < sahBins - 1; ++b)
+    {
+      side += bins[b];
+      count += counts[b];
+      FCL_REAL cost = right_costs[b + 1];
+      if(count > 0) cost += count * surfaceArea(side);
+      if(cost < best_cost)
+      {
+        best_cost = cost;
+        split_axis = axis;
+        split_value = lower + extent * (b + 1) / sahBins;
+      }
+    }
+  }
+}
+
 template<typename BV>
 void computeSplitVector(const BV& bv, Vec3f& split_vector)
 {
@@ -190,6 +282,13 @@ void BVSplitter<OBB>::computeRule_median(const OBB& bv, unsigned int* primitive_
   computeSplitValue_median<OBB>(bv, vertices, tri_indices, primitive_indices, num_primitives, type, split_vector, split_value);
 }
 
+template<>
+void BVSplitter<OBB>::computeRule_sah(const OBB& bv, unsigned int* primitive_indices, int num_primitives)
+{
+  computeSplitRule_sah(bv.axes, vertices, tri_indices, primitive_indices, num_primitives, type, split_axis, split_value);
+  split_vector.noalias() = bv.axes.col(split_axis);
+}
+
 template<>
 void BVSplitter<RSS>::computeRule_bvcenter(const RSS& bv, unsigned int*, int)
 {
@@ -211,6 +310,13 @@ void BVSplitter<RSS>::computeRule_median(const RSS& bv, unsigned int* primitive_
   computeSplitValue_median<RSS>(bv, vertices, tri_indices, primitive_indices, num_primitives, type, split_vector, split_value);
 }
 
+template<>
+void BVSplitter<RSS>::computeRule_sah(const RSS& bv, unsigned int* primitive_indices, int num_primitives)
+{
+  computeSplitRule_sah(bv.axes, vertices, tri_indices, primitive_indices, num_primitives, type, split_axis, split_value);
+  split_vector.noalias() = bv.axes.col(split_axis);
+}
+
 template<>
 void BVSplitter<kIOS>::computeRule_bvcenter(const kIOS& bv, unsigned int*, int)
 {
@@ -232,6 +338,13 @@ void BVSplitter<kIOS>::computeRule_median(const kIOS& bv, unsigned int* primitiv
   computeSplitValue_median<kIOS>(bv, vertices, tri_indices, primitive_indices, num_primitives, type, split_vector, split_value);
 }
 
+template<>
+void BVSplitter<kIOS>::computeRule_sah(const kIOS& bv, unsigned int* primitive_indices, int num_primitives)
+{
+  computeSplitRule_sah(bv.obb.axes, vertices, tri_indices, primitive_indices, num_primitives, type, split_axis, split_value);
+  split_vector.noalias() = bv.obb.axes.col(split_axis);
+}
+
 template<>
 void BVSplitter<OBBRSS>::computeRule_bvcenter
 (const OBBRSS& bv, unsigned int*, int)
@@ -254,6 +367,13 @@ void BVSplitter<OBBRSS>::computeRule_median(const OBBRSS& bv, unsigned int* prim
   computeSplitValue_median<OBBRSS>(bv, vertices, tri_indices, primitive_indices, num_primitives, type, split_vector, split_value);
 }
 
+template<>
+void BVSplitter<OBBRSS>::computeRule_sah(const OBBRSS& bv, unsigned int* primitive_indices, int num_primitives)
+{
+  computeSplitRule_sah(bv.obb.axes, vertices, tri_indices, primitive_indices, num_primitives, type, split_axis, split_value);
+  split_vector.noalias() = bv.obb.axes.col(split_axis);
+}
+
 
 template<>
 bool BVSplitter<OBB>::apply(const Vec3f& q) const
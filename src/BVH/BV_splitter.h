@@ -49,8 +49,22 @@ namespace hpp
 namespace fcl
 {
 
-/// @brief Three types of split algorithms are provided in FCL as default
-enum SplitMethodType {SPLIT_METHOD_MEAN, SPLIT_METHOD_MEDIAN, SPLIT_METHOD_BV_CENTER};
+/// @brief Four types of split algorithms are provided in FCL as default
+enum SplitMethodType {SPLIT_METHOD_MEAN, SPLIT_METHOD_MEDIAN, SPLIT_METHOD_BV_CENTER, SPLIT_METHOD_SAH};
+
+/// @brief Binned surface area heuristic.
+///
+/// The primitive centroids are binned along each axis of frame. Among the
+/// planes between bins, the chosen one minimizes the sum, over both sides,
+/// of the number of primitives times the surface area of the box bounding
+/// them, the box being aligned with frame.
+/// @param frame the split is made along one of its columns.
+/// @retval split_axis the index of the column along which to split.
+/// @retval split_value the position of the split plane along this column.
+void computeSplitRule_sah(const Matrix3f& frame, Vec3f* vertices,
+                          Triangle* triangles, unsigned int* primitive_indices,
+                          int num_primitives, BVHModelType type,
+                          int& split_axis, FCL_REAL& split_value);
 
 
 /// @brief A class describing the split rule that splits each BV node
@@ -88,6 +102,9 @@ public:
     case SPLIT_METHOD_BV_CENTER:
       computeRule_bvcenter(bv, primitive_indices, num_primitives);
       break;
+    case SPLIT_METHOD_SAH:
+      computeRule_sah(bv, primitive_indices, num_primitives);
+      break;
     default:
       std::cerr << "Split method not supported" << std::endl;
     }
@@ -216,6 +233,14 @@ private:
       split_value = (proj[num_primitives / 2] + proj[num_primitives / 2 - 1]) / 2;
     }
   }
+
+  /// @brief Split algorithm 4: Split the node according to the surface area heuristic
+  void computeRule_sah(const BV&, unsigned int* primitive_indices, int num_primitives)
+  {
+    computeSplitRule_sah(Matrix3f::Identity(), vertices, tri_indices,
+                         primitive_indices, num_primitives, type,
+                         split_axis, split_value);
+  }
 };
 
 
@@ -240,6 +265,9 @@ void BVSplitter<OBB>::computeRule_mean(const OBB& bv, unsigned int* primitive_in
 template<>
 void BVSplitter<OBB>::computeRule_median(const OBB& bv, unsigned int* primitive_indices, int num_primitives);
 
+template<>
+void BVSplitter<OBB>::computeRule_sah(const OBB& bv, unsigned int* primitive_indices, int num_primitives);
+
 template<>
 void BVSplitter<RSS>::computeRule_bvcenter(const RSS& bv, unsigned int* primitive_indices, int num_primitives);
           
@@ -249,6 +277,9 @@ void BVSplitter<RSS>::computeRule_mean(const RSS& bv, unsigned int* primitive_in
 template<>
 void BVSplitter<RSS>::computeRule_median(const RSS& bv, unsigned int* primitive_indices, int num_primitives);
 
+template<>
+void BVSplitter<RSS>::computeRule_sah(const RSS& bv, unsigned int* primitive_indices, int num_primitives);
+
 template<>
 void BVSplitter<kIOS>::computeRule_bvcenter(const kIOS& bv, unsigned int* primitive_indices, int num_primitives);
 
@@ -258,6 +289,9 @@ void BVSplitter<kIOS>::computeRule_mean(const kIOS& bv, unsigned int* primitive_
 template<>
 void BVSplitter<kIOS>::computeRule_median(const kIOS& bv, unsigned int* primitive_indices, int num_primitives);
 
+template<>
+void BVSplitter<kIOS>::computeRule_sah(const kIOS& bv, unsigned int* primitive_indices, int num_primitives);
+
 template<>
 void BVSplitter<OBBRSS>::computeRule_bvcenter(const OBBRSS& bv, unsigned int* primitive_indices, int num_primitives);
 
@@ -267,6 +301,9 @@ void BVSplitter<OBBRSS>::computeRule_mean(const OBBRSS& bv, unsigned int* primit
 template<>
 void BVSplitter<OBBRSS>::computeRule_median(const OBBRSS& bv, unsigned int* primitive_indices, int num_primitives);
 
+template<>
+void BVSplitter<OBBRSS>::computeRule_sah(const OBBRSS& bv, unsigned int* primitive_indices, int num_primitives);
+
 }
 
 } // namespace hpp
@@ -0,0 +1,398 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <hpp/fcl/broadphase/broadphase_SaP.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace hpp
+{
+namespace fcl
+{
+
+void SaPCollisionManager::registerObjects(const std::vector<CollisionObject*>& other_objs)
+{
+  if(other_objs.empty()) return;
+  if(!proxies.empty())
+  {
+    BroadPhaseCollisionManager::registerObjects(other_objs);
+    return;
+  }
+
+  // Bulk loading: sort all the endpoints once and sweep along the first axis
+  // to find the overlapping pairs.
+  proxies.resize(other_objs.size());
+  for(int axis = 0; axis < 3; ++axis)
+    axes[axis].resize(2 * other_objs.size());
+  for(std::size_t i = 0; i < other_objs.size(); ++i)
+  {
+    Proxy& proxy = proxies[i];
+    proxy.obj = other_objs[i];
+    proxy.aabb = other_objs[i]->getAABB();
+    proxy_index[proxy.obj] = i;
+    for(int axis = 0; axis < 3; ++axis)
+    {
+      for(int k = 0; k < 2; ++k)
+      {
+        EndPoint& ep = axes[axis][2 * i + k];
+        ep.value = k ? proxy.aabb.max_[axis] : proxy.aabb.min_[axis];
+        ep.proxy = i;
+        ep.is_max = k;
+      }
+    }
+  }
+
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    std::sort(axes[axis].begin(), axes[axis].end());
+    renumber(axis, 0);
+  }
+
+  std::vector<std::size_t> active;
+  for(std::size_t i = 0; i < axes[0].size(); ++i)
+  {
+    const EndPoint& ep = axes[0][i];
+    if(ep.is_max)
+    {
+      active.erase(std::find(active.begin(), active.end(), ep.proxy));
+      continue;
+    }
+    const Proxy& proxy = proxies[ep.proxy];
+    for(std::size_t j = 0; j < active.size(); ++j)
+    {
+      const Proxy& other = proxies[active[j]];
+      if(proxy.aabb.overlap(other.aabb))
+        overlap_pairs.insert(makePair(proxy.obj, other.obj));
+    }
+    active.push_back(ep.proxy);
+  }
+}
+
+void SaPCollisionManager::registerObject(CollisionObject* obj)
+{
+  std::size_t i = proxies.size();
+  proxies.push_back(Proxy());
+  Proxy& proxy = proxies.back();
+  proxy.obj = obj;
+  proxy.aabb = obj->getAABB();
+  proxy_index[obj] = i;
+
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    std::vector<EndPoint>& eps = axes[axis];
+    EndPoint ep;
+    ep.proxy = i;
+    ep.value = proxy.aabb.min_[axis];
+    ep.is_max = 0;
+    std::size_t first = (std::size_t)(std::upper_bound(eps.begin(), eps.end(), ep) - eps.begin());
+    eps.insert(eps.begin() + first, ep);
+    ep.value = proxy.aabb.max_[axis];
+    ep.is_max = 1;
+    eps.insert(std::upper_bound(eps.begin() + first, eps.end(), ep), ep);
+    renumber(axis, first);
+  }
+
+  for(std::size_t j = 0; j < i; ++j)
+  {
+    if(proxies[j].aabb.overlap(proxy.aabb))
+      overlap_pairs.insert(makePair(proxies[j].obj, obj));
+  }
+}
+
+void SaPCollisionManager::unregisterObject(CollisionObject* obj)
+{
+  std::map<CollisionObject*, std::size_t>::iterator it = proxy_index.find(obj);
+  if(it == proxy_index.end()) return;
+  std::size_t i = it->second;
+  proxy_index.erase(it);
+
+  for(std::size_t j = 0; j < proxies.size(); ++j)
+  {
+    if(j != i && proxies[j].aabb.overlap(proxies[i].aabb))
+      overlap_pairs.erase(makePair(proxies[j].obj, obj));
+  }
+
+  // Move the last proxy in place of the removed one.
+  std::size_t last = proxies.size() - 1;
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    std::vector<EndPoint>& eps = axes[axis];
+    if(i != last)
+    {
+      eps[proxies[last].endpoints[axis][0]].proxy = i;
+      eps[proxies[last].endpoints[axis][1]].proxy = i;
+    }
+    std::size_t first = proxies[i].endpoints[axis][0];
+    eps.erase(eps.begin() + proxies[i].endpoints[axis][1]);
+    eps.erase(eps.begin() + first);
+  }
+  if(i != last)
+  {
+    proxies[i] = proxies[last];
+    proxy_index[proxies[i].obj] = i;
+  }
+  proxies.pop_back();
+
+  for(int axis = 0; axis < 3; ++axis)
+    renumber(axis, 0);
+}
+
+void SaPCollisionManager::update()
+{
+  for(std::size_t i = 0; i < proxies.size(); ++i)
+    updateProxy(i, NULL);
+}
+
+void SaPCollisionManager::update(CollisionObject* updated_obj)
+{
+  std::map<CollisionObject*, std::size_t>::const_iterator it = proxy_index.find(updated_obj);
+  if(it != proxy_index.end())
+    updateProxy(it->second, NULL);
+}
+
+void SaPCollisionManager::update(const std::vector<CollisionObject*>& updated_objs)
+{
+  for(std::size_t i = 0; i < updated_objs.size(); ++i)
+    update(updated_objs[i]);
+}
+
+void SaPCollisionManager::update(const std::vector<CollisionObject*>& updated_objs,
+                                 std::vector<ObjectPair>& created,
+                                 std::vector<ObjectPair>& destroyed)
+{
+  created.clear();
+  destroyed.clear();
+
+  PairChanges changes;
+  for(std::size_t i = 0; i < updated_objs.size(); ++i)
+  {
+    std::map<CollisionObject*, std::size_t>::const_iterator it = proxy_index.find(updated_objs[i]);
+    if(it != proxy_index.end())
+      updateProxy(it->second, &changes);
+  }
+
+  // A pair may be created and destroyed during the same update when both
+  // objects have moved: only report the net changes.
+  for(PairChanges::const_iterator it = changes.begin(); it != changes.end(); ++it)
+  {
+    bool overlapping = overlap_pairs.find(it->first) != overlap_pairs.end();
+    if(overlapping && !it->second)
+      created.push_back(it->first);
+    else if(!overlapping && it->second)
+      destroyed.push_back(it->first);
+  }
+}
+
+void SaPCollisionManager::updateProxy(std::size_t i, PairChanges* changes)
+{
+  Proxy& proxy = proxies[i];
+  proxy.aabb = proxy.obj->getAABB();
+
+  // Objects are updated one at a time so that, apart from the endpoints of
+  // the current object, the axes are sorted. The endpoint moving outwards is
+  // moved first so that the lower bound never crosses the upper bound.
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    std::vector<EndPoint>& eps = axes[axis];
+    bool max_first = proxy.aabb.max_[axis] > eps[proxy.endpoints[axis][1]].value;
+    for(int j = 0; j < 2; ++j)
+    {
+      int k = max_first ? 1 - j : j;
+      std::size_t e = proxy.endpoints[axis][k];
+      eps[e].value = k ? proxy.aabb.max_[axis] : proxy.aabb.min_[axis];
+      moveEndPoint(axis, e, changes);
+    }
+  }
+}
+
+void SaPCollisionManager::moveEndPoint(int axis, std::size_t i, PairChanges* changes)
+{
+  std::vector<EndPoint>& eps = axes[axis];
+
+  while(i > 0 && eps[i] < eps[i - 1])
+  {
+    handleSwap(eps[i], eps[i - 1], true, changes);
+    std::swap(eps[i], eps[i - 1]);
+    proxies[eps[i].proxy].endpoints[axis][eps[i].is_max] = i;
+    --i;
+    proxies[eps[i].proxy].endpoints[axis][eps[i].is_max] = i;
+  }
+
+  while(i + 1 < eps.size() && eps[i + 1] < eps[i])
+  {
+    handleSwap(eps[i], eps[i + 1], false, changes);
+    std::swap(eps[i], eps[i + 1]);
+    proxies[eps[i].proxy].endpoints[axis][eps[i].is_max] = i;
+    ++i;
+    proxies[eps[i].proxy].endpoints[axis][eps[i].is_max] = i;
+  }
+}
+
+void SaPCollisionManager::handleSwap(const EndPoint& m, const EndPoint& p, bool m_moved_left, PairChanges* changes)
+{
+  if(m.is_max == p.is_max || m.proxy == p.proxy) return;
+
+  const Proxy& a = proxies[m.proxy];
+  const Proxy& b = proxies[p.proxy];
+  // The intervals start overlapping along this axis when a lower bound moves
+  // to the left of an upper bound, and stop when it moves to the right.
+  bool start_overlap = (m.is_max == 0) == m_moved_left;
+  if(start_overlap)
+  {
+    if(a.aabb.overlap(b.aabb))
+      addPair(a.obj, b.obj, changes);
+  }
+  else
+    removePair(a.obj, b.obj, changes);
+}
+
+void SaPCollisionManager::addPair(CollisionObject* a, CollisionObject* b, PairChanges* changes)
+{
+  ObjectPair pair (makePair(a, b));
+  bool inserted = overlap_pairs.insert(pair).second;
+  if(changes && inserted)
+    changes->insert(std::make_pair(pair, false));
+}
+
+void SaPCollisionManager::removePair(CollisionObject* a, CollisionObject* b, PairChanges* changes)
+{
+  ObjectPair pair (makePair(a, b));
+  bool erased = overlap_pairs.erase(pair) > 0;
+  if(changes && erased)
+    changes->insert(std::make_pair(pair, true));
+}
+
+void SaPCollisionManager::renumber(int axis, std::size_t begin)
+{
+  std::vector<EndPoint>& eps = axes[axis];
+  for(std::size_t i = begin; i < eps.size(); ++i)
+    proxies[eps[i].proxy].endpoints[axis][eps[i].is_max] = i;
+}
+
+void SaPCollisionManager::clear()
+{
+  for(int axis = 0; axis < 3; ++axis)
+    axes[axis].clear();
+  proxies.clear();
+  proxy_index.clear();
+  overlap_pairs.clear();
+}
+
+void SaPCollisionManager::getObjects(std::vector<CollisionObject*>& objs) const
+{
+  objs.resize(proxies.size());
+  for(std::size_t i = 0; i < proxies.size(); ++i)
+    objs[i] = proxies[i].obj;
+}
+
+void SaPCollisionManager::collide(CollisionObject* obj, void* cdata, CollisionCallBack callback) const
+{
+  if(proxies.empty()) return;
+  const AABB& aabb = obj->getAABB();
+
+  // Only the lower bounds below the upper bound of the query may overlap it:
+  // scan them along the axis where they are the fewest.
+  EndPoint query;
+  query.is_max = 1;
+  int best_axis = 0;
+  std::size_t best_end = std::numeric_limits<std::size_t>::max();
+  for(int axis = 0; axis < 3; ++axis)
+  {
+    query.value = aabb.max_[axis];
+    std::size_t end = (std::size_t)(std::upper_bound(axes[axis].begin(), axes[axis].end(), query) - axes[axis].begin());
+    if(end < best_end)
+    {
+      best_end = end;
+      best_axis = axis;
+    }
+  }
+
+  const std::vector<EndPoint>& eps = axes[best_axis];
+  for(std::size_t i = 0; i < best_end; ++i)
+  {
+    if(eps[i].is_max) continue;
+    const Proxy& proxy = proxies[eps[i].proxy];
+    if(proxy.aabb.overlap(aabb))
+    {
+      if(callback(proxy.obj, obj, cdata))
+        return;
+    }
+  }
+}
+
+void SaPCollisionManager::distance(CollisionObject* obj, void* cdata, DistanceCallBack callback) const
+{
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  const AABB& aabb = obj->getAABB();
+  for(std::size_t i = 0; i < proxies.size(); ++i)
+  {
+    if(proxies[i].aabb.distance(aabb) < min_dist)
+    {
+      if(callback(proxies[i].obj, obj, cdata, min_dist))
+        return;
+    }
+  }
+}
+
+void SaPCollisionManager::collide(void* cdata, CollisionCallBack callback) const
+{
+  for(ObjectPairSet::const_iterator it = overlap_pairs.begin(); it != overlap_pairs.end(); ++it)
+  {
+    if(callback(it->first, it->second, cdata))
+      return;
+  }
+}
+
+void SaPCollisionManager::distance(void* cdata, DistanceCallBack callback) const
+{
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  for(std::size_t i = 0; i < proxies.size(); ++i)
+  {
+    for(std::size_t j = i + 1; j < proxies.size(); ++j)
+    {
+      if(proxies[i].aabb.distance(proxies[j].aabb) < min_dist)
+      {
+        if(callback(proxies[i].obj, proxies[j].obj, cdata, min_dist))
+          return;
+      }
+    }
+  }
+}
+
+}
+
+} // namespace hpp
@@ -0,0 +1,222 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <hpp/fcl/broadphase/broadphase_collision_manager.h>
+
+#include <algorithm>
+#include <limits>
+
+namespace hpp
+{
+namespace fcl
+{
+
+void BroadPhaseCollisionManager::registerObjects(const std::vector<CollisionObject*>& other_objs)
+{
+  for(std::size_t i = 0; i < other_objs.size(); ++i)
+    registerObject(other_objs[i]);
+}
+
+void BroadPhaseCollisionManager::update(CollisionObject* /*updated_obj*/)
+{
+  update();
+}
+
+void BroadPhaseCollisionManager::update(const std::vector<CollisionObject*>& /*updated_objs*/)
+{
+  update();
+}
+
+void BroadPhaseCollisionManager::collide(BroadPhaseCollisionManager* other_manager, void* cdata, CollisionCallBack callback) const
+{
+  if(other_manager == this)
+  {
+    collide(cdata, callback);
+    return;
+  }
+
+  std::vector<CollisionObject*> other_objs;
+  other_manager->getObjects(other_objs);
+  for(std::size_t i = 0; i < other_objs.size(); ++i)
+    collide(other_objs[i], cdata, callback);
+}
+
+void BroadPhaseCollisionManager::distance(BroadPhaseCollisionManager* other_manager, void* cdata, DistanceCallBack callback) const
+{
+  if(other_manager == this)
+  {
+    distance(cdata, callback);
+    return;
+  }
+
+  std::vector<CollisionObject*> other_objs;
+  other_manager->getObjects(other_objs);
+  for(std::size_t i = 0; i < other_objs.size(); ++i)
+    distance(other_objs[i], cdata, callback);
+}
+
+void NaiveCollisionManager::registerObjects(const std::vector<CollisionObject*>& other_objs)
+{
+  objs.insert(objs.end(), other_objs.begin(), other_objs.end());
+}
+
+void NaiveCollisionManager::registerObject(CollisionObject* obj)
+{
+  objs.push_back(obj);
+}
+
+void NaiveCollisionManager::unregisterObject(CollisionObject* obj)
+{
+  std::vector<CollisionObject*>::iterator it = std::find(objs.begin(), objs.end(), obj);
+  if(it != objs.end())
+    objs.erase(it);
+}
+
+void NaiveCollisionManager::clear()
+{
+  objs.clear();
+}
+
+void NaiveCollisionManager::getObjects(std::vector<CollisionObject*>& objs_) const
+{
+  objs_ = objs;
+}
+
+void NaiveCollisionManager::collide(CollisionObject* obj, void* cdata, CollisionCallBack callback) const
+{
+  for(std::size_t i = 0; i < objs.size(); ++i)
+  {
+    if(objs[i]->getAABB().overlap(obj->getAABB()))
+    {
+      if(callback(objs[i], obj, cdata))
+        return;
+    }
+  }
+}
+
+void NaiveCollisionManager::distance(CollisionObject* obj, void* cdata, DistanceCallBack callback) const
+{
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  for(std::size_t i = 0; i < objs.size(); ++i)
+  {
+    if(objs[i]->getAABB().distance(obj->getAABB()) < min_dist)
+    {
+      if(callback(objs[i], obj, cdata, min_dist))
+        return;
+    }
+  }
+}
+
+void NaiveCollisionManager::collide(void* cdata, CollisionCallBack callback) const
+{
+  for(std::size_t i = 0; i < objs.size(); ++i)
+  {
+    for(std::size_t j = i + 1; j < objs.size(); ++j)
+    {
+      if(objs[i]->getAABB().overlap(objs[j]->getAABB()))
+      {
+        if(callback(objs[i], objs[j], cdata))
+          return;
+      }
+    }
+  }
+}
+
+void NaiveCollisionManager::distance(void* cdata, DistanceCallBack callback) const
+{
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  for(std::size_t i = 0; i < objs.size(); ++i)
+  {
+    for(std::size_t j = i + 1; j < objs.size(); ++j)
+    {
+      if(objs[i]->getAABB().distance(objs[j]->getAABB()) < min_dist)
+      {
+        if(callback(objs[i], objs[j], cdata, min_dist))
+          return;
+      }
+    }
+  }
+}
+
+void NaiveCollisionManager::collide(BroadPhaseCollisionManager* other_manager, void* cdata, CollisionCallBack callback) const
+{
+  if(other_manager == this)
+  {
+    collide(cdata, callback);
+    return;
+  }
+
+  std::vector<CollisionObject*> other_objs;
+  other_manager->getObjects(other_objs);
+  for(std::size_t i = 0; i < objs.size(); ++i)
+  {
+    for(std::size_t j = 0; j < other_objs.size(); ++j)
+    {
+      if(objs[i]->getAABB().overlap(other_objs[j]->getAABB()))
+      {
+        if(callback(objs[i], other_objs[j], cdata))
+          return;
+      }
+    }
+  }
+}
+
+void NaiveCollisionManager::distance(BroadPhaseCollisionManager* other_manager, void* cdata, DistanceCallBack callback) const
+{
+  if(other_manager == this)
+  {
+    distance(cdata, callback);
+    return;
+  }
+
+  std::vector<CollisionObject*> other_objs;
+  other_manager->getObjects(other_objs);
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  for(std::size_t i = 0; i < objs.size(); ++i)
+  {
+    for(std::size_t j = 0; j < other_objs.size(); ++j)
+    {
+      if(objs[i]->getAABB().distance(other_objs[j]->getAABB()) < min_dist)
+      {
+        if(callback(objs[i], other_objs[j], cdata, min_dist))
+          return;
+      }
+    }
+  }
+}
+
+}
+
+} // namespace hpp
@@ -0,0 +1,322 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <hpp/fcl/broadphase/broadphase_dynamic_AABB_tree.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace
+{
+  typedef detail::HierarchyTree Tree;
+  typedef Tree::NodeIndex NodeIndex;
+  typedef Tree::Node Node;
+
+  /// Whether the traversal of a pair of nodes should descend into the first
+  /// one, i.e. the largest one which is not a leaf.
+  inline bool descendFirst(const Node& a, const Node& b)
+  {
+    return b.isLeaf() || (!a.isLeaf() && a.bv.size() > b.bv.size());
+  }
+
+  bool collisionRecurse(const Tree& tree, NodeIndex n, CollisionObject* query,
+                        void* cdata, CollisionCallBack callback)
+  {
+    const Node& node = tree.getNode(n);
+    if(!node.bv.overlap(query->getAABB())) return false;
+
+    if(node.isLeaf())
+    {
+      if(!node.data->getAABB().overlap(query->getAABB())) return false;
+      return callback(node.data, query, cdata);
+    }
+
+    return collisionRecurse(tree, node.children[0], query, cdata, callback)
+      || collisionRecurse(tree, node.children[1], query, cdata, callback);
+  }
+
+  bool collisionRecurse(const Tree& tree1, NodeIndex n1,
+                        const Tree& tree2, NodeIndex n2,
+                        void* cdata, CollisionCallBack callback)
+  {
+    const Node& a = tree1.getNode(n1);
+    const Node& b = tree2.getNode(n2);
+    if(!a.bv.overlap(b.bv)) return false;
+
+    if(a.isLeaf() && b.isLeaf())
+    {
+      if(!a.data->getAABB().overlap(b.data->getAABB())) return false;
+      return callback(a.data, b.data, cdata);
+    }
+
+    if(descendFirst(a, b))
+      return collisionRecurse(tree1, a.children[0], tree2, n2, cdata, callback)
+        || collisionRecurse(tree1, a.children[1], tree2, n2, cdata, callback);
+    else
+      return collisionRecurse(tree1, n1, tree2, b.children[0], cdata, callback)
+        || collisionRecurse(tree1, n1, tree2, b.children[1], cdata, callback);
+  }
+
+  bool selfCollisionRecurse(const Tree& tree, NodeIndex n,
+                            void* cdata, CollisionCallBack callback)
+  {
+    const Node& node = tree.getNode(n);
+    if(node.isLeaf()) return false;
+
+    return selfCollisionRecurse(tree, node.children[0], cdata, callback)
+      || selfCollisionRecurse(tree, node.children[1], cdata, callback)
+      || collisionRecurse(tree, node.children[0], tree, node.children[1], cdata, callback);
+  }
+
+  bool distanceRecurse(const Tree& tree, NodeIndex n, CollisionObject* query,
+                       void* cdata, DistanceCallBack callback, FCL_REAL& min_dist)
+  {
+    const Node& node = tree.getNode(n);
+    if(node.isLeaf())
+    {
+      if(node.data->getAABB().distance(query->getAABB()) >= min_dist) return false;
+      return callback(node.data, query, cdata, min_dist);
+    }
+
+    // Visit the closest child first, it is more likely to lower min_dist.
+    NodeIndex c[2] = { node.children[0], node.children[1] };
+    FCL_REAL d[2] = { tree.getNode(c[0]).bv.distance(query->getAABB()),
+                      tree.getNode(c[1]).bv.distance(query->getAABB()) };
+    if(d[1] < d[0]) { std::swap(c[0], c[1]); std::swap(d[0], d[1]); }
+
+    for(int k = 0; k < 2; ++k)
+    {
+      if(d[k] < min_dist &&
+         distanceRecurse(tree, c[k], query, cdata, callback, min_dist))
+        return true;
+    }
+    return false;
+  }
+
+  bool distanceRecurse(const Tree& tree1, NodeIndex n1,
+                       const Tree& tree2, NodeIndex n2,
+                       void* cdata, DistanceCallBack callback, FCL_REAL& min_dist)
+  {
+    const Node& a = tree1.getNode(n1);
+    const Node& b = tree2.getNode(n2);
+
+    if(a.isLeaf() && b.isLeaf())
+    {
+      if(a.data->getAABB().distance(b.data->getAABB()) >= min_dist) return false;
+      return callback(a.data, b.data, cdata, min_dist);
+    }
+
+    const bool first = descendFirst(a, b);
+    const Node& parent = first ? a : b;
+    const Node& other = first ? b : a;
+    const Tree& tree = first ? tree1 : tree2;
+
+    NodeIndex c[2] = { parent.children[0], parent.children[1] };
+    FCL_REAL d[2] = { tree.getNode(c[0]).bv.distance(other.bv),
+                      tree.getNode(c[1]).bv.distance(other.bv) };
+    if(d[1] < d[0]) { std::swap(c[0], c[1]); std::swap(d[0], d[1]); }
+
+    for(int k = 0; k < 2; ++k)
+    {
+      if(d[k] >= min_dist) continue;
+      bool stop = first ?
+        distanceRecurse(tree1, c[k], tree2, n2, cdata, callback, min_dist) :
+        distanceRecurse(tree1, n1, tree2, c[k], cdata, callback, min_dist);
+      if(stop) return true;
+    }
+    return false;
+  }
+
+  bool selfDistanceRecurse(const Tree& tree, NodeIndex n,
+                           void* cdata, DistanceCallBack callback, FCL_REAL& min_dist)
+  {
+    const Node& node = tree.getNode(n);
+    if(node.isLeaf()) return false;
+
+    const NodeIndex c0 = node.children[0], c1 = node.children[1];
+    if(selfDistanceRecurse(tree, c0, cdata, callback, min_dist)) return true;
+    if(selfDistanceRecurse(tree, c1, cdata, callback, min_dist)) return true;
+
+    if(tree.getNode(c0).bv.distance(tree.getNode(c1).bv) < min_dist)
+      return distanceRecurse(tree, c0, tree, c1, cdata, callback, min_dist);
+    return false;
+  }
+}
+
+AABB DynamicAABBTreeCollisionManager::fatAABB(const CollisionObject* obj) const
+{
+  AABB bv (obj->getAABB());
+  return bv.expand((bv.max_ - bv.min_) * fat_margin);
+}
+
+void DynamicAABBTreeCollisionManager::registerObjects(const std::vector<CollisionObject*>& other_objs)
+{
+  if(other_objs.empty()) return;
+
+  const bool was_empty = dtree.empty();
+  for(std::size_t i = 0; i < other_objs.size(); ++i)
+    registerObject(other_objs[i]);
+
+  // A top-down construction gives better trees than successive insertions.
+  if(was_empty && tree_init_level > 0)
+    dtree.rebuild(tree_init_level);
+}
+
+void DynamicAABBTreeCollisionManager::registerObject(CollisionObject* obj)
+{
+  table[obj] = dtree.insert(fatAABB(obj), obj);
+}
+
+void DynamicAABBTreeCollisionManager::unregisterObject(CollisionObject* obj)
+{
+  ObjectLeafMap::iterator it = table.find(obj);
+  if(it == table.end()) return;
+
+  dtree.remove(it->second);
+  table.erase(it);
+}
+
+void DynamicAABBTreeCollisionManager::setup()
+{
+  if(dtree.size() < 2) return;
+
+  FCL_REAL balanced_height = std::ceil(std::log((FCL_REAL)dtree.size()) / std::log(2.));
+  if(dtree.getHeight() > max_tree_nonbalanced_level * balanced_height)
+    dtree.rebuild(tree_init_level);
+}
+
+bool DynamicAABBTreeCollisionManager::updateObject(CollisionObject* obj)
+{
+  ObjectLeafMap::const_iterator it = table.find(obj);
+  if(it == table.end()) return false;
+
+  return dtree.update(it->second, obj->getAABB(), fatAABB(obj));
+}
+
+void DynamicAABBTreeCollisionManager::update()
+{
+  for(ObjectLeafMap::const_iterator it = table.begin(); it != table.end(); ++it)
+    updateObject(it->first);
+}
+
+void DynamicAABBTreeCollisionManager::update(CollisionObject* updated_obj)
+{
+  updateObject(updated_obj);
+}
+
+void DynamicAABBTreeCollisionManager::update(const std::vector<CollisionObject*>& updated_objs)
+{
+  for(std::size_t i = 0; i < updated_objs.size(); ++i)
+    updateObject(updated_objs[i]);
+}
+
+void DynamicAABBTreeCollisionManager::clear()
+{
+  dtree.clear();
+  table.clear();
+}
+
+void DynamicAABBTreeCollisionManager::getObjects(std::vector<CollisionObject*>& objs) const
+{
+  objs.resize(0);
+  objs.reserve(table.size());
+  for(ObjectLeafMap::const_iterator it = table.begin(); it != table.end(); ++it)
+    objs.push_back(it->first);
+}
+
+void DynamicAABBTreeCollisionManager::collide(CollisionObject* obj, void* cdata, CollisionCallBack callback) const
+{
+  if(dtree.empty()) return;
+  collisionRecurse(dtree, dtree.getRoot(), obj, cdata, callback);
+}
+
+void DynamicAABBTreeCollisionManager::distance(CollisionObject* obj, void* cdata, DistanceCallBack callback) const
+{
+  if(dtree.empty()) return;
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  distanceRecurse(dtree, dtree.getRoot(), obj, cdata, callback, min_dist);
+}
+
+void DynamicAABBTreeCollisionManager::collide(void* cdata, CollisionCallBack callback) const
+{
+  if(dtree.empty()) return;
+  selfCollisionRecurse(dtree, dtree.getRoot(), cdata, callback);
+}
+
+void DynamicAABBTreeCollisionManager::distance(void* cdata, DistanceCallBack callback) const
+{
+  if(dtree.empty()) return;
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  selfDistanceRecurse(dtree, dtree.getRoot(), cdata, callback, min_dist);
+}
+
+void DynamicAABBTreeCollisionManager::collide(BroadPhaseCollisionManager* other_manager, void* cdata, CollisionCallBack callback) const
+{
+  const DynamicAABBTreeCollisionManager* other =
+    dynamic_cast<const DynamicAABBTreeCollisionManager*>(other_manager);
+  if(other == NULL || other == this)
+  {
+    BroadPhaseCollisionManager::collide(other_manager, cdata, callback);
+    return;
+  }
+
+  if(dtree.empty() || other->dtree.empty()) return;
+  collisionRecurse(dtree, dtree.getRoot(), other->dtree, other->dtree.getRoot(), cdata, callback);
+}
+
+void DynamicAABBTreeCollisionManager::distance(BroadPhaseCollisionManager* other_manager, void* cdata, DistanceCallBack callback) const
+{
+  const DynamicAABBTreeCollisionManager* other =
+    dynamic_cast<const DynamicAABBTreeCollisionManager*>(other_manager);
+  if(other == NULL || other == this)
+  {
+    BroadPhaseCollisionManager::distance(other_manager, cdata, callback);
+    return;
+  }
+
+  if(dtree.empty() || other->dtree.empty()) return;
+  FCL_REAL min_dist = std::numeric_limits<FCL_REAL>::max();
+  distanceRecurse(dtree, dtree.getRoot(), other->dtree, other->dtree.getRoot(), cdata, callback, min_dist);
+}
+
+}
+
+} // namespace hpp
@@ -0,0 +1,401 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <hpp/fcl/broadphase/detail/hierarchy_tree.h>
+
+#include <algorithm>
+
+namespace hpp
+{
+namespace fcl
+{
+namespace detail
+{
+
+const HierarchyTree::NodeIndex HierarchyTree::NULL_NODE;
+
+namespace
+{
+  /// Order nodes according to the center of their bounding volume along an
+  /// axis.
+  struct CenterLess
+  {
+    const std::vector<HierarchyTree::Node>& nodes;
+    int axis;
+
+    CenterLess (const std::vector<HierarchyTree::Node>& n, int a)
+      : nodes (n), axis (a) {}
+
+    bool operator() (HierarchyTree::NodeIndex a, HierarchyTree::NodeIndex b) const
+    {
+      const AABB& ba = nodes[a].bv, &bb = nodes[b].bv;
+      return ba.min_[axis] + ba.max_[axis] < bb.min_[axis] + bb.max_[axis];
+    }
+  };
+
+  /// Whether the center of a node is below a threshold along an axis.
+  struct CenterBelow
+  {
+    const std::vector<HierarchyTree::Node>& nodes;
+    int axis;
+    FCL_REAL split;
+
+    CenterBelow (const std::vector<HierarchyTree::Node>& n, int a, FCL_REAL s)
+      : nodes (n), axis (a), split (s) {}
+
+    bool operator() (HierarchyTree::NodeIndex a) const
+    {
+      const AABB& ba = nodes[a].bv;
+      return 0.5 * (ba.min_[axis] + ba.max_[axis]) < split;
+    }
+  };
+}
+
+HierarchyTree::HierarchyTree() : root_ (NULL_NODE),
+                                 free_list_ (NULL_NODE),
+                                 n_leaves_ (0)
+{
+}
+
+void HierarchyTree::clear()
+{
+  nodes_.clear();
+  root_ = NULL_NODE;
+  free_list_ = NULL_NODE;
+  n_leaves_ = 0;
+}
+
+HierarchyTree::NodeIndex HierarchyTree::allocateNode()
+{
+  NodeIndex i;
+  if(free_list_ == NULL_NODE)
+  {
+    i = nodes_.size();
+    nodes_.push_back(Node());
+  }
+  else
+  {
+    i = free_list_;
+    free_list_ = nodes_[i].parent;
+  }
+
+  Node& node = nodes_[i];
+  node.parent = NULL_NODE;
+  node.children[0] = node.children[1] = NULL_NODE;
+  node.height = 0;
+  node.data = NULL;
+  return i;
+}
+
+void HierarchyTree::releaseNode(NodeIndex i)
+{
+  nodes_[i].parent = free_list_;
+  nodes_[i].height = -1;
+  nodes_[i].data = NULL;
+  free_list_ = i;
+}
+
+HierarchyTree::NodeIndex HierarchyTree::insert(const AABB& bv, CollisionObject* data)
+{
+  NodeIndex leaf = allocateNode();
+  nodes_[leaf].bv = bv;
+  nodes_[leaf].data = data;
+  insertLeaf(leaf);
+  ++n_leaves_;
+  return leaf;
+}
+
+void HierarchyTree::remove(NodeIndex leaf)
+{
+  removeLeaf(leaf);
+  releaseNode(leaf);
+  --n_leaves_;
+}
+
+bool HierarchyTree::update(NodeIndex leaf, const AABB& bv, const AABB& fat_bv)
+{
+  if(nodes_[leaf].bv.contain(bv)) return false;
+
+  removeLeaf(leaf);
+  nodes_[leaf].bv = fat_bv;
+  insertLeaf(leaf);
+  return true;
+}
+
+void HierarchyTree::insertLeaf(NodeIndex leaf)
+{
+  if(root_ == NULL_NODE)
+  {
+    root_ = leaf;
+    nodes_[leaf].parent = NULL_NODE;
+    return;
+  }
+
+  // Look for the best sibling, following the surface area heuristic: the
+  // cost of a node is the sum of the areas of the nodes that are enlarged
+  // when the new leaf is inserted below it.
+  const AABB bv (nodes_[leaf].bv);
+  NodeIndex index = root_;
+  while(!nodes_[index].isLeaf())
+  {
+    const Node& node = nodes_[index];
+    FCL_REAL area = surfaceArea(node.bv);
+    FCL_REAL combined_area = surfaceArea(node.bv + bv);
+
+    // Cost of creating a new parent for this node and the new leaf
+    FCL_REAL cost = 2 * combined_area;
+    // Minimum cost of pushing the leaf further down the tree
+    FCL_REAL inheritance_cost = 2 * (combined_area - area);
+
+    FCL_REAL child_costs[2];
+    for(int k = 0; k < 2; ++k)
+    {
+      const Node& child = nodes_[node.children[k]];
+      child_costs[k] = surfaceArea(child.bv + bv) + inheritance_cost;
+      if(!child.isLeaf())
+        child_costs[k] -= surfaceArea(child.bv);
+    }
+
+    if(cost < child_costs[0] && cost < child_costs[1])
+      break;
+
+    index = (child_costs[0] < child_costs[1]) ? node.children[0] : node.children[1];
+  }
+
+  const NodeIndex sibling = index;
+  const NodeIndex old_parent = nodes_[sibling].parent;
+  const NodeIndex new_parent = allocateNode();
+
+  Node& parent = nodes_[new_parent];
+  parent.parent = old_parent;
+  parent.bv = bv + nodes_[sibling].bv;
+  parent.height = nodes_[sibling].height + 1;
+  parent.children[0] = sibling;
+  parent.children[1] = leaf;
+
+  if(old_parent != NULL_NODE)
+  {
+    Node& op = nodes_[old_parent];
+    if(op.children[0] == sibling) op.children[0] = new_parent;
+    else op.children[1] = new_parent;
+  }
+  else
+    root_ = new_parent;
+
+  nodes_[sibling].parent = new_parent;
+  nodes_[leaf].parent = new_parent;
+
+  refitUpward(new_parent);
+}
+
+void HierarchyTree::removeLeaf(NodeIndex leaf)
+{
+  if(leaf == root_)
+  {
+    root_ = NULL_NODE;
+    return;
+  }
+
+  const NodeIndex parent = nodes_[leaf].parent;
+  const NodeIndex grand_parent = nodes_[parent].parent;
+  const NodeIndex sibling = (nodes_[parent].children[0] == leaf) ?
+    nodes_[parent].children[1] : nodes_[parent].children[0];
+
+  if(grand_parent != NULL_NODE)
+  {
+    Node& gp = nodes_[grand_parent];
+    if(gp.children[0] == parent) gp.children[0] = sibling;
+    else gp.children[1] = sibling;
+    nodes_[sibling].parent = grand_parent;
+    releaseNode(parent);
+    refitUpward(grand_parent);
+  }
+  else
+  {
+    root_ = sibling;
+    nodes_[sibling].parent = NULL_NODE;
+    releaseNode(parent);
+  }
+  nodes_[leaf].parent = NULL_NODE;
+}
+
+void HierarchyTree::refitUpward(NodeIndex i)
+{
+  while(i != NULL_NODE)
+  {
+    i = balance(i);
+
+    Node& node = nodes_[i];
+    const Node& c0 = nodes_[node.children[0]];
+    const Node& c1 = nodes_[node.children[1]];
+    node.height = 1 + std::max(c0.height, c1.height);
+    node.bv = c0.bv + c1.bv;
+
+    i = node.parent;
+  }
+}
+
+HierarchyTree::NodeIndex HierarchyTree::balance(NodeIndex iA)
+{
+  Node& A = nodes_[iA];
+  if(A.isLeaf() || A.height < 2)
+    return iA;
+
+  const NodeIndex iB = A.children[0];
+  const NodeIndex iC = A.children[1];
+  Node& B = nodes_[iB];
+  Node& C = nodes_[iC];
+
+  const int imbalance = C.height - B.height;
+
+  // The rotation moves the higher child up and A down, in place of the
+  // lower grand child.
+  if(imbalance > 1 || imbalance < -1)
+  {
+    const int up = (imbalance > 1) ? 1 : 0;
+    const NodeIndex iU = A.children[up];
+    const NodeIndex iO = A.children[1 - up];
+    Node& U = nodes_[iU];
+    Node& O = nodes_[iO];
+    const NodeIndex iF = U.children[0];
+    const NodeIndex iG = U.children[1];
+    Node& F = nodes_[iF];
+    Node& G = nodes_[iG];
+
+    // Swap A and U
+    U.children[0] = iA;
+    U.parent = A.parent;
+    A.parent = iU;
+
+    if(U.parent != NULL_NODE)
+    {
+      Node& P = nodes_[U.parent];
+      if(P.children[0] == iA) P.children[0] = iU;
+      else P.children[1] = iU;
+    }
+    else
+      root_ = iU;
+
+    // Keep the higher grand child below U, move the other one below A.
+    const bool keep_f = F.height > G.height;
+    const NodeIndex iK = keep_f ? iF : iG;
+    const NodeIndex iM = keep_f ? iG : iF;
+    Node& K = nodes_[iK];
+    Node& M = nodes_[iM];
+
+    U.children[1] = iK;
+    A.children[up] = iM;
+    M.parent = iA;
+
+    A.bv = O.bv + M.bv;
+    A.height = 1 + std::max(O.height, M.height);
+    U.bv = A.bv + K.bv;
+    U.height = 1 + std::max(A.height, K.height);
+    return iU;
+  }
+
+  return iA;
+}
+
+void HierarchyTree::rebuild(int level)
+{
+  std::vector<NodeIndex> leaves;
+  leaves.reserve(n_leaves_);
+  for(NodeIndex i = 0; i < nodes_.size(); ++i)
+  {
+    if(nodes_[i].height == 0)
+      leaves.push_back(i);
+    else if(nodes_[i].height > 0)
+      releaseNode(i);
+  }
+
+  root_ = NULL_NODE;
+  if(leaves.empty()) return;
+
+  if(level <= 0)
+  {
+    for(std::size_t i = 0; i < leaves.size(); ++i)
+      insertLeaf(leaves[i]);
+  }
+  else
+  {
+    root_ = buildTopDown(leaves.begin(), leaves.end(), level);
+    nodes_[root_].parent = NULL_NODE;
+  }
+}
+
+HierarchyTree::NodeIndex HierarchyTree::buildTopDown(std::vector<NodeIndex>::iterator begin,
+                                                     std::vector<NodeIndex>::iterator end,
+                                                     int level)
+{
+  if(end - begin == 1)
+    return *begin;
+
+  AABB centers;
+  for(std::vector<NodeIndex>::iterator it = begin; it != end; ++it)
+    centers += nodes_[*it].bv.center();
+
+  int axis;
+  (centers.max_ - centers.min_).maxCoeff(&axis);
+
+  std::vector<NodeIndex>::iterator mid = end;
+  if(level == 2)
+    mid = std::partition(begin, end,
+                         CenterBelow(nodes_, axis, centers.center()[axis]));
+  if(mid == begin || mid == end)
+  {
+    mid = begin + (end - begin) / 2;
+    std::nth_element(begin, mid, end, CenterLess(nodes_, axis));
+  }
+
+  const NodeIndex c0 = buildTopDown(begin, mid, level);
+  const NodeIndex c1 = buildTopDown(mid, end, level);
+  const NodeIndex i = allocateNode();
+
+  Node& node = nodes_[i];
+  node.children[0] = c0;
+  node.children[1] = c1;
+  node.bv = nodes_[c0].bv + nodes_[c1].bv;
+  node.height = 1 + std::max(nodes_[c0].height, nodes_[c1].height);
+  nodes_[c0].parent = i;
+  nodes_[c1].parent = i;
+  return i;
+}
+
+} // namespace detail
+
+}
+
+} // namespace hpp
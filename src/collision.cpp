@@ -38,9 +38,14 @@
 
 #include <hpp/fcl/collision.h>
 #include <hpp/fcl/collision_func_matrix.h>
+#include <hpp/fcl/thread_pool.h>
 #include <hpp/fcl/narrowphase/narrowphase.h>
+#include "traversal/traversal_node_setup.h"
+#include <../src/collision_node.h>
 
+#include <algorithm>
 #include <iostream>
+#include <boost/shared_ptr.hpp>
 
 namespace hpp
 {
@@ -70,6 +75,31 @@ void invertResults(CollisionResult& result)
     }
 }
 
+namespace
+{
+  /// Look up the collision function between o1 and o2
+  /// @retval swap whether the function must be called with o2 first, in which
+  ///         case the result must be reordered by invertResults.
+  /// @return the function, NULL if the pair of objects is not supported.
+  CollisionFunctionMatrix::CollisionFunc getCollisionFunction
+  (const CollisionGeometry* o1, const CollisionGeometry* o2, bool& swap)
+  {
+    const CollisionFunctionMatrix& looktable = getCollisionFunctionLookTable();
+    OBJECT_TYPE object_type1 = o1->getObjectType();
+    OBJECT_TYPE object_type2 = o2->getObjectType();
+    NODE_TYPE node_type1 = o1->getNodeType();
+    NODE_TYPE node_type2 = o2->getNodeType();
+
+    swap = (object_type1 == OT_GEOM && object_type2 == OT_BVH);
+    CollisionFunctionMatrix::CollisionFunc func = swap ?
+      looktable.collision_matrix[node_type2][node_type1] :
+      looktable.collision_matrix[node_type1][node_type2];
+    if(!func)
+      std::cerr << "Warning: collision function between node type " << node_type1 << " and node type " << node_type2 << " is not supported"<< std::endl;
+    return func;
+  }
+}
+
 std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1,
                     const CollisionGeometry* o2, const Transform3f& tf2,
                     const GJKSolver* nsolver_,
@@ -80,7 +110,6 @@ std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1,
   if(!nsolver_)
     nsolver = new GJKSolver();  
 
-  const CollisionFunctionMatrix& looktable = getCollisionFunctionLookTable();
   result.distance_lower_bound = -1;
   std::size_t res; 
   if(request.num_max_contacts == 0)
@@ -90,34 +119,18 @@ std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1,
   }
   else
   {
-    OBJECT_TYPE object_type1 = o1->getObjectType();
-    OBJECT_TYPE object_type2 = o2->getObjectType();
-    NODE_TYPE node_type1 = o1->getNodeType();
-    NODE_TYPE node_type2 = o2->getNodeType();
-  
-    if(object_type1 == OT_GEOM && object_type2 == OT_BVH)
-    {  
-      if(!looktable.collision_matrix[node_type2][node_type1])
-      {
-        std::cerr << "Warning: collision function between node type " << node_type1 << " and node type " << node_type2 << " is not supported"<< std::endl;
-        res = 0;
-      }
-      else
-      {
-        res = looktable.collision_matrix[node_type2][node_type1](o2, tf2, o1, tf1, nsolver, request, result);
-        invertResults(result);
-      }
-    }
-    else
+    bool swap;
+    CollisionFunctionMatrix::CollisionFunc func =
+      getCollisionFunction(o1, o2, swap);
+    if(!func)
+      res = 0;
+    else if(swap)
     {
-      if(!looktable.collision_matrix[node_type1][node_type2])
-      {
-        std::cerr << "Warning: collision function between node type " << node_type1 << " and node type " << node_type2 << " is not supported"<< std::endl;
-        res = 0;
-      }
-      else
-        res = looktable.collision_matrix[node_type1][node_type2](o1, tf1, o2, tf2, nsolver, request, result);
+      res = func(o2, tf2, o1, tf1, nsolver, request, result);
+      invertResults(result);
     }
+    else
+      res = func(o1, tf1, o2, tf2, nsolver, request, result);
   }
 
   if(!nsolver_)
@@ -166,6 +179,200 @@ std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1,
   }
 }
 
+std::size_t collide(const CollisionGeometry* o1,
+                    const std::vector<Transform3f>& tf1,
+                    const CollisionGeometry* o2, const Transform3f& tf2,
+                    const CollisionRequest& request,
+                    std::vector<CollisionResult>& results,
+                    bool stopAtFirstCollision)
+{
+  if(request.num_max_contacts == 0)
+  {
+    std::cerr << "Warning: should stop early as num_max_contact is " << request.num_max_contacts << " !" << std::endl;
+    results.clear();
+    return tf1.size();
+  }
+  if(request.gjk_solver_type != GST_INDEP)
+  {
+    std::cerr << "Warning! Invalid GJK solver" << std::endl;
+    results.clear();
+    return tf1.size();
+  }
+
+  bool swap;
+  CollisionFunctionMatrix::CollisionFunc func =
+    getCollisionFunction(o1, o2, swap);
+  if(!func)
+  {
+    results.clear();
+    return tf1.size();
+  }
+
+  results.resize(tf1.size());
+
+  // Successive configurations are close to each other: the separating
+  // direction found by GJK is a good initial guess for the next one.
+  GJKSolver solver;
+  solver.enableCachedGuess(true);
+  if(request.enable_cached_gjk_guess)
+    solver.setCachedGuess(request.cached_gjk_guess);
+
+  std::size_t first = tf1.size();
+  for(std::size_t i = 0; i < tf1.size(); ++i)
+  {
+    CollisionResult& result = results[i];
+    result.clear();
+    result.distance_lower_bound = -1;
+    std::size_t res;
+    if(swap)
+    {
+      res = func(o2, tf2, o1, tf1[i], &solver, request, result);
+      invertResults(result);
+    }
+    else
+      res = func(o1, tf1[i], o2, tf2, &solver, request, result);
+
+    if(res > 0 && first == tf1.size())
+    {
+      first = i;
+      if(stopAtFirstCollision)
+      {
+        results.resize(i + 1);
+        break;
+      }
+    }
+  }
+  return first;
+}
+
+namespace
+{
+  /// Collision tests of a range of pairs, with one solver per thread.
+  struct CollideTask : ThreadPool::Task
+  {
+    CollideTask(const std::vector<CollisionObjectPair>& pairs_,
+                const CollisionRequest& request_,
+                std::vector<CollisionResult>& results_,
+                std::size_t num_threads) :
+      pairs(pairs_), request(request_), results(results_),
+      solvers(num_threads), num_collisions(num_threads, 0)
+    {}
+
+    void run(std::size_t begin, std::size_t end, std::size_t thread_id)
+    {
+      const GJKSolver* solver = &solvers[thread_id];
+      for(std::size_t i = begin; i < end; ++i)
+      {
+        results[i].clear();
+        if(collide(pairs[i].first, pairs[i].second, solver, request,
+                   results[i]) > 0)
+          ++num_collisions[thread_id];
+      }
+    }
+
+    const std::vector<CollisionObjectPair>& pairs;
+    const CollisionRequest& request;
+    std::vector<CollisionResult>& results;
+    std::vector<GJKSolver> solvers;
+    std::vector<std::size_t> num_collisions;
+  };
+}
+
+std::size_t collide(const std::vector<CollisionObjectPair>& pairs,
+                    const CollisionRequest& request,
+                    std::vector<CollisionResult>& results,
+                    ThreadPool& pool)
+{
+  results.resize(pairs.size());
+  if(request.gjk_solver_type != GST_INDEP)
+  {
+    std::cerr << "Warning! Invalid GJK solver" << std::endl;
+    return 0;
+  }
+
+  // Build the look up table before starting the threads.
+  getCollisionFunctionLookTable();
+
+  CollideTask task(pairs, request, results, pool.size());
+  pool.parallelFor(pairs.size(), task,
+                   std::max<std::size_t>(1, pairs.size() / (64 * pool.size())));
+
+  std::size_t res = 0;
+  for(std::size_t i = 0; i < task.num_collisions.size(); ++i)
+    res += task.num_collisions[i];
+  return res;
+}
+
+namespace
+{
+  /// Collision between two meshes, with one traversal node per thread.
+  template<typename T_BVH>
+  std::size_t parallelMeshCollide(const CollisionGeometry* o1,
+                                  const Transform3f& tf1,
+                                  const CollisionGeometry* o2,
+                                  const Transform3f& tf2,
+                                  const CollisionRequest& request,
+                                  CollisionResult& result, ThreadPool& pool)
+  {
+    typedef MeshCollisionTraversalNode<T_BVH, 0> Node;
+    if(request.isSatisfied(result)) return result.numContacts();
+
+    const BVHModel<T_BVH>* obj1 = static_cast<const BVHModel<T_BVH>* >(o1);
+    const BVHModel<T_BVH>* obj2 = static_cast<const BVHModel<T_BVH>* >(o2);
+
+    // One node per thread, each one set up from the models.
+    std::vector<boost::shared_ptr<Node> > threadNodes;
+    std::vector<CollisionTraversalNodeBase*> nodes;
+    for(std::size_t i = 0; i < pool.size(); ++i)
+    {
+      threadNodes.push_back(boost::shared_ptr<Node>(new Node(request)));
+      initialize(*threadNodes.back(), *obj1, tf1, *obj2, tf2, result);
+      nodes.push_back(threadNodes.back().get());
+    }
+    collide(nodes, result, pool);
+    return result.numContacts();
+  }
+}
+
+std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1,
+                    const CollisionGeometry* o2, const Transform3f& tf2,
+                    const CollisionRequest& request, CollisionResult& result,
+                    ThreadPool& pool)
+{
+  if(pool.size() > 1 && request.num_max_contacts > 0 &&
+     o1->getObjectType() == OT_BVH && o2->getObjectType() == OT_BVH &&
+     o1->getNodeType() == o2->getNodeType())
+  {
+    result.distance_lower_bound = -1;
+    switch(o1->getNodeType())
+    {
+    case BV_AABB:
+      return parallelMeshCollide<AABB>(o1, tf1, o2, tf2, request, result, pool);
+    case BV_OBB:
+      return parallelMeshCollide<OBB>(o1, tf1, o2, tf2, request, result, pool);
+    case BV_RSS:
+      return parallelMeshCollide<RSS>(o1, tf1, o2, tf2, request, result, pool);
+    case BV_kIOS:
+      return parallelMeshCollide<kIOS>(o1, tf1, o2, tf2, request, result, pool);
+    case BV_OBBRSS:
+      return parallelMeshCollide<OBBRSS>(o1, tf1, o2, tf2, request, result,
+                                         pool);
+    case BV_KDOP16:
+      return parallelMeshCollide<KDOP<16> >(o1, tf1, o2, tf2, request, result,
+                                            pool);
+    case BV_KDOP18:
+      return parallelMeshCollide<KDOP<18> >(o1, tf1, o2, tf2, request, result,
+                                            pool);
+    case BV_KDOP24:
+      return parallelMeshCollide<KDOP<24> >(o1, tf1, o2, tf2, request, result,
+                                            pool);
+    default:
+      break;
+    }
+  }
+  return collide(o1, tf1, o2, tf2, request, result);
+}
+
 }
 
 
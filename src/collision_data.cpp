@@ -62,7 +62,9 @@ bool DistanceRequest::isSatisfied(const DistanceResult& result) const
     enable_distance_lower_bound (enable_distance_lower_bound_),
     gjk_solver_type(gjk_solver_type_),
     security_margin (0),
-    break_distance (1e-3)
+    break_distance (1e-3),
+    front (NULL),
+    gjk_cache (NULL)
   {
     enable_cached_gjk_guess = false;
     cached_gjk_guess = Vec3f(1, 0, 0);
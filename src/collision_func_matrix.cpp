@@ -42,6 +42,8 @@
 #include <../src/collision_node.h>
 #include <hpp/fcl/narrowphase/narrowphase.h>
 #include "distance_func_matrix.h"
+#include "sdf_solver.h"
+#include "hfield_solver.h"
 
 namespace hpp
 {
@@ -138,6 +140,100 @@ std::size_t BVHOcTreeCollide(const CollisionGeometry* o1, const Transform3f& tf1
 
 #endif
 
+std::size_t SDFShapeCollide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                            const GJKSolver*,
+                            const CollisionRequest& request, CollisionResult& result)
+{
+  if(request.isSatisfied(result)) return result.numContacts();
+
+  SDFSolver solver (true);
+  return solver.shapeIntersect(static_cast<const SignedDistanceField*>(o1), tf1,
+                               static_cast<const ShapeBase*>(o2), tf2, request, result);
+}
+
+std::size_t ShapeSDFCollide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                            const GJKSolver*,
+                            const CollisionRequest& request, CollisionResult& result)
+{
+  if(request.isSatisfied(result)) return result.numContacts();
+
+  SDFSolver solver (false);
+  return solver.shapeIntersect(static_cast<const SignedDistanceField*>(o2), tf2,
+                               static_cast<const ShapeBase*>(o1), tf1, request, result);
+}
+
+template<typename T_BVH>
+std::size_t SDFBVHCollide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                          const GJKSolver*,
+                          const CollisionRequest& request, CollisionResult& result)
+{
+  if(request.isSatisfied(result)) return result.numContacts();
+
+  SDFSolver solver (true);
+  return solver.meshIntersect(static_cast<const SignedDistanceField*>(o1), tf1,
+                              static_cast<const BVHModel<T_BVH>*>(o2), tf2, request, result);
+}
+
+template<typename T_BVH>
+std::size_t BVHSDFCollide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                          const GJKSolver*,
+                          const CollisionRequest& request, CollisionResult& result)
+{
+  if(request.isSatisfied(result)) return result.numContacts();
+
+  SDFSolver solver (false);
+  return solver.meshIntersect(static_cast<const SignedDistanceField*>(o2), tf2,
+                              static_cast<const BVHModel<T_BVH>*>(o1), tf1, request, result);
+}
+
+template<typename T_SH>
+std::size_t HFieldShapeCollide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                               const GJKSolver* nsolver,
+                               const CollisionRequest& request, CollisionResult& result)
+{
+  if(request.isSatisfied(result)) return result.numContacts();
+
+  HeightFieldSolver solver (nsolver, true);
+  return solver.shapeIntersect(static_cast<const HeightField*>(o1), tf1,
+                               static_cast<const T_SH*>(o2), tf2, request, result);
+}
+
+template<typename T_SH>
+std::size_t ShapeHFieldCollide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                               const GJKSolver* nsolver,
+                               const CollisionRequest& request, CollisionResult& result)
+{
+  if(request.isSatisfied(result)) return result.numContacts();
+
+  HeightFieldSolver solver (nsolver, false);
+  return solver.shapeIntersect(static_cast<const HeightField*>(o2), tf2,
+                               static_cast<const T_SH*>(o1), tf1, request, result);
+}
+
+template<typename T_BVH>
+std::size_t HFieldBVHCollide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                             const GJKSolver* nsolver,
+                             const CollisionRequest& request, CollisionResult& result)
+{
+  if(request.isSatisfied(result)) return result.numContacts();
+
+  HeightFieldSolver solver (nsolver, true);
+  return solver.meshIntersect(static_cast<const HeightField*>(o1), tf1,
+                              static_cast<const BVHModel<T_BVH>*>(o2), tf2, request, result);
+}
+
+template<typename T_BVH>
+std::size_t BVHHFieldCollide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                             const GJKSolver* nsolver,
+                             const CollisionRequest& request, CollisionResult& result)
+{
+  if(request.isSatisfied(result)) return result.numContacts();
+
+  HeightFieldSolver solver (nsolver, false);
+  return solver.meshIntersect(static_cast<const HeightField*>(o2), tf2,
+                              static_cast<const BVHModel<T_BVH>*>(o1), tf1, request, result);
+}
+
 template<typename T_SH1, typename T_SH2>
 std::size_t ShapeShapeCollide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2, 
                               const GJKSolver* nsolver,
@@ -147,6 +243,7 @@ std::size_t ShapeShapeCollide(const CollisionGeometry* o1, const Transform3f& tf
 
   DistanceResult distanceResult;
   DistanceRequest distanceRequest (request.enable_contact);
+  distanceRequest.gjk_cache = request.gjk_cache;
   FCL_REAL distance = ShapeShapeDistance <T_SH1, T_SH2>
     (o1, tf1, o2, tf2, nsolver, distanceRequest, distanceResult);
 
@@ -178,29 +275,6 @@ std::size_t ShapeShapeCollide(const CollisionGeometry* o1, const Transform3f& tf
   return 0;
 }
 
-template<typename T_BVH, typename T_SH>
-struct BVHShapeCollider
-{
-  static std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2, 
-                             const GJKSolver* nsolver,
-                             const CollisionRequest& request, CollisionResult& result)
-  {
-    if(request.isSatisfied(result)) return result.numContacts();
-
-    MeshShapeCollisionTraversalNode<T_BVH, T_SH> node (request);
-    const BVHModel<T_BVH>* obj1 = static_cast<const BVHModel<T_BVH>* >(o1);
-    BVHModel<T_BVH>* obj1_tmp = new BVHModel<T_BVH>(*obj1);
-    Transform3f tf1_tmp = tf1;
-    const T_SH* obj2 = static_cast<const T_SH*>(o2);
-
-    initialize(node, *obj1_tmp, tf1_tmp, *obj2, tf2, nsolver, result);
-    fcl::collide(&node, request, result);
-
-    delete obj1_tmp;
-    return result.numContacts();
-  }
-};
-
 namespace details
 {
 
@@ -216,12 +290,25 @@ std::size_t orientedBVHShapeCollide(const CollisionGeometry* o1, const Transform
   const T_SH* obj2 = static_cast<const T_SH*>(o2);
 
   initialize(node, *obj1, tf1, *obj2, tf2, nsolver, result);
-  fcl::collide(&node, request, result);
+  fcl::collide(&node, request, result, getFrontList(request.front, o1, o2));
   return result.numContacts();
 }
 
 }
 
+/// The mesh is not transformed: its bounding volumes are tested in the frame
+/// of the shape.
+template<typename T_BVH, typename T_SH>
+struct BVHShapeCollider
+{
+  static std::size_t collide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2, 
+                             const GJKSolver* nsolver,
+                             const CollisionRequest& request, CollisionResult& result)
+  {
+    return details::orientedBVHShapeCollide<MeshShapeCollisionTraversalNode<T_BVH, T_SH, 0>, T_BVH, T_SH>(o1, tf1, o2, tf2, nsolver, request, result);
+  }
+};
+
 
 template<typename T_SH>
 struct BVHShapeCollider<OBB, T_SH>
@@ -271,28 +358,6 @@ struct BVHShapeCollider<OBBRSS, T_SH>
 };
 
 
-template<typename T_BVH>
-std::size_t BVHCollide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2, const CollisionRequest& request, CollisionResult& result)
-{
-  if(request.isSatisfied(result)) return result.numContacts();
-  
-  MeshCollisionTraversalNode<T_BVH> node (request);
-  const BVHModel<T_BVH>* obj1 = static_cast<const BVHModel<T_BVH>* >(o1);
-  const BVHModel<T_BVH>* obj2 = static_cast<const BVHModel<T_BVH>* >(o2);
-  BVHModel<T_BVH>* obj1_tmp = new BVHModel<T_BVH>(*obj1);
-  Transform3f tf1_tmp = tf1;
-  BVHModel<T_BVH>* obj2_tmp = new BVHModel<T_BVH>(*obj2);
-  Transform3f tf2_tmp = tf2;
-  
-  initialize(node, *obj1_tmp, tf1_tmp, *obj2_tmp, tf2_tmp, result);
-  fcl::collide(&node, request, result);
-
-  delete obj1_tmp;
-  delete obj2_tmp;
-
-  return result.numContacts();
-}
-
 namespace details
 {
 template<typename OrientedMeshCollisionTraversalNode, typename T_BVH>
@@ -305,13 +370,21 @@ std::size_t orientedMeshCollide(const CollisionGeometry* o1, const Transform3f&
   const BVHModel<T_BVH>* obj2 = static_cast<const BVHModel<T_BVH>* >(o2);
 
   initialize(node, *obj1, tf1, *obj2, tf2, result);
-  collide(&node, request, result);
+  collide(&node, request, result, getFrontList(request.front, o1, o2));
 
   return result.numContacts();
 }
 
 }
 
+/// The meshes are not transformed: the bounding volumes of the second mesh
+/// are tested in the frame of the first one.
+template<typename T_BVH>
+std::size_t BVHCollide(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2, const CollisionRequest& request, CollisionResult& result)
+{
+  return details::orientedMeshCollide<MeshCollisionTraversalNode<T_BVH, 0>, T_BVH>(o1, tf1, o2, tf2, request, result);
+}
+
 template<>
 std::size_t BVHCollide<OBB>(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2, const CollisionRequest& request, CollisionResult& result)
 {
@@ -541,6 +614,78 @@ CollisionFunctionMatrix::CollisionFunctionMatrix()
   collision_matrix[BV_KDOP18][GEOM_OCTREE] = &BVHOcTreeCollide<KDOP<18> >;
   collision_matrix[BV_KDOP24][GEOM_OCTREE] = &BVHOcTreeCollide<KDOP<24> >;
 #endif
+
+  collision_matrix[GEOM_SDF][GEOM_BOX] = &SDFShapeCollide;
+  collision_matrix[GEOM_SDF][GEOM_SPHERE] = &SDFShapeCollide;
+  collision_matrix[GEOM_SDF][GEOM_CAPSULE] = &SDFShapeCollide;
+  collision_matrix[GEOM_SDF][GEOM_CONE] = &SDFShapeCollide;
+  collision_matrix[GEOM_SDF][GEOM_CYLINDER] = &SDFShapeCollide;
+  collision_matrix[GEOM_SDF][GEOM_CONVEX] = &SDFShapeCollide;
+  collision_matrix[GEOM_SDF][GEOM_TRIANGLE] = &SDFShapeCollide;
+
+  collision_matrix[GEOM_BOX][GEOM_SDF] = &ShapeSDFCollide;
+  collision_matrix[GEOM_SPHERE][GEOM_SDF] = &ShapeSDFCollide;
+  collision_matrix[GEOM_CAPSULE][GEOM_SDF] = &ShapeSDFCollide;
+  collision_matrix[GEOM_CONE][GEOM_SDF] = &ShapeSDFCollide;
+  collision_matrix[GEOM_CYLINDER][GEOM_SDF] = &ShapeSDFCollide;
+  collision_matrix[GEOM_CONVEX][GEOM_SDF] = &ShapeSDFCollide;
+  collision_matrix[GEOM_TRIANGLE][GEOM_SDF] = &ShapeSDFCollide;
+
+  collision_matrix[GEOM_SDF][BV_AABB] = &SDFBVHCollide<AABB>;
+  collision_matrix[GEOM_SDF][BV_OBB] = &SDFBVHCollide<OBB>;
+  collision_matrix[GEOM_SDF][BV_RSS] = &SDFBVHCollide<RSS>;
+  collision_matrix[GEOM_SDF][BV_OBBRSS] = &SDFBVHCollide<OBBRSS>;
+  collision_matrix[GEOM_SDF][BV_kIOS] = &SDFBVHCollide<kIOS>;
+  collision_matrix[GEOM_SDF][BV_KDOP16] = &SDFBVHCollide<KDOP<16> >;
+  collision_matrix[GEOM_SDF][BV_KDOP18] = &SDFBVHCollide<KDOP<18> >;
+  collision_matrix[GEOM_SDF][BV_KDOP24] = &SDFBVHCollide<KDOP<24> >;
+
+  collision_matrix[BV_AABB][GEOM_SDF] = &BVHSDFCollide<AABB>;
+  collision_matrix[BV_OBB][GEOM_SDF] = &BVHSDFCollide<OBB>;
+  collision_matrix[BV_RSS][GEOM_SDF] = &BVHSDFCollide<RSS>;
+  collision_matrix[BV_OBBRSS][GEOM_SDF] = &BVHSDFCollide<OBBRSS>;
+  collision_matrix[BV_kIOS][GEOM_SDF] = &BVHSDFCollide<kIOS>;
+  collision_matrix[BV_KDOP16][GEOM_SDF] = &BVHSDFCollide<KDOP<16> >;
+  collision_matrix[BV_KDOP18][GEOM_SDF] = &BVHSDFCollide<KDOP<18> >;
+  collision_matrix[BV_KDOP24][GEOM_SDF] = &BVHSDFCollide<KDOP<24> >;
+
+  collision_matrix[GEOM_HFIELD][GEOM_BOX] = &HFieldShapeCollide<Box>;
+  collision_matrix[GEOM_HFIELD][GEOM_SPHERE] = &HFieldShapeCollide<Sphere>;
+  collision_matrix[GEOM_HFIELD][GEOM_CAPSULE] = &HFieldShapeCollide<Capsule>;
+  collision_matrix[GEOM_HFIELD][GEOM_CONE] = &HFieldShapeCollide<Cone>;
+  collision_matrix[GEOM_HFIELD][GEOM_CYLINDER] = &HFieldShapeCollide<Cylinder>;
+  collision_matrix[GEOM_HFIELD][GEOM_CONVEX] = &HFieldShapeCollide<ConvexBase>;
+  collision_matrix[GEOM_HFIELD][GEOM_PLANE] = &HFieldShapeCollide<Plane>;
+  collision_matrix[GEOM_HFIELD][GEOM_HALFSPACE] = &HFieldShapeCollide<Halfspace>;
+  collision_matrix[GEOM_HFIELD][GEOM_TRIANGLE] = &HFieldShapeCollide<TriangleP>;
+
+  collision_matrix[GEOM_BOX][GEOM_HFIELD] = &ShapeHFieldCollide<Box>;
+  collision_matrix[GEOM_SPHERE][GEOM_HFIELD] = &ShapeHFieldCollide<Sphere>;
+  collision_matrix[GEOM_CAPSULE][GEOM_HFIELD] = &ShapeHFieldCollide<Capsule>;
+  collision_matrix[GEOM_CONE][GEOM_HFIELD] = &ShapeHFieldCollide<Cone>;
+  collision_matrix[GEOM_CYLINDER][GEOM_HFIELD] = &ShapeHFieldCollide<Cylinder>;
+  collision_matrix[GEOM_CONVEX][GEOM_HFIELD] = &ShapeHFieldCollide<ConvexBase>;
+  collision_matrix[GEOM_PLANE][GEOM_HFIELD] = &ShapeHFieldCollide<Plane>;
+  collision_matrix[GEOM_HALFSPACE][GEOM_HFIELD] = &ShapeHFieldCollide<Halfspace>;
+  collision_matrix[GEOM_TRIANGLE][GEOM_HFIELD] = &ShapeHFieldCollide<TriangleP>;
+
+  collision_matrix[GEOM_HFIELD][BV_AABB] = &HFieldBVHCollide<AABB>;
+  collision_matrix[GEOM_HFIELD][BV_OBB] = &HFieldBVHCollide<OBB>;
+  collision_matrix[GEOM_HFIELD][BV_RSS] = &HFieldBVHCollide<RSS>;
+  collision_matrix[GEOM_HFIELD][BV_OBBRSS] = &HFieldBVHCollide<OBBRSS>;
+  collision_matrix[GEOM_HFIELD][BV_kIOS] = &HFieldBVHCollide<kIOS>;
+  collision_matrix[GEOM_HFIELD][BV_KDOP16] = &HFieldBVHCollide<KDOP<16> >;
+  collision_matrix[GEOM_HFIELD][BV_KDOP18] = &HFieldBVHCollide<KDOP<18> >;
+  collision_matrix[GEOM_HFIELD][BV_KDOP24] = &HFieldBVHCollide<KDOP<24> >;
+
+  collision_matrix[BV_AABB][GEOM_HFIELD] = &BVHHFieldCollide<AABB>;
+  collision_matrix[BV_OBB][GEOM_HFIELD] = &BVHHFieldCollide<OBB>;
+  collision_matrix[BV_RSS][GEOM_HFIELD] = &BVHHFieldCollide<RSS>;
+  collision_matrix[BV_OBBRSS][GEOM_HFIELD] = &BVHHFieldCollide<OBBRSS>;
+  collision_matrix[BV_kIOS][GEOM_HFIELD] = &BVHHFieldCollide<kIOS>;
+  collision_matrix[BV_KDOP16][GEOM_HFIELD] = &BVHHFieldCollide<KDOP<16> >;
+  collision_matrix[BV_KDOP18][GEOM_HFIELD] = &BVHHFieldCollide<KDOP<18> >;
+  collision_matrix[BV_KDOP24][GEOM_HFIELD] = &BVHHFieldCollide<KDOP<24> >;
 }
 //template struct CollisionFunctionMatrix;
 }
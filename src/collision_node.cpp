@@ -44,36 +44,20 @@ namespace hpp
 namespace fcl
 {
 
-void collide(CollisionTraversalNodeBase* node,
-             const CollisionRequest& request, CollisionResult& result,
-	     BVHFrontList* front_list,
-             bool recursive)
+void collide(const std::vector<CollisionTraversalNodeBase*>& nodes,
+             CollisionResult& result, ThreadPool& pool)
 {
-  if(front_list && front_list->size() > 0)
-  {
-    propagateBVHFrontListCollisionRecurse(node, request, result, front_list);
-  }
-  else
-  {
-    FCL_REAL sqrDistLowerBound=0;
-    if (recursive)
-      collisionRecurse(node, 0, 0, front_list, sqrDistLowerBound);
-    else
-      collisionNonRecurse(node, front_list, sqrDistLowerBound);
-    result.distance_lower_bound = sqrt (sqrDistLowerBound);
-  }
+  FCL_REAL sqrDistLowerBound=0;
+  collisionParallel(nodes, pool, result, sqrDistLowerBound);
+  result.distance_lower_bound = sqrt (sqrDistLowerBound);
 }
 
-void distance(DistanceTraversalNodeBase* node, BVHFrontList* front_list, int qsize)
+void distance(const std::vector<DistanceTraversalNodeBase*>& nodes,
+              ThreadPool& pool, int qsize)
 {
-  node->preprocess();
-  
-  if(qsize <= 2)
-    distanceRecurse(node, 0, 0, front_list);
-  else
-    distanceQueueRecurse(node, 0, 0, front_list, qsize);
-
-  node->postprocess();
+  nodes[0]->preprocess();
+  distanceParallel(nodes, pool, qsize);
+  nodes[0]->postprocess();
 }
 
 }
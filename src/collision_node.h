@@ -40,9 +40,12 @@
 
 /// @cond INTERNAL
 
+#include <vector>
+#include <hpp/fcl/fwd.hh>
 #include <hpp/fcl/BVH/BVH_front.h>
 #include "traversal/traversal_node_base.h"
 #include "traversal/traversal_node_bvhs.h"
+#include "traversal/traversal_recurse.h"
 
 /// @brief collision and distance function on traversal nodes. these functions provide a higher level abstraction for collision functions provided in collision_func_matrix
 namespace hpp
@@ -53,17 +56,58 @@ namespace fcl
 
 /// collision on collision traversal node
 /// 
-/// @param node node containing both objects to test,
+/// @param node node containing both objects to test, see collisionRecurse
+///        for the requirements on Node.
 /// @retval squared lower bound to the distance between the objects if they
 ///         do not collide.
 /// @param front_list list of nodes visited by the query, can be used to
 ///        accelerate computation
-void collide(CollisionTraversalNodeBase* node, const CollisionRequest& request,
+template<typename Node>
+void collide(Node* node, const CollisionRequest& /*request*/,
              CollisionResult& result, BVHFrontList* front_list = NULL,
-             bool recursive = true);
+             bool recursive = true)
+{
+  FCL_REAL sqrDistLowerBound=0;
+  if(front_list && front_list->size() > 0)
+    propagateBVHFrontListCollisionRecurse(node, front_list, sqrDistLowerBound);
+  else if (recursive)
+    collisionRecurse(node, 0, 0, front_list, sqrDistLowerBound);
+  else
+    collisionNonRecurse(node, front_list, sqrDistLowerBound);
+  result.distance_lower_bound = sqrt (sqrDistLowerBound);
+}
 
 /// @brief distance computation on distance traversal node; can use front list to accelerate
-void distance(DistanceTraversalNodeBase* node, BVHFrontList* front_list = NULL, int qsize = 2);
+template<typename Node>
+void distance(Node* node, BVHFrontList* front_list = NULL, int qsize = 2)
+{
+  node->preprocess();
+  
+  if(front_list && front_list->size() > 0)
+    propagateBVHFrontListDistanceRecurse(node, front_list);
+  else if(qsize <= 2)
+    distanceRecurse(node, 0, 0, front_list);
+  else
+    distanceQueueRecurse(node, 0, 0, front_list, qsize);
+
+  node->postprocess();
+}
+
+/// collision on collision traversal nodes, the traversal being shared among
+/// the threads of pool
+///
+/// @param nodes one node per thread of pool, all initialized on the same
+///        objects and with the same result.
+void collide(const std::vector<CollisionTraversalNodeBase*>& nodes,
+             CollisionResult& result, ThreadPool& pool);
+
+/// @brief distance computation on distance traversal nodes, the traversal
+/// being shared among the threads of pool
+///
+/// @param nodes one node per thread of pool, all initialized on the same
+///        objects and with the same result.
+void distance(const std::vector<DistanceTraversalNodeBase*>& nodes,
+              ThreadPool& pool, int qsize = 2);
 }
 
 } // namespace hpp
@@ -38,8 +38,14 @@
 #include <hpp/fcl/distance.h>
 #include <hpp/fcl/distance_func_matrix.h>
 #include <hpp/fcl/narrowphase/narrowphase.h>
+#include <hpp/fcl/thread_pool.h>
+#include "traversal/traversal_node_setup.h"
+#include <../src/collision_node.h>
 
+#include <algorithm>
 #include <iostream>
+#include <limits>
+#include <boost/shared_ptr.hpp>
 
 namespace hpp
 {
@@ -52,6 +58,44 @@ DistanceFunctionMatrix& getDistanceFunctionLookTable()
   return table;
 }
 
+namespace
+{
+  /// Look up the distance function between o1 and o2
+  /// @retval swap whether the function must be called with o2 first, in which
+  ///         case the result must be reordered by swapResult.
+  /// @return the function, NULL if the pair of objects is not supported.
+  DistanceFunctionMatrix::DistanceFunc getDistanceFunction
+  (const CollisionGeometry* o1, const CollisionGeometry* o2, bool& swap)
+  {
+    const DistanceFunctionMatrix& looktable = getDistanceFunctionLookTable();
+    OBJECT_TYPE object_type1 = o1->getObjectType();
+    NODE_TYPE node_type1 = o1->getNodeType();
+    OBJECT_TYPE object_type2 = o2->getObjectType();
+    NODE_TYPE node_type2 = o2->getNodeType();
+
+    swap = (object_type1 == OT_GEOM && object_type2 == OT_BVH);
+    DistanceFunctionMatrix::DistanceFunc func = swap ?
+      looktable.distance_matrix[node_type2][node_type1] :
+      looktable.distance_matrix[node_type1][node_type2];
+    if(!func)
+      std::cerr << "Warning: distance function between node type " << node_type1 << " and node type " << node_type2 << " is not supported" << std::endl;
+    return func;
+  }
+
+  /// If closest points are requested, switch object 1 and 2
+  void swapResult(const DistanceRequest& request, DistanceResult& result)
+  {
+    if (request.enable_nearest_points) {
+      const CollisionGeometry *tmpo = result.o1;
+      result.o1 = result.o2;
+      result.o2 = tmpo;
+      Vec3f tmpn (result.nearest_points [0]);
+      result.nearest_points [0] = result.nearest_points [1];
+      result.nearest_points [1] = tmpn;
+    }
+  }
+}
+
 FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1, 
                   const CollisionGeometry* o2, const Transform3f& tf2,
                   const GJKSolver* nsolver_,
@@ -61,45 +105,19 @@ FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1,
   if(!nsolver_) 
     nsolver = new GJKSolver();
 
-  const DistanceFunctionMatrix& looktable = getDistanceFunctionLookTable();
-
-  OBJECT_TYPE object_type1 = o1->getObjectType();
-  NODE_TYPE node_type1 = o1->getNodeType();
-  OBJECT_TYPE object_type2 = o2->getObjectType();
-  NODE_TYPE node_type2 = o2->getNodeType();
-
   FCL_REAL res = std::numeric_limits<FCL_REAL>::max();
 
-  if(object_type1 == OT_GEOM && object_type2 == OT_BVH)
+  bool swap;
+  DistanceFunctionMatrix::DistanceFunc func = getDistanceFunction(o1, o2, swap);
+  if(func)
   {
-    if(!looktable.distance_matrix[node_type2][node_type1])
+    if(swap)
     {
-      std::cerr << "Warning: distance function between node type " << node_type1 << " and node type " << node_type2 << " is not supported" << std::endl;
+      res = func(o2, tf2, o1, tf1, nsolver, request, result);
+      swapResult(request, result);
     }
     else
-    {
-      res = looktable.distance_matrix[node_type2][node_type1](o2, tf2, o1, tf1, nsolver, request, result);
-      // If closest points are requested, switch object 1 and 2
-      if (request.enable_nearest_points) {
-	const CollisionGeometry *tmpo = result.o1;
-	result.o1 = result.o2;
-	result.o2 = tmpo;
-	Vec3f tmpn (result.nearest_points [0]);
-	result.nearest_points [0] = result.nearest_points [1];
-	result.nearest_points [1] = tmpn;
-      }
-    }
-  }
-  else
-  {
-    if(!looktable.distance_matrix[node_type1][node_type2])
-    {
-      std::cerr << "Warning: distance function between node type " << node_type1 << " and node type " << node_type2 << " is not supported" << std::endl;
-    }
-    else
-    {
-      res = looktable.distance_matrix[node_type1][node_type2](o1, tf1, o2, tf2, nsolver, request, result);    
-    }
+      res = func(o1, tf1, o2, tf2, nsolver, request, result);
   }
 
   if(!nsolver_)
@@ -145,6 +163,175 @@ FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1,
   }
 }
 
+FCL_REAL distance(const CollisionGeometry* o1,
+                  const std::vector<Transform3f>& tf1,
+                  const CollisionGeometry* o2, const Transform3f& tf2,
+                  const DistanceRequest& request,
+                  std::vector<DistanceResult>& results,
+                  bool stopAtFirstCollision)
+{
+  FCL_REAL res = std::numeric_limits<FCL_REAL>::max();
+  if(request.gjk_solver_type != GST_INDEP)
+  {
+    results.clear();
+    return -1;
+  }
+
+  bool swap;
+  DistanceFunctionMatrix::DistanceFunc func = getDistanceFunction(o1, o2, swap);
+  if(!func)
+  {
+    results.clear();
+    return res;
+  }
+
+  // Successive configurations are close to each other: the separating
+  // direction found by GJK is a good initial guess for the next one.
+  GJKSolver solver;
+  solver.enableCachedGuess(true);
+
+  results.resize(tf1.size());
+  for(std::size_t i = 0; i < tf1.size(); ++i)
+  {
+    DistanceResult& result = results[i];
+    result.clear();
+    FCL_REAL d;
+    if(swap)
+    {
+      d = func(o2, tf2, o1, tf1[i], &solver, request, result);
+      swapResult(request, result);
+    }
+    else
+      d = func(o1, tf1[i], o2, tf2, &solver, request, result);
+
+    if(d < res) res = d;
+    if(stopAtFirstCollision && d <= 0)
+    {
+      results.resize(i + 1);
+      break;
+    }
+  }
+  return res;
+}
+
+namespace
+{
+  /// Distance computations of a range of pairs, with one solver per thread.
+  struct DistanceTask : ThreadPool::Task
+  {
+    DistanceTask(const std::vector<CollisionObjectPair>& pairs_,
+                 const DistanceRequest& request_,
+                 std::vector<DistanceResult>& results_,
+                 std::size_t num_threads) :
+      pairs(pairs_), request(request_), results(results_),
+      solvers(num_threads),
+      min_distances(num_threads, std::numeric_limits<FCL_REAL>::max())
+    {}
+
+    void run(std::size_t begin, std::size_t end, std::size_t thread_id)
+    {
+      const GJKSolver* solver = &solvers[thread_id];
+      for(std::size_t i = begin; i < end; ++i)
+      {
+        results[i].clear();
+        FCL_REAL d = distance(pairs[i].first, pairs[i].second, solver,
+                              request, results[i]);
+        if(d < min_distances[thread_id])
+          min_distances[thread_id] = d;
+      }
+    }
+
+    const std::vector<CollisionObjectPair>& pairs;
+    const DistanceRequest& request;
+    std::vector<DistanceResult>& results;
+    std::vector<GJKSolver> solvers;
+    std::vector<FCL_REAL> min_distances;
+  };
+}
+
+FCL_REAL distance(const std::vector<CollisionObjectPair>& pairs,
+                  const DistanceRequest& request,
+                  std::vector<DistanceResult>& results,
+                  ThreadPool& pool)
+{
+  results.resize(pairs.size());
+  if(request.gjk_solver_type != GST_INDEP)
+    return -1;
+
+  // Build the look up table before starting the threads.
+  getDistanceFunctionLookTable();
+
+  DistanceTask task(pairs, request, results, pool.size());
+  pool.parallelFor(pairs.size(), task,
+                   std::max<std::size_t>(1, pairs.size() / (64 * pool.size())));
+
+  return *std::min_element(task.min_distances.begin(),
+                           task.min_distances.end());
+}
+
+
+namespace
+{
+  /// Distance between two meshes, with one traversal node per thread.
+  template<typename Node, typename T_BVH>
+  FCL_REAL parallelMeshDistance(const CollisionGeometry* o1,
+                                const Transform3f& tf1,
+                                const CollisionGeometry* o2,
+                                const Transform3f& tf2,
+                                const DistanceRequest& request,
+                                DistanceResult& result, ThreadPool& pool)
+  {
+    if(request.isSatisfied(result)) return result.min_distance;
+
+    const BVHModel<T_BVH>* obj1 = static_cast<const BVHModel<T_BVH>* >(o1);
+    const BVHModel<T_BVH>* obj2 = static_cast<const BVHModel<T_BVH>* >(o2);
+
+    // One node per thread, each one set up from the models.
+    std::vector<boost::shared_ptr<Node> > threadNodes;
+    std::vector<DistanceTraversalNodeBase*> nodes;
+    for(std::size_t i = 0; i < pool.size(); ++i)
+    {
+      threadNodes.push_back(boost::shared_ptr<Node>(new Node()));
+      initialize(*threadNodes.back(), *obj1, tf1, *obj2, tf2, request, result);
+      nodes.push_back(threadNodes.back().get());
+    }
+    distance(nodes, pool);
+    return result.min_distance;
+  }
+}
+
+FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1,
+                  const CollisionGeometry* o2, const Transform3f& tf2,
+                  const DistanceRequest& request, DistanceResult& result,
+                  ThreadPool& pool)
+{
+  if(pool.size() > 1 &&
+     o1->getObjectType() == OT_BVH && o2->getObjectType() == OT_BVH &&
+     o1->getNodeType() == o2->getNodeType())
+  {
+    switch(o1->getNodeType())
+    {
+    case BV_AABB:
+      return parallelMeshDistance<MeshDistanceTraversalNode<AABB, 0>, AABB>
+        (o1, tf1, o2, tf2, request, result, pool);
+    case BV_OBB:
+      return parallelMeshDistance<MeshDistanceTraversalNode<OBB, 0>, OBB>
+        (o1, tf1, o2, tf2, request, result, pool);
+    case BV_RSS:
+      return parallelMeshDistance<MeshDistanceTraversalNodeRSS, RSS>
+        (o1, tf1, o2, tf2, request, result, pool);
+    case BV_kIOS:
+      return parallelMeshDistance<MeshDistanceTraversalNodekIOS, kIOS>
+        (o1, tf1, o2, tf2, request, result, pool);
+    case BV_OBBRSS:
+      return parallelMeshDistance<MeshDistanceTraversalNodeOBBRSS, OBBRSS>
+        (o1, tf1, o2, tf2, request, result, pool);
+    default:
+      break;
+    }
+  }
+  return distance(o1, tf1, o2, tf2, request, result);
+}
 
 }
 
@@ -340,6 +340,7 @@ namespace fcl {
       const Vec3f& p2 = distanceResult.nearest_points [1];
       contact.pos = .5*(p1+p2);
       contact.normal = (p2-p1)/(p2-p1).norm ();
+      contact.penetration_depth = -distance;
       result.addContact (contact);
       return 1;
     }
@@ -39,6 +39,8 @@
 
 #include <../src/collision_node.h>
 #include "traversal/traversal_node_setup.h"
+#include "sdf_solver.h"
+#include "hfield_solver.h"
 
 namespace hpp
 {
@@ -127,6 +129,100 @@ FCL_REAL OcTreeBVHDistance(const CollisionGeometry* o1, const Transform3f& tf1,
 
 #endif
 
+FCL_REAL SDFShapeDistance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                          const GJKSolver*,
+                          const DistanceRequest& request, DistanceResult& result)
+{
+  if(request.isSatisfied(result)) return result.min_distance;
+
+  SDFSolver solver (true);
+  return solver.shapeDistance(static_cast<const SignedDistanceField*>(o1), tf1,
+                              static_cast<const ShapeBase*>(o2), tf2, request, result);
+}
+
+FCL_REAL ShapeSDFDistance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                          const GJKSolver*,
+                          const DistanceRequest& request, DistanceResult& result)
+{
+  if(request.isSatisfied(result)) return result.min_distance;
+
+  SDFSolver solver (false);
+  return solver.shapeDistance(static_cast<const SignedDistanceField*>(o2), tf2,
+                              static_cast<const ShapeBase*>(o1), tf1, request, result);
+}
+
+template<typename T_BVH>
+FCL_REAL SDFBVHDistance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                        const GJKSolver*,
+                        const DistanceRequest& request, DistanceResult& result)
+{
+  if(request.isSatisfied(result)) return result.min_distance;
+
+  SDFSolver solver (true);
+  return solver.meshDistance(static_cast<const SignedDistanceField*>(o1), tf1,
+                             static_cast<const BVHModel<T_BVH>*>(o2), tf2, request, result);
+}
+
+template<typename T_BVH>
+FCL_REAL BVHSDFDistance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                        const GJKSolver*,
+                        const DistanceRequest& request, DistanceResult& result)
+{
+  if(request.isSatisfied(result)) return result.min_distance;
+
+  SDFSolver solver (false);
+  return solver.meshDistance(static_cast<const SignedDistanceField*>(o2), tf2,
+                             static_cast<const BVHModel<T_BVH>*>(o1), tf1, request, result);
+}
+
+template<typename T_SH>
+FCL_REAL HFieldShapeDistance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                             const GJKSolver* nsolver,
+                             const DistanceRequest& request, DistanceResult& result)
+{
+  if(request.isSatisfied(result)) return result.min_distance;
+
+  HeightFieldSolver solver (nsolver, true);
+  return solver.shapeDistance(static_cast<const HeightField*>(o1), tf1,
+                              static_cast<const T_SH*>(o2), tf2, request, result);
+}
+
+template<typename T_SH>
+FCL_REAL ShapeHFieldDistance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                             const GJKSolver* nsolver,
+                             const DistanceRequest& request, DistanceResult& result)
+{
+  if(request.isSatisfied(result)) return result.min_distance;
+
+  HeightFieldSolver solver (nsolver, false);
+  return solver.shapeDistance(static_cast<const HeightField*>(o2), tf2,
+                              static_cast<const T_SH*>(o1), tf1, request, result);
+}
+
+template<typename T_BVH>
+FCL_REAL HFieldBVHDistance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                           const GJKSolver* nsolver,
+                           const DistanceRequest& request, DistanceResult& result)
+{
+  if(request.isSatisfied(result)) return result.min_distance;
+
+  HeightFieldSolver solver (nsolver, true);
+  return solver.meshDistance(static_cast<const HeightField*>(o1), tf1,
+                             static_cast<const BVHModel<T_BVH>*>(o2), tf2, request, result);
+}
+
+template<typename T_BVH>
+FCL_REAL BVHHFieldDistance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                           const GJKSolver* nsolver,
+                           const DistanceRequest& request, DistanceResult& result)
+{
+  if(request.isSatisfied(result)) return result.min_distance;
+
+  HeightFieldSolver solver (nsolver, false);
+  return solver.meshDistance(static_cast<const HeightField*>(o2), tf2,
+                             static_cast<const BVHModel<T_BVH>*>(o1), tf1, request, result);
+}
+
 template<typename T_SH1, typename T_SH2>
 FCL_REAL ShapeShapeDistance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2, const GJKSolver* nsolver,
                         const DistanceRequest& request, DistanceResult& result)
@@ -142,27 +238,6 @@ FCL_REAL ShapeShapeDistance(const CollisionGeometry* o1, const Transform3f& tf1,
   return result.min_distance;
 }
 
-template<typename T_BVH, typename T_SH>
-struct BVHShapeDistancer
-{
-  static FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2, const GJKSolver* nsolver,
-                           const DistanceRequest& request, DistanceResult& result)
-  {
-    if(request.isSatisfied(result)) return result.min_distance;
-    MeshShapeDistanceTraversalNode<T_BVH, T_SH> node;
-    const BVHModel<T_BVH>* obj1 = static_cast<const BVHModel<T_BVH>* >(o1);
-    BVHModel<T_BVH>* obj1_tmp = new BVHModel<T_BVH>(*obj1);
-    Transform3f tf1_tmp = tf1;
-    const T_SH* obj2 = static_cast<const T_SH*>(o2);
-
-    initialize(node, *obj1_tmp, tf1_tmp, *obj2, tf2, nsolver, request, result);
-    fcl::distance(&node);
-    
-    delete obj1_tmp;
-    return result.min_distance;
-  }
-};
-
 namespace details
 {
 
@@ -176,13 +251,25 @@ FCL_REAL orientedBVHShapeDistance(const CollisionGeometry* o1, const Transform3f
   const T_SH* obj2 = static_cast<const T_SH*>(o2);
 
   initialize(node, *obj1, tf1, *obj2, tf2, nsolver, request, result);
-  fcl::distance(&node);
+  fcl::distance(&node, getFrontList(request.front, o1, o2));
 
   return result.min_distance;  
 }
 
 }
 
+/// The mesh is not transformed: its bounding volumes are tested in the frame
+/// of the shape.
+template<typename T_BVH, typename T_SH>
+struct BVHShapeDistancer
+{
+  static FCL_REAL distance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2, const GJKSolver* nsolver,
+                           const DistanceRequest& request, DistanceResult& result)
+  {
+    return details::orientedBVHShapeDistance<MeshShapeDistanceTraversalNode<T_BVH, T_SH, 0>, T_BVH, T_SH>(o1, tf1, o2, tf2, nsolver, request, result);
+  }
+};
+
 template<typename T_SH>
 struct BVHShapeDistancer<RSS, T_SH>
 {
@@ -215,27 +302,6 @@ struct BVHShapeDistancer<OBBRSS, T_SH>
 };
 
 
-template<typename T_BVH>
-FCL_REAL BVHDistance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
-                     const DistanceRequest& request, DistanceResult& result)
-{
-  if(request.isSatisfied(result)) return result.min_distance;
-  MeshDistanceTraversalNode<T_BVH> node;
-  const BVHModel<T_BVH>* obj1 = static_cast<const BVHModel<T_BVH>* >(o1);
-  const BVHModel<T_BVH>* obj2 = static_cast<const BVHModel<T_BVH>* >(o2);
-  BVHModel<T_BVH>* obj1_tmp = new BVHModel<T_BVH>(*obj1);
-  Transform3f tf1_tmp = tf1;
-  BVHModel<T_BVH>* obj2_tmp = new BVHModel<T_BVH>(*obj2);
-  Transform3f tf2_tmp = tf2;
-
-  initialize(node, *obj1_tmp, tf1_tmp, *obj2_tmp, tf2_tmp, request, result);
-  distance(&node);
-  delete obj1_tmp;
-  delete obj2_tmp;
-  
-  return result.min_distance;
-}
-
 namespace details
 {
 template<typename OrientedMeshDistanceTraversalNode, typename T_BVH>
@@ -248,13 +314,22 @@ FCL_REAL orientedMeshDistance(const CollisionGeometry* o1, const Transform3f& tf
   const BVHModel<T_BVH>* obj2 = static_cast<const BVHModel<T_BVH>* >(o2);
 
   initialize(node, *obj1, tf1, *obj2, tf2, request, result);
-  distance(&node);
+  distance(&node, getFrontList(request.front, o1, o2));
 
   return result.min_distance;
 }
 
 }
 
+/// The meshes are not transformed: the bounding volumes of the second mesh
+/// are tested in the frame of the first one.
+template<typename T_BVH>
+FCL_REAL BVHDistance(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
+                     const DistanceRequest& request, DistanceResult& result)
+{
+  return details::orientedMeshDistance<MeshDistanceTraversalNode<T_BVH, 0>, T_BVH>(o1, tf1, o2, tf2, request, result);
+}
+
 template<>
 FCL_REAL BVHDistance<RSS>(const CollisionGeometry* o1, const Transform3f& tf1, const CollisionGeometry* o2, const Transform3f& tf2,
                           const DistanceRequest& request, DistanceResult& result)
@@ -366,8 +441,6 @@ DistanceFunctionMatrix::DistanceFunctionMatrix()
   distance_matrix[GEOM_HALFSPACE][GEOM_PLANE] = &ShapeShapeDistance<Halfspace, Plane>;
   distance_matrix[GEOM_HALFSPACE][GEOM_HALFSPACE] = &ShapeShapeDistance<Halfspace, Halfspace>;
 
-  /* AABB distance not implemented */
-  /*
   distance_matrix[BV_AABB][GEOM_BOX] = &BVHShapeDistancer<AABB, Box>::distance;
   distance_matrix[BV_AABB][GEOM_SPHERE] = &BVHShapeDistancer<AABB, Sphere>::distance;
   distance_matrix[BV_AABB][GEOM_CAPSULE] = &BVHShapeDistancer<AABB, Capsule>::distance;
@@ -376,7 +449,6 @@ DistanceFunctionMatrix::DistanceFunctionMatrix()
   distance_matrix[BV_AABB][GEOM_CONVEX] = &BVHShapeDistancer<AABB, ConvexBase>::distance;
   distance_matrix[BV_AABB][GEOM_PLANE] = &BVHShapeDistancer<AABB, Plane>::distance;
   distance_matrix[BV_AABB][GEOM_HALFSPACE] = &BVHShapeDistancer<AABB, Halfspace>::distance;
-  */
 
   distance_matrix[BV_OBB][GEOM_BOX] = &BVHShapeDistancer<OBB, Box>::distance;
   distance_matrix[BV_OBB][GEOM_SPHERE] = &BVHShapeDistancer<OBB, Sphere>::distance;
@@ -490,6 +562,78 @@ DistanceFunctionMatrix::DistanceFunctionMatrix()
   distance_matrix[BV_KDOP24][GEOM_OCTREE] = &BVHOcTreeDistance<KDOP<24> >;
 #endif
 
+  distance_matrix[GEOM_SDF][GEOM_BOX] = &SDFShapeDistance;
+  distance_matrix[GEOM_SDF][GEOM_SPHERE] = &SDFShapeDistance;
+  distance_matrix[GEOM_SDF][GEOM_CAPSULE] = &SDFShapeDistance;
+  distance_matrix[GEOM_SDF][GEOM_CONE] = &SDFShapeDistance;
+  distance_matrix[GEOM_SDF][GEOM_CYLINDER] = &SDFShapeDistance;
+  distance_matrix[GEOM_SDF][GEOM_CONVEX] = &SDFShapeDistance;
+  distance_matrix[GEOM_SDF][GEOM_TRIANGLE] = &SDFShapeDistance;
+
+  distance_matrix[GEOM_BOX][GEOM_SDF] = &ShapeSDFDistance;
+  distance_matrix[GEOM_SPHERE][GEOM_SDF] = &ShapeSDFDistance;
+  distance_matrix[GEOM_CAPSULE][GEOM_SDF] = &ShapeSDFDistance;
+  distance_matrix[GEOM_CONE][GEOM_SDF] = &ShapeSDFDistance;
+  distance_matrix[GEOM_CYLINDER][GEOM_SDF] = &ShapeSDFDistance;
+  distance_matrix[GEOM_CONVEX][GEOM_SDF] = &ShapeSDFDistance;
+  distance_matrix[GEOM_TRIANGLE][GEOM_SDF] = &ShapeSDFDistance;
+
+  distance_matrix[GEOM_SDF][BV_AABB] = &SDFBVHDistance<AABB>;
+  distance_matrix[GEOM_SDF][BV_OBB] = &SDFBVHDistance<OBB>;
+  distance_matrix[GEOM_SDF][BV_RSS] = &SDFBVHDistance<RSS>;
+  distance_matrix[GEOM_SDF][BV_OBBRSS] = &SDFBVHDistance<OBBRSS>;
+  distance_matrix[GEOM_SDF][BV_kIOS] = &SDFBVHDistance<kIOS>;
+  distance_matrix[GEOM_SDF][BV_KDOP16] = &SDFBVHDistance<KDOP<16> >;
+  distance_matrix[GEOM_SDF][BV_KDOP18] = &SDFBVHDistance<KDOP<18> >;
+  distance_matrix[GEOM_SDF][BV_KDOP24] = &SDFBVHDistance<KDOP<24> >;
+
+  distance_matrix[BV_AABB][GEOM_SDF] = &BVHSDFDistance<AABB>;
+  distance_matrix[BV_OBB][GEOM_SDF] = &BVHSDFDistance<OBB>;
+  distance_matrix[BV_RSS][GEOM_SDF] = &BVHSDFDistance<RSS>;
+  distance_matrix[BV_OBBRSS][GEOM_SDF] = &BVHSDFDistance<OBBRSS>;
+  distance_matrix[BV_kIOS][GEOM_SDF] = &BVHSDFDistance<kIOS>;
+  distance_matrix[BV_KDOP16][GEOM_SDF] = &BVHSDFDistance<KDOP<16> >;
+  distance_matrix[BV_KDOP18][GEOM_SDF] = &BVHSDFDistance<KDOP<18> >;
+  distance_matrix[BV_KDOP24][GEOM_SDF] = &BVHSDFDistance<KDOP<24> >;
+
+  distance_matrix[GEOM_HFIELD][GEOM_BOX] = &HFieldShapeDistance<Box>;
+  distance_matrix[GEOM_HFIELD][GEOM_SPHERE] = &HFieldShapeDistance<Sphere>;
+  distance_matrix[GEOM_HFIELD][GEOM_CAPSULE] = &HFieldShapeDistance<Capsule>;
+  distance_matrix[GEOM_HFIELD][GEOM_CONE] = &HFieldShapeDistance<Cone>;
+  distance_matrix[GEOM_HFIELD][GEOM_CYLINDER] = &HFieldShapeDistance<Cylinder>;
+  distance_matrix[GEOM_HFIELD][GEOM_CONVEX] = &HFieldShapeDistance<ConvexBase>;
+  distance_matrix[GEOM_HFIELD][GEOM_PLANE] = &HFieldShapeDistance<Plane>;
+  distance_matrix[GEOM_HFIELD][GEOM_HALFSPACE] = &HFieldShapeDistance<Halfspace>;
+  distance_matrix[GEOM_HFIELD][GEOM_TRIANGLE] = &HFieldShapeDistance<TriangleP>;
+
+  distance_matrix[GEOM_BOX][GEOM_HFIELD] = &ShapeHFieldDistance<Box>;
+  distance_matrix[GEOM_SPHERE][GEOM_HFIELD] = &ShapeHFieldDistance<Sphere>;
+  distance_matrix[GEOM_CAPSULE][GEOM_HFIELD] = &ShapeHFieldDistance<Capsule>;
+  distance_matrix[GEOM_CONE][GEOM_HFIELD] = &ShapeHFieldDistance<Cone>;
+  distance_matrix[GEOM_CYLINDER][GEOM_HFIELD] = &ShapeHFieldDistance<Cylinder>;
+  distance_matrix[GEOM_CONVEX][GEOM_HFIELD] = &ShapeHFieldDistance<ConvexBase>;
+  distance_matrix[GEOM_PLANE][GEOM_HFIELD] = &ShapeHFieldDistance<Plane>;
+  distance_matrix[GEOM_HALFSPACE][GEOM_HFIELD] = &ShapeHFieldDistance<Halfspace>;
+  distance_matrix[GEOM_TRIANGLE][GEOM_HFIELD] = &ShapeHFieldDistance<TriangleP>;
+
+  distance_matrix[GEOM_HFIELD][BV_AABB] = &HFieldBVHDistance<AABB>;
+  distance_matrix[GEOM_HFIELD][BV_OBB] = &HFieldBVHDistance<OBB>;
+  distance_matrix[GEOM_HFIELD][BV_RSS] = &HFieldBVHDistance<RSS>;
+  distance_matrix[GEOM_HFIELD][BV_OBBRSS] = &HFieldBVHDistance<OBBRSS>;
+  distance_matrix[GEOM_HFIELD][BV_kIOS] = &HFieldBVHDistance<kIOS>;
+  distance_matrix[GEOM_HFIELD][BV_KDOP16] = &HFieldBVHDistance<KDOP<16> >;
+  distance_matrix[GEOM_HFIELD][BV_KDOP18] = &HFieldBVHDistance<KDOP<18> >;
+  distance_matrix[GEOM_HFIELD][BV_KDOP24] = &HFieldBVHDistance<KDOP<24> >;
+
+  distance_matrix[BV_AABB][GEOM_HFIELD] = &BVHHFieldDistance<AABB>;
+  distance_matrix[BV_OBB][GEOM_HFIELD] = &BVHHFieldDistance<OBB>;
+  distance_matrix[BV_RSS][GEOM_HFIELD] = &BVHHFieldDistance<RSS>;
+  distance_matrix[BV_OBBRSS][GEOM_HFIELD] = &BVHHFieldDistance<OBBRSS>;
+  distance_matrix[BV_kIOS][GEOM_HFIELD] = &BVHHFieldDistance<kIOS>;
+  distance_matrix[BV_KDOP16][GEOM_HFIELD] = &BVHHFieldDistance<KDOP<16> >;
+  distance_matrix[BV_KDOP18][GEOM_HFIELD] = &BVHHFieldDistance<KDOP<18> >;
+  distance_matrix[BV_KDOP24][GEOM_HFIELD] = &BVHHFieldDistance<KDOP<24> >;
+
 
 }
 //template struct DistanceFunctionMatrix;
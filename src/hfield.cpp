@@ -0,0 +1,125 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <limits>
+#include <stdexcept>
+
+#include <hpp/fcl/hfield.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+HeightField::HeightField(FCL_REAL x_dim_, FCL_REAL y_dim_, int nx, int ny,
+                         const std::vector<FCL_REAL>& heights_) :
+  CollisionGeometry(),
+  x_dim (x_dim_),
+  y_dim (y_dim_),
+  heights (heights_)
+{
+  if(x_dim <= 0 || y_dim <= 0)
+    throw std::invalid_argument("The dimensions of a height field must be positive.");
+  if(nx < 2 || ny < 2)
+    throw std::invalid_argument("A height field needs at least 2 samples along each axis.");
+  if(heights.size() != (std::size_t) nx * ny)
+    throw std::invalid_argument("The number of heights does not match the size of the height field.");
+
+  dims[0] = nx;
+  dims[1] = ny;
+  origin[0] = -.5 * x_dim;
+  origin[1] = -.5 * y_dim;
+  step[0] = x_dim / (nx - 1);
+  step[1] = y_dim / (ny - 1);
+
+  // Level 0: the bounds of the cells.
+  Level level;
+  level.dims[0] = nx - 1;
+  level.dims[1] = ny - 1;
+  level.offset = 0;
+  levels.push_back(level);
+  for(int j = 0; j < ny - 1; ++j)
+  {
+    for(int i = 0; i < nx - 1; ++i)
+    {
+      const FCL_REAL
+        h00 = getHeight(i, j), h10 = getHeight(i + 1, j),
+        h01 = getHeight(i, j + 1), h11 = getHeight(i + 1, j + 1);
+      min_heights.push_back(std::min(std::min(h00, h10), std::min(h01, h11)));
+      max_heights.push_back(std::max(std::max(h00, h10), std::max(h01, h11)));
+    }
+  }
+
+  // Upper levels: the bounds of 2 x 2 blocks of nodes of the level below.
+  while(level.dims[0] > 1 || level.dims[1] > 1)
+  {
+    const Level below (level);
+    level.dims[0] = (below.dims[0] + 1) / 2;
+    level.dims[1] = (below.dims[1] + 1) / 2;
+    level.offset = min_heights.size();
+    levels.push_back(level);
+    for(int j = 0; j < level.dims[1]; ++j)
+    {
+      for(int i = 0; i < level.dims[0]; ++i)
+      {
+        FCL_REAL lo = std::numeric_limits<FCL_REAL>::max(), hi = -lo;
+        for(int b = 2 * j; b < std::min(2 * j + 2, below.dims[1]); ++b)
+        {
+          for(int a = 2 * i; a < std::min(2 * i + 2, below.dims[0]); ++a)
+          {
+            const std::size_t n = below.offset + (std::size_t) a +
+              (std::size_t) below.dims[0] * (std::size_t) b;
+            lo = std::min(lo, min_heights[n]);
+            hi = std::max(hi, max_heights[n]);
+          }
+        }
+        min_heights.push_back(lo);
+        max_heights.push_back(hi);
+      }
+    }
+  }
+
+  computeLocalAABB();
+}
+
+void HeightField::computeLocalAABB()
+{
+  getNodeBV(getNumLevels() - 1, 0, 0, aabb_local);
+  aabb_center = aabb_local.center();
+  aabb_radius = (aabb_local.min_ - aabb_center).norm();
+}
+
+}
+
+} // namespace hpp
@@ -0,0 +1,549 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_HFIELD_SOLVER_H
+#define HPP_FCL_HFIELD_SOLVER_H
+
+/// @cond INTERNAL
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include <hpp/fcl/hfield.h>
+#include <hpp/fcl/collision_data.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/BV/BV.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/narrowphase/narrowphase.h>
+
+#include "shape/geometric_shapes_utility.h"
+#include "intersect.h"
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace details
+{
+
+/// @brief Lower bound of the distance between an axis aligned box and an
+///        oriented box, given the axis aligned box containing the latter.
+///
+/// The boxes are separated along the axes of both boxes.
+inline FCL_REAL boxDistanceLowerBound(const AABB& box, const OBB& obb,
+                                      const AABB& obb_box)
+{
+  FCL_REAL bound = box.distance(obb_box);
+  const Vec3f center (.5 * (box.min_ + box.max_)),
+              half_side (.5 * (box.max_ - box.min_));
+  for(int j = 0; j < 3; ++j)
+  {
+    const FCL_REAL separation =
+      std::fabs(obb.axes.col(j).dot(obb.To - center)) - obb.extent[j] -
+      obb.axes.col(j).cwiseAbs().dot(half_side);
+    bound = std::max(bound, separation);
+  }
+  return bound;
+}
+
+/// @brief Lower bound of the distance between a shape and boxes, all of
+///        them in the frame of a height field.
+template<typename S>
+class HeightFieldShapeBound
+{
+public:
+  /// @param tf pose of the shape in the frame of the height field
+  HeightFieldShapeBound(const S& shape, const Transform3f& tf)
+  {
+    computeBV<AABB>(shape, tf, box);
+    AABB local;
+    computeBV<AABB>(shape, Transform3f(), local);
+    obb.axes = tf.getRotation();
+    obb.To = tf.transform(local.center());
+    obb.extent = .5 * (local.max_ - local.min_);
+  }
+
+  FCL_REAL operator()(const AABB& bv) const
+  {
+    return boxDistanceLowerBound(bv, obb, box);
+  }
+
+private:
+  AABB box;
+  /// @brief local AABB of the shape
+  OBB obb;
+};
+
+/// @brief The bounding box of a half space is unbounded, the distance of
+///        the corners of the boxes to its boundary is used instead.
+template<>
+class HeightFieldShapeBound<Halfspace>
+{
+public:
+  HeightFieldShapeBound(const Halfspace& shape, const Transform3f& tf) :
+    halfspace (transform(shape, tf))
+  {}
+
+  FCL_REAL operator()(const AABB& bv) const
+  {
+    return halfspace.signedDistance(bv.center()) -
+      .5 * halfspace.n.cwiseAbs().dot(bv.max_ - bv.min_);
+  }
+
+private:
+  Halfspace halfspace;
+};
+
+template<>
+class HeightFieldShapeBound<Plane>
+{
+public:
+  HeightFieldShapeBound(const Plane& shape, const Transform3f& tf) :
+    plane (transform(shape, tf))
+  {}
+
+  FCL_REAL operator()(const AABB& bv) const
+  {
+    return std::max(plane.distance(bv.center()) -
+                    .5 * plane.n.cwiseAbs().dot(bv.max_ - bv.min_),
+                    (FCL_REAL) 0);
+  }
+
+private:
+  Plane plane;
+};
+
+}
+
+/// @brief Collision and distance queries between a height field and shapes
+///        or meshes.
+///
+/// The implicit hierarchy of the height field is traversed from its root,
+/// closest node first, and the nodes whose bounding box is too far from
+/// the other object are discarded. The bounding volumes of a mesh are
+/// compared to the boxes of the height field through their OBB expressed in
+/// the frame of the height field, the largest of the two nodes being split
+/// first. At the leaves, the two triangles of a cell are tested against the
+/// shape with GJKSolver::shapeTriangleInteraction, or against a triangle of
+/// the mesh like in MeshCollisionTraversalNode.
+class HeightFieldSolver
+{
+public:
+  /// @param hfield_first whether the height field is the first object of
+  ///        the query, which gives the order of the objects in the results.
+  HeightFieldSolver(const GJKSolver* nsolver, bool hfield_first) :
+    nsolver_ (nsolver), hfield_first_ (hfield_first)
+  {}
+
+  /// @brief distance between a height field and a shape
+  template<typename S>
+  FCL_REAL shapeDistance(const HeightField* hfield, const Transform3f& tf1,
+                         const S* shape, const Transform3f& tf2,
+                         const DistanceRequest& request,
+                         DistanceResult& result) const
+  {
+    DistanceVisitor visitor = { this, hfield, shape, &request, &result };
+    traverseShape(*shape, tf1, tf2, visitor);
+    return result.min_distance;
+  }
+
+  /// @brief collision between a height field and a shape
+  template<typename S>
+  std::size_t shapeIntersect(const HeightField* hfield, const Transform3f& tf1,
+                             const S* shape, const Transform3f& tf2,
+                             const CollisionRequest& request,
+                             CollisionResult& result) const
+  {
+    CollisionVisitor visitor = { this, hfield, shape, &request, &result,
+                                 std::numeric_limits<FCL_REAL>::max(), 0 };
+    traverseShape(*shape, tf1, tf2, visitor);
+    if(visitor.count == 0)
+      result.distance_lower_bound = visitor.lower_bound;
+    return visitor.count;
+  }
+
+  /// @brief distance between a height field and a mesh
+  template<typename BV>
+  FCL_REAL meshDistance(const HeightField* hfield, const Transform3f& tf1,
+                        const BVHModel<BV>* model, const Transform3f& tf2,
+                        const DistanceRequest& request,
+                        DistanceResult& result) const
+  {
+    DistanceVisitor visitor = { this, hfield, model, &request, &result };
+    traverseMesh(*model, tf1, tf2, visitor);
+    return result.min_distance;
+  }
+
+  /// @brief collision between a height field and a mesh
+  template<typename BV>
+  std::size_t meshIntersect(const HeightField* hfield, const Transform3f& tf1,
+                            const BVHModel<BV>* model, const Transform3f& tf2,
+                            const CollisionRequest& request,
+                            CollisionResult& result) const
+  {
+    CollisionVisitor visitor = { this, hfield, model, &request, &result,
+                                 std::numeric_limits<FCL_REAL>::max(), 0 };
+    traverseMesh(*model, tf1, tf2, visitor);
+    if(visitor.count == 0)
+      result.distance_lower_bound = visitor.lower_bound;
+    return visitor.count;
+  }
+
+private:
+  /// The points of the leaf tests are in the world frame, p1 being on the
+  /// height field and p2 on the other object, and the normal goes from the
+  /// height field to the other object.
+  struct DistanceVisitor
+  {
+    const HeightFieldSolver* solver;
+    const HeightField* hfield;
+    const CollisionGeometry* other;
+    const DistanceRequest* request;
+    DistanceResult* result;
+
+    /// Penetration of meshes is not computed, like for the distance
+    /// between two meshes.
+    bool penetration() const { return false; }
+    FCL_REAL threshold() const { return result->min_distance; }
+    void discard(FCL_REAL) {}
+    bool visit(int id, int b, FCL_REAL distance, const Vec3f& p1,
+               const Vec3f& p2, const Vec3f& normal)
+    {
+      if(distance < result->min_distance)
+      {
+        if(solver->hfield_first_)
+          result->update(distance, hfield, other, id, b, p1, p2, normal);
+        else
+          result->update(distance, other, hfield, b, id, p2, p1, -normal);
+      }
+      return request->isSatisfied(*result);
+    }
+  };
+
+  struct CollisionVisitor
+  {
+    const HeightFieldSolver* solver;
+    const HeightField* hfield;
+    const CollisionGeometry* other;
+    const CollisionRequest* request;
+    CollisionResult* result;
+    FCL_REAL lower_bound;
+    std::size_t count;
+
+    bool penetration() const { return true; }
+    /// The bounds of the nodes do not tell how deep the objects overlap:
+    /// nodes are only discarded if they are separated.
+    FCL_REAL threshold() const
+    {
+      return std::max(request->security_margin, (FCL_REAL) 0);
+    }
+    void discard(FCL_REAL bound) { lower_bound = std::min(lower_bound, bound); }
+    bool visit(int id, int b, FCL_REAL distance, const Vec3f& p1,
+               const Vec3f& p2, const Vec3f& normal)
+    {
+      if(distance > request->security_margin)
+      {
+        discard(distance);
+        return false;
+      }
+      ++count;
+      if(result->numContacts() < request->num_max_contacts)
+      {
+        const Vec3f pos ((distance > 0) ? Vec3f(.5 * (p1 + p2)) : p1);
+        if(solver->hfield_first_)
+          result->addContact(Contact(hfield, other, id, b, pos, normal,
+                                     -distance));
+        else
+          result->addContact(Contact(other, hfield, b, id, pos, -normal,
+                                     -distance));
+      }
+      return request->isSatisfied(*result);
+    }
+  };
+
+  /// @brief A node of the hierarchy of the height field, or of a mesh when
+  ///        level is negative, and the lower bound of its distance to the
+  ///        other object.
+  struct Node
+  {
+    int level, i, j;
+    AABB bv;
+    /// @brief the bounding volume of a mesh node, bv being its AABB
+    OBB obb;
+    FCL_REAL bound;
+
+    bool operator<(const Node& other) const { return bound < other.bound; }
+  };
+
+  /// @brief Children of a node of the height field, closest first.
+  /// @return the number of children
+  template<typename Bound>
+  static int children(const HeightField& hfield, const Node& node,
+                      const Bound& bound, Node* nodes)
+  {
+    const int level = node.level - 1;
+    int n = 0;
+    for(int j = 2 * node.j;
+        j < std::min(2 * node.j + 2, hfield.getLevelSize(level, 1)); ++j)
+    {
+      for(int i = 2 * node.i;
+          i < std::min(2 * node.i + 2, hfield.getLevelSize(level, 0)); ++i)
+      {
+        Node& child = nodes[n++];
+        child.level = level;
+        child.i = i;
+        child.j = j;
+        hfield.getNodeBV(level, i, j, child.bv);
+        child.bound = bound(child.bv);
+      }
+    }
+    std::sort(nodes, nodes + n);
+    return n;
+  }
+
+  static Node root(const HeightField& hfield)
+  {
+    Node node;
+    node.level = hfield.getNumLevels() - 1;
+    node.i = node.j = 0;
+    hfield.getNodeBV(node.level, 0, 0, node.bv);
+    node.bound = 0;
+    return node;
+  }
+
+  template<typename S, typename Visitor>
+  void traverseShape(const S& shape, const Transform3f& tf1,
+                     const Transform3f& tf2, Visitor& visitor) const
+  {
+    const details::HeightFieldShapeBound<S> bound (shape,
+                                                   tf1.inverseTimes(tf2));
+    Node node (root(*visitor.hfield));
+    node.bound = bound(node.bv);
+    if(node.bound > visitor.threshold())
+      visitor.discard(node.bound);
+    else
+      traverseShape(shape, tf1, tf2, bound, node, visitor);
+  }
+
+  /// @return whether the visitor stopped the search
+  template<typename S, typename Visitor>
+  bool traverseShape(const S& shape, const Transform3f& tf1,
+                     const Transform3f& tf2,
+                     const details::HeightFieldShapeBound<S>& bound,
+                     const Node& node, Visitor& visitor) const
+  {
+    const HeightField& hfield = *visitor.hfield;
+    if(node.level == 0)
+    {
+      const int cell = node.i + (hfield.getSize(0) - 1) * node.j;
+      for(int id = 2 * cell; id < 2 * cell + 2; ++id)
+      {
+        Vec3f P1, P2, P3, p1, p2, normal;
+        FCL_REAL distance;
+        hfield.getTriangle(id, P1, P2, P3);
+        // normal goes from the shape to the triangle when they collide.
+        if(nsolver_->shapeTriangleInteraction(shape, tf2, P1, P2, P3, tf1,
+                                              distance, p2, p1, normal))
+          normal = -normal;
+        else
+          normal = (p2 - p1).normalized();
+        if(visitor.visit(id, Contact::NONE, distance, p1, p2, normal))
+          return true;
+      }
+      return false;
+    }
+
+    Node nodes[4];
+    const int n = children(hfield, node, bound, nodes);
+    for(int k = 0; k < n; ++k)
+    {
+      if(nodes[k].bound > visitor.threshold())
+        visitor.discard(nodes[k].bound);
+      else if(traverseShape(shape, tf1, tf2, bound, nodes[k], visitor))
+        return true;
+    }
+    return false;
+  }
+
+  /// @brief bounding boxes of a node of a mesh
+  /// @param tf pose of the mesh in the frame of the height field
+  template<typename BV>
+  static void meshBV(const BVHModel<BV>& model, const Transform3f& tf,
+                     Node& node)
+  {
+    OBB& obb = node.obb;
+    convertBV(model.getBV(node.i).bv, tf, obb);
+    const Vec3f r (obb.axes.cwiseAbs() * obb.extent);
+    node.bv.min_ = obb.To - r;
+    node.bv.max_ = obb.To + r;
+  }
+
+  template<typename BV, typename Visitor>
+  void traverseMesh(const BVHModel<BV>& model, const Transform3f& tf1,
+                    const Transform3f& tf2, Visitor& visitor) const
+  {
+    if(model.getNumBVs() == 0) return;
+    const Transform3f tf (tf1.inverseTimes(tf2));
+    Node node (root(*visitor.hfield)), mesh_node;
+    mesh_node.level = -1;
+    mesh_node.i = 0;
+    meshBV(model, tf, mesh_node);
+    const FCL_REAL bound = details::boxDistanceLowerBound(node.bv,
+        mesh_node.obb, mesh_node.bv);
+    if(bound > visitor.threshold())
+      visitor.discard(bound);
+    else
+      traverseMesh(model, tf1, tf, node, mesh_node, visitor);
+  }
+
+  /// @param tf pose of the mesh in the frame of the height field
+  /// @return whether the visitor stopped the search
+  template<typename BV, typename Visitor>
+  bool traverseMesh(const BVHModel<BV>& model, const Transform3f& tf1,
+                    const Transform3f& tf, const Node& node,
+                    const Node& mesh_node, Visitor& visitor) const
+  {
+    const HeightField& hfield = *visitor.hfield;
+    const BVNode<BV>& bv_node = model.getBV(mesh_node.i);
+    if(node.level == 0 && bv_node.isLeaf())
+    {
+      const int b = bv_node.primitiveId();
+      const Triangle& tri = model.tri_indices[b];
+      const Vec3f Q1 (tf.transform(model.vertices[tri[0]])),
+                  Q2 (tf.transform(model.vertices[tri[1]])),
+                  Q3 (tf.transform(model.vertices[tri[2]]));
+      const int cell = node.i + (hfield.getSize(0) - 1) * node.j;
+      for(int id = 2 * cell; id < 2 * cell + 2; ++id)
+      {
+        Vec3f P1, P2, P3, p1, p2, normal;
+        FCL_REAL distance;
+        hfield.getTriangle(id, P1, P2, P3);
+        triangleInteraction(P1, P2, P3, Q1, Q2, Q3, tf1,
+                            visitor.penetration(), distance, p1, p2, normal);
+        if(visitor.visit(id, b, distance, p1, p2, normal))
+          return true;
+      }
+      return false;
+    }
+
+    const Vec3f hsize (node.bv.max_ - node.bv.min_),
+                msize (mesh_node.bv.max_ - mesh_node.bv.min_);
+    if(bv_node.isLeaf() ||
+       (node.level > 0 && hsize.squaredNorm() > msize.squaredNorm()))
+    {
+      Node nodes[4];
+      const MeshBound bound = { &mesh_node };
+      const int n = children(hfield, node, bound, nodes);
+      for(int k = 0; k < n; ++k)
+      {
+        if(nodes[k].bound > visitor.threshold())
+          visitor.discard(nodes[k].bound);
+        else if(traverseMesh(model, tf1, tf, nodes[k], mesh_node, visitor))
+          return true;
+      }
+      return false;
+    }
+
+    Node nodes[2];
+    nodes[0].i = bv_node.leftChild();
+    nodes[1].i = bv_node.rightChild();
+    for(int k = 0; k < 2; ++k)
+    {
+      nodes[k].level = -1;
+      meshBV(model, tf, nodes[k]);
+      nodes[k].bound = details::boxDistanceLowerBound(node.bv, nodes[k].obb,
+                                                      nodes[k].bv);
+    }
+    if(nodes[1] < nodes[0]) std::swap(nodes[0], nodes[1]);
+    for(int k = 0; k < 2; ++k)
+    {
+      if(nodes[k].bound > visitor.threshold())
+        visitor.discard(nodes[k].bound);
+      else if(traverseMesh(model, tf1, tf, node, nodes[k], visitor))
+        return true;
+    }
+    return false;
+  }
+
+  struct MeshBound
+  {
+    const Node* node;
+    FCL_REAL operator()(const AABB& bv) const
+    {
+      return details::boxDistanceLowerBound(bv, node->obb, node->bv);
+    }
+  };
+
+  /// @brief Distance between a triangle of the height field and a triangle
+  ///        of a mesh, both in the frame of the height field.
+  /// @param penetration whether the penetration of intersecting triangles
+  ///        should be computed, otherwise their distance is 0.
+  void triangleInteraction(const Vec3f& P1, const Vec3f& P2, const Vec3f& P3,
+                           const Vec3f& Q1, const Vec3f& Q2, const Vec3f& Q3,
+                           const Transform3f& tf1, bool penetration,
+                           FCL_REAL& distance, Vec3f& p1, Vec3f& p2,
+                           Vec3f& normal) const
+  {
+    FCL_REAL sqrDistLowerBound;
+    if(penetration && Intersect::intersectTriangles(P1, P2, P3, Q1, Q2, Q3,
+                                                    sqrDistLowerBound))
+    {
+      const TriangleP tri1 (P1, P2, P3), tri2 (Q1, Q2, Q3);
+      nsolver_->shapeDistance(tri1, tf1, tri2, tf1, distance, p1, p2, normal);
+      return;
+    }
+    distance = std::sqrt(TriangleDistance::sqrTriDistance(P1, P2, P3,
+                                                          Q1, Q2, Q3, p1, p2));
+    if(distance > 0)
+      normal = tf1.getRotation() * (p2 - p1) / distance;
+    else
+      normal.setZero();
+    p1 = tf1.transform(p1).eval();
+    p2 = tf1.transform(p2).eval();
+  }
+
+  const GJKSolver* nsolver_;
+  bool hfield_first_;
+};
+
+}
+
+} // namespace hpp
+
+/// @endcond
+
+#endif
@@ -36,6 +36,8 @@
 /** \author Jia Pan */
 
 #include "intersect.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <limits>
 #include <vector>
@@ -61,6 +63,108 @@ bool Intersect::buildTrianglePlane
   return false;
 }
 
+namespace
+{
+  /// Position of a triangle with respect to a plane
+  enum PlaneSide {
+    ABOVE, BELOW, CROSSING, TOUCHING
+  };
+
+  /// Signed distances d of the vertices V of a triangle to the plane of
+  /// normal n passing through O.
+  /// @retval minDist distance of the closest vertex to the plane if the
+  ///         triangle is on one side of it.
+  inline PlaneSide planeSide (const Vec3f& n, const Vec3f& O, const Vec3f V[3],
+                              FCL_REAL d[3], FCL_REAL& minDist)
+  {
+    static const FCL_REAL eps = 100 * std::numeric_limits<FCL_REAL>::epsilon();
+    FCL_REAL scale2 = 0;
+    for (int i = 0; i < 3; ++i) {
+      Vec3f OV (V[i] - O);
+      d[i] = n.dot (OV);
+      scale2 = std::max (scale2, OV.squaredNorm());
+    }
+    FCL_REAL tol = eps * sqrt (scale2);
+    if (d[0] > tol && d[1] > tol && d[2] > tol) {
+      minDist = std::min (std::min (d[0], d[1]), d[2]);
+      return ABOVE;
+    }
+    if (d[0] < -tol && d[1] < -tol && d[2] < -tol) {
+      minDist = - std::max (std::max (d[0], d[1]), d[2]);
+      return BELOW;
+    }
+    if (std::fabs (d[0]) <= tol || std::fabs (d[1]) <= tol ||
+        std::fabs (d[2]) <= tol)
+      return TOUCHING;
+    return CROSSING;
+  }
+
+  /// Interval covered by the segment of intersection of a triangle crossing
+  /// a plane, projected on direction D.
+  inline void crossingInterval (const Vec3f V[3], const FCL_REAL d[3],
+                                const Vec3f& D, FCL_REAL& tmin, FCL_REAL& tmax)
+  {
+    // k is the vertex alone on its side of the plane.
+    int k;
+    if ((d[0] > 0) == (d[1] > 0)) k = 2;
+    else if ((d[0] > 0) == (d[2] > 0)) k = 1;
+    else k = 0;
+    int i = (k + 1) % 3, j = (k + 2) % 3;
+    FCL_REAL ti = D.dot (V[k] + (V[i] - V[k]) * (d[k] / (d[k] - d[i]))),
+             tj = D.dot (V[k] + (V[j] - V[k]) * (d[k] / (d[k] - d[j])));
+    tmin = std::min (ti, tj);
+    tmax = std::max (ti, tj);
+  }
+} // namespace
+
+bool Intersect::intersectTriangles
+(const Vec3f& P1, const Vec3f& P2, const Vec3f& P3,
+ const Vec3f& Q1, const Vec3f& Q2, const Vec3f& Q3,
+ FCL_REAL& sqrDistLowerBound)
+{
+  const Vec3f P[3] = { P1, P2, P3 };
+  const Vec3f Q[3] = { Q1, Q2, Q3 };
+
+  Vec3f nP, nQ;
+  FCL_REAL tP, tQ;
+  if (buildTrianglePlane (P1, P2, P3, &nP, &tP) &&
+      buildTrianglePlane (Q1, Q2, Q3, &nQ, &tQ)) {
+    FCL_REAL dP[3], dQ[3], minDistP = 0, minDistQ = 0;
+    PlaneSide sideP = planeSide (nQ, Q1, P, dP, minDistP);
+    PlaneSide sideQ = planeSide (nP, P1, Q, dQ, minDistQ);
+    if (sideP == ABOVE || sideP == BELOW || sideQ == ABOVE || sideQ == BELOW) {
+      FCL_REAL minDist = std::max (minDistP, minDistQ);
+      sqrDistLowerBound = minDist * minDist;
+      return false;
+    }
+    Vec3f D (nP.cross (nQ));
+    if (sideP == CROSSING && sideQ == CROSSING &&
+        D.squaredNorm() > std::numeric_limits<FCL_REAL>::epsilon()) {
+      FCL_REAL tPmin, tPmax, tQmin, tQmax;
+      crossingInterval (P, dP, D, tPmin, tPmax);
+      crossingInterval (Q, dQ, D, tQmin, tQmax);
+      sqrDistLowerBound = 0;
+      return tPmin <= tQmax && tQmin <= tPmax;
+    }
+  }
+
+  // Degenerate triangles, vertices on the plane of the other triangle or
+  // almost parallel planes. The distance of touching and coplanar
+  // triangles is only computed up to rounding errors.
+  static const FCL_REAL eps = 100 * std::numeric_limits<FCL_REAL>::epsilon();
+  FCL_REAL scale2 = std::max (std::max ((P2 - P1).squaredNorm(),
+                                        (P3 - P1).squaredNorm()),
+                              std::max (std::max ((Q1 - P1).squaredNorm(),
+                                                  (Q2 - P1).squaredNorm()),
+                                        (Q3 - P1).squaredNorm()));
+  Vec3f p, q;
+  sqrDistLowerBound = TriangleDistance::sqrTriDistance (P1, P2, P3,
+                                                        Q1, Q2, Q3, p, q);
+  if (sqrDistLowerBound > eps * eps * scale2) return false;
+  sqrDistLowerBound = 0;
+  return true;
+}
+
 void TriangleDistance::segPoints(const Vec3f& P, const Vec3f& A, const Vec3f& Q, const Vec3f& B,
                                  Vec3f& VEC, Vec3f& X, Vec3f& Y)
 {
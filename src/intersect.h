@@ -54,6 +54,21 @@ class Intersect
 public:
   static bool buildTrianglePlane
     (const Vec3f& v1, const Vec3f& v2, const Vec3f& v3, Vec3f* n, FCL_REAL* t);
+
+  /// Test whether two triangles intersect
+  /// @param P1, P2, P3 vertices of the first triangle,
+  /// @param Q1, Q2, Q3 vertices of the second triangle,
+  /// @retval sqrDistLowerBound square of a lower bound of the distance
+  ///         between the triangles if they do not intersect, 0 otherwise.
+  /// This test is much cheaper than TriangleDistance::sqrTriDistance:
+  /// the triangles are first tested against the plane of each other, then
+  /// the segments of intersection with the other plane are compared on
+  /// the line of intersection of the planes. Degenerate and coplanar
+  /// configurations fall back to TriangleDistance::sqrTriDistance.
+  static bool intersectTriangles
+    (const Vec3f& P1, const Vec3f& P2, const Vec3f& P3,
+     const Vec3f& Q1, const Vec3f& Q2, const Vec3f& Q3,
+     FCL_REAL& sqrDistLowerBound);
 }; // class Intersect
 
 /// @brief Project functions
@@ -37,7 +37,22 @@
 #include <hpp/fcl/mesh_loader/loader.h>
 #include <hpp/fcl/mesh_loader/assimp.h>
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+
+#include <boost/cstdint.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
 #include <hpp/fcl/BV/BV.h>
+#include <hpp/fcl/serialization.h>
+#include <hpp/fcl/thread_pool.h>
 
 namespace hpp
 {
@@ -77,18 +92,171 @@ namespace fcl {
     }
   }
 
+  namespace
+  {
+    /// Load a range of files, each with a given scale.
+    struct LoadTask : ThreadPool::Task
+    {
+      LoadTask (MeshLoader& loader_,
+                const std::vector<std::string>& filenames_,
+                const std::vector<Vec3f>& scales_,
+                std::vector<BVHModelPtr_t>& models_) :
+        loader (loader_), filenames (filenames_), scales (scales_),
+        models (models_)
+      {}
+
+      void run (std::size_t begin, std::size_t end, std::size_t)
+      {
+        for (std::size_t i = begin; i < end; ++i)
+          models[i] = loader.load (filenames[i], scales[i]);
+      }
+
+      MeshLoader& loader;
+      const std::vector<std::string>& filenames;
+      const std::vector<Vec3f>& scales;
+      std::vector<BVHModelPtr_t>& models;
+    };
+
+    /// Version of the names of the files in the disk cache. Increase it when
+    /// the name or the content of the files changes, so that files saved by
+    /// previous versions are not loaded.
+    const unsigned int cacheVersion = 1;
+
+    /// 64 bits FNV-1a hash, which does not depend on the platform nor on the
+    /// version of the libraries, unlike boost::hash.
+    boost::uint64_t fnv1a (const std::string& data)
+    {
+      boost::uint64_t hash = 0xcbf29ce484222325ULL;
+      for (std::size_t i = 0; i < data.size(); ++i) {
+        hash ^= (unsigned char)data[i];
+        hash *= 0x100000001b3ULL;
+      }
+      return hash;
+    }
+
+    /// Name of the file of a model in the disk cache.
+    /// \return an empty string if the file cannot be read.
+    std::string cacheFilename (const std::string& filename,
+        const Vec3f& scale, NODE_TYPE bvType)
+    {
+      std::ifstream file (filename.c_str(), std::ios::binary);
+      if (!file) return std::string();
+      std::string content ((std::istreambuf_iterator<char> (file)),
+          std::istreambuf_iterator<char> ());
+
+      std::ostringstream oss;
+      oss << 'v' << cacheVersion << '-'
+        << std::hex << std::setfill('0')
+        << std::setw (16) << fnv1a (content)
+        << '-' << content.size();
+      // The bits of the scale, so that the name does not depend on the
+      // formatting of floating point numbers nor on the byte order.
+      for (int i = 0; i < 3; ++i) {
+        FCL_REAL s = scale[i];
+        boost::uint64_t bits;
+        std::memcpy (&bits, &s, sizeof(s));
+        oss << '-' << std::setw (16) << bits;
+      }
+      oss << std::dec << '-' << (int)bvType << ".hppfcl";
+      return oss.str();
+    }
+  }
+
+  std::vector<BVHModelPtr_t> MeshLoader::loadMany (
+      const std::vector<std::string>& filenames,
+      const std::vector<Vec3f>& scales,
+      ThreadPool& pool)
+  {
+    if (filenames.size() != scales.size())
+      throw std::invalid_argument ("The number of files and of scales differ.");
+    std::vector<BVHModelPtr_t> models (filenames.size());
+    LoadTask task (*this, filenames, scales, models);
+    pool.parallelFor (filenames.size(), task);
+    return models;
+  }
+
+  void CachedMeshLoader::setCacheDirectory (const std::string& directory)
+  {
+    boost::mutex::scoped_lock lock (lock_);
+    cache_directory_ = directory;
+  }
+
+  std::string CachedMeshLoader::getCacheDirectory () const
+  {
+    boost::mutex::scoped_lock lock (lock_);
+    return cache_directory_;
+  }
+
   BVHModelPtr_t CachedMeshLoader::load (const std::string& filename,
       const Vec3f& scale)
   {
     Key key (filename, scale);
-    Cache_t::const_iterator _cached = cache_.find (key);
-    if (_cached == cache_.end()) {
-      BVHModelPtr_t geom = MeshLoader::load (filename, scale);
-      cache_.insert (std::make_pair(key, geom));
-      return geom;
-    } else {
-      return _cached->second;
+    {
+      boost::mutex::scoped_lock lock (lock_);
+      while (true) {
+        Cache_t::const_iterator _cached = cache_.find (key);
+        if (_cached != cache_.end()) return _cached->second;
+        // Another thread is loading this file: wait for its result.
+        if (loading_.count (key) == 0) break;
+        loaded_.wait (lock);
+      }
+      loading_.insert (key);
+    }
+
+    BVHModelPtr_t geom;
+    try {
+      geom = build (filename, scale);
+    } catch (...) {
+      boost::mutex::scoped_lock lock (lock_);
+      loading_.erase (key);
+      loaded_.notify_all ();
+      throw;
+    }
+
+    boost::mutex::scoped_lock lock (lock_);
+    loading_.erase (key);
+    cache_.insert (std::make_pair(key, geom));
+    loaded_.notify_all ();
+    return geom;
+  }
+
+  BVHModelPtr_t CachedMeshLoader::build (const std::string& filename,
+      const Vec3f& scale)
+  {
+    std::string directory = getCacheDirectory ();
+    if (directory.empty()) return MeshLoader::load (filename, scale);
+
+    std::string name (cacheFilename (filename, scale, getBVType()));
+    if (name.empty()) return MeshLoader::load (filename, scale);
+    std::string path (directory + "/" + name);
+
+    if (std::ifstream (path.c_str()).good()) {
+      try {
+        BVHModelPtr_t geom (boost::dynamic_pointer_cast<BVHModelBase>
+            (loadBinary (path)));
+        if (geom) return geom;
+        std::cerr << "Warning! " << path << " is not a BVH model" << std::endl;
+      } catch (const std::exception& e) {
+        std::cerr << "Warning! Could not load " << path << ": " << e.what()
+          << std::endl;
+      }
+    }
+
+    BVHModelPtr_t geom = MeshLoader::load (filename, scale);
+    // Write a temporary file and rename it, so that other processes never
+    // read a partially written file.
+    std::string tmp (path + "." +
+        boost::uuids::to_string (boost::uuids::random_generator() ()));
+    try {
+      saveBinary (*geom, tmp);
+      if (std::rename (tmp.c_str(), path.c_str()) != 0)
+        throw std::runtime_error ("could not rename " + tmp);
+    } catch (const std::exception& e) {
+      std::remove (tmp.c_str());
+      std::cerr << "Warning! Could not save " << path << ": " << e.what()
+        << std::endl;
     }
+    return geom;
   }
 }
 
@@ -36,6 +36,7 @@
 /** \author Jia Pan */
 
 #include <hpp/fcl/narrowphase/gjk.h>
+#include <boost/thread/tss.hpp>
 #include "../intersect.h"
 #include "../math/tools.h"
 
@@ -167,14 +168,27 @@ void getShapeSupport(const Cylinder* cylinder, const Vec3f& dir, Vec3f& support)
   assert (fabs (support [0] * dir [1] - support [1] * dir [0]) < eps);
 }
 
-void getShapeSupport(const ConvexBase* convex, const Vec3f& dir, Vec3f& support)
+/// @param hint index of the support point along a previous direction, or -1.
+///        Set to the index of the support point along dir.
+void getShapeSupport(const ConvexBase* convex, const Vec3f& dir, Vec3f& support,
+                     int& hint)
 {
   const Vec3f* pts = convex->points;
   const ConvexBase::Neighbors* nn = convex->neighbors;
 
-  int i = 0;
+  // Start from the best of the previous support point and of the point
+  // given by the lookup table.
+  int i = (int)convex->supportStart(dir);
   FCL_REAL maxdot = pts[i].dot(dir);
   FCL_REAL dot;
+  if (hint >= 0 && hint != i) {
+    dot = pts[hint].dot(dir);
+    if (dot > maxdot) {
+      maxdot = dot;
+      i = hint;
+    }
+  }
+
   bool found = true;
   while (found)
   {
@@ -190,9 +204,23 @@ void getShapeSupport(const ConvexBase* convex, const Vec3f& dir, Vec3f& support)
     }
   }
 
+  hint = i;
   support = pts[i];
 }
 
+inline void getShapeSupport(const ConvexBase* convex, const Vec3f& dir, Vec3f& support)
+{
+  int hint = -1;
+  getShapeSupport(convex, dir, support, hint);
+}
+
+/// @brief Support function of shapes which do not use a hint.
+template <typename Shape>
+inline void getShapeSupport(const Shape* shape, const Vec3f& dir, Vec3f& support, int&)
+{
+  getShapeSupport(shape, dir, support);
+}
+
 #define CALL_GET_SHAPE_SUPPORT(ShapeType)                                      \
   getShapeSupport (static_cast<const ShapeType*>(shape),                       \
       (shape_traits<ShapeType>::NeedNormalizedDir && !dirIsNormalized)         \
@@ -240,13 +268,13 @@ Vec3f getSupport(const ShapeBase* shape, const Vec3f& dir, bool dirIsNormalized)
 template <typename Shape0, typename Shape1, bool TransformIsIdentity>
 void getSupportTpl (const Shape0* s0, const Shape1* s1,
     const Matrix3f& oR1, const Vec3f& ot1,
-    const Vec3f& dir, Vec3f& support0, Vec3f& support1)
+    const Vec3f& dir, Vec3f& support0, Vec3f& support1, int hints[2])
 {
-  getShapeSupport (s0, dir, support0);
+  getShapeSupport (s0, dir, support0, hints[0]);
   if (TransformIsIdentity)
-    getShapeSupport (s1, - dir, support1);
+    getShapeSupport (s1, - dir, support1, hints[1]);
   else {
-    getShapeSupport (s1, - oR1.transpose() * dir, support1);
+    getShapeSupport (s1, - oR1.transpose() * dir, support1, hints[1]);
     support1 = oR1 * support1 + ot1;
   }
 }
@@ -272,7 +300,7 @@ void getSupportFuncTpl (const MinkowskiDiff& md,
       static_cast <const Shape1*>(md.shapes[1]),
       md.oR1, md.ot1,
       (NeedNormalizedDir && !dirIsNormalized) ? dir.normalized() : dir,
-      support0, support1);
+      support0, support1, md.support_hints);
 }
 
 template <typename Shape0>
@@ -348,6 +376,7 @@ void MinkowskiDiff::set (const ShapeBase* shape0, const ShapeBase* shape1,
   bool identity = (oR1.isIdentity() && ot1.isZero());
 
   getSupportFunc = makeGetSupportFunction0 (shape0, shape1, identity);
+  support_hints[0] = support_hints[1] = -1;
 }
 
 void MinkowskiDiff::set (const ShapeBase* shape0, const ShapeBase* shape1)
@@ -359,6 +388,7 @@ void MinkowskiDiff::set (const ShapeBase* shape0, const ShapeBase* shape1)
   ot1.setZero();
 
   getSupportFunc = makeGetSupportFunction0 (shape0, shape1, true);
+  support_hints[0] = support_hints[1] = -1;
 }
 
 void GJK::initialize()
@@ -366,6 +396,7 @@ void GJK::initialize()
   nfree = 0;
   status = Failed;
   distance_upper_bound = std::numeric_limits<FCL_REAL>::max();
+  iterations = 0;
   simplex = NULL;
 }
 
@@ -431,9 +462,90 @@ bool GJK::getClosestPoints (const Simplex& simplex, Vec3f& w0, Vec3f& w1)
   return true;
 }
 
-GJK::Status GJK::evaluate(const MinkowskiDiff& shape_, const Vec3f& guess)
+void GJK::getWarmStart(WarmStart& warm_start) const
+{
+  warm_start.status = status;
+  warm_start.rank = 0;
+  if(simplex == NULL) return;
+  for(vertex_id_t i = 0; i < simplex->rank; ++i)
+    warm_start.directions[i] = simplex->vertex[i]->d;
+  warm_start.rank = simplex->rank;
+}
+
+bool GJK::initializeSimplex(const WarmStart& warm_start)
+{
+  Simplex& s = simplices[0];
+  for(vertex_id_t i = 0; i < warm_start.rank; ++i)
+  {
+    appendVertex(s, warm_start.directions[i]);
+    // Several directions may give the same support vertex in the new
+    // configuration.
+    const Vec3f& w = s.vertex[s.rank - 1]->w;
+    for(vertex_id_t j = 0; j + 1 < s.rank; ++j)
+    {
+      if((s.vertex[j]->w - w).squaredNorm() <= tolerance * tolerance)
+      {
+        removeVertex(s);
+        break;
+      }
+    }
+  }
+
+  if(s.rank == 1)
+  {
+    ray = s.vertex[0]->w;
+    return true;
+  }
+
+  // The simplex may not be in the configuration assumed by the projections
+  // of the main loop, where the last vertex is the newest support point:
+  // use the general projections and keep the vertices of the closest
+  // feature.
+  Project::ProjectResult projection;
+  SimplexV* const* vs = s.vertex;
+  switch(s.rank)
+  {
+  case 2:
+    projection = Project::projectLineOrigin (vs[0]->w, vs[1]->w);
+    break;
+  case 3:
+    projection = Project::projectTriangleOrigin (vs[0]->w, vs[1]->w, vs[2]->w);
+    break;
+  case 4:
+    projection = Project::projectTetrahedraOrigin (vs[0]->w, vs[1]->w,
+                                                   vs[2]->w, vs[3]->w);
+    break;
+  }
+  if(projection.encode == 0)
+  {
+    while(s.rank > 0) removeVertex(s);
+    return false;
+  }
+
+  Simplex& next = simplices[1];
+  next.rank = 0;
+  ray.setZero();
+  for(vertex_id_t i = 0; i < s.rank; ++i)
+  {
+    if(projection.encode & (1 << i))
+    {
+      next.vertex[next.rank++] = vs[i];
+      ray += projection.parameterization[i] * vs[i]->w;
+    }
+    else
+      free_v[nfree++] = vs[i];
+  }
+  // The origin is inside the tetrahedron.
+  if(next.rank == 4) ray.setZero();
+  s.rank = 0;
+  current = 1;
+  return true;
+}
+
+GJK::Status GJK::evaluate(const MinkowskiDiff& shape_, const Vec3f& guess,
+                          const WarmStart* warm_start)
 {
-  size_t iterations = 0;
+  iterations = 0;
   FCL_REAL alpha = 0;
 
   free_v[0] = &store_v[0];
@@ -447,11 +559,15 @@ GJK::Status GJK::evaluate(const MinkowskiDiff& shape_, const Vec3f& guess)
   shape = &shape_;
   distance = 0.0;
   simplices[0].rank = 0;
-  ray = guess;
 
-  if (ray.squaredNorm() > 0) appendVertex(simplices[0], -ray);
-  else                       appendVertex(simplices[0], Vec3f(1, 0, 0), true);
-  ray = simplices[0].vertex[0]->w;
+  if (!warm_start || warm_start->rank == 0
+      || !initializeSimplex(*warm_start))
+  {
+    ray = guess;
+    if (ray.squaredNorm() > 0) appendVertex(simplices[0], -ray);
+    else                       appendVertex(simplices[0], Vec3f(1, 0, 0), true);
+    ray = simplices[0].vertex[0]->w;
+  }
 
   do
   {
@@ -1046,16 +1162,43 @@ bool GJK::projectTetrahedraOrigin(const Simplex& current, Simplex& next)
 
 void EPA::initialize()
 {
-  sv_store = new SimplexV[max_vertex_num];
-  fc_store = new SimplexF[max_face_num];
+  delete [] sv_store;
+  delete [] fc_store;
+  sv_store = (max_vertex_num > 0) ? new SimplexV[max_vertex_num] : NULL;
+  fc_store = (max_face_num > 0) ? new SimplexF[max_face_num] : NULL;
   status = Failed;
   normal = Vec3f(0, 0, 0);
   depth = 0;
   nextsv = 0;
+  hull = SimplexList();
+  stock = SimplexList();
   for(size_t i = 0; i < max_face_num; ++i)
     stock.append(&fc_store[max_face_num-i-1]);
 }
 
+void EPA::reset(unsigned int max_face_num_, unsigned int max_vertex_num_,
+                unsigned int max_iterations_, FCL_REAL tolerance_)
+{
+  max_iterations = max_iterations_;
+  tolerance = tolerance_;
+  if (max_face_num != max_face_num_ || max_vertex_num != max_vertex_num_) {
+    max_face_num = max_face_num_;
+    max_vertex_num = max_vertex_num_;
+    initialize();
+  }
+}
+
+namespace
+{
+  boost::thread_specific_ptr<EPA> thread_epa;
+}
+
+EPA& getThreadEPA()
+{
+  if (!thread_epa.get()) thread_epa.reset(new EPA());
+  return *thread_epa;
+}
+
 bool EPA::getEdgeDist(SimplexF* face, SimplexV* a, SimplexV* b, FCL_REAL& dist)
 {
   Vec3f ba = b->w - a->w;
@@ -75,7 +75,7 @@ namespace fcl
 template<>
 bool GJKSolver::shapeIntersect<Sphere, Capsule>(const Sphere &s1, const Transform3f& tf1,
                                                       const Capsule &s2, const Transform3f& tf2,
-                                                      Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+                                                      Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   return details::sphereCapsuleIntersect(s1, tf1, s2, tf2, contact_points, penetration_depth, normal);
 }
@@ -83,7 +83,7 @@ bool GJKSolver::shapeIntersect<Sphere, Capsule>(const Sphere &s1, const Transfor
 template<>
 bool GJKSolver::shapeIntersect<Capsule, Sphere>(const Capsule &s1, const Transform3f& tf1,
                                                       const Sphere &s2, const Transform3f& tf2,
-                                                      Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+                                                      Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   const bool res = details::sphereCapsuleIntersect(s2, tf2, s1, tf1, contact_points, penetration_depth, normal);
   if (normal) (*normal) *= -1.0;
@@ -93,7 +93,7 @@ bool GJKSolver::shapeIntersect<Capsule, Sphere>(const Capsule &s1, const Transfo
 template<>
 bool GJKSolver::shapeIntersect<Sphere, Sphere>(const Sphere& s1, const Transform3f& tf1,
                                                      const Sphere& s2, const Transform3f& tf2,
-                                                     Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+                                                     Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   return details::sphereSphereIntersect(s1, tf1, s2, tf2, contact_points, penetration_depth, normal);
 }
@@ -101,7 +101,7 @@ bool GJKSolver::shapeIntersect<Sphere, Sphere>(const Sphere& s1, const Transform
 template<>
 bool GJKSolver::shapeIntersect<Box, Sphere>(const Box   & s1, const Transform3f& tf1,
                                                   const Sphere& s2, const Transform3f& tf2,
-                                                  Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+                                                  Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL dist;
   Vec3f ps, pb, n;
@@ -116,7 +116,7 @@ bool GJKSolver::shapeIntersect<Box, Sphere>(const Box   & s1, const Transform3f&
 template<>
 bool GJKSolver::shapeIntersect<Sphere, Box>(const Sphere& s1, const Transform3f& tf1,
                                                   const Box   & s2, const Transform3f& tf2,
-                                                  Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+                                                  Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL dist;
   Vec3f ps, pb, n;
@@ -131,7 +131,7 @@ bool GJKSolver::shapeIntersect<Sphere, Box>(const Sphere& s1, const Transform3f&
 template<>
 bool GJKSolver::shapeIntersect<Box, Box>(const Box& s1, const Transform3f& tf1,
                                                const Box& s2, const Transform3f& tf2,
-                                               Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+                                               Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   return details::boxBoxIntersect(s1, tf1, s2, tf2, contact_points, penetration_depth, normal);
 }
@@ -140,7 +140,7 @@ template<>
 bool GJKSolver::shapeIntersect<Sphere, Halfspace>
 (const Sphere& s1, const Transform3f& tf1,
  const Halfspace& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -154,7 +154,7 @@ bool GJKSolver::shapeIntersect<Sphere, Halfspace>
 template<>
 bool GJKSolver::shapeIntersect<Halfspace, Sphere>(const Halfspace& s1, const Transform3f& tf1,
                                                         const Sphere& s2, const Transform3f& tf2,
-                                                        Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+                                                        Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -170,7 +170,7 @@ template<>
 bool GJKSolver::shapeIntersect<Box, Halfspace>
 (const Box& s1, const Transform3f& tf1,
  const Halfspace& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -185,7 +185,7 @@ template<>
 bool GJKSolver::shapeIntersect<Halfspace, Box>
 (const Halfspace& s1, const Transform3f& tf1,
  const Box& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -201,7 +201,7 @@ template<>
 bool GJKSolver::shapeIntersect<Capsule, Halfspace>
 (const Capsule& s1, const Transform3f& tf1,
  const Halfspace& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -216,7 +216,7 @@ template<>
 bool GJKSolver::shapeIntersect<Halfspace, Capsule>
 (const Halfspace& s1, const Transform3f& tf1,
  const Capsule& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -232,7 +232,7 @@ template<>
 bool GJKSolver::shapeIntersect<Cylinder, Halfspace>
 (const Cylinder& s1, const Transform3f& tf1,
  const Halfspace& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -247,7 +247,7 @@ template<>
 bool GJKSolver::shapeIntersect<Halfspace, Cylinder>
 (const Halfspace& s1, const Transform3f& tf1,
  const Cylinder& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -263,7 +263,7 @@ template<>
 bool GJKSolver::shapeIntersect<Cone, Halfspace>
 (const Cone& s1, const Transform3f& tf1,
  const Halfspace& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -278,7 +278,7 @@ template<>
 bool GJKSolver::shapeIntersect<Halfspace, Cone>
 (const Halfspace& s1, const Transform3f& tf1,
  const Cone& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -293,7 +293,7 @@ bool GJKSolver::shapeIntersect<Halfspace, Cone>
 template<>
 bool GJKSolver::shapeIntersect<Halfspace, Halfspace>(const Halfspace& s1, const Transform3f& tf1,
                                                            const Halfspace& s2, const Transform3f& tf2,
-                                                           Vec3f* /*contact_points*/, FCL_REAL* /*penetration_depth*/, Vec3f* /*normal*/) const
+                                                           Vec3f* /*contact_points*/, FCL_REAL* /*penetration_depth*/, Vec3f* /*normal*/, details::GJK::WarmStart*) const
 {
   Halfspace s;
   Vec3f p, d;
@@ -305,7 +305,7 @@ bool GJKSolver::shapeIntersect<Halfspace, Halfspace>(const Halfspace& s1, const
 template<>
 bool GJKSolver::shapeIntersect<Plane, Halfspace>(const Plane& s1, const Transform3f& tf1,
                                                        const Halfspace& s2, const Transform3f& tf2,
-                                                       Vec3f* /*contact_points*/, FCL_REAL* /*penetration_depth*/, Vec3f* /*normal*/) const
+                                                       Vec3f* /*contact_points*/, FCL_REAL* /*penetration_depth*/, Vec3f* /*normal*/, details::GJK::WarmStart*) const
 {
   Plane pl;
   Vec3f p, d;
@@ -317,7 +317,7 @@ bool GJKSolver::shapeIntersect<Plane, Halfspace>(const Plane& s1, const Transfor
 template<>
 bool GJKSolver::shapeIntersect<Halfspace, Plane>(const Halfspace& s1, const Transform3f& tf1,
                                                        const Plane& s2, const Transform3f& tf2,
-                                                       Vec3f* /*contact_points*/, FCL_REAL* /*penetration_depth*/, Vec3f* /*normal*/) const
+                                                       Vec3f* /*contact_points*/, FCL_REAL* /*penetration_depth*/, Vec3f* /*normal*/, details::GJK::WarmStart*) const
 {
   Plane pl;
   Vec3f p, d;
@@ -330,7 +330,7 @@ template<>
 bool GJKSolver::shapeIntersect<Sphere, Plane>
 (const Sphere& s1, const Transform3f& tf1,
  const Plane& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -345,7 +345,7 @@ template<>
 bool GJKSolver::shapeIntersect<Plane, Sphere>
 (const Plane& s1, const Transform3f& tf1,
  const Sphere& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -361,7 +361,7 @@ template<>
 bool GJKSolver::shapeIntersect<Box, Plane>
 (const Box& s1, const Transform3f& tf1,
  const Plane& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -376,7 +376,7 @@ template<>
 bool GJKSolver::shapeIntersect<Plane, Box>
 (const Plane& s1, const Transform3f& tf1,
  const Box& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -392,7 +392,7 @@ template<>
 bool GJKSolver::shapeIntersect<Capsule, Plane>
 (const Capsule& s1, const Transform3f& tf1,
  const Plane& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -407,7 +407,7 @@ template<>
 bool GJKSolver::shapeIntersect<Plane, Capsule>
 (const Plane& s1, const Transform3f& tf1,
  const Capsule& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -423,7 +423,7 @@ template<>
 bool GJKSolver::shapeIntersect<Cylinder, Plane>
 (const Cylinder& s1, const Transform3f& tf1,
  const Plane& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -438,7 +438,7 @@ template<>
 bool GJKSolver::shapeIntersect<Plane, Cylinder>
 (const Plane& s1, const Transform3f& tf1,
  const Cylinder& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -454,7 +454,7 @@ template<>
 bool GJKSolver::shapeIntersect<Cone, Plane>
 (const Cone& s1, const Transform3f& tf1,
  const Plane& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -469,7 +469,7 @@ template<>
 bool GJKSolver::shapeIntersect<Plane, Cone>
 (const Plane& s1, const Transform3f& tf1,
  const Cone& s2, const Transform3f& tf2,
- Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+ Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   FCL_REAL distance;
   Vec3f p1, p2;
@@ -484,7 +484,7 @@ bool GJKSolver::shapeIntersect<Plane, Cone>
 template<>
 bool GJKSolver::shapeIntersect<Plane, Plane>(const Plane& s1, const Transform3f& tf1,
                                                    const Plane& s2, const Transform3f& tf2,
-                                                   Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal) const
+                                                   Vec3f* contact_points, FCL_REAL* penetration_depth, Vec3f* normal, details::GJK::WarmStart*) const
 {
   return details::planeIntersect(s1, tf1, s2, tf2, contact_points, penetration_depth, normal);
 }
@@ -549,7 +549,7 @@ template<>
 bool GJKSolver::shapeDistance<Sphere, Capsule>
 (const Sphere& s1, const Transform3f& tf1,
  const Capsule& s2, const Transform3f& tf2,
- FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const
+ FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart*) const
 {
   return details::sphereCapsuleDistance(s1, tf1, s2, tf2, dist, p1, p2, normal);
 }
@@ -558,7 +558,7 @@ template<>
 bool GJKSolver::shapeDistance<Capsule, Sphere>
 (const Capsule& s1, const Transform3f& tf1,
  const Sphere& s2, const Transform3f& tf2,
- FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const
+ FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart*) const
 {
   return details::sphereCapsuleDistance(s2, tf2, s1, tf1, dist, p2, p1, normal);
 }
@@ -567,7 +567,7 @@ template<>
 bool GJKSolver::shapeDistance<Sphere, Cylinder>
 (const Sphere& s1, const Transform3f& tf1,
  const Cylinder& s2, const Transform3f& tf2,
- FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const
+ FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart*) const
 {
   return details::sphereCylinderDistance
     (s1, tf1, s2, tf2, dist, p1, p2, normal);
@@ -577,7 +577,7 @@ template<>
 bool GJKSolver::shapeDistance<Box, Sphere>
 (const Box   & s1, const Transform3f& tf1,
  const Sphere& s2, const Transform3f& tf2,
- FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const
+ FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart*) const
 {
   return !details::boxSphereDistance (s1, tf1, s2, tf2, dist, p1, p2, normal);
 }
@@ -586,7 +586,7 @@ template<>
 bool GJKSolver::shapeDistance<Sphere, Box>
 (const Sphere& s1, const Transform3f& tf1,
  const Box   & s2, const Transform3f& tf2,
- FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const
+ FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart*) const
 {
   bool collide = details::boxSphereDistance (s2, tf2, s1, tf1, dist, p2, p1, normal);
   normal *= -1;
@@ -597,7 +597,7 @@ template<>
 bool GJKSolver::shapeDistance<Cylinder, Sphere>
 (const Cylinder& s1, const Transform3f& tf1,
  const Sphere& s2, const Transform3f& tf2,
- FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const
+ FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart*) const
 {
   return details::sphereCylinderDistance
     (s2, tf2, s1, tf1, dist, p2, p1, normal);
@@ -607,7 +607,7 @@ template<>
 bool GJKSolver::shapeDistance<Sphere, Sphere>
 (const Sphere& s1, const Transform3f& tf1,
  const Sphere& s2, const Transform3f& tf2,
- FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const
+ FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart*) const
 {
   return details::sphereSphereDistance(s1, tf1, s2, tf2, dist, p1, p2, normal);
 }
@@ -616,7 +616,7 @@ template<>
 bool GJKSolver::shapeDistance<Capsule, Capsule>
 (const Capsule& /*s1*/, const Transform3f& /*tf1*/,
  const Capsule& /*s2*/, const Transform3f& /*tf2*/,
- FCL_REAL& /*dist*/, Vec3f& /*p1*/, Vec3f& /*p2*/, Vec3f& /*normal*/) const
+ FCL_REAL& /*dist*/, Vec3f& /*p1*/, Vec3f& /*p2*/, Vec3f& /*normal*/, details::GJK::WarmStart*) const
 {
   abort ();
 }
@@ -625,7 +625,7 @@ bool GJKSolver::shapeDistance<Capsule, Capsule>
     bool GJKSolver::shapeDistance<TriangleP, TriangleP>
     (const TriangleP& s1, const Transform3f& tf1,
      const TriangleP& s2, const Transform3f& tf2,
-     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal) const
+     FCL_REAL& dist, Vec3f& p1, Vec3f& p2, Vec3f& normal, details::GJK::WarmStart*) const
   {
     const TriangleP
       t1 (tf1.transform(s1.a), tf1.transform(s1.b), tf1.transform(s1.c)),
@@ -0,0 +1,543 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <stdexcept>
+
+#include <hpp/fcl/sdf.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/narrowphase/gjk.h>
+#ifdef HPP_FCL_HAVE_OCTOMAP
+#include <hpp/fcl/octree.h>
+#endif
+
+#include "intersect.h"
+#include "sdf_solver.h"
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace
+{
+  /// @brief squared distance between a point and a segment, or a point if
+  ///        the segment is degenerate
+  FCL_REAL segmentSqrDistance(const Vec3f& a, const Vec3f& b, const Vec3f& p)
+  {
+    Project::ProjectResult res = Project::projectLine(a, b, p);
+    return (res.sqr_distance < 0) ? (p - a).squaredNorm() : res.sqr_distance;
+  }
+
+  /// @brief distance between a point and a triangle, possibly degenerate
+  FCL_REAL triangleDistance(const Vec3f& a, const Vec3f& b, const Vec3f& c,
+                            const Vec3f& p)
+  {
+    Project::ProjectResult res = Project::projectTriangle(a, b, c, p);
+    if(res.sqr_distance < 0)
+      res.sqr_distance = std::min(segmentSqrDistance(a, b, p),
+          std::min(segmentSqrDistance(b, c, p), segmentSqrDistance(c, a, p)));
+    return std::sqrt(res.sqr_distance);
+  }
+
+  /// @brief Whether a line parallel to x crosses a triangle.
+  /// @retval x coordinate of the intersection
+  bool crossTriangle(FCL_REAL y, FCL_REAL z,
+                     const Vec3f& a, const Vec3f& b, const Vec3f& c,
+                     FCL_REAL& x)
+  {
+    // barycentric coordinates of (y, z) in the projection of the triangle
+    const FCL_REAL wa = (c[1] - b[1]) * (z - b[2]) - (c[2] - b[2]) * (y - b[1]);
+    const FCL_REAL wb = (a[1] - c[1]) * (z - c[2]) - (a[2] - c[2]) * (y - c[1]);
+    const FCL_REAL wc = (b[1] - a[1]) * (z - a[2]) - (b[2] - a[2]) * (y - a[1]);
+    if(!((wa >= 0 && wb >= 0 && wc >= 0) || (wa <= 0 && wb <= 0 && wc <= 0)))
+      return false;
+    const FCL_REAL w = wa + wb + wc;
+    if(w == 0) return false;
+    x = (wa * a[0] + wb * b[0] + wc * c[0]) / w;
+    return true;
+  }
+
+#ifdef HPP_FCL_HAVE_OCTOMAP
+  /// @brief Squared euclidean distance transform of a line of samples, see
+  ///        P. Felzenszwalb and D. Huttenlocher, Distance Transforms of
+  ///        Sampled Functions, 2012.
+  void distanceTransform(const FCL_REAL* f, FCL_REAL* d, int n,
+                         int* v, FCL_REAL* z)
+  {
+    const FCL_REAL inf = std::numeric_limits<FCL_REAL>::infinity();
+    int k = 0;
+    v[0] = 0;
+    z[0] = -inf;
+    z[1] = inf;
+    for(int q = 1; q < n; ++q)
+    {
+      // intersection of the parabola of q with the lowest parabolas
+      FCL_REAL s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * (q - v[k]));
+      while(s <= z[k])
+      {
+        --k;
+        s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * (q - v[k]));
+      }
+      ++k;
+      v[k] = q;
+      z[k] = s;
+      z[k + 1] = inf;
+    }
+    k = 0;
+    for(int q = 0; q < n; ++q)
+    {
+      while(z[k + 1] < q) ++k;
+      d[q] = (FCL_REAL) ((q - v[k]) * (q - v[k])) + f[v[k]];
+    }
+  }
+
+  /// @brief Squared euclidean distance transform of a grid, in samples
+  void distanceTransform(std::vector<FCL_REAL>& grid, const int dims[3])
+  {
+    const int n = std::max(dims[0], std::max(dims[1], dims[2]));
+    std::vector<FCL_REAL> f (n), d (n), z (n + 1);
+    std::vector<int> v (n);
+    const std::size_t strides[3] = { 1, (std::size_t) dims[0],
+                                     (std::size_t) dims[0] * dims[1] };
+    for(int a = 0; a < 3; ++a)
+    {
+      const int b = (a + 1) % 3, c = (a + 2) % 3;
+      for(int j = 0; j < dims[b]; ++j)
+      {
+        for(int k = 0; k < dims[c]; ++k)
+        {
+          const std::size_t start = j * strides[b] + k * strides[c];
+          for(int i = 0; i < dims[a]; ++i) f[i] = grid[start + i * strides[a]];
+          distanceTransform(&f[0], &d[0], dims[a], &v[0], &z[0]);
+          for(int i = 0; i < dims[a]; ++i) grid[start + i * strides[a]] = d[i];
+        }
+      }
+    }
+  }
+#endif
+}
+
+SignedDistanceField::SignedDistanceField(const Vec3f& origin_,
+                                         FCL_REAL resolution_,
+                                         int nx, int ny, int nz,
+                                         const std::vector<FCL_REAL>& values_) :
+  origin (origin_),
+  resolution (resolution_),
+  values (values_)
+{
+  dims[0] = nx;
+  dims[1] = ny;
+  dims[2] = nz;
+  if(resolution <= 0)
+    throw std::invalid_argument("The resolution of a signed distance field must be positive.");
+  if(nx < 2 || ny < 2 || nz < 2)
+    throw std::invalid_argument("A signed distance field needs at least 2 samples along each axis.");
+  if(values.size() != (std::size_t) nx * ny * nz)
+    throw std::invalid_argument("The number of samples does not match the size of the signed distance field.");
+  computeLocalAABB();
+}
+
+void SignedDistanceField::initGrid(const AABB& box, FCL_REAL resolution_,
+                                   FCL_REAL padding)
+{
+  if(resolution_ <= 0)
+    throw std::invalid_argument("The resolution of a signed distance field must be positive.");
+  resolution = resolution_;
+  origin = box.min_ - Vec3f::Constant(padding);
+  for(int a = 0; a < 3; ++a)
+  {
+    FCL_REAL length = box.max_[a] - box.min_[a] + 2 * padding;
+    dims[a] = std::max(2, (int) std::ceil(length / resolution) + 1);
+  }
+  values.assign((std::size_t) dims[0] * dims[1] * dims[2],
+                std::numeric_limits<FCL_REAL>::max());
+}
+
+SignedDistanceField::SignedDistanceField(const BVHModelBase& model,
+                                         FCL_REAL resolution_,
+                                         FCL_REAL padding)
+{
+  if(model.num_tris == 0)
+    throw std::invalid_argument("The signed distance field of a mesh without triangle is not defined.");
+  AABB box;
+  for(int i = 0; i < model.num_vertices; ++i) box += model.vertices[i];
+  initGrid(box, resolution_, padding);
+
+  std::vector<int> closest (values.size(), -1);
+  std::vector<int> crossings (values.size(), 0);
+  // The lines along which the crossings are counted are moved by a tiny
+  // amount, so that they do not pass through the edges of meshes aligned
+  // with the grid.
+  const FCL_REAL offset_y = 1.234567e-7 * resolution;
+  const FCL_REAL offset_z = 1.456789e-7 * resolution;
+
+  // Exact distances to the triangles in the cells that contain them, and
+  // crossings of the lines of samples parallel to x.
+  for(int t = 0; t < model.num_tris; ++t)
+  {
+    const Triangle& tri = model.tri_indices[t];
+    const Vec3f& a = model.vertices[tri[0]];
+    const Vec3f& b = model.vertices[tri[1]];
+    const Vec3f& c = model.vertices[tri[2]];
+    int lo[3], hi[3];
+    for(int k = 0; k < 3; ++k)
+    {
+      FCL_REAL min = std::min(a[k], std::min(b[k], c[k]));
+      FCL_REAL max = std::max(a[k], std::max(b[k], c[k]));
+      lo[k] = std::max(0, (int) std::floor((min - origin[k]) / resolution) - 1);
+      hi[k] = std::min(dims[k] - 1, (int) std::ceil((max - origin[k]) / resolution) + 1);
+    }
+
+    for(int k = lo[2]; k <= hi[2]; ++k)
+    {
+      for(int j = lo[1]; j <= hi[1]; ++j)
+      {
+        for(int i = lo[0]; i <= hi[0]; ++i)
+        {
+          const Vec3f p (origin + resolution * Vec3f(i, j, k));
+          const FCL_REAL d = triangleDistance(a, b, c, p);
+          const std::size_t id = index(i, j, k);
+          if(d < values[id]) { values[id] = d; closest[id] = t; }
+        }
+
+        FCL_REAL x;
+        if(crossTriangle(origin[1] + j * resolution + offset_y,
+                         origin[2] + k * resolution + offset_z, a, b, c, x))
+        {
+          // the crossing counts for the samples after it
+          int i = std::max(0, (int) std::ceil((x - origin[0]) / resolution));
+          if(i < dims[0]) ++crossings[index(i, j, k)];
+        }
+      }
+    }
+  }
+
+  // Propagate the closest triangles to the rest of the grid by sweeping it
+  // in the 8 diagonal directions, twice.
+  for(int pass = 0; pass < 2; ++pass)
+  {
+    for(int s = 0; s < 8; ++s)
+    {
+      const int di = (s & 1) ? -1 : 1, dj = (s & 2) ? -1 : 1, dk = (s & 4) ? -1 : 1;
+      for(int k = (dk > 0) ? 0 : dims[2] - 1; k >= 0 && k < dims[2]; k += dk)
+      for(int j = (dj > 0) ? 0 : dims[1] - 1; j >= 0 && j < dims[1]; j += dj)
+      for(int i = (di > 0) ? 0 : dims[0] - 1; i >= 0 && i < dims[0]; i += di)
+      {
+        const std::size_t id = index(i, j, k);
+        const Vec3f p (origin + resolution * Vec3f(i, j, k));
+        // the 7 neighbours already visited by the sweep
+        for(int n = 1; n < 8; ++n)
+        {
+          const int i2 = i - ((n & 1) ? di : 0);
+          const int j2 = j - ((n & 2) ? dj : 0);
+          const int k2 = k - ((n & 4) ? dk : 0);
+          if(i2 < 0 || i2 >= dims[0] || j2 < 0 || j2 >= dims[1] ||
+             k2 < 0 || k2 >= dims[2])
+            continue;
+          const int t = closest[index(i2, j2, k2)];
+          if(t < 0 || t == closest[id]) continue;
+          const Triangle& tri = model.tri_indices[t];
+          const FCL_REAL d = triangleDistance(model.vertices[tri[0]],
+              model.vertices[tri[1]], model.vertices[tri[2]], p);
+          if(d < values[id]) { values[id] = d; closest[id] = t; }
+        }
+      }
+    }
+  }
+
+  // Samples after an odd number of crossings are inside.
+  for(int k = 0; k < dims[2]; ++k)
+  {
+    for(int j = 0; j < dims[1]; ++j)
+    {
+      int count = 0;
+      for(int i = 0; i < dims[0]; ++i)
+      {
+        const std::size_t id = index(i, j, k);
+        count += crossings[id];
+        if(count % 2) values[id] = -values[id];
+      }
+    }
+  }
+
+  computeLocalAABB();
+}
+
+#ifdef HPP_FCL_HAVE_OCTOMAP
+SignedDistanceField::SignedDistanceField(const OcTree& tree,
+                                         FCL_REAL resolution_,
+                                         FCL_REAL padding)
+{
+  const std::vector<boost::array<FCL_REAL, 6> > boxes (tree.toBoxes());
+  if(boxes.empty())
+    throw std::invalid_argument("The signed distance field of an octree without occupied cell is not defined.");
+  AABB box;
+  for(std::size_t b = 0; b < boxes.size(); ++b)
+  {
+    const Vec3f center (boxes[b][0], boxes[b][1], boxes[b][2]);
+    const Vec3f half (Vec3f::Constant(boxes[b][3] / 2));
+    box += center - half;
+    box += center + half;
+  }
+  // Half a sample more of padding puts the samples at the centers of the
+  // cells when the resolution and the padding are multiples of the one of
+  // the octree.
+  initGrid(box, resolution_, padding + resolution_ / 2);
+
+  // Squared distances, in samples, to the closest sample inside and to the
+  // closest sample outside. The samples are inside when they lie in an
+  // occupied cell.
+  const FCL_REAL far = 1e20;
+  std::vector<FCL_REAL> to_inside (values.size(), far);
+  std::vector<FCL_REAL> to_outside (values.size(), 0);
+  for(std::size_t b = 0; b < boxes.size(); ++b)
+  {
+    int lo[3], hi[3];
+    for(int k = 0; k < 3; ++k)
+    {
+      const FCL_REAL half = boxes[b][3] / 2;
+      lo[k] = std::max(0, (int) std::ceil((boxes[b][k] - half - origin[k]) / resolution));
+      hi[k] = std::min(dims[k], (int) std::ceil((boxes[b][k] + half - origin[k]) / resolution));
+    }
+    for(int k = lo[2]; k < hi[2]; ++k)
+      for(int j = lo[1]; j < hi[1]; ++j)
+        for(int i = lo[0]; i < hi[0]; ++i)
+        {
+          const std::size_t id = index(i, j, k);
+          to_inside[id] = 0;
+          to_outside[id] = far;
+        }
+  }
+  distanceTransform(to_inside, dims);
+  distanceTransform(to_outside, dims);
+
+  // The surface is half way between the samples inside and outside.
+  for(std::size_t id = 0; id < values.size(); ++id)
+  {
+    if(to_inside[id] == 0)
+      values[id] = - (std::sqrt(to_outside[id]) - .5) * resolution;
+    else
+      values[id] = (std::sqrt(to_inside[id]) - .5) * resolution;
+  }
+
+  computeLocalAABB();
+}
+#endif
+
+void SignedDistanceField::computeLocalAABB()
+{
+  aabb_local.min_ = origin;
+  aabb_local.max_ = origin + resolution *
+    Vec3f(dims[0] - 1, dims[1] - 1, dims[2] - 1);
+  aabb_center = aabb_local.center();
+  aabb_radius = (aabb_local.min_ - aabb_center).norm();
+}
+
+namespace
+{
+  /// @brief Local minimum of the field on a convex shape, by the conditional
+  ///        gradient method: the support point of the shape in the direction
+  ///        of steepest descent minimizes the linearized field, the next
+  ///        point is the minimum on the segment to this support point.
+  /// @param R, T pose of the shape in the frame of the field
+  /// @param point initial point of the shape, and the minimum at return,
+  ///        in the frame of the field
+  /// @retval gradient gradient of the field at the minimum
+  FCL_REAL descend(const SignedDistanceField& sdf, const ShapeBase& shape,
+                   const Matrix3f& R, const Vec3f& T, Vec3f& point,
+                   Vec3f& gradient)
+  {
+    const FCL_REAL tolerance = 1e-4 * sdf.getResolution();
+    const int max_iterations = 32;
+    const int line_search_iterations = 12;
+    const FCL_REAL golden = (std::sqrt(5.) - 1) / 2;
+
+    FCL_REAL value = sdf.distance(point, gradient);
+    for(int iter = 0; iter < max_iterations; ++iter)
+    {
+      const Vec3f s (R * details::getSupport(&shape, - R.transpose() * gradient, false) + T);
+      const Vec3f delta (s - point);
+      // upper bound of the gap between the current value and the minimum of
+      // the field on the shape, when the field is convex.
+      if(- gradient.dot(delta) <= tolerance) break;
+
+      FCL_REAL a = 0, b = 1;
+      FCL_REAL t1 = b - golden * (b - a), t2 = a + golden * (b - a);
+      FCL_REAL f1 = sdf.distance(point + t1 * delta),
+        f2 = sdf.distance(point + t2 * delta);
+      for(int i = 0; i < line_search_iterations; ++i)
+      {
+        if(f1 < f2)
+        {
+          b = t2; t2 = t1; f2 = f1;
+          t1 = b - golden * (b - a);
+          f1 = sdf.distance(point + t1 * delta);
+        }
+        else
+        {
+          a = t1; t1 = t2; f1 = f2;
+          t2 = a + golden * (b - a);
+          f2 = sdf.distance(point + t2 * delta);
+        }
+      }
+      FCL_REAL t = (f1 < f2) ? t1 : t2;
+      FCL_REAL f = std::min(f1, f2);
+      const FCL_REAL fs = sdf.distance(s);
+      if(fs < f) { t = 1; f = fs; }
+      if(f >= value) break;
+
+      point += t * delta;
+      value = sdf.distance(point, gradient);
+    }
+    return value;
+  }
+
+  /// @brief distance between a convex shape and a point, in the frame of
+  ///        the shape
+  /// @retval closest the point of the shape closest to p
+  FCL_REAL pointDistance(const ShapeBase& shape, const Vec3f& p, Vec3f& closest)
+  {
+    const Sphere origin (0);
+    details::MinkowskiDiff diff;
+    diff.set(&shape, &origin, Transform3f(), Transform3f(p));
+    details::GJK gjk(128, 1e-6);
+    const details::GJK::Status status = gjk.evaluate(diff, Vec3f(1, 0, 0));
+    Vec3f w1;
+    if(status != details::GJK::Inside)
+      details::GJK::getClosestPoints(*gjk.getSimplex(), closest, w1);
+    // p is inside the shape, or on it, which may leave a degenerate
+    // simplex, e.g. in the plane of a triangle.
+    if(status == details::GJK::Inside || gjk.distance <= 0 ||
+       !closest.allFinite())
+    {
+      closest = p;
+      return 0;
+    }
+    return gjk.distance;
+  }
+
+  /// @brief A box of the frame of a shape, and a lower bound of the field
+  ///        on it.
+  struct Cell
+  {
+    Vec3f center, half_side;
+    FCL_REAL bound;
+
+    Cell(const SignedDistanceField& sdf, const Matrix3f& R, const Vec3f& T,
+         const Vec3f& center_, const Vec3f& half_side_) :
+      center (center_), half_side (half_side_),
+      // the distance is 1-Lipschitz
+      bound (sdf.distance(R * center + T) - half_side.norm())
+    {}
+
+    bool operator< (const Cell& other) const { return bound > other.bound; }
+  };
+}
+
+namespace details
+{
+
+FCL_REAL minimizeOnShape(const SignedDistanceField& sdf, const ShapeBase& shape,
+                         const Transform3f& tf, Vec3f& point, Vec3f& gradient,
+                         FCL_REAL threshold)
+{
+  const Matrix3f& R = tf.getRotation();
+  const Vec3f& T = tf.getTranslation();
+  const FCL_REAL tolerance = sdf.getResolution();
+  const int max_cells = 1 << 12;
+
+  // Start from the support point of the shape in the direction of steepest
+  // descent at the origin of the shape.
+  sdf.distance(T, gradient);
+  point = R * getSupport(&shape, - R.transpose() * gradient, false) + T;
+  FCL_REAL value = descend(sdf, shape, R, T, point, gradient);
+
+  // The field is not convex: the local minimum is checked by branch and
+  // bound on a subdivision of the bounding box of the shape. The cells
+  // that meet the shape are searched from their point closest to their
+  // center, and split until the minimum is known up to the tolerance.
+  Vec3f lo, hi;
+  for(int a = 0; a < 3; ++a)
+  {
+    hi[a] = details::getSupport(&shape, Vec3f::Unit(a), true)[a];
+    lo[a] = details::getSupport(&shape, - Vec3f::Unit(a), true)[a];
+  }
+  std::priority_queue<Cell> cells;
+  cells.push(Cell(sdf, R, T, .5 * (lo + hi), .5 * (hi - lo)));
+  for(int n = 0; !cells.empty(); ++n)
+  {
+    const Cell cell (cells.top());
+    // The cells above the threshold cannot change the result of the query.
+    if(cell.bound >= std::min(value, threshold) - tolerance) break;
+    // The search is too long: the lower bound is returned.
+    if(n == max_cells) return cell.bound;
+    cells.pop();
+
+    const FCL_REAL radius = cell.half_side.norm();
+    Vec3f closest;
+    if(pointDistance(shape, cell.center, closest) > radius) continue;
+    Vec3f p (R * closest + T), g;
+    if(sdf.distance(p) < value)
+    {
+      const FCL_REAL f = descend(sdf, shape, R, T, p, g);
+      if(f < value) { value = f; point = p; gradient = g; }
+    }
+    // The field on the cell is not lower than at closest minus twice the
+    // radius.
+    if(2 * radius <= tolerance) continue;
+
+    int a;
+    cell.half_side.maxCoeff(&a);
+    Vec3f half_side (cell.half_side), offset (Vec3f::Zero());
+    half_side[a] *= .5;
+    offset[a] = half_side[a];
+    for(int k = 0; k < 2; ++k, offset = - offset)
+    {
+      const Cell child (sdf, R, T, cell.center + offset, half_side);
+      if(child.bound < std::min(value, threshold) - tolerance)
+        cells.push(child);
+    }
+  }
+  return value;
+}
+
+}
+
+}
+
+} // namespace hpp
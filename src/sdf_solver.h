@@ -0,0 +1,313 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HPP_FCL_SDF_SOLVER_H
+#define HPP_FCL_SDF_SOLVER_H
+
+/// @cond INTERNAL
+
+#include <limits>
+#include <algorithm>
+
+#include <hpp/fcl/sdf.h>
+#include <hpp/fcl/collision_data.h>
+#include <hpp/fcl/BV/BV.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace details
+{
+
+/// @brief Minimum of a signed distance field on a convex shape.
+///
+/// It is the signed distance between the shape and the object of the
+/// field, or the opposite of the depth of the deepest point of the shape
+/// when they overlap. Local minima are found with the conditional gradient
+/// method, which only needs the support function of the shape. As the
+/// field is not convex in general, they are checked by branch and bound on
+/// boxes covering the shape, with the bound given by the 1-Lipschitz
+/// continuity of the distance. The minimum is thus not overestimated by
+/// more than the resolution of the field.
+/// @param tf pose of the shape in the frame of the field
+/// @param threshold the minimum is not searched above it: the result is
+///        then only known not to be lower than threshold minus the
+///        resolution
+/// @retval point point of the shape reaching the result, in the frame of
+///         the field
+/// @retval gradient gradient of the field at this point
+/// @return the minimum, or a lower bound of it when the search is too long.
+FCL_REAL minimizeOnShape(const SignedDistanceField& sdf, const ShapeBase& shape,
+                         const Transform3f& tf, Vec3f& point, Vec3f& gradient,
+                         FCL_REAL threshold = std::numeric_limits<FCL_REAL>::max());
+
+}
+
+/// @brief Collision and distance queries between a signed distance field
+///        and shapes or meshes.
+///
+/// Shapes are tested with details::minimizeOnShape. The bounding volumes of
+/// a mesh are approximated by the bounding spheres of their oriented boxes:
+/// since the distance is 1-Lipschitz, the field is not lower on a sphere
+/// than at its center minus its radius. The triangles of the leaves whose
+/// sphere is not discarded are tested like shapes.
+class SDFSolver
+{
+public:
+  /// @param sdf_first whether the field is the first object of the query,
+  ///        which gives the order of the objects in the results.
+  SDFSolver(bool sdf_first) : sdf_first_ (sdf_first) {}
+
+  /// @brief distance between a field and a shape
+  FCL_REAL shapeDistance(const SignedDistanceField* sdf, const Transform3f& tf1,
+                         const ShapeBase* shape, const Transform3f& tf2,
+                         const DistanceRequest&, DistanceResult& result) const
+  {
+    Vec3f point, gradient;
+    FCL_REAL value = details::minimizeOnShape(*sdf, *shape,
+        tf1.inverseTimes(tf2), point, gradient);
+    updateDistance(sdf, tf1, shape, DistanceResult::NONE, value, point,
+                   gradient, result);
+    return value;
+  }
+
+  /// @brief collision between a field and a shape
+  std::size_t shapeIntersect(const SignedDistanceField* sdf, const Transform3f& tf1,
+                             const ShapeBase* shape, const Transform3f& tf2,
+                             const CollisionRequest& request,
+                             CollisionResult& result) const
+  {
+    Vec3f point, gradient;
+    FCL_REAL value = details::minimizeOnShape(*sdf, *shape,
+        tf1.inverseTimes(tf2), point, gradient, request.security_margin);
+    if(value <= request.security_margin)
+    {
+      if(result.numContacts() < request.num_max_contacts)
+        addContact(sdf, tf1, shape, Contact::NONE, value, point, gradient,
+                   result);
+      return 1;
+    }
+    result.distance_lower_bound = value;
+    return 0;
+  }
+
+  /// @brief distance between a field and a mesh
+  template<typename BV>
+  FCL_REAL meshDistance(const SignedDistanceField* sdf, const Transform3f& tf1,
+                        const BVHModel<BV>* model, const Transform3f& tf2,
+                        const DistanceRequest& request,
+                        DistanceResult& result) const
+  {
+    DistanceVisitor visitor = { this, sdf, &tf1, model, &request, &result };
+    if(model->getNumBVs() > 0)
+      minimizeOnMesh(*sdf, *model, tf1.inverseTimes(tf2), 0, visitor);
+    return result.min_distance;
+  }
+
+  /// @brief collision between a field and a mesh
+  template<typename BV>
+  std::size_t meshIntersect(const SignedDistanceField* sdf, const Transform3f& tf1,
+                            const BVHModel<BV>* model, const Transform3f& tf2,
+                            const CollisionRequest& request,
+                            CollisionResult& result) const
+  {
+    CollisionVisitor visitor = { this, sdf, &tf1, model, &request, &result,
+                                 std::numeric_limits<FCL_REAL>::max(), 0 };
+    if(model->getNumBVs() > 0)
+      minimizeOnMesh(*sdf, *model, tf1.inverseTimes(tf2), 0, visitor);
+    if(visitor.count == 0)
+      result.distance_lower_bound = visitor.lower_bound;
+    return visitor.count;
+  }
+
+private:
+  struct DistanceVisitor
+  {
+    const SDFSolver* solver;
+    const SignedDistanceField* sdf;
+    const Transform3f* tf;
+    const CollisionGeometry* other;
+    const DistanceRequest* request;
+    DistanceResult* result;
+
+    FCL_REAL threshold() const { return result->min_distance; }
+    void discard(FCL_REAL) {}
+    bool visit(int b, FCL_REAL value, const Vec3f& point, const Vec3f& gradient)
+    {
+      if(value < result->min_distance)
+        solver->updateDistance(sdf, *tf, other, b, value, point, gradient,
+                               *result);
+      return request->isSatisfied(*result);
+    }
+  };
+
+  struct CollisionVisitor
+  {
+    const SDFSolver* solver;
+    const SignedDistanceField* sdf;
+    const Transform3f* tf;
+    const CollisionGeometry* other;
+    const CollisionRequest* request;
+    CollisionResult* result;
+    FCL_REAL lower_bound;
+    std::size_t count;
+
+    FCL_REAL threshold() const { return request->security_margin; }
+    void discard(FCL_REAL bound) { lower_bound = std::min(lower_bound, bound); }
+    bool visit(int b, FCL_REAL value, const Vec3f& point, const Vec3f& gradient)
+    {
+      if(value > request->security_margin)
+      {
+        discard(value);
+        return false;
+      }
+      ++count;
+      if(result->numContacts() < request->num_max_contacts)
+        solver->addContact(sdf, *tf, other, b, value, point, gradient, *result);
+      return request->isSatisfied(*result);
+    }
+  };
+
+  /// @brief lower bound of the field on a bounding volume of a mesh
+  template<typename BV>
+  static FCL_REAL lowerBound(const SignedDistanceField& sdf, const BV& bv,
+                             const Transform3f& tf)
+  {
+    // BV::center is not the center of all the bounding volumes, e.g. RSS.
+    OBB obb;
+    convertBV(bv, tf, obb);
+    return sdf.distance(obb.To) - obb.extent.norm();
+  }
+
+  /// @brief Visit the triangles of a subtree of a mesh on which the field
+  ///        may be lower than the threshold of the visitor, closest first.
+  /// @param tf pose of the mesh in the frame of the field
+  /// @return whether the visitor stopped the search
+  template<typename BV, typename Visitor>
+  static bool minimizeOnMesh(const SignedDistanceField& sdf,
+                             const BVHModel<BV>& model, const Transform3f& tf,
+                             int b, Visitor& visitor)
+  {
+    const BVNode<BV>& node = model.getBV(b);
+    if(node.isLeaf())
+    {
+      const int id = node.primitiveId();
+      const Triangle& tri = model.tri_indices[id];
+      const TriangleP triangle(tf.transform(model.vertices[tri[0]]),
+                               tf.transform(model.vertices[tri[1]]),
+                               tf.transform(model.vertices[tri[2]]));
+      Vec3f point, gradient;
+      FCL_REAL value = details::minimizeOnShape(sdf, triangle, Transform3f(),
+                                                point, gradient,
+                                                visitor.threshold());
+      return visitor.visit(id, value, point, gradient);
+    }
+
+    int children[2] = { node.leftChild(), node.rightChild() };
+    FCL_REAL bounds[2] = {
+      lowerBound(sdf, model.getBV(children[0]).bv, tf),
+      lowerBound(sdf, model.getBV(children[1]).bv, tf) };
+    if(bounds[1] < bounds[0])
+    {
+      std::swap(children[0], children[1]);
+      std::swap(bounds[0], bounds[1]);
+    }
+    for(int i = 0; i < 2; ++i)
+    {
+      if(bounds[i] > visitor.threshold())
+        visitor.discard(bounds[i]);
+      else if(minimizeOnMesh(sdf, model, tf, children[i], visitor))
+        return true;
+    }
+    return false;
+  }
+
+  /// @brief closest point of the object of the field, in its frame
+  static Vec3f closestPoint(FCL_REAL value, const Vec3f& point,
+                            const Vec3f& gradient)
+  {
+    FCL_REAL norm = gradient.norm();
+    return (norm > 0) ? Vec3f(point - (value / norm) * gradient) : point;
+  }
+
+  /// @brief normal of the surface of the object of the field, in its frame
+  static Vec3f normal(const Vec3f& gradient)
+  {
+    FCL_REAL norm = gradient.norm();
+    return (norm > 0) ? Vec3f(gradient / norm) : Vec3f(0, 0, 1);
+  }
+
+  void updateDistance(const SignedDistanceField* sdf, const Transform3f& tf1,
+                      const CollisionGeometry* other, int b, FCL_REAL value,
+                      const Vec3f& point, const Vec3f& gradient,
+                      DistanceResult& result) const
+  {
+    const Vec3f p1 (tf1.transform(closestPoint(value, point, gradient)));
+    const Vec3f p2 (tf1.transform(point));
+    const Vec3f n (tf1.getRotation() * normal(gradient));
+    if(sdf_first_)
+      result.update(value, sdf, other, DistanceResult::NONE, b, p1, p2, n);
+    else
+      result.update(value, other, sdf, b, DistanceResult::NONE, p2, p1, -n);
+  }
+
+  void addContact(const SignedDistanceField* sdf, const Transform3f& tf1,
+                  const CollisionGeometry* other, int b, FCL_REAL value,
+                  const Vec3f& point, const Vec3f& gradient,
+                  CollisionResult& result) const
+  {
+    Contact contact = sdf_first_ ?
+      Contact(sdf, other, Contact::NONE, b) :
+      Contact(other, sdf, b, Contact::NONE);
+    contact.pos = tf1.transform(.5 * (point + closestPoint(value, point, gradient)));
+    contact.normal = tf1.getRotation() * normal(gradient);
+    if(!sdf_first_) contact.normal = - contact.normal;
+    contact.penetration_depth = - value;
+    result.addContact(contact);
+  }
+
+  bool sdf_first_;
+};
+
+}
+
+} // namespace hpp
+
+/// @endcond
+
+#endif
@@ -0,0 +1,528 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#include <hpp/fcl/serialization.h>
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/convex.h>
+#ifdef HPP_FCL_HAVE_OCTOMAP
+#include <hpp/fcl/octree.h>
+#endif
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace
+{
+
+const char magic[8] = "HPPFCLB";
+const boost::uint32_t version = 1;
+const boost::uint32_t byte_order = 0x01020304;
+
+/// @brief Alignment of the sections in the file
+const boost::uint64_t alignment = 64;
+
+enum { num_sections = 4 };
+
+/// @brief Array of elements stored in the file
+struct Section
+{
+  boost::uint64_t offset;
+  boost::uint64_t count;
+  boost::uint64_t element_size;
+};
+
+struct Header
+{
+  char magic[8];
+  boost::uint32_t version;
+  boost::uint32_t byte_order;
+  boost::uint32_t object_type;
+  boost::uint32_t node_type;
+
+  FCL_REAL aabb_min[3];
+  FCL_REAL aabb_max[3];
+  FCL_REAL aabb_radius;
+  FCL_REAL cost_density;
+  /// Parameters of the geometry, which depend on its type
+  FCL_REAL parameters[4];
+
+  Section sections[num_sections];
+};
+
+/// @brief Set the header fields common to all the geometries
+void initHeader(Header& header, const CollisionGeometry& geometry)
+{
+  memset(&header, 0, sizeof(Header));
+  memcpy(header.magic, magic, sizeof(magic));
+  header.version = version;
+  header.byte_order = byte_order;
+  header.object_type = geometry.getObjectType();
+  header.node_type = geometry.getNodeType();
+  for(int i = 0; i < 3; ++i)
+  {
+    header.aabb_min[i] = geometry.aabb_local.min_[i];
+    header.aabb_max[i] = geometry.aabb_local.max_[i];
+  }
+  header.aabb_radius = geometry.aabb_radius;
+  header.cost_density = geometry.cost_density;
+}
+
+void readHeader(const Header& header, CollisionGeometry& geometry)
+{
+  for(int i = 0; i < 3; ++i)
+  {
+    geometry.aabb_local.min_[i] = header.aabb_min[i];
+    geometry.aabb_local.max_[i] = header.aabb_max[i];
+  }
+  geometry.aabb_center = geometry.aabb_local.center();
+  geometry.aabb_radius = header.aabb_radius;
+  geometry.cost_density = header.cost_density;
+}
+
+/// @brief Writes a header and sections to a file.
+class Writer
+{
+public:
+  Writer(const CollisionGeometry& geometry) : num_(0)
+  {
+    initHeader(header, geometry);
+  }
+
+  Header header;
+
+  /// @brief Add a section of count elements of type T
+  template <typename T> void add(const T* data, std::size_t count)
+  {
+    add(reinterpret_cast<const char*>(data), count, sizeof(T));
+  }
+
+  void add(const char* data, std::size_t count, std::size_t element_size)
+  {
+    assert(num_ < num_sections);
+    Section& s = header.sections[num_];
+    s.count = count;
+    s.element_size = element_size;
+    data_[num_++] = data;
+  }
+
+  void write(const std::string& filename)
+  {
+    boost::uint64_t offset = align(sizeof(Header));
+    for(int i = 0; i < num_; ++i)
+    {
+      header.sections[i].offset = offset;
+      offset = align(offset + header.sections[i].count * header.sections[i].element_size);
+    }
+
+    std::ofstream os(filename.c_str(), std::ios::binary | std::ios::trunc);
+    if(!os)
+      throw std::runtime_error("Cannot open " + filename + " for writing.");
+    os.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    for(int i = 0; i < num_; ++i)
+    {
+      const Section& s = header.sections[i];
+      pad(os, s.offset);
+      os.write(data_[i], (std::streamsize)(s.count * s.element_size));
+    }
+    pad(os, offset);
+    if(!os)
+      throw std::runtime_error("Cannot write " + filename + ".");
+  }
+
+private:
+  const char* data_[num_sections];
+  int num_;
+
+  static boost::uint64_t align(boost::uint64_t offset)
+  {
+    return (offset + alignment - 1) / alignment * alignment;
+  }
+
+  static void pad(std::ofstream& os, boost::uint64_t offset)
+  {
+    static const char zeros[alignment] = {0};
+    std::streamoff pos = os.tellp();
+    os.write(zeros, (std::streamsize)(offset - (boost::uint64_t)pos));
+  }
+};
+
+/// @brief A file mapped in memory, or read in memory when mapping is not
+///        available.
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::string& filename) : data_(NULL), size_(0)
+  {
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0)
+      throw std::runtime_error("Cannot open " + filename + ".");
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+      close(fd);
+      throw std::runtime_error("Cannot read " + filename + ".");
+    }
+    size_ = (std::size_t)st.st_size;
+    void* data = mmap(NULL, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED)
+      throw std::runtime_error("Cannot map " + filename + ".");
+    data_ = static_cast<char*>(data);
+#else
+    std::ifstream is(filename.c_str(), std::ios::binary | std::ios::ate);
+    if(!is)
+      throw std::runtime_error("Cannot open " + filename + ".");
+    size_ = (std::size_t)is.tellg();
+    data_ = new char[size_];
+    is.seekg(0);
+    if(!is.read(data_, (std::streamsize)size_))
+    {
+      delete [] data_;
+      throw std::runtime_error("Cannot read " + filename + ".");
+    }
+#endif
+  }
+
+  ~MappedFile()
+  {
+#ifndef _WIN32
+    munmap(data_, size_);
+#else
+    delete [] data_;
+#endif
+  }
+
+  char* data() const { return data_; }
+  std::size_t size() const { return size_; }
+
+private:
+  char* data_;
+  std::size_t size_;
+};
+
+typedef boost::shared_ptr<MappedFile> MappedFilePtr_t;
+
+/// @brief Deleter of a geometry which keeps the mapping it points into
+///        alive.
+struct KeepMapping
+{
+  MappedFilePtr_t file;
+
+  void operator()(CollisionGeometry* geometry) const { delete geometry; }
+};
+
+/// @brief Pointer to the elements of section i, which must be of type T.
+template <typename T>
+T* section(const MappedFile& file, const Header& header, int i)
+{
+  const Section& s = header.sections[i];
+  if(s.count == 0) return NULL;
+  if(s.element_size != sizeof(T) || s.offset % alignment != 0
+     || s.offset > file.size()
+     || s.count > (file.size() - s.offset) / sizeof(T)
+     || s.count > (boost::uint64_t)std::numeric_limits<int>::max())
+    throw std::runtime_error("Invalid section in binary file.");
+  return reinterpret_cast<T*>(file.data() + s.offset);
+}
+
+/// @brief Check that the triangles are made of the vertices.
+void checkTriangles(const Triangle* triangles, std::size_t num_triangles,
+                    std::size_t num_vertices)
+{
+  for(std::size_t i = 0; i < num_triangles; ++i)
+    for(int j = 0; j < 3; ++j)
+      if(triangles[i][j] >= num_vertices)
+        throw std::runtime_error("Invalid triangle in binary file.");
+}
+
+void saveConvex(const CollisionGeometry& geometry, const std::string& filename)
+{
+  const Convex<Triangle>* convex =
+    dynamic_cast<const Convex<Triangle>*>(&geometry);
+  if(!convex)
+    throw std::invalid_argument("Only Convex<Triangle> can be saved.");
+  Writer writer(geometry);
+  writer.add(convex->points, (std::size_t)convex->num_points);
+  writer.add(convex->polygons, (std::size_t)convex->num_polygons);
+  writer.write(filename);
+}
+
+CollisionGeometry* loadConvex(const MappedFile& file, const Header& header)
+{
+  Vec3f* points = section<Vec3f>(file, header, 0);
+  Triangle* polygons = section<Triangle>(file, header, 1);
+  if(points == NULL)
+    throw std::runtime_error("Invalid convex in binary file.");
+  checkTriangles(polygons, header.sections[1].count, header.sections[0].count);
+  Convex<Triangle>* convex = new Convex<Triangle>(false,
+      points, (int)header.sections[0].count,
+      polygons, (int)header.sections[1].count);
+  readHeader(header, *convex);
+  return convex;
+}
+
+#ifdef HPP_FCL_HAVE_OCTOMAP
+void saveOcTree(const CollisionGeometry& geometry, const std::string& filename)
+{
+  const OcTree& octree = static_cast<const OcTree&>(geometry);
+  std::ostringstream os;
+  octree.getTree()->writeBinaryConst(os);
+  std::string data(os.str());
+
+  Writer writer(geometry);
+  writer.header.parameters[0] = octree.getDefaultOccupancy();
+  writer.header.parameters[1] = octree.getOccupancyThres();
+  writer.header.parameters[2] = octree.getFreeThres();
+  writer.add(data.data(), data.size());
+  writer.write(filename);
+}
+
+/// The octomap tree is made of linked nodes: it is read from the mapping.
+CollisionGeometry* loadOcTree(const MappedFile& file, const Header& header)
+{
+  const char* data = section<char>(file, header, 0);
+  std::istringstream is(std::string(data, header.sections[0].count));
+  boost::shared_ptr<octomap::OcTree> tree(new octomap::OcTree(1));
+  if(!tree->readBinary(is))
+    throw std::runtime_error("Invalid octree in binary file.");
+
+  OcTree* octree = new OcTree(tree);
+  octree->setCellDefaultOccupancy(header.parameters[0]);
+  octree->setOccupancyThres(header.parameters[1]);
+  octree->setFreeThres(header.parameters[2]);
+  readHeader(header, *octree);
+  return octree;
+}
+#endif
+
+} // namespace
+
+namespace internal
+{
+
+template <typename BV>
+struct BVHModelSerializer
+{
+  static void save(const CollisionGeometry& geometry, const std::string& filename)
+  {
+    const BVHModel<BV>& model = static_cast<const BVHModel<BV>&>(geometry);
+    if(model.build_state != BVH_BUILD_STATE_PROCESSED
+       && model.build_state != BVH_BUILD_STATE_UPDATED)
+      throw std::invalid_argument("The BVH model is not built.");
+
+    int num_primitives = (model.getModelType() == BVH_MODEL_TRIANGLES)
+      ? model.num_tris : model.num_vertices;
+    Writer writer(geometry);
+    writer.add(model.vertices, (std::size_t)model.num_vertices);
+    writer.add(model.tri_indices, (std::size_t)model.num_tris);
+    writer.add(model.bvs, (std::size_t)model.num_bvs);
+    writer.add(model.primitive_indices, (std::size_t)num_primitives);
+    writer.write(filename);
+  }
+
+  static CollisionGeometry* load(const MappedFile& file, const Header& header)
+  {
+    Vec3f* vertices = section<Vec3f>(file, header, 0);
+    Triangle* tri_indices = section<Triangle>(file, header, 1);
+    BVNode<BV>* bvs = section<BVNode<BV> >(file, header, 2);
+    unsigned int* primitive_indices = section<unsigned int>(file, header, 3);
+
+    // The traversals trust the indices: they are checked before the model
+    // is built on the mapping.
+    const std::size_t num_vertices = header.sections[0].count,
+      num_tris = header.sections[1].count, num_bvs = header.sections[2].count;
+    // The primitives are the triangles, or the vertices of a point cloud.
+    const std::size_t num_primitives = (num_tris > 0) ? num_tris : num_vertices;
+    if(header.sections[3].count != num_primitives || num_bvs == 0)
+      throw std::runtime_error("Invalid number of primitives in binary file.");
+    checkTriangles(tri_indices, num_tris, num_vertices);
+    for(std::size_t i = 0; i < num_primitives; ++i)
+      if(primitive_indices[i] >= num_primitives)
+        throw std::runtime_error("Invalid primitive in binary file.");
+    for(std::size_t i = 0; i < num_bvs; ++i)
+    {
+      const BVNode<BV>& node = bvs[i];
+      // The children are stored after their parent, which excludes cycles.
+      bool valid = (node.first_primitive >= 0 && node.num_primitives > 0
+        && (std::size_t)node.first_primitive + (std::size_t)node.num_primitives
+           <= num_primitives);
+      if(node.isLeaf())
+        valid = valid && (std::size_t)node.primitiveId() < num_primitives;
+      else
+        valid = valid && (std::size_t)node.first_child > i
+          && (std::size_t)node.first_child + 1 < num_bvs;
+      if(!valid)
+        throw std::runtime_error("Invalid bounding volume in binary file.");
+    }
+
+    BVHModel<BV>* model = new BVHModel<BV>();
+    model->own_storage_ = false;
+    model->vertices = vertices;
+    model->tri_indices = tri_indices;
+    model->bvs = bvs;
+    model->primitive_indices = primitive_indices;
+    model->num_vertices = model->num_vertices_allocated =
+      (int)header.sections[0].count;
+    model->num_tris = model->num_tris_allocated =
+      (int)header.sections[1].count;
+    model->num_bvs = model->num_bvs_allocated =
+      (int)header.sections[2].count;
+    model->build_state = BVH_BUILD_STATE_PROCESSED;
+    readHeader(header, *model);
+    return model;
+  }
+};
+
+} // namespace internal
+
+void saveBinary(const CollisionGeometry& geometry, const std::string& filename)
+{
+  switch(geometry.getNodeType())
+  {
+  case BV_AABB:
+    internal::BVHModelSerializer<AABB>::save(geometry, filename);
+    break;
+  case BV_OBB:
+    internal::BVHModelSerializer<OBB>::save(geometry, filename);
+    break;
+  case BV_RSS:
+    internal::BVHModelSerializer<RSS>::save(geometry, filename);
+    break;
+  case BV_kIOS:
+    internal::BVHModelSerializer<kIOS>::save(geometry, filename);
+    break;
+  case BV_OBBRSS:
+    internal::BVHModelSerializer<OBBRSS>::save(geometry, filename);
+    break;
+  case BV_KDOP16:
+    internal::BVHModelSerializer<KDOP<16> >::save(geometry, filename);
+    break;
+  case BV_KDOP18:
+    internal::BVHModelSerializer<KDOP<18> >::save(geometry, filename);
+    break;
+  case BV_KDOP24:
+    internal::BVHModelSerializer<KDOP<24> >::save(geometry, filename);
+    break;
+  case GEOM_CONVEX:
+    saveConvex(geometry, filename);
+    break;
+#ifdef HPP_FCL_HAVE_OCTOMAP
+  case GEOM_OCTREE:
+    saveOcTree(geometry, filename);
+    break;
+#endif
+  default:
+    throw std::invalid_argument("This geometry cannot be saved in binary format.");
+  }
+}
+
+CollisionGeometryPtr_t loadBinary(const std::string& filename)
+{
+  MappedFilePtr_t file(new MappedFile(filename));
+  if(file->size() < sizeof(Header))
+    throw std::runtime_error(filename + " is not a binary file of hpp-fcl.");
+  const Header& header = *reinterpret_cast<const Header*>(file->data());
+  if(memcmp(header.magic, magic, sizeof(magic)) != 0)
+    throw std::runtime_error(filename + " is not a binary file of hpp-fcl.");
+  if(header.version != version)
+    throw std::runtime_error(filename + " has an unsupported version.");
+  if(header.byte_order != byte_order)
+    throw std::runtime_error(filename + " was written on an incompatible machine.");
+
+  CollisionGeometry* geometry;
+  switch(header.node_type)
+  {
+  case BV_AABB:
+    geometry = internal::BVHModelSerializer<AABB>::load(*file, header);
+    break;
+  case BV_OBB:
+    geometry = internal::BVHModelSerializer<OBB>::load(*file, header);
+    break;
+  case BV_RSS:
+    geometry = internal::BVHModelSerializer<RSS>::load(*file, header);
+    break;
+  case BV_kIOS:
+    geometry = internal::BVHModelSerializer<kIOS>::load(*file, header);
+    break;
+  case BV_OBBRSS:
+    geometry = internal::BVHModelSerializer<OBBRSS>::load(*file, header);
+    break;
+  case BV_KDOP16:
+    geometry = internal::BVHModelSerializer<KDOP<16> >::load(*file, header);
+    break;
+  case BV_KDOP18:
+    geometry = internal::BVHModelSerializer<KDOP<18> >::load(*file, header);
+    break;
+  case BV_KDOP24:
+    geometry = internal::BVHModelSerializer<KDOP<24> >::load(*file, header);
+    break;
+  case GEOM_CONVEX:
+    geometry = loadConvex(*file, header);
+    break;
+#ifdef HPP_FCL_HAVE_OCTOMAP
+  case GEOM_OCTREE:
+    return CollisionGeometryPtr_t(loadOcTree(*file, header));
+#endif
+  default:
+    throw std::runtime_error(filename + " contains an unsupported geometry.");
+  }
+
+  KeepMapping deleter = { file };
+  return CollisionGeometryPtr_t(geometry, deleter);
+}
+
+}
+
+} // namespace hpp
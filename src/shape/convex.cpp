@@ -0,0 +1,535 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <hpp/fcl/shape/convex.h>
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace
+{
+
+/// @brief Triangular face of the hull during the quickhull algorithm.
+///
+/// Edge i goes from v[i] to v[(i+1)%3] and is shared with face adj[i].
+/// The vertices are in counter clockwise order seen from outside.
+struct HullFace
+{
+  int v[3];
+  int adj[3];
+  Vec3f n;
+  FCL_REAL d;
+  /// Points above the face, not yet in the hull
+  std::vector<int> outside;
+  bool alive;
+  bool visible;
+
+  FCL_REAL distance(const Vec3f& p) const { return n.dot(p) - d; }
+
+  /// Index of the edge from a to b, -1 if none.
+  int edge(int a, int b) const
+  {
+    for(int i = 0; i < 3; ++i)
+      if(v[i] == a && v[(i+1)%3] == b) return i;
+    return -1;
+  }
+};
+
+struct HorizonEdge
+{
+  int a, b;
+  /// Face across the edge, which is not visible from the eye point.
+  int face;
+};
+
+class QuickHull
+{
+public:
+  QuickHull(const Vec3f* points, int num_points, FCL_REAL eps)
+    : pts_(points), n_(num_points), eps_(eps) {}
+
+  /// @brief Compute the hull. Fills faces_ with the alive faces.
+  /// \return false if rounding errors made the hull inconsistent.
+  bool compute()
+  {
+    initialSimplex();
+
+    std::vector<int> stack;
+    for(int i = 0; i < (int)faces_.size(); ++i) stack.push_back(i);
+
+    std::vector<int> visible;
+    std::vector<HorizonEdge> horizon;
+    while(!stack.empty())
+    {
+      int f = stack.back();
+      stack.pop_back();
+      if(!faces_[f].alive || faces_[f].outside.empty()) continue;
+
+      // The farthest point above the face is on the hull.
+      const std::vector<int>& outside = faces_[f].outside;
+      int eye = outside[0];
+      FCL_REAL maxd = faces_[f].distance(pts_[eye]);
+      for(std::size_t k = 1; k < outside.size(); ++k)
+      {
+        FCL_REAL d = faces_[f].distance(pts_[outside[k]]);
+        if(d > maxd) { maxd = d; eye = outside[k]; }
+      }
+
+      visible.clear();
+      horizon.clear();
+      findHorizon(pts_[eye], f, -1, visible, horizon);
+      // Rounding errors: the visible faces are not a disk.
+      if(!isLoop(horizon)) return false;
+
+      // Create a cone of faces from the horizon to the eye point.
+      std::size_t first = faces_.size(), nh = horizon.size();
+      for(std::size_t k = 0; k < nh; ++k)
+      {
+        const HorizonEdge& e = horizon[k];
+        int nf = addFace(e.a, e.b, eye);
+        HullFace& face = faces_[nf];
+        face.adj[0] = e.face;
+        face.adj[1] = (int)(first + (k + 1) % nh);
+        face.adj[2] = (int)(first + (k + nh - 1) % nh);
+        HullFace& across = faces_[e.face];
+        across.adj[across.edge(e.b, e.a)] = nf;
+      }
+
+      // Give the outside points of the visible faces to the new faces.
+      for(std::size_t k = 0; k < visible.size(); ++k)
+      {
+        HullFace& vf = faces_[visible[k]];
+        vf.alive = false;
+        for(std::size_t l = 0; l < vf.outside.size(); ++l)
+        {
+          int p = vf.outside[l];
+          if(p == eye) continue;
+          assignPoint(p, first, faces_.size());
+        }
+        std::vector<int>().swap(vf.outside);
+      }
+      for(std::size_t k = first; k < faces_.size(); ++k)
+        stack.push_back((int)k);
+    }
+    return true;
+  }
+
+  std::vector<HullFace> faces_;
+
+private:
+  const Vec3f* pts_;
+  int n_;
+  FCL_REAL eps_;
+
+  int addFace(int a, int b, int c)
+  {
+    HullFace f;
+    f.v[0] = a; f.v[1] = b; f.v[2] = c;
+    f.adj[0] = f.adj[1] = f.adj[2] = -1;
+    f.n = (pts_[b] - pts_[a]).cross(pts_[c] - pts_[a]);
+    f.n.normalize();
+    f.d = f.n.dot(pts_[a]);
+    f.alive = true;
+    f.visible = false;
+    faces_.push_back(f);
+    return (int)faces_.size() - 1;
+  }
+
+  /// Add point p to the outside set of the face of [begin, end) it is the
+  /// farthest above, if any.
+  void assignPoint(int p, std::size_t begin, std::size_t end)
+  {
+    int best = -1;
+    FCL_REAL maxd = eps_;
+    for(std::size_t k = begin; k < end; ++k)
+    {
+      FCL_REAL d = faces_[k].distance(pts_[p]);
+      if(d > maxd) { maxd = d; best = (int)k; }
+    }
+    if(best >= 0) faces_[best].outside.push_back(p);
+  }
+
+  /// Depth first search of the faces visible from eye. The edges between
+  /// visible and hidden faces are added to horizon in counter clockwise
+  /// order.
+  ///
+  /// A face is visible if eye is above it, whatever the tolerance: hiding
+  /// the faces which are almost in the plane of eye may fold the new faces
+  /// over them.
+  void findHorizon(const Vec3f& eye, int f, int from,
+                   std::vector<int>& visible, std::vector<HorizonEdge>& horizon)
+  {
+    HullFace& face = faces_[f];
+    face.visible = true;
+    visible.push_back(f);
+    int start = (from < 0) ? 0 : from + 1;
+    int count = (from < 0) ? 3 : 2;
+    for(int k = 0; k < count; ++k)
+    {
+      int e = (start + k) % 3;
+      int g = face.adj[e];
+      if(faces_[g].visible) continue;
+      if(faces_[g].distance(eye) > 0)
+        findHorizon(eye, g, faces_[g].edge(face.v[(e+1)%3], face.v[e]),
+                    visible, horizon);
+      else
+      {
+        HorizonEdge h = { face.v[e], face.v[(e+1)%3], g };
+        horizon.push_back(h);
+      }
+    }
+  }
+
+  static bool isLoop(const std::vector<HorizonEdge>& horizon)
+  {
+    if(horizon.size() < 3) return false;
+    for(std::size_t k = 0; k < horizon.size(); ++k)
+      if(horizon[k].b != horizon[(k + 1) % horizon.size()].a) return false;
+    return true;
+  }
+
+  void initialSimplex()
+  {
+    // Two extreme points along the axes that are the farthest apart.
+    int extremes[6] = {0, 0, 0, 0, 0, 0};
+    for(int i = 1; i < n_; ++i)
+      for(int j = 0; j < 3; ++j)
+      {
+        if(pts_[i][j] < pts_[extremes[2*j  ]][j]) extremes[2*j  ] = i;
+        if(pts_[i][j] > pts_[extremes[2*j+1]][j]) extremes[2*j+1] = i;
+      }
+    int i0 = 0, i1 = 0;
+    FCL_REAL maxd = -1;
+    for(int j = 0; j < 3; ++j)
+    {
+      FCL_REAL d = (pts_[extremes[2*j+1]] - pts_[extremes[2*j]]).squaredNorm();
+      if(d > maxd) { maxd = d; i0 = extremes[2*j]; i1 = extremes[2*j+1]; }
+    }
+    if(std::sqrt(maxd) <= eps_)
+      throw std::invalid_argument("The points are all at the same place.");
+
+    // The farthest point from the line (i0, i1).
+    Vec3f u = (pts_[i1] - pts_[i0]).normalized();
+    int i2 = -1;
+    maxd = eps_;
+    for(int i = 0; i < n_; ++i)
+    {
+      FCL_REAL d = (pts_[i] - pts_[i0]).cross(u).norm();
+      if(d > maxd) { maxd = d; i2 = i; }
+    }
+    if(i2 < 0)
+      throw std::invalid_argument("The points are all on a line.");
+
+    // The farthest point from the plane (i0, i1, i2).
+    Vec3f n = (pts_[i1] - pts_[i0]).cross(pts_[i2] - pts_[i0]).normalized();
+    int i3 = -1;
+    maxd = eps_;
+    for(int i = 0; i < n_; ++i)
+    {
+      FCL_REAL d = std::abs(n.dot(pts_[i] - pts_[i0]));
+      if(d > maxd) { maxd = d; i3 = i; }
+    }
+    if(i3 < 0)
+      throw std::invalid_argument("The points are all on a plane.");
+
+    // Orient the tetrahedron so that i3 is below the face (i0, i1, i2).
+    if(n.dot(pts_[i3] - pts_[i0]) > 0) std::swap(i1, i2);
+    addFace(i0, i1, i2);
+    addFace(i0, i3, i1);
+    addFace(i1, i3, i2);
+    addFace(i2, i3, i0);
+    for(int f = 0; f < 4; ++f)
+      for(int e = 0; e < 3; ++e)
+      {
+        int a = faces_[f].v[e], b = faces_[f].v[(e+1)%3];
+        for(int g = 0; g < 4; ++g)
+          if(faces_[g].edge(b, a) >= 0) faces_[f].adj[e] = g;
+      }
+
+    for(int i = 0; i < n_; ++i)
+    {
+      if(i == i0 || i == i1 || i == i2 || i == i3) continue;
+      assignPoint(i, 0, 4);
+    }
+  }
+};
+
+/// @brief Vertices of the polygon made by a set of coplanar faces, in
+///        counter clockwise order. Empty if the faces do not make a disk,
+///        or if the polygon is not convex up to eps.
+std::vector<int> polygonBoundary(const std::vector<HullFace>& faces,
+                                 const std::vector<int>& group,
+                                 const std::vector<int>& group_of,
+                                 const Vec3f* points, FCL_REAL eps)
+{
+  // Boundary edges, as a map from the origin to the end of the edge.
+  int gid = group_of[group[0]];
+  std::map<int, int> next;
+  for(std::size_t k = 0; k < group.size(); ++k)
+  {
+    const HullFace& f = faces[group[k]];
+    for(int e = 0; e < 3; ++e)
+    {
+      if(group_of[f.adj[e]] == gid) continue;
+      if(!next.insert(std::make_pair(f.v[e], f.v[(e+1)%3])).second)
+        return std::vector<int>();
+    }
+  }
+
+  std::vector<int> loop;
+  int start = next.begin()->first, v = start;
+  do
+  {
+    loop.push_back(v);
+    std::map<int, int>::const_iterator it = next.find(v);
+    if(it == next.end() || loop.size() > next.size()) return std::vector<int>();
+    v = it->second;
+  } while(v != start);
+  if(loop.size() != next.size()) return std::vector<int>();
+
+  // The faces are only coplanar up to eps: the polygon may be concave.
+  const Vec3f& n = faces[group[0]].n;
+  const std::size_t m = loop.size();
+  for(std::size_t k = 0; k < m; ++k)
+  {
+    const Vec3f& a = points[loop[(k + m - 1) % m]];
+    const Vec3f& v = points[loop[k]];
+    const Vec3f& b = points[loop[(k + 1) % m]];
+    if((b - a).cross(v - a).dot(n) > eps * (b - a).norm())
+      return std::vector<int>();
+  }
+  return loop;
+}
+
+} // namespace
+
+ConvexBase* ConvexBase::convexHull(const Vec3f* points, int num_points,
+                                   FCL_REAL tolerance)
+{
+  if(num_points < 4)
+    throw std::invalid_argument("At least 4 points are needed to build a "
+                                "convex hull.");
+
+  Vec3f lo(points[0]), hi(points[0]);
+  for(int i = 1; i < num_points; ++i)
+  {
+    lo = lo.cwiseMin(points[i]);
+    hi = hi.cwiseMax(points[i]);
+  }
+  const FCL_REAL eps = tolerance * (hi - lo).norm();
+
+  // The visibility of the faces is decided by the sign of a distance,
+  // which rounding errors make unreliable for degenerate sets of points,
+  // e.g. coplanar points. The hull is computed on points moved randomly by
+  // a fraction of the tolerance, which are in general position, and
+  // computed again with other moves if it still fails.
+  std::vector<Vec3f> moved (num_points);
+  boost::random::mt19937 generator;
+  boost::random::uniform_real_distribution<FCL_REAL> noise (-.1 * eps, .1 * eps);
+  std::vector<HullFace> faces;
+  for(int attempt = 0; faces.empty(); ++attempt)
+  {
+    if(attempt == 8)
+      throw std::runtime_error("Failed to compute the convex hull.");
+    for(int i = 0; i < num_points; ++i)
+      for(int j = 0; j < 3; ++j)
+        moved[i][j] = points[i][j] + noise(generator);
+    QuickHull qh(&moved[0], num_points, eps);
+    if(qh.compute()) faces.swap(qh.faces_);
+  }
+
+  // Group the adjacent faces which are in the plane of the first face of
+  // the group. The largest faces, whose normal is the most accurate, are
+  // taken first.
+  std::vector<std::pair<FCL_REAL, int> > by_area;
+  for(std::size_t f = 0; f < faces.size(); ++f)
+  {
+    if(!faces[f].alive) continue;
+    const int* v = faces[f].v;
+    by_area.push_back(std::make_pair(- (points[v[1]] - points[v[0]])
+          .cross(points[v[2]] - points[v[0]]).squaredNorm(), (int)f));
+  }
+  std::sort(by_area.begin(), by_area.end());
+  std::vector<int> group_of(faces.size(), -1);
+  std::vector<std::vector<int> > groups;
+  for(std::size_t k = 0; k < by_area.size(); ++k)
+  {
+    const int f = by_area[k].second;
+    if(group_of[f] >= 0) continue;
+    int gid = (int)groups.size();
+    groups.push_back(std::vector<int>(1, f));
+    std::vector<int>& group = groups.back();
+    group_of[f] = gid;
+    for(std::size_t k = 0; k < group.size(); ++k)
+    {
+      const HullFace& g = faces[group[k]];
+      for(int e = 0; e < 3; ++e)
+      {
+        int h = g.adj[e];
+        if(group_of[h] >= 0) continue;
+        const HullFace& fh = faces[h];
+        bool coplanar = true;
+        for(int i = 0; i < 3; ++i)
+          coplanar = coplanar
+            && std::abs(faces[f].distance(points[fh.v[i]])) <= eps;
+        if(coplanar)
+        {
+          group_of[h] = gid;
+          group.push_back(h);
+        }
+      }
+    }
+  }
+
+  // Boundary of the polygon of each group. Groups which are not a convex
+  // disk are kept as separate triangles.
+  std::vector<std::vector<int> > polygons;
+  std::vector<int> polygon_group;
+  for(std::size_t g = 0; g < groups.size(); ++g)
+  {
+    std::vector<int> loop = polygonBoundary(faces, groups[g], group_of,
+                                            points, eps);
+    if(!loop.empty())
+    {
+      polygons.push_back(loop);
+      polygon_group.push_back((int)g);
+    }
+    else
+      for(std::size_t k = 0; k < groups[g].size(); ++k)
+      {
+        const HullFace& f = faces[groups[g][k]];
+        polygons.push_back(std::vector<int>(f.v, f.v + 3));
+        polygon_group.push_back(-1);
+      }
+  }
+
+  // A vertex which is inside a polygon or on a straight part of the
+  // boundary of all the polygons it belongs to is not a vertex of the hull.
+  // Removing a vertex of more than two polygons would leave a hole.
+  std::vector<bool> corner(num_points, false);
+  std::vector<int> valence(num_points, 0);
+  for(std::size_t p = 0; p < polygons.size(); ++p)
+  {
+    const std::vector<int>& poly = polygons[p];
+    std::size_t n = poly.size();
+    for(std::size_t k = 0; k < n; ++k)
+    {
+      const Vec3f& a = points[poly[(k + n - 1) % n]];
+      const Vec3f& v = points[poly[k]];
+      const Vec3f& b = points[poly[(k + 1) % n]];
+      Vec3f u = (b - a).normalized();
+      if((v - a).cross(u).norm() > eps || ++valence[poly[k]] > 2)
+        corner[poly[k]] = true;
+    }
+  }
+
+  std::vector<int> index(num_points, -1);
+  int num_hull_points = 0;
+  for(int i = 0; i < num_points; ++i)
+    if(corner[i]) index[i] = num_hull_points++;
+
+  Vec3f* hull_points = new Vec3f[num_hull_points];
+  for(int i = 0; i < num_points; ++i)
+    if(corner[i]) hull_points[index[i]] = points[i];
+
+  // Triangulate the polygons in zig-zag, so that no vertex gets too many
+  // neighbors. The first triangle is cut at the sharpest corner: cut at a
+  // flat corner, it would be too thin to have an accurate normal. The
+  // polygons which keep all the points of their faces keep their faces,
+  // which are convex.
+  std::vector<Triangle> triangles;
+  std::vector<int> poly;
+  for(std::size_t p = 0; p < polygons.size(); ++p)
+  {
+    const std::vector<int>* group = (polygon_group[p] >= 0)
+      ? &groups[polygon_group[p]] : NULL;
+    bool keep_faces = true;
+    for(std::size_t k = 0; group != NULL && k < group->size(); ++k)
+      for(int l = 0; l < 3; ++l)
+        keep_faces = keep_faces && corner[faces[(*group)[k]].v[l]];
+    if(group != NULL && keep_faces)
+    {
+      for(std::size_t k = 0; k < group->size(); ++k)
+      {
+        const int* v = faces[(*group)[k]].v;
+        triangles.push_back(Triangle(index[v[0]], index[v[1]], index[v[2]]));
+      }
+      continue;
+    }
+
+    poly.clear();
+    for(std::size_t k = 0; k < polygons[p].size(); ++k)
+      if(corner[polygons[p][k]]) poly.push_back(index[polygons[p][k]]);
+    const std::size_t n = poly.size();
+    std::size_t sharpest = 0;
+    FCL_REAL max_cos = -2;
+    for(std::size_t k = 0; k < n; ++k)
+    {
+      const Vec3f& v = hull_points[poly[k]];
+      FCL_REAL c = (hull_points[poly[(k + n - 1) % n]] - v).normalized()
+        .dot((hull_points[poly[(k + 1) % n]] - v).normalized());
+      if(c > max_cos) { max_cos = c; sharpest = k; }
+    }
+    std::rotate(poly.begin(), poly.begin() + sharpest, poly.end());
+    int i = 0, j = (int)n - 1;
+    bool left = true;
+    while(j - i >= 2)
+    {
+      if(left) { triangles.push_back(Triangle(poly[i], poly[i+1], poly[j])); ++i; }
+      else     { triangles.push_back(Triangle(poly[i], poly[j-1], poly[j])); --j; }
+      left = !left;
+    }
+  }
+
+  Triangle* hull_triangles = new Triangle[triangles.size()];
+  std::copy(triangles.begin(), triangles.end(), hull_triangles);
+  return new Convex<Triangle>(true, hull_points, num_hull_points,
+                              hull_triangles, (int)triangles.size());
+}
+
+}
+
+} // namespace hpp
@@ -51,6 +51,7 @@ ConvexBase::ConvexBase(bool own_storage, Vec3f* points_, int num_points_) :
   own_storage_ (own_storage)
 {
   computeCenter();
+  computeSupportStarts();
 }
 
 ConvexBase::ConvexBase(const ConvexBase& other) :
@@ -58,6 +59,7 @@ ConvexBase::ConvexBase(const ConvexBase& other) :
   points       (other.points),
   num_points   (other.num_points),
   center       (other.center),
+  support_starts (other.support_starts),
   own_storage_ (other.own_storage_)
 {
   if (own_storage_) {
@@ -89,6 +91,37 @@ void ConvexBase::computeCenter()
   center /= num_points;
 }
 
+void ConvexBase::computeSupportStarts()
+{
+  support_starts.clear();
+  if(num_points < support_start_min_points) return;
+
+  const int N = support_start_resolution;
+  support_starts.resize(6 * N * N);
+  Vec3f dir;
+  for(int face = 0; face < 6; ++face)
+  {
+    int a = face / 2, b = (a + 1) % 3, c = (a + 2) % 3;
+    dir[a] = (face % 2) ? -1 : 1;
+    for(int i = 0; i < N; ++i)
+    {
+      dir[b] = (2 * i + 1) / (FCL_REAL)N - 1;
+      for(int j = 0; j < N; ++j)
+      {
+        dir[c] = (2 * j + 1) / (FCL_REAL)N - 1;
+        unsigned int best = 0;
+        FCL_REAL maxdot = points[0].dot(dir);
+        for(int k = 1; k < num_points; ++k)
+        {
+          FCL_REAL dot = points[k].dot(dir);
+          if(dot > maxdot) { maxdot = dot; best = (unsigned int)k; }
+        }
+        support_starts[(face * N + i) * N + j] = best;
+      }
+    }
+  }
+}
+
 void Halfspace::unitNormalTest()
 {
   FCL_REAL l = n.norm();
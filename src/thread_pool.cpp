@@ -0,0 +1,206 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <hpp/fcl/thread_pool.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <boost/bind.hpp>
+
+namespace hpp
+{
+namespace fcl
+{
+
+ThreadPool::ThreadPool(std::size_t num_threads) :
+  num_threads_(num_threads),
+  task_(NULL),
+  grain_(1),
+  generation_(0),
+  active_(0),
+  stop_(false),
+  failed_(false)
+{
+  if(num_threads_ == 0)
+    num_threads_ = std::max(1u, boost::thread::hardware_concurrency());
+  ranges_.reset(new Range[num_threads_]);
+  for(std::size_t i = 0; i < num_threads_; ++i)
+    ranges_[i].begin = ranges_[i].end = 0;
+  for(std::size_t i = 1; i < num_threads_; ++i)
+    threads_.create_thread(boost::bind(&ThreadPool::workerLoop, this, i));
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    boost::mutex::scoped_lock lock(lock_);
+    stop_ = true;
+  }
+  job_cond_.notify_all();
+  threads_.join_all();
+}
+
+void ThreadPool::parallelFor(std::size_t n, Task& task, std::size_t grain)
+{
+  if(n == 0) return;
+  if(grain == 0) grain = 1;
+
+  if(num_threads_ == 1 || n <= grain)
+  {
+    task.run(0, n, 0);
+    return;
+  }
+
+  for(std::size_t i = 0; i < num_threads_; ++i)
+  {
+    boost::mutex::scoped_lock lock(ranges_[i].lock);
+    ranges_[i].begin = n * i / num_threads_;
+    ranges_[i].end = n * (i + 1) / num_threads_;
+  }
+
+  {
+    boost::mutex::scoped_lock lock(lock_);
+    task_ = &task;
+    grain_ = grain;
+    active_ = num_threads_ - 1;
+    failed_ = false;
+    error_.clear();
+    ++generation_;
+  }
+  job_cond_.notify_all();
+
+  work(0);
+
+  {
+    boost::mutex::scoped_lock lock(lock_);
+    while(active_ > 0)
+      done_cond_.wait(lock);
+    task_ = NULL;
+  }
+
+  if(failed_)
+    throw std::runtime_error(error_);
+}
+
+void ThreadPool::workerLoop(std::size_t id)
+{
+  std::size_t generation = 0;
+  while(true)
+  {
+    {
+      boost::mutex::scoped_lock lock(lock_);
+      while(!stop_ && generation == generation_)
+        job_cond_.wait(lock);
+      if(stop_) return;
+      generation = generation_;
+    }
+
+    work(id);
+
+    {
+      boost::mutex::scoped_lock lock(lock_);
+      if(--active_ == 0)
+        done_cond_.notify_one();
+    }
+  }
+}
+
+void ThreadPool::work(std::size_t id)
+{
+  Range& own = ranges_[id];
+  while(true)
+  {
+    std::size_t begin, end;
+    {
+      boost::mutex::scoped_lock lock(own.lock);
+      begin = own.begin;
+      end = std::min(own.begin + grain_, own.end);
+      own.begin = end;
+    }
+    if(begin < end)
+      runTask(begin, end, id);
+    else if(!steal(id))
+      return;
+  }
+}
+
+bool ThreadPool::steal(std::size_t thief)
+{
+  // The range of the thief is empty, so no other thread modifies it: it is
+  // only updated once the lock of the victim has been released.
+  for(std::size_t k = 1; k < num_threads_; ++k)
+  {
+    Range& victim = ranges_[(thief + k) % num_threads_];
+    std::size_t begin, end;
+    {
+      boost::mutex::scoped_lock lock(victim.lock);
+      if(victim.begin >= victim.end) continue;
+      std::size_t remaining = victim.end - victim.begin;
+      end = victim.end;
+      victim.end -= (remaining > grain_) ? remaining / 2 : remaining;
+      begin = victim.end;
+    }
+    Range& own = ranges_[thief];
+    boost::mutex::scoped_lock lock(own.lock);
+    own.begin = begin;
+    own.end = end;
+    return true;
+  }
+  return false;
+}
+
+void ThreadPool::runTask(std::size_t begin, std::size_t end, std::size_t id)
+{
+  try
+  {
+    task_->run(begin, end, id);
+  }
+  catch(const std::exception& e)
+  {
+    boost::mutex::scoped_lock lock(lock_);
+    if(!failed_) error_ = e.what();
+    failed_ = true;
+  }
+  catch(...)
+  {
+    boost::mutex::scoped_lock lock(lock_);
+    if(!failed_) error_ = "unknown exception in ThreadPool task";
+    failed_ = true;
+  }
+}
+
+}
+
+} // namespace hpp
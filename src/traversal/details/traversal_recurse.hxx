@@ -0,0 +1,526 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef HPP_FCL_TRAVERSAL_DETAILS_TRAVERSAL_RECURSE_HXX
+#define HPP_FCL_TRAVERSAL_DETAILS_TRAVERSAL_RECURSE_HXX
+
+/// @cond INTERNAL
+
+#include <algorithm>
+#include <limits>
+
+namespace hpp
+{
+namespace fcl
+{
+
+namespace details
+{
+  /// Calls to the methods of a traversal node of type Node. They are not
+  /// virtual, so that they can be inlined in the traversal: Node must be the
+  /// dynamic type of the node.
+  template<typename Node> struct StaticTraversalCalls
+  {
+    static bool isFirstNodeLeaf(const Node* n, int b)
+    { return n->Node::isFirstNodeLeaf(b); }
+    static bool isSecondNodeLeaf(const Node* n, int b)
+    { return n->Node::isSecondNodeLeaf(b); }
+    static bool firstOverSecond(const Node* n, int b1, int b2)
+    { return n->Node::firstOverSecond(b1, b2); }
+    static int getFirstLeftChild(const Node* n, int b)
+    { return n->Node::getFirstLeftChild(b); }
+    static int getFirstRightChild(const Node* n, int b)
+    { return n->Node::getFirstRightChild(b); }
+    static int getSecondLeftChild(const Node* n, int b)
+    { return n->Node::getSecondLeftChild(b); }
+    static int getSecondRightChild(const Node* n, int b)
+    { return n->Node::getSecondRightChild(b); }
+
+    static bool BVDisjoints(const Node* n, int b1, int b2,
+                            FCL_REAL& sqrDistLowerBound)
+    { return n->Node::BVDisjoints(b1, b2, sqrDistLowerBound); }
+    static void leafCollides(const Node* n, int b1, int b2,
+                             FCL_REAL& sqrDistLowerBound)
+    { n->Node::leafCollides(b1, b2, sqrDistLowerBound); }
+    static bool canStop(const Node* n)
+    { return n->Node::canStop(); }
+
+    static FCL_REAL BVDistanceLowerBound(const Node* n, int b1, int b2)
+    { return n->Node::BVDistanceLowerBound(b1, b2); }
+    static void leafComputeDistance(const Node* n, int b1, int b2)
+    {
+      n->Node::leafComputeDistance(b1, b2);
+      n->shareMinDistance();
+    }
+    static bool canStop(const Node* n, FCL_REAL c)
+    { return n->Node::canStop(c); }
+  };
+
+  /// Calls to the methods of a traversal node through virtual dispatch.
+  template<typename Base> struct VirtualTraversalCalls
+  {
+    static bool isFirstNodeLeaf(const Base* n, int b)
+    { return n->isFirstNodeLeaf(b); }
+    static bool isSecondNodeLeaf(const Base* n, int b)
+    { return n->isSecondNodeLeaf(b); }
+    static bool firstOverSecond(const Base* n, int b1, int b2)
+    { return n->firstOverSecond(b1, b2); }
+    static int getFirstLeftChild(const Base* n, int b)
+    { return n->getFirstLeftChild(b); }
+    static int getFirstRightChild(const Base* n, int b)
+    { return n->getFirstRightChild(b); }
+    static int getSecondLeftChild(const Base* n, int b)
+    { return n->getSecondLeftChild(b); }
+    static int getSecondRightChild(const Base* n, int b)
+    { return n->getSecondRightChild(b); }
+
+    static bool BVDisjoints(const Base* n, int b1, int b2,
+                            FCL_REAL& sqrDistLowerBound)
+    { return n->BVDisjoints(b1, b2, sqrDistLowerBound); }
+    static void leafCollides(const Base* n, int b1, int b2,
+                             FCL_REAL& sqrDistLowerBound)
+    { n->leafCollides(b1, b2, sqrDistLowerBound); }
+    static bool canStop(const Base* n)
+    { return n->canStop(); }
+
+    static FCL_REAL BVDistanceLowerBound(const Base* n, int b1, int b2)
+    { return n->BVDistanceLowerBound(b1, b2); }
+    static void leafComputeDistance(const Base* n, int b1, int b2)
+    {
+      n->leafComputeDistance(b1, b2);
+      n->shareMinDistance();
+    }
+    static bool canStop(const Base* n, FCL_REAL c)
+    { return n->canStop(c); }
+  };
+
+  /// Calls used by the traversal functions on a node of type Node.
+  template<typename Node> struct TraversalCalls
+    : StaticTraversalCalls<Node> {};
+
+  template<> struct TraversalCalls<CollisionTraversalNodeBase>
+    : VirtualTraversalCalls<CollisionTraversalNodeBase> {};
+
+  template<> struct TraversalCalls<DistanceTraversalNodeBase>
+    : VirtualTraversalCalls<DistanceTraversalNodeBase> {};
+
+  /** @brief Bounding volume test structure */
+  struct BVT
+  {
+    /** @brief distance between bvs */
+    FCL_REAL d;
+
+    /** @brief bv indices for a pair of bvs in two models */
+    int b1, b2;
+  };
+
+  /** @brief Comparer between two BVT */
+  struct BVT_Comparer
+  {
+    bool operator() (const BVT& lhs, const BVT& rhs) const
+    {
+      return lhs.d > rhs.d;
+    }
+  };
+
+  /** @brief Order of BVT by increasing distance */
+  inline bool closer(const BVT& lhs, const BVT& rhs)
+  {
+    return lhs.d < rhs.d;
+  }
+
+  struct BVTQ
+  {
+    BVTQ() : qsize(2) {}
+
+    bool empty() const
+    {
+      return pq.empty();
+    }
+
+    size_t size() const
+    {
+      return pq.size();
+    }
+
+    const BVT& top() const
+    {
+      return pq.top();
+    }
+
+    void push(const BVT& x)
+    {
+      pq.push(x);
+    }
+
+    void pop()
+    {
+      pq.pop();
+    }
+
+    bool full() const
+    {
+      return (pq.size() + 1 >= qsize);
+    }
+
+    std::priority_queue<BVT, std::vector<BVT>, BVT_Comparer> pq;
+
+    /** @brief Queue size */
+    unsigned int qsize;
+  };
+} // namespace details
+
+template<typename Node>
+void collisionRecurse(Node* node, int b1, int b2,
+		      BVHFrontList* front_list, FCL_REAL& sqrDistLowerBound)
+{
+  typedef details::TraversalCalls<Node> C;
+  bool l1 = C::isFirstNodeLeaf(node, b1);
+  bool l2 = C::isSecondNodeLeaf(node, b2);
+  if(l1 && l2)
+  {
+    updateFrontList(front_list, b1, b2);
+
+   // if(node->BVDisjoints(b1, b2, sqrDistLowerBound)) return;
+    C::leafCollides(node, b1, b2, sqrDistLowerBound);
+    return;
+  }
+
+  if(C::BVDisjoints(node, b1, b2, sqrDistLowerBound)) {
+    updateFrontList(front_list, b1, b2);
+    return;
+  }
+  FCL_REAL sqrDistLowerBound1 = 0, sqrDistLowerBound2 = 0;
+  if(C::firstOverSecond(node, b1, b2))
+  {
+    int c1 = C::getFirstLeftChild(node, b1);
+    int c2 = C::getFirstRightChild(node, b1);
+
+    collisionRecurse(node, c1, b2, front_list, sqrDistLowerBound1);
+
+    // early stop is disabled is front_list is used
+    if(C::canStop(node) && !front_list) return;
+
+    collisionRecurse(node, c2, b2, front_list, sqrDistLowerBound2);
+    sqrDistLowerBound = std::min (sqrDistLowerBound1, sqrDistLowerBound2);
+  }
+  else
+  {
+    int c1 = C::getSecondLeftChild(node, b2);
+    int c2 = C::getSecondRightChild(node, b2);
+
+    collisionRecurse(node, b1, c1, front_list, sqrDistLowerBound1);
+
+    // early stop is disabled is front_list is used
+    if(C::canStop(node) && !front_list) return;
+
+    collisionRecurse(node, b1, c2, front_list, sqrDistLowerBound2);
+    sqrDistLowerBound = std::min (sqrDistLowerBound1, sqrDistLowerBound2);
+  }
+  return;
+}
+
+template<typename Node>
+void collisionNonRecurse(Node* node,
+		         BVHFrontList* front_list, FCL_REAL& sqrDistLowerBound)
+{
+  typedef details::TraversalCalls<Node> C;
+  typedef std::pair<int, int> BVPair_t;
+  //typedef std::stack<BVPair_t, std::vector<BVPair_t> > Stack_t;
+  typedef std::vector<BVPair_t> Stack_t;
+
+  Stack_t pairs;
+  pairs.reserve (1000);
+  sqrDistLowerBound = std::numeric_limits<FCL_REAL>::infinity();
+  FCL_REAL sdlb = std::numeric_limits<FCL_REAL>::infinity();
+
+  pairs.push_back (BVPair_t (0, 0));
+
+  while (!pairs.empty()) {
+    int a = pairs.back().first,
+        b = pairs.back().second;
+    pairs.pop_back();
+
+    bool la = C::isFirstNodeLeaf(node, a);
+    bool lb = C::isSecondNodeLeaf(node, b);
+
+    // Leaf / Leaf case
+    if (la && lb) {
+      updateFrontList(front_list, a, b);
+
+      // TODO should we test the BVs ?
+      //if(node->BVDijsoints(a, b, sdlb)) {
+        //if (sdlb < sqrDistLowerBound) sqrDistLowerBound = sdlb;
+        //continue;
+      //}
+      C::leafCollides(node, a, b, sdlb);
+      if (sdlb < sqrDistLowerBound) sqrDistLowerBound = sdlb;
+      if (C::canStop(node) && !front_list) return;
+      continue;
+    }
+
+    // TODO shouldn't we test the leaf triangle against BV is la != lb
+    // if (la && !lb) { // leaf triangle 1 against BV 2
+    // } else if (!la && lb) { // BV 1 against leaf triangle 2
+    // }
+
+    // Check the BV
+    if(C::BVDisjoints(node, a, b, sdlb)) {
+      if (sdlb < sqrDistLowerBound) sqrDistLowerBound = sdlb;
+      updateFrontList(front_list, a, b);
+      continue;
+    }
+
+    if(C::firstOverSecond(node, a, b))
+    {
+      int c1 = C::getFirstLeftChild(node, a);
+      int c2 = C::getFirstRightChild(node, a);
+      pairs.push_back (BVPair_t (c2, b));
+      pairs.push_back (BVPair_t (c1, b));
+    }
+    else
+    {
+      int c1 = C::getSecondLeftChild(node, b);
+      int c2 = C::getSecondRightChild(node, b);
+      pairs.push_back (BVPair_t (a, c2));
+      pairs.push_back (BVPair_t (a, c1));
+    }
+  }
+}
+
+/** Recurse function for self collision
+ * Make sure node is set correctly so that the first and second tree are the same
+ */
+template<typename Node>
+void distanceRecurse(Node* node, int b1, int b2, BVHFrontList* front_list)
+{
+  typedef details::TraversalCalls<Node> C;
+  bool l1 = C::isFirstNodeLeaf(node, b1);
+  bool l2 = C::isSecondNodeLeaf(node, b2);
+
+  if(l1 && l2)
+  {
+    updateFrontList(front_list, b1, b2);
+
+    C::leafComputeDistance(node, b1, b2);
+    return;
+  }
+
+  int a1, a2, c1, c2;
+
+  if(C::firstOverSecond(node, b1, b2))
+  {
+    a1 = C::getFirstLeftChild(node, b1);
+    a2 = b2;
+    c1 = C::getFirstRightChild(node, b1);
+    c2 = b2;
+  }
+  else
+  {
+    a1 = b1;
+    a2 = C::getSecondLeftChild(node, b2);
+    c1 = b1;
+    c2 = C::getSecondRightChild(node, b2);
+  }
+
+  FCL_REAL d1 = C::BVDistanceLowerBound(node, a1, a2);
+  FCL_REAL d2 = C::BVDistanceLowerBound(node, c1, c2);
+
+  if(d2 < d1)
+  {
+    if(!C::canStop(node, d2))
+      distanceRecurse(node, c1, c2, front_list);
+    else
+      updateFrontList(front_list, c1, c2);
+
+    if(!C::canStop(node, d1))
+      distanceRecurse(node, a1, a2, front_list);
+    else
+      updateFrontList(front_list, a1, a2);
+  }
+  else
+  {
+    if(!C::canStop(node, d1))
+      distanceRecurse(node, a1, a2, front_list);
+    else
+      updateFrontList(front_list, a1, a2);
+
+    if(!C::canStop(node, d2))
+      distanceRecurse(node, c1, c2, front_list);
+    else
+      updateFrontList(front_list, c1, c2);
+  }
+}
+
+template<typename Node>
+void distanceQueueRecurse(Node* node, int b1, int b2, BVHFrontList* front_list, int qsize)
+{
+  typedef details::TraversalCalls<Node> C;
+  details::BVTQ bvtq;
+  bvtq.qsize = qsize;
+
+  details::BVT min_test;
+  min_test.b1 = b1;
+  min_test.b2 = b2;
+
+  while(1)
+  {
+    bool l1 = C::isFirstNodeLeaf(node, min_test.b1);
+    bool l2 = C::isSecondNodeLeaf(node, min_test.b2);
+
+    if(l1 && l2)
+    {
+      updateFrontList(front_list, min_test.b1, min_test.b2);
+
+      C::leafComputeDistance(node, min_test.b1, min_test.b2);
+    }
+    else if(bvtq.full())
+    {
+      // queue should not get two more tests, recur
+
+      distanceQueueRecurse(node, min_test.b1, min_test.b2, front_list, qsize);
+    }
+    else
+    {
+      // queue capacity is not full yet
+      details::BVT bvt1, bvt2;
+
+      if(C::firstOverSecond(node, min_test.b1, min_test.b2))
+      {
+        int c1 = C::getFirstLeftChild(node, min_test.b1);
+        int c2 = C::getFirstRightChild(node, min_test.b1);
+        bvt1.b1 = c1;
+        bvt1.b2 = min_test.b2;
+        bvt1.d = C::BVDistanceLowerBound(node, bvt1.b1, bvt1.b2);
+
+        bvt2.b1 = c2;
+        bvt2.b2 = min_test.b2;
+        bvt2.d = C::BVDistanceLowerBound(node, bvt2.b1, bvt2.b2);
+      }
+      else
+      {
+        int c1 = C::getSecondLeftChild(node, min_test.b2);
+        int c2 = C::getSecondRightChild(node, min_test.b2);
+        bvt1.b1 = min_test.b1;
+        bvt1.b2 = c1;
+        bvt1.d = C::BVDistanceLowerBound(node, bvt1.b1, bvt1.b2);
+
+        bvt2.b1 = min_test.b1;
+        bvt2.b2 = c2;
+        bvt2.d = C::BVDistanceLowerBound(node, bvt2.b1, bvt2.b2);
+      }
+
+      bvtq.push(bvt1);
+      bvtq.push(bvt2);
+    }
+
+    if(bvtq.empty())
+      break;
+    else
+    {
+      min_test = bvtq.top();
+      bvtq.pop();
+
+      if(C::canStop(node, min_test.d))
+      {
+        // The pairs left in the queue are pruned as well: they belong to
+        // the front.
+        updateFrontList(front_list, min_test.b1, min_test.b2);
+        if(front_list)
+        {
+          for(; !bvtq.empty(); bvtq.pop())
+            updateFrontList(front_list, bvtq.top().b1, bvtq.top().b2);
+        }
+        break;
+      }
+    }
+  }
+}
+
+
+template<typename Node>
+void propagateBVHFrontListCollisionRecurse
+  (Node* node, BVHFrontList* front_list, FCL_REAL& sqrDistLowerBound)
+{
+  // Every node of the front, including the leaves and the disjoint nodes,
+  // is traversed again and contributes to the new front.
+  BVHFrontList front;
+  front.reserve(front_list->size());
+  sqrDistLowerBound = std::numeric_limits<FCL_REAL>::infinity();
+  FCL_REAL sdlb;
+  for(std::size_t i = 0; i < front_list->size(); ++i)
+  {
+    const BVHFrontNode& f = (*front_list)[i];
+    collisionRecurse(node, f.left, f.right, &front, sdlb);
+    sqrDistLowerBound = std::min(sqrDistLowerBound, sdlb);
+  }
+  front_list->swap(front);
+}
+
+template<typename Node>
+void propagateBVHFrontListDistanceRecurse(Node* node, BVHFrontList* front_list)
+{
+  typedef details::TraversalCalls<Node> C;
+  std::vector<details::BVT> pairs(front_list->size());
+  for(std::size_t i = 0; i < pairs.size(); ++i)
+  {
+    const BVHFrontNode& f = (*front_list)[i];
+    pairs[i].b1 = f.left;
+    pairs[i].b2 = f.right;
+    pairs[i].d = C::BVDistanceLowerBound(node, f.left, f.right);
+  }
+  // The closest pairs first, so that the others are more likely to be
+  // pruned.
+  std::sort(pairs.begin(), pairs.end(), details::closer);
+
+  BVHFrontList front;
+  front.reserve(front_list->size());
+  for(std::size_t i = 0; i < pairs.size(); ++i)
+  {
+    if(C::canStop(node, pairs[i].d))
+      updateFrontList(&front, pairs[i].b1, pairs[i].b2);
+    else
+      distanceRecurse(node, pairs[i].b1, pairs[i].b2, &front);
+  }
+  front_list->swap(front);
+}
+
+}
+
+} // namespace hpp
+
+/// @endcond
+
+#endif
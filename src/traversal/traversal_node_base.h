@@ -44,6 +44,9 @@
 #include <hpp/fcl/math/transform.h>
 #include <hpp/fcl/collision_data.h>
 
+#include <algorithm>
+#include <boost/atomic.hpp>
+
 namespace hpp
 {
 namespace fcl
@@ -145,7 +148,8 @@ public:
 class DistanceTraversalNodeBase : public TraversalNodeBase
 {
 public:
-  DistanceTraversalNodeBase() : result(NULL), enable_statistics(false) {}
+  DistanceTraversalNodeBase() : result(NULL), shared_min_distance(NULL),
+                                enable_statistics(false) {}
 
   virtual ~DistanceTraversalNodeBase();
 
@@ -169,6 +173,31 @@ public:
   /// @brief distance result kept during the traversal iteration
   DistanceResult* result;
 
+  /// @brief Lowest distance found by the threads of a parallel traversal,
+  ///        NULL for a sequential traversal.
+  boost::atomic<FCL_REAL>* shared_min_distance;
+
+  /// @brief Lowest distance found so far, by this node or by the other
+  ///        threads of a parallel traversal.
+  FCL_REAL minDistance() const
+  {
+    if(!shared_min_distance) return result->min_distance;
+    return std::min(result->min_distance,
+                    shared_min_distance->load(boost::memory_order_relaxed));
+  }
+
+  /// @brief Publish the distance of result to the other threads of a
+  ///        parallel traversal.
+  void shareMinDistance() const
+  {
+    if(!shared_min_distance) return;
+    FCL_REAL shared = shared_min_distance->load(boost::memory_order_relaxed);
+    while(result->min_distance < shared &&
+          !shared_min_distance->compare_exchange_weak
+          (shared, result->min_distance, boost::memory_order_relaxed))
+      ;
+  }
+
   /// @brief Whether stores statistics 
   bool enable_statistics;
 };
@@ -567,10 +567,20 @@ public:
                                   
 
 /// @brief Traversal node for distance between mesh and shape
-template<typename BV, typename S>
+///
+/// When _Options is 0, the mesh is not transformed: the bounding volume of
+/// the shape is tested against the bounding volumes of the mesh placed at
+/// tf1, which requires function distance(R, T, bv1, bv2).
+template<typename BV, typename S,
+  int _Options = RelativeTransformationIsIdentity>
 class MeshShapeDistanceTraversalNode : public BVHShapeDistanceTraversalNode<BV, S>
 { 
 public:
+  enum {
+    Options = _Options,
+    RTIsIdentity = _Options & RelativeTransformationIsIdentity
+  };
+
   MeshShapeDistanceTraversalNode() : BVHShapeDistanceTraversalNode<BV, S>()
   {
     vertices = NULL;
@@ -582,6 +592,15 @@ public:
     nsolver = NULL;
   }
 
+  /// @brief BV culling test in one BVTT node
+  FCL_REAL BVDistanceLowerBound(int b1, int b2) const
+  {
+    if (RTIsIdentity)
+      return BVHShapeDistanceTraversalNode<BV, S>::BVDistanceLowerBound(b1, b2);
+    if(this->enable_statistics) this->num_bv_tests++;
+    return distance(this->tf1.getRotation(), this->tf1.getTranslation(), this->model2_bv, this->model1->getBV(b1).bv);
+  }
+
   /// @brief Distance testing between leaves (one triangle and one shape)
   void leafComputeDistance(int b1, int /*b2*/) const
   {
@@ -599,9 +618,16 @@ public:
     
     FCL_REAL d;
     Vec3f closest_p1, closest_p2, normal;
-    nsolver->shapeTriangleInteraction(*(this->model2), this->tf2, p1, p2, p3,
-                                      Transform3f (), d, closest_p2, closest_p1,
-                                      normal);
+    if (RTIsIdentity) {
+      static const Transform3f Id;
+      nsolver->shapeTriangleInteraction(*(this->model2), this->tf2, p1, p2, p3,
+                                        Id, d, closest_p2, closest_p1,
+                                        normal);
+    } else {
+      nsolver->shapeTriangleInteraction(*(this->model2), this->tf2, p1, p2, p3,
+                                        this->tf1, d, closest_p2, closest_p1,
+                                        normal);
+    }
 
     this->result->update(d, this->model1, this->model2, primitive_id,
                          DistanceResult::NONE, closest_p1, closest_p2,
@@ -611,7 +637,8 @@ public:
   /// @brief Whether the traversal process can stop early
   bool canStop(FCL_REAL c) const
   {
-    if((c >= this->result->min_distance - abs_err) && (c * (1 + rel_err) >= this->result->min_distance))
+    const FCL_REAL min_distance = this->minDistance();
+    if((c >= min_distance - abs_err) && (c * (1 + rel_err) >= min_distance))
       return true;
     return false;
   }
@@ -834,7 +861,8 @@ public:
   /// @brief Whether the traversal process can stop early
   bool canStop(FCL_REAL c) const
   {
-    if((c >= this->result->min_distance - abs_err) && (c * (1 + rel_err) >= this->result->min_distance))
+    const FCL_REAL min_distance = this->minDistance();
+    if((c >= min_distance - abs_err) && (c * (1 + rel_err) >= min_distance))
       return true;
     return false;
   }
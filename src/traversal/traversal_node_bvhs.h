@@ -74,6 +74,8 @@ public:
   {
     model1 = NULL;
     model2 = NULL;
+    compact1 = NULL;
+    compact2 = NULL;
 
     num_bv_tests = 0;
     num_leaf_tests = 0;
@@ -83,23 +85,36 @@ public:
   /// @brief Whether the BV node in the first BVH tree is leaf
   bool isFirstNodeLeaf(int b) const
   {
+    if(compact1) return compact1[b].isLeaf();
     return model1->getBV(b).isLeaf();
   }
 
   /// @brief Whether the BV node in the second BVH tree is leaf
   bool isSecondNodeLeaf(int b) const
   {
+    if(compact2) return compact2[b].isLeaf();
     return model2->getBV(b).isLeaf();
   }
 
   /// @brief Determine the traversal order, is the first BVTT subtree better
   bool firstOverSecond(int b1, int b2) const
   {
-    FCL_REAL sz1 = model1->getBV(b1).bv.size();
-    FCL_REAL sz2 = model2->getBV(b2).bv.size();
-
-    bool l1 = model1->getBV(b1).isLeaf();
-    bool l2 = model2->getBV(b2).isLeaf();
+    FCL_REAL sz1, sz2;
+    bool l1, l2;
+    if(compact1)
+    {
+      sz1 = compact1[b1].bv.size();
+      sz2 = compact2[b2].bv.size();
+      l1 = compact1[b1].isLeaf();
+      l2 = compact2[b2].isLeaf();
+    }
+    else
+    {
+      sz1 = model1->getBV(b1).bv.size();
+      sz2 = model2->getBV(b2).bv.size();
+      l1 = model1->getBV(b1).isLeaf();
+      l2 = model2->getBV(b2).isLeaf();
+    }
 
     if(l2 || (!l1 && (sz1 > sz2)))
       return true;
@@ -109,24 +124,28 @@ public:
   /// @brief Obtain the left child of BV node in the first BVH
   int getFirstLeftChild(int b) const
   {
+    if(compact1) return compact1[b].leftChild();
     return model1->getBV(b).leftChild();
   }
 
   /// @brief Obtain the right child of BV node in the first BVH
   int getFirstRightChild(int b) const
   {
+    if(compact1) return compact1[b].rightChild();
     return model1->getBV(b).rightChild();
   }
 
   /// @brief Obtain the left child of BV node in the second BVH
   int getSecondLeftChild(int b) const
   {
+    if(compact2) return compact2[b].leftChild();
     return model2->getBV(b).leftChild();
   }
 
   /// @brief Obtain the right child of BV node in the second BVH
   int getSecondRightChild(int b) const
   {
+    if(compact2) return compact2[b].rightChild();
     return model2->getBV(b).rightChild();
   }
   
@@ -135,6 +154,11 @@ public:
   /// @brief The second BVH model
   const BVHModel<BV>* model2;
 
+  /// @brief Compact layouts of the models, used instead of the BV nodes
+  ///        when both models have one, NULL otherwise.
+  const CompactBVNode<BV>* compact1;
+  const CompactBVNode<BV>* compact2;
+
   /// @brief statistical information
   mutable int num_bv_tests;
   mutable int num_leaf_tests;
@@ -164,6 +188,14 @@ public:
   bool BVDisjoints(int b1, int b2) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
+    if (this->compact1) {
+      const typename CompactBV<BV>::type& bv1 = this->compact1[b1].bv;
+      const typename CompactBV<BV>::type& bv2 = this->compact2[b2].bv;
+      if (RTIsIdentity)
+        return !bv1.overlap(bv2);
+      else
+        return !overlap(RT._R(), RT._T(), bv1, bv2);
+    }
     if (RTIsIdentity)
       return !this->model1->getBV(b1).overlap(this->model2->getBV(b2));
     else
@@ -178,6 +210,16 @@ public:
   bool BVDisjoints(int b1, int b2, FCL_REAL& sqrDistLowerBound) const
   {
     if(this->enable_statistics) this->num_bv_tests++;
+    if (this->compact1) {
+      const typename CompactBV<BV>::type& bv1 = this->compact1[b1].bv;
+      const typename CompactBV<BV>::type& bv2 = this->compact2[b2].bv;
+      if (RTIsIdentity)
+        return !bv1.overlap(bv2, this->request, sqrDistLowerBound);
+      bool res = !overlap(RT._R(), RT._T(), bv1, bv2,
+          this->request, sqrDistLowerBound);
+      assert (!res || sqrDistLowerBound > 0);
+      return res;
+    }
     if (RTIsIdentity)
       return !this->model1->getBV(b1).overlap(this->model2->getBV(b2),
           this->request, sqrDistLowerBound);
@@ -201,6 +243,12 @@ public:
   /// considered as in collision. in this case a contact point is
   /// returned in the CollisionResult.
   ///
+  /// The triangles are first tested by Intersect::intersectTriangles. The
+  /// distance between disjoint triangles is only computed if the security
+  /// margin is positive or if the distance lower bound is requested. GJK
+  /// and EPA are only run on intersecting triangles, when the penetration
+  /// depth is needed.
+  ///
   /// @note If the distance between objects is less than the security margin,
   ///       and the object are not colliding, the penetration depth is
   ///       negative.
@@ -208,11 +256,14 @@ public:
   {
     if(this->enable_statistics) this->num_leaf_tests++;
 
-    const BVNode<BV>& node1 = this->model1->getBV(b1);
-    const BVNode<BV>& node2 = this->model2->getBV(b2);
-
-    int primitive_id1 = node1.primitiveId();
-    int primitive_id2 = node2.primitiveId();
+    int primitive_id1, primitive_id2;
+    if (this->compact1) {
+      primitive_id1 = this->compact1[b1].primitiveId();
+      primitive_id2 = this->compact2[b2].primitiveId();
+    } else {
+      primitive_id1 = this->model1->getBV(b1).primitiveId();
+      primitive_id2 = this->model2->getBV(b2).primitiveId();
+    }
 
     const Triangle& tri_id1 = tri_indices1[primitive_id1];
     const Triangle& tri_id2 = tri_indices2[primitive_id2];
@@ -224,31 +275,64 @@ public:
     const Vec3f& Q2 = vertices2[tri_id2[1]];
     const Vec3f& Q3 = vertices2[tri_id2[2]];
 
-    TriangleP tri1 (P1, P2, P3);
-    TriangleP tri2 (Q1, Q2, Q3);
-    GJKSolver solver;
+    // Vertices of the second triangle in the frame of the first model.
+    Vec3f Q[3];
+    if (RTIsIdentity) {
+      Q[0] = Q1; Q[1] = Q2; Q[2] = Q3;
+    } else {
+      Q[0].noalias() = RT._R() * Q1 + RT._T();
+      Q[1].noalias() = RT._R() * Q2 + RT._T();
+      Q[2].noalias() = RT._R() * Q3 + RT._T();
+    }
+
     Vec3f p1, p2; // closest points if no collision contact points if collision.
     Vec3f normal;
     FCL_REAL distance;
-    solver.shapeDistance (tri1, this->tf1, tri2, this->tf2,
-                          distance, p1, p2, normal);
-    FCL_REAL distToCollision = distance - this->request.security_margin;
-    sqrDistLowerBound = distance * distance;
-    if (distToCollision <= 0) { // collision
-      Vec3f p (p1); // contact point
-      FCL_REAL penetrationDepth (0);
-      if(this->result->numContacts() < this->request.num_max_contacts) {
-        // How much (Q1, Q2, Q3) should be moved so that all vertices are
-        // above (P1, P2, P3).
-        penetrationDepth = -distance;
-        if (distance > 0) {
-          normal = (p2-p1).normalized ();
-          p = .5* (p1+p2);
-        }
+    if (!Intersect::intersectTriangles (P1, P2, P3, Q[0], Q[1], Q[2],
+                                        sqrDistLowerBound)) {
+      if (this->request.security_margin <= 0 &&
+          !this->request.enable_distance_lower_bound)
+        return;
+      sqrDistLowerBound = TriangleDistance::sqrTriDistance
+        (P1, P2, P3, Q[0], Q[1], Q[2], p1, p2);
+      distance = sqrt (sqrDistLowerBound);
+      if (distance > this->request.security_margin) return;
+      if (distance > 0)
+        normal = this->tf1.getRotation() * (p2-p1) / distance;
+      else
+        normal.setZero();
+      p1 = this->tf1.transform (p1);
+      p2 = this->tf1.transform (p2);
+    } else if (this->request.enable_contact ||
+               this->request.security_margin < 0) {
+      TriangleP tri1 (P1, P2, P3);
+      TriangleP tri2 (Q1, Q2, Q3);
+      solver.shapeDistance (tri1, this->tf1, tri2, this->tf2,
+                            distance, p1, p2, normal);
+      if (distance > this->request.security_margin) return;
+      // The closest points are expressed in the world frame.
+      if (distance > 0) normal = (p2-p1) / distance;
+    } else {
+      distance = 0;
+    }
+
+    // collision
+    if(this->result->numContacts() < this->request.num_max_contacts) {
+      if (!this->request.enable_contact) {
         this->result->addContact(Contact(this->model1, this->model2,
                                          primitive_id1, primitive_id2,
-                                         p, normal, penetrationDepth));
+                                         Vec3f::Zero(), Vec3f::Zero(),
+                                         -distance));
+        return;
       }
+      Vec3f p (p1); // contact point
+      // How much (Q1, Q2, Q3) should be moved so that all vertices are
+      // above (P1, P2, P3).
+      FCL_REAL penetrationDepth = -distance;
+      if (distance > 0) p = .5* (p1+p2);
+      this->result->addContact(Contact(this->model1, this->model2,
+                                       primitive_id1, primitive_id2,
+                                       p, normal, penetrationDepth));
     }
   }
 
@@ -265,6 +349,9 @@ public:
   Triangle* tri_indices2;
 
   details::RelativeTransformation<!bool(RTIsIdentity)> RT;
+
+  /// @brief Solver of the penetration of intersecting triangles
+  GJKSolver solver;
 };
 
 /// @brief Traversal node for collision between two meshes if their underlying BVH node is oriented node (OBB, RSS, OBBRSS, kIOS)
@@ -390,10 +477,19 @@ public:
 
 
 /// @brief Traversal node for distance computation between two meshes
-template<typename BV>
+///
+/// When _Options is 0, the models are not transformed: the bounding volumes
+/// of the second model are tested in the frame of the first one, which
+/// requires function distance(R, T, bv1, bv2).
+template<typename BV, int _Options = RelativeTransformationIsIdentity>
 class MeshDistanceTraversalNode : public BVHDistanceTraversalNode<BV>
 {
 public:
+  enum {
+    Options = _Options,
+    RTIsIdentity = _Options & RelativeTransformationIsIdentity
+  };
+
   MeshDistanceTraversalNode() : BVHDistanceTraversalNode<BV>()
   {
     vertices1 = NULL;
@@ -405,6 +501,27 @@ public:
     abs_err = this->request.abs_err;
   }
 
+  /// @brief Nearest points are computed in the frame of the first model
+  void postprocess()
+  {
+    if (RTIsIdentity) return;
+    if(this->request.enable_nearest_points && (this->result->o1 == this->model1) && (this->result->o2 == this->model2))
+    {
+      this->result->nearest_points[0] = this->tf1.transform(this->result->nearest_points[0]).eval();
+      this->result->nearest_points[1] = this->tf1.transform(this->result->nearest_points[1]).eval();
+    }
+  }
+
+  /// @brief BV culling test in one BVTT node
+  FCL_REAL BVDistanceLowerBound(int b1, int b2) const
+  {
+    if (RTIsIdentity)
+      return BVHDistanceTraversalNode<BV>::BVDistanceLowerBound(b1, b2);
+    if(this->enable_statistics) this->num_bv_tests++;
+    return distance(RT._R(), RT._T(), this->model1->getBV(b1).bv,
+                    this->model2->getBV(b2).bv);
+  }
+
   /// @brief Distance testing between leaves (two triangles)
   void leafComputeDistance(int b1, int b2) const
   {
@@ -430,8 +547,13 @@ public:
     // nearest point pair
     Vec3f P1, P2, normal;
 
-    FCL_REAL d = sqrt (TriangleDistance::sqrTriDistance
-		       (t11, t12, t13, t21, t22, t23, P1, P2));
+    FCL_REAL d;
+    if (RTIsIdentity)
+      d = sqrt (TriangleDistance::sqrTriDistance
+                (t11, t12, t13, t21, t22, t23, P1, P2));
+    else
+      d = sqrt (TriangleDistance::sqrTriDistance
+                (t11, t12, t13, t21, t22, t23, RT._R(), RT._T(), P1, P2));
 
     this->result->update(d, this->model1, this->model2, primitive_id1,
                          primitive_id2, P1, P2, normal);
@@ -440,7 +562,8 @@ public:
   /// @brief Whether the traversal process can stop early
   bool canStop(FCL_REAL c) const
   {
-    if((c >= this->result->min_distance - abs_err) && (c * (1 + rel_err) >= this->result->min_distance))
+    const FCL_REAL min_distance = this->minDistance();
+    if((c >= min_distance - abs_err) && (c * (1 + rel_err) >= min_distance))
       return true;
     return false;
   }
@@ -454,6 +577,8 @@ public:
   /// @brief relative and absolute error, default value is 0.01 for both terms
   FCL_REAL rel_err;
   FCL_REAL abs_err;
+
+  details::RelativeTransformation<!bool(RTIsIdentity)> RT;
 };
 
 /// @brief Traversal node for distance computation between two meshes if their underlying BVH node is oriented node (RSS, OBBRSS, kIOS)
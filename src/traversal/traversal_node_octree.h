@@ -82,9 +82,10 @@ public:
     crequest = &request_;
     cresult = &result_;
     
-    OcTreeIntersectRecurse(tree1, tree1->getRoot(), tree1->getRootBV(), 
-                           tree2, tree2->getRoot(), tree2->getRootBV(), 
-                           tf1, tf2);
+    if(tree1->isCompiled())
+      OcTreeIntersect(tree1, tree1->getCompiledRoot(), tree2, tf1, tf2);
+    else
+      OcTreeIntersect(tree1, tree1->getRoot(), tree2, tf1, tf2);
   }
 
   /// @brief distance between two octrees
@@ -96,9 +97,10 @@ public:
     drequest = &request_;
     dresult = &result_;
 
-    OcTreeDistanceRecurse(tree1, tree1->getRoot(), tree1->getRootBV(), 
-                          tree2, tree2->getRoot(), tree2->getRootBV(),
-                          tf1, tf2);
+    if(tree1->isCompiled())
+      OcTreeDistance(tree1, tree1->getCompiledRoot(), tree2, tf1, tf2);
+    else
+      OcTreeDistance(tree1, tree1->getRoot(), tree2, tf1, tf2);
   }
 
   /// @brief collision between octree and mesh
@@ -111,9 +113,12 @@ public:
     crequest = &request_;
     cresult = &result_;
 
-    OcTreeMeshIntersectRecurse(tree1, tree1->getRoot(), tree1->getRootBV(),
-                               tree2, 0,
-                               tf1, tf2);
+    if(tree1->isCompiled())
+      OcTreeMeshIntersectRecurse(tree1, tree1->getCompiledRoot(),
+                                 tree1->getRootBV(), tree2, 0, tf1, tf2);
+    else
+      OcTreeMeshIntersectRecurse(tree1, tree1->getRoot(), tree1->getRootBV(),
+                                 tree2, 0, tf1, tf2);
   }
 
   /// @brief distance between octree and mesh
@@ -126,9 +131,12 @@ public:
     drequest = &request_;
     dresult = &result_;
 
-    OcTreeMeshDistanceRecurse(tree1, tree1->getRoot(), tree1->getRootBV(),
-                              tree2, 0,
-                              tf1, tf2);
+    if(tree1->isCompiled())
+      OcTreeMeshDistanceRecurse(tree1, tree1->getCompiledRoot(),
+                                tree1->getRootBV(), tree2, 0, tf1, tf2);
+    else
+      OcTreeMeshDistanceRecurse(tree1, tree1->getRoot(), tree1->getRootBV(),
+                                tree2, 0, tf1, tf2);
   }
 
   /// @brief collision between mesh and octree
@@ -142,9 +150,12 @@ public:
     crequest = &request_;
     cresult = &result_;
 
-    OcTreeMeshIntersectRecurse(tree2, tree2->getRoot(), tree2->getRootBV(),
-                               tree1, 0,
-                               tf2, tf1);
+    if(tree2->isCompiled())
+      OcTreeMeshIntersectRecurse(tree2, tree2->getCompiledRoot(),
+                                 tree2->getRootBV(), tree1, 0, tf2, tf1);
+    else
+      OcTreeMeshIntersectRecurse(tree2, tree2->getRoot(), tree2->getRootBV(),
+                                 tree1, 0, tf2, tf1);
   }
 
   /// @brief distance between mesh and octree
@@ -176,9 +187,12 @@ public:
     computeBV<AABB>(s, Transform3f(), bv2);
     OBB obb2;
     convertBV(bv2, tf2, obb2);
-    OcTreeShapeIntersectRecurse(tree, tree->getRoot(), tree->getRootBV(),
-                                s, obb2,
-                                tf1, tf2);
+    if(tree->isCompiled())
+      OcTreeShapeIntersectRecurse(tree, tree->getCompiledRoot(),
+                                  tree->getRootBV(), s, obb2, tf1, tf2);
+    else
+      OcTreeShapeIntersectRecurse(tree, tree->getRoot(), tree->getRootBV(),
+                                  s, obb2, tf1, tf2);
     
   }
 
@@ -196,9 +210,12 @@ public:
     computeBV<AABB>(s, Transform3f(), bv1);
     OBB obb1;
     convertBV(bv1, tf1, obb1);
-    OcTreeShapeIntersectRecurse(tree, tree->getRoot(), tree->getRootBV(),
-                                s, obb1,
-                                tf2, tf1);
+    if(tree->isCompiled())
+      OcTreeShapeIntersectRecurse(tree, tree->getCompiledRoot(),
+                                  tree->getRootBV(), s, obb1, tf2, tf1);
+    else
+      OcTreeShapeIntersectRecurse(tree, tree->getRoot(), tree->getRootBV(),
+                                  s, obb1, tf2, tf1);
   }
 
   /// @brief distance between octree and shape
@@ -213,9 +230,12 @@ public:
 
     AABB aabb2;
     computeBV<AABB>(s, tf2, aabb2);
-    OcTreeShapeDistanceRecurse(tree, tree->getRoot(), tree->getRootBV(),
-                               s, aabb2,
-                               tf1, tf2);
+    if(tree->isCompiled())
+      OcTreeShapeDistanceRecurse(tree, tree->getCompiledRoot(),
+                                 tree->getRootBV(), s, aabb2, tf1, tf2);
+    else
+      OcTreeShapeDistanceRecurse(tree, tree->getRoot(), tree->getRootBV(),
+                                 s, aabb2, tf1, tf2);
   }
 
   /// @brief distance between shape and octree
@@ -230,15 +250,50 @@ public:
 
     AABB aabb1;
     computeBV<AABB>(s, tf1, aabb1);
-    OcTreeShapeDistanceRecurse(tree, tree->getRoot(), tree->getRootBV(),
-                               s, aabb1,
-                               tf2, tf1);
+    if(tree->isCompiled())
+      OcTreeShapeDistanceRecurse(tree, tree->getCompiledRoot(),
+                                 tree->getRootBV(), s, aabb1, tf2, tf1);
+    else
+      OcTreeShapeDistanceRecurse(tree, tree->getRoot(), tree->getRootBV(),
+                                 s, aabb1, tf2, tf1);
   }
   
 
 private:
-  template<typename S>
-  bool OcTreeShapeDistanceRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
+  /// @brief collision between two octrees, from the root root1 of tree1
+  template<typename Node1>
+  void OcTreeIntersect(const OcTree* tree1, const Node1* root1,
+                       const OcTree* tree2,
+                       const Transform3f& tf1, const Transform3f& tf2) const
+  {
+    if(tree2->isCompiled())
+      OcTreeIntersectRecurse(tree1, root1, tree1->getRootBV(),
+                             tree2, tree2->getCompiledRoot(), tree2->getRootBV(),
+                             tf1, tf2);
+    else
+      OcTreeIntersectRecurse(tree1, root1, tree1->getRootBV(),
+                             tree2, tree2->getRoot(), tree2->getRootBV(),
+                             tf1, tf2);
+  }
+
+  /// @brief distance between two octrees, from the root root1 of tree1
+  template<typename Node1>
+  void OcTreeDistance(const OcTree* tree1, const Node1* root1,
+                      const OcTree* tree2,
+                      const Transform3f& tf1, const Transform3f& tf2) const
+  {
+    if(tree2->isCompiled())
+      OcTreeDistanceRecurse(tree1, root1, tree1->getRootBV(),
+                            tree2, tree2->getCompiledRoot(), tree2->getRootBV(),
+                            tf1, tf2);
+    else
+      OcTreeDistanceRecurse(tree1, root1, tree1->getRootBV(),
+                            tree2, tree2->getRoot(), tree2->getRootBV(),
+                            tf1, tf2);
+  }
+
+  template<typename S, typename Node>
+  bool OcTreeShapeDistanceRecurse(const OcTree* tree1, const Node* root1, const AABB& bv1,
                                   const S& s, const AABB& aabb2,
                                   const Transform3f& tf1, const Transform3f& tf2) const
   {
@@ -255,7 +310,7 @@ private:
         solver->shapeDistance(box, box_tf, s, tf2, dist, closest_p1,
                               closest_p2, normal);
         
-        dresult->update(dist, tree1, &s, (int) (root1 - tree1->getRoot()),
+        dresult->update(dist, tree1, &s, tree1->nodeIndex(root1),
                         DistanceResult::NONE, closest_p1, closest_p2,
                         normal);
         
@@ -271,9 +326,9 @@ private:
     {
       if(tree1->nodeChildExists(root1, i))
       {
-        const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
+        const Node* child = tree1->getNodeChild(root1, i);
         AABB child_bv;
-        computeChildBV(bv1, i, child_bv);
+        tree1->computeChildBV(root1, bv1, i, child_bv);
         
         AABB aabb1;
         convertBV(child_bv, tf1, aabb1);
@@ -289,8 +344,8 @@ private:
     return false;
   }
 
-  template<typename S>
-  bool OcTreeShapeIntersectRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
+  template<typename S, typename Node>
+  bool OcTreeShapeIntersectRecurse(const OcTree* tree1, const Node* root1, const AABB& bv1,
                                    const S& s, const OBB& obb2,
                                    const Transform3f& tf1, const Transform3f& tf2) const
   {
@@ -333,7 +388,7 @@ private:
             if(solver->shapeIntersect(box, box_tf, s, tf2, NULL, NULL, NULL))
             {
               if(cresult->numContacts() < crequest->num_max_contacts)
-                cresult->addContact(Contact(tree1, &s, root1 - tree1->getRoot(), Contact::NONE));
+                cresult->addContact(Contact(tree1, &s, tree1->nodeIndex(root1), Contact::NONE));
             }
           }
           else
@@ -345,7 +400,7 @@ private:
             if(solver->shapeIntersect(box, box_tf, s, tf2, &contact, &depth, &normal))
             {
               if(cresult->numContacts() < crequest->num_max_contacts)
-                cresult->addContact(Contact(tree1, &s, root1 - tree1->getRoot(), Contact::NONE, contact, normal, depth));
+                cresult->addContact(Contact(tree1, &s, tree1->nodeIndex(root1), Contact::NONE, contact, normal, depth));
             }
           }
 
@@ -373,9 +428,9 @@ private:
     {
       if(tree1->nodeChildExists(root1, i))
       {
-        const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
+        const Node* child = tree1->getNodeChild(root1, i);
         AABB child_bv;
-        computeChildBV(bv1, i, child_bv);
+        tree1->computeChildBV(root1, bv1, i, child_bv);
         
         if(OcTreeShapeIntersectRecurse(tree1, child, child_bv, s, obb2, tf1, tf2))
           return true;
@@ -385,8 +440,8 @@ private:
     return false;    
   }
 
-  template<typename BV>
-  bool OcTreeMeshDistanceRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
+  template<typename BV, typename Node>
+  bool OcTreeMeshDistanceRecurse(const OcTree* tree1, const Node* root1, const AABB& bv1,
                                  const BVHModel<BV>* tree2, int root2,
                                  const Transform3f& tf1, const Transform3f& tf2) const
   {
@@ -409,7 +464,7 @@ private:
         solver->shapeTriangleInteraction(box, box_tf, p1, p2, p3, tf2, dist,
                                          closest_p1, closest_p2, normal);
 
-        dresult->update(dist, tree1, tree2, (int) (root1 - tree1->getRoot()),
+        dresult->update(dist, tree1, tree2, tree1->nodeIndex(root1),
                         primitive_id, closest_p1, closest_p2, normal);
 
         return drequest->isSatisfied(*dresult);
@@ -426,9 +481,9 @@ private:
       {
         if(tree1->nodeChildExists(root1, i))
         {
-          const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
+          const Node* child = tree1->getNodeChild(root1, i);
           AABB child_bv;
-          computeChildBV(bv1, i, child_bv);
+          tree1->computeChildBV(root1, bv1, i, child_bv);
 
           FCL_REAL d;
           AABB aabb1, aabb2;
@@ -474,8 +529,8 @@ private:
   }
 
 
-  template<typename BV>
-  bool OcTreeMeshIntersectRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
+  template<typename BV, typename Node>
+  bool OcTreeMeshIntersectRecurse(const OcTree* tree1, const Node* root1, const AABB& bv1,
                                   const BVHModel<BV>* tree2, int root2,
                                   const Transform3f& tf1, const Transform3f& tf2) const
   {
@@ -551,7 +606,7 @@ private:
             {
               if(cresult->numContacts() < crequest->num_max_contacts)
                 cresult->addContact(Contact(tree1, tree2,
-                                            (int)(root1 - tree1->getRoot()),
+                                            tree1->nodeIndex(root1),
                                             primitive_id));
             }
           }
@@ -567,7 +622,7 @@ private:
               assert (crequest->security_margin == 0);
               if(cresult->numContacts() < crequest->num_max_contacts)
                 cresult->addContact
-                  (Contact(tree1, tree2, (int) (root1 - tree1->getRoot()),
+                  (Contact(tree1, tree2, tree1->nodeIndex(root1),
                            primitive_id, c1, normal, -distance));
             }
           }
@@ -601,9 +656,9 @@ private:
       {
         if(tree1->nodeChildExists(root1, i))
         {
-          const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
+          const Node* child = tree1->getNodeChild(root1, i);
           AABB child_bv;
-          computeChildBV(bv1, i, child_bv);
+          tree1->computeChildBV(root1, bv1, i, child_bv);
           
           if(OcTreeMeshIntersectRecurse(tree1, child, child_bv, tree2, root2, tf1, tf2))
             return true;
@@ -623,8 +678,9 @@ private:
     return false;
   }
 
-  bool OcTreeDistanceRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
-                             const OcTree* tree2, const OcTree::OcTreeNode* root2, const AABB& bv2,
+  template<typename Node1, typename Node2>
+  bool OcTreeDistanceRecurse(const OcTree* tree1, const Node1* root1, const AABB& bv1,
+                             const OcTree* tree2, const Node2* root2, const AABB& bv2,
                              const Transform3f& tf1, const Transform3f& tf2) const
   {
     if(!tree1->nodeHasChildren(root1) && !tree2->nodeHasChildren(root2))
@@ -641,8 +697,8 @@ private:
         solver->shapeDistance(box1, box1_tf, box2, box2_tf, dist, closest_p1,
                               closest_p2, normal);
 
-        dresult->update(dist, tree1, tree2, (int) (root1 - tree1->getRoot()),
-                        (int) (root2 - tree2->getRoot()),
+        dresult->update(dist, tree1, tree2, tree1->nodeIndex(root1),
+                        tree2->nodeIndex(root2),
                         closest_p1, closest_p2, normal);
         
         return drequest->isSatisfied(*dresult);
@@ -659,9 +715,9 @@ private:
       {
         if(tree1->nodeChildExists(root1, i))
         {
-          const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
+          const Node1* child = tree1->getNodeChild(root1, i);
           AABB child_bv;
-          computeChildBV(bv1, i, child_bv);
+          tree1->computeChildBV(root1, bv1, i, child_bv);
 
           FCL_REAL d;
           AABB aabb1, aabb2;
@@ -684,9 +740,9 @@ private:
       {
         if(tree2->nodeChildExists(root2, i))
         {
-          const OcTree::OcTreeNode* child = tree2->getNodeChild(root2, i);
+          const Node2* child = tree2->getNodeChild(root2, i);
           AABB child_bv;
-          computeChildBV(bv2, i, child_bv);
+          tree2->computeChildBV(root2, bv2, i, child_bv);
 
           FCL_REAL d;
           AABB aabb1, aabb2;
@@ -707,8 +763,9 @@ private:
   }
 
 
-  bool OcTreeIntersectRecurse(const OcTree* tree1, const OcTree::OcTreeNode* root1, const AABB& bv1,
-                              const OcTree* tree2, const OcTree::OcTreeNode* root2, const AABB& bv2,
+  template<typename Node1, typename Node2>
+  bool OcTreeIntersectRecurse(const OcTree* tree1, const Node1* root1, const AABB& bv1,
+                              const OcTree* tree2, const Node2* root2, const AABB& bv2,
                               const Transform3f& tf1, const Transform3f& tf2) const
   {
     if(!root1 && !root2)
@@ -741,24 +798,24 @@ private:
         {
           if(tree2->nodeChildExists(root2, i))
           {
-            const OcTree::OcTreeNode* child = tree2->getNodeChild(root2, i);
+            const Node2* child = tree2->getNodeChild(root2, i);
             AABB child_bv;
-            computeChildBV(bv2, i, child_bv);
-            if(OcTreeIntersectRecurse(tree1, NULL, bv1, tree2, child, child_bv, tf1, tf2))
+            tree2->computeChildBV(root2, bv2, i, child_bv);
+            if(OcTreeIntersectRecurse(tree1, (const Node1*) NULL, bv1, tree2, child, child_bv, tf1, tf2))
               return true;
           }
           else 
           {
             AABB child_bv;
-            computeChildBV(bv2, i, child_bv);
-            if(OcTreeIntersectRecurse(tree1, NULL, bv1, tree2, NULL, child_bv, tf1, tf2))
+            tree2->computeChildBV(root2, bv2, i, child_bv);
+            if(OcTreeIntersectRecurse(tree1, (const Node1*) NULL, bv1, tree2, (const Node2*) NULL, child_bv, tf1, tf2))
               return true;
           }
         }
       }
       else
       {
-        if(OcTreeIntersectRecurse(tree1, NULL, bv1, tree2, NULL, bv2, tf1, tf2))
+        if(OcTreeIntersectRecurse(tree1, (const Node1*) NULL, bv1, tree2, (const Node2*) NULL, bv2, tf1, tf2))
           return true;
       }
       
@@ -772,24 +829,24 @@ private:
         {
           if(tree1->nodeChildExists(root1, i))
           {
-            const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
+            const Node1* child = tree1->getNodeChild(root1, i);
             AABB child_bv;
-            computeChildBV(bv1, i,  child_bv);
-            if(OcTreeIntersectRecurse(tree1, child, child_bv, tree2, NULL, bv2, tf1, tf2))
+            tree1->computeChildBV(root1, bv1, i, child_bv);
+            if(OcTreeIntersectRecurse(tree1, child, child_bv, tree2, (const Node2*) NULL, bv2, tf1, tf2))
               return true;
           }
           else
           {
             AABB child_bv;
-            computeChildBV(bv1, i, child_bv);
-            if(OcTreeIntersectRecurse(tree1, NULL, child_bv, tree2, NULL, bv2, tf1, tf2))
+            tree1->computeChildBV(root1, bv1, i, child_bv);
+            if(OcTreeIntersectRecurse(tree1, (const Node1*) NULL, child_bv, tree2, (const Node2*) NULL, bv2, tf1, tf2))
               return true;
           }
         }
       }
       else
       {
-        if(OcTreeIntersectRecurse(tree1, NULL, bv1, tree2, NULL, bv2, tf1, tf2))
+        if(OcTreeIntersectRecurse(tree1, (const Node1*) NULL, bv1, tree2, (const Node2*) NULL, bv2, tf1, tf2))
           return true;
       }
       
@@ -808,7 +865,7 @@ private:
           if(obb1.overlap(obb2))
           {
             if(cresult->numContacts() < crequest->num_max_contacts)
-              cresult->addContact(Contact(tree1, tree2, root1 - tree1->getRoot(), root2 - tree2->getRoot()));
+              cresult->addContact(Contact(tree1, tree2, tree1->nodeIndex(root1), tree2->nodeIndex(root2)));
           }
         }
         else
@@ -824,7 +881,7 @@ private:
           if(solver->shapeIntersect(box1, box1_tf, box2, box2_tf, &contact, &depth, &normal))
           {
             if(cresult->numContacts() < crequest->num_max_contacts)
-              cresult->addContact(Contact(tree1, tree2, root1 - tree1->getRoot(), root2 - tree2->getRoot(), contact, normal, depth));
+              cresult->addContact(Contact(tree1, tree2, tree1->nodeIndex(root1), tree2->nodeIndex(root2), contact, normal, depth));
           }
         }
 
@@ -854,9 +911,9 @@ private:
       {
         if(tree1->nodeChildExists(root1, i))
         {
-          const OcTree::OcTreeNode* child = tree1->getNodeChild(root1, i);
+          const Node1* child = tree1->getNodeChild(root1, i);
           AABB child_bv;
-          computeChildBV(bv1, i, child_bv);
+          tree1->computeChildBV(root1, bv1, i, child_bv);
         
           if(OcTreeIntersectRecurse(tree1, child, child_bv, 
                                     tree2, root2, bv2,
@@ -871,9 +928,9 @@ private:
       {
         if(tree2->nodeChildExists(root2, i))
         {
-          const OcTree::OcTreeNode* child = tree2->getNodeChild(root2, i);
+          const Node2* child = tree2->getNodeChild(root2, i);
           AABB child_bv;
-          computeChildBV(bv2, i, child_bv);
+          tree2->computeChildBV(root2, bv2, i, child_bv);
           
           if(OcTreeIntersectRecurse(tree1, root1, bv1,
                                     tree2, child, child_bv,
@@ -62,7 +62,7 @@ inline bool initialize(OcTreeCollisionTraversalNode& node,
                        const OcTree& model2, const Transform3f& tf2,
                        const OcTreeSolver* otsolver,
                        CollisionResult& result)
-
+{
   node.result = &result;
 
   node.model1 = &model1;
@@ -342,6 +342,33 @@ bool initialize(MeshShapeCollisionTraversalNode<BV, S>& node,
   return true;
 }
 
+/// @brief Initialize traversal node for collision between one mesh and one shape, without transforming the mesh
+template<typename BV, typename S>
+bool initialize(MeshShapeCollisionTraversalNode<BV, S, 0>& node,
+                const BVHModel<BV>& model1, const Transform3f& tf1,
+                const S& model2, const Transform3f& tf2,
+                const GJKSolver* nsolver,
+                CollisionResult& result)
+{
+  if(model1.getModelType() != BVH_MODEL_TRIANGLES)
+    return false;
+
+  node.model1 = &model1;
+  node.tf1 = tf1;
+  node.model2 = &model2;
+  node.tf2 = tf2;
+  node.nsolver = nsolver;
+
+  computeBV(model2, tf2, node.model2_bv);
+
+  node.vertices = model1.vertices;
+  node.tri_indices = model1.tri_indices;
+
+  node.result = &result;
+
+  return true;
+}
+
 /// @cond IGNORE
 namespace details
 {
@@ -504,6 +531,10 @@ bool initialize(MeshCollisionTraversalNode<BV, RelativeTransformationIsIdentity>
   node.model2 = &model2;
   node.tf2 = tf2;
 
+  bool compact = model1.getCompactBVs() && model2.getCompactBVs();
+  node.compact1 = compact ? model1.getCompactBVs() : NULL;
+  node.compact2 = compact ? model2.getCompactBVs() : NULL;
+
   node.vertices1 = model1.vertices;
   node.vertices2 = model2.vertices;
 
@@ -535,6 +566,10 @@ bool initialize(MeshCollisionTraversalNode<BV, 0>& node,
   node.model2 = &model2;
   node.tf2 = tf2;
 
+  bool compact = model1.getCompactBVs() && model2.getCompactBVs();
+  node.compact1 = compact ? model1.getCompactBVs() : NULL;
+  node.compact2 = compact ? model2.getCompactBVs() : NULL;
+
   node.result = &result;
 
   node.RT.R = tf1.getRotation().transpose() * tf2.getRotation();
@@ -560,6 +595,7 @@ bool initialize(ShapeDistanceTraversalNode<S1, S2>& node,
   node.model2 = &shape2;
   node.tf2 = tf2;
   node.nsolver = nsolver;
+  node.warm_start = getWarmStart(request.gjk_cache, &shape1, &shape2);
 
   return true;
 }
@@ -628,6 +664,37 @@ bool initialize(MeshDistanceTraversalNode<BV>& node,
 }
 
 
+/// @brief Initialize traversal node for distance computation between two meshes, without transforming the meshes
+template<typename BV>
+bool initialize(MeshDistanceTraversalNode<BV, 0>& node,
+                const BVHModel<BV>& model1, const Transform3f& tf1,
+                const BVHModel<BV>& model2, const Transform3f& tf2,
+                const DistanceRequest& request,
+                DistanceResult& result)
+{
+  if(model1.getModelType() != BVH_MODEL_TRIANGLES || model2.getModelType() != BVH_MODEL_TRIANGLES)
+    return false;
+
+  node.request = request;
+  node.result = &result;
+
+  node.model1 = &model1;
+  node.tf1 = tf1;
+  node.model2 = &model2;
+  node.tf2 = tf2;
+
+  node.vertices1 = model1.vertices;
+  node.vertices2 = model2.vertices;
+
+  node.tri_indices1 = model1.tri_indices;
+  node.tri_indices2 = model2.tri_indices;
+
+  node.RT.R = tf1.getRotation().transpose() * tf2.getRotation();
+  node.RT.T = tf1.getRotation().transpose() * (tf2.getTranslation() - tf1.getTranslation());
+
+  return true;
+}
+
 /// @brief Initialize traversal node for distance computation between two meshes, specialized for RSS type
 bool initialize(MeshDistanceTraversalNodeRSS& node,
                 const BVHModel<RSS>& model1, const Transform3f& tf1,
@@ -696,6 +763,35 @@ bool initialize(MeshShapeDistanceTraversalNode<BV, S>& node,
   return true;
 }
 
+/// @brief Initialize traversal node for distance computation between one mesh and one shape, without transforming the mesh
+template<typename BV, typename S>
+bool initialize(MeshShapeDistanceTraversalNode<BV, S, 0>& node,
+                const BVHModel<BV>& model1, const Transform3f& tf1,
+                const S& model2, const Transform3f& tf2,
+                const GJKSolver* nsolver,
+                const DistanceRequest& request,
+                DistanceResult& result)
+{
+  if(model1.getModelType() != BVH_MODEL_TRIANGLES)
+    return false;
+
+  node.request = request;
+  node.result = &result;
+
+  node.model1 = &model1;
+  node.tf1 = tf1;
+  node.model2 = &model2;
+  node.tf2 = tf2;
+  node.nsolver = nsolver;
+  
+  node.vertices = model1.vertices;
+  node.tri_indices = model1.tri_indices;
+
+  computeBV(model2, tf2, node.model2_bv);
+
+  return true;
+}
+
 /// @brief Initialize traversal node for distance computation between one shape and one mesh, given the current transforms
 template<typename S, typename BV>
 bool initialize(ShapeMeshDistanceTraversalNode<S, BV>& node,
@@ -132,6 +132,7 @@ public:
     model2 = NULL;
 
     nsolver = NULL;
+    warm_start = NULL;
   }
 
   /// @brief BV culling test in one BVTT node
@@ -146,7 +147,7 @@ public:
     FCL_REAL distance;
     Vec3f closest_p1, closest_p2, normal;
     nsolver->shapeDistance(*model1, tf1, *model2, tf2, distance, closest_p1,
-                           closest_p2, normal);
+                           closest_p2, normal, warm_start);
     result->update(distance, model1, model2, DistanceResult::NONE,
                    DistanceResult::NONE, closest_p1, closest_p2, normal);
   }
@@ -155,6 +156,9 @@ public:
   const S2* model2;
 
   const GJKSolver* nsolver;
+
+  /// @brief Simplex of the pair kept by DistanceRequest::gjk_cache, or NULL
+  details::GJK::WarmStart* warm_start;
 };
 
 /// @}
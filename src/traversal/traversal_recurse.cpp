@@ -38,388 +38,269 @@
 
 #include "traversal_recurse.h"
 
+#include <algorithm>
+#include <limits>
 #include <vector>
+#include <boost/thread/mutex.hpp>
+#include <hpp/fcl/thread_pool.h>
 
 namespace hpp
 {
 namespace fcl
 {
-void collisionRecurse(CollisionTraversalNodeBase* node, int b1, int b2, 
-		      BVHFrontList* front_list, FCL_REAL& sqrDistLowerBound)
+namespace
 {
-  FCL_REAL sqrDistLowerBound1 = 0, sqrDistLowerBound2 = 0;
-  bool l1 = node->isFirstNodeLeaf(b1);
-  bool l2 = node->isSecondNodeLeaf(b2);
-  if(l1 && l2)
-  {
-    updateFrontList(front_list, b1, b2);
+  typedef std::pair<int, int> BVPair_t;
+  using details::BVT;
 
-   // if(node->BVDisjoints(b1, b2, sqrDistLowerBound)) return;
-    node->leafCollides(b1, b2, sqrDistLowerBound);
-    return;
-  }
+  /// Number of subtrees of the bounding volume test tree given to each
+  /// thread, so that work stealing can balance the load.
+  const std::size_t subtreesPerThread = 16;
 
-  if(node->BVDisjoints(b1, b2, sqrDistLowerBound)) {
-    updateFrontList(front_list, b1, b2);
-    return;
-  }
-  if(node->firstOverSecond(b1, b2))
+  /// Traverse subtrees with collisionRecurse, in one result per subtree.
+  struct CollisionSubtreesTask : ThreadPool::Task
   {
-    int c1 = node->getFirstLeftChild(b1);
-    int c2 = node->getFirstRightChild(b1);
+    CollisionSubtreesTask
+    (const std::vector<CollisionTraversalNodeBase*>& nodes_,
+     const std::vector<BVPair_t>& subtrees_, std::size_t num_contacts_) :
+      nodes(nodes_), subtrees(subtrees_), results(subtrees_.size()),
+      sqrDistLowerBounds(subtrees_.size(),
+                         std::numeric_limits<FCL_REAL>::infinity()),
+      num_contacts(num_contacts_)
+    {}
+
+    void run(std::size_t begin, std::size_t end, std::size_t thread_id)
+    {
+      CollisionTraversalNodeBase* node = nodes[thread_id];
+      for(std::size_t i = begin; i < end; ++i)
+      {
+        {
+          boost::mutex::scoped_lock lock(mutex);
+          if(num_contacts >= node->request.num_max_contacts) return;
+        }
+        node->result = &results[i];
+        sqrDistLowerBounds[i] = 0;
+        collisionRecurse(node, subtrees[i].first, subtrees[i].second, NULL,
+                         sqrDistLowerBounds[i]);
+        if(results[i].numContacts() > 0)
+        {
+          boost::mutex::scoped_lock lock(mutex);
+          num_contacts += results[i].numContacts();
+        }
+      }
+    }
 
-    collisionRecurse(node, c1, b2, front_list, sqrDistLowerBound1);
+    const std::vector<CollisionTraversalNodeBase*>& nodes;
+    const std::vector<BVPair_t>& subtrees;
+    std::vector<CollisionResult> results;
+    std::vector<FCL_REAL> sqrDistLowerBounds;
 
-    // early stop is disabled is front_list is used
-    if(node->canStop() && !front_list) return;
+    /// Number of contacts found by all the threads, to stop early.
+    std::size_t num_contacts;
+    boost::mutex mutex;
+  };
 
-    collisionRecurse(node, c2, b2, front_list, sqrDistLowerBound2);
-    sqrDistLowerBound = std::min (sqrDistLowerBound1, sqrDistLowerBound2);
-  }
-  else
+  /// Shares a distance among the nodes of a parallel traversal while it
+  /// exists.
+  struct SharedMinDistance
   {
-    int c1 = node->getSecondLeftChild(b2);
-    int c2 = node->getSecondRightChild(b2);
+    SharedMinDistance(const std::vector<DistanceTraversalNodeBase*>& nodes_,
+                      FCL_REAL min_distance) :
+      nodes(nodes_), value(min_distance)
+    {
+      for(std::size_t i = 0; i < nodes.size(); ++i)
+        nodes[i]->shared_min_distance = &value;
+    }
 
-    collisionRecurse(node, b1, c1, front_list, sqrDistLowerBound1);
+    ~SharedMinDistance()
+    {
+      for(std::size_t i = 0; i < nodes.size(); ++i)
+        nodes[i]->shared_min_distance = NULL;
+    }
 
-    // early stop is disabled is front_list is used
-    if(node->canStop() && !front_list) return;
+    const std::vector<DistanceTraversalNodeBase*>& nodes;
+    boost::atomic<FCL_REAL> value;
+  };
 
-    collisionRecurse(node, b1, c2, front_list, sqrDistLowerBound2);
-    sqrDistLowerBound = std::min (sqrDistLowerBound1, sqrDistLowerBound2);
-  }
-  return;
+  /// Traverse subtrees with distanceRecurse or distanceQueueRecurse. The
+  /// nodes prune the traversal with the lowest distance found by all the
+  /// threads, and the results of the threads are merged in best.
+  struct DistanceSubtreesTask : ThreadPool::Task
+  {
+    DistanceSubtreesTask
+    (const std::vector<DistanceTraversalNodeBase*>& nodes_,
+     const std::vector<BVT>& subtrees_, DistanceResult& best_, int qsize_) :
+      nodes(nodes_), subtrees(subtrees_), best(best_), qsize(qsize_),
+      results(nodes_.size(), best_)
+    {}
+
+    void run(std::size_t begin, std::size_t end, std::size_t thread_id)
+    {
+      DistanceTraversalNodeBase* node = nodes[thread_id];
+      DistanceResult& result = results[thread_id];
+      node->result = &result;
+      for(std::size_t i = begin; i < end; ++i)
+      {
+        const BVT& subtree = subtrees[i];
+        if(node->canStop(subtree.d)) continue;
+
+        FCL_REAL min_distance = result.min_distance;
+        if(qsize <= 2)
+          distanceRecurse(node, subtree.b1, subtree.b2, NULL);
+        else
+          distanceQueueRecurse(node, subtree.b1, subtree.b2, NULL, qsize);
+
+        if(result.min_distance < min_distance)
+        {
+          boost::mutex::scoped_lock lock(mutex);
+          best.update(result);
+        }
+      }
+    }
+
+    const std::vector<DistanceTraversalNodeBase*>& nodes;
+    const std::vector<BVT>& subtrees;
+    DistanceResult& best;
+    int qsize;
+    std::vector<DistanceResult> results;
+    boost::mutex mutex;
+  };
 }
 
-void collisionNonRecurse(CollisionTraversalNodeBase* node,
-		         BVHFrontList* front_list, FCL_REAL& sqrDistLowerBound)
+void collisionParallel(const std::vector<CollisionTraversalNodeBase*>& nodes,
+                       ThreadPool& pool, CollisionResult& result,
+                       FCL_REAL& sqrDistLowerBound)
 {
-  typedef std::pair<int, int> BVPair_t;
-  //typedef std::stack<BVPair_t, std::vector<BVPair_t> > Stack_t;
-  typedef std::vector<BVPair_t> Stack_t;
-
-  Stack_t pairs;
-  pairs.reserve (1000);
+  CollisionTraversalNodeBase* node = nodes[0];
+  const std::size_t target = subtreesPerThread * pool.size();
+
+  // Breadth first expansion of the bounding volume test tree: pairs[head:]
+  // is the front of the expansion, the pairs of leaves are not expanded.
+  std::vector<BVPair_t> pairs, subtrees;
+  pairs.push_back(BVPair_t(0, 0));
+  std::size_t head = 0;
   sqrDistLowerBound = std::numeric_limits<FCL_REAL>::infinity();
   FCL_REAL sdlb = std::numeric_limits<FCL_REAL>::infinity();
+  while(head < pairs.size() && pairs.size() - head + subtrees.size() < target)
+  {
+    int a = pairs[head].first,
+        b = pairs[head].second;
+    ++head;
 
-  pairs.push_back (BVPair_t (0, 0));
-
-  while (!pairs.empty()) {
-    int a = pairs.back().first,
-        b = pairs.back().second;
-    pairs.pop_back();
-
-    bool la = node->isFirstNodeLeaf(a);
-    bool lb = node->isSecondNodeLeaf(b);
-
-    // Leaf / Leaf case
-    if (la && lb) {
-      updateFrontList(front_list, a, b);
-
-      // TODO should we test the BVs ?
-      //if(node->BVDijsoints(a, b, sdlb)) {
-        //if (sdlb < sqrDistLowerBound) sqrDistLowerBound = sdlb;
-        //continue;
-      //}
-      node->leafCollides(a, b, sdlb);
-      if (sdlb < sqrDistLowerBound) sqrDistLowerBound = sdlb;
-      if (node->canStop() && !front_list) return;
+    if(node->isFirstNodeLeaf(a) && node->isSecondNodeLeaf(b))
+    {
+      subtrees.push_back(BVPair_t(a, b));
       continue;
     }
-
-    // TODO shouldn't we test the leaf triangle against BV is la != lb
-    // if (la && !lb) { // leaf triangle 1 against BV 2
-    // } else if (!la && lb) { // BV 1 against leaf triangle 2
-    // }
-
-    // Check the BV
-    if(node->BVDisjoints(a, b, sdlb)) {
-      if (sdlb < sqrDistLowerBound) sqrDistLowerBound = sdlb;
-      updateFrontList(front_list, a, b);
+    if(node->BVDisjoints(a, b, sdlb))
+    {
+      if(sdlb < sqrDistLowerBound) sqrDistLowerBound = sdlb;
       continue;
     }
-
     if(node->firstOverSecond(a, b))
     {
-      int c1 = node->getFirstLeftChild(a);
-      int c2 = node->getFirstRightChild(a);
-      pairs.push_back (BVPair_t (c2, b));
-      pairs.push_back (BVPair_t (c1, b));
+      pairs.push_back(BVPair_t(node->getFirstLeftChild(a), b));
+      pairs.push_back(BVPair_t(node->getFirstRightChild(a), b));
     }
     else
     {
-      int c1 = node->getSecondLeftChild(b);
-      int c2 = node->getSecondRightChild(b);
-      pairs.push_back (BVPair_t (a, c2));
-      pairs.push_back (BVPair_t (a, c1));
+      pairs.push_back(BVPair_t(a, node->getSecondLeftChild(b)));
+      pairs.push_back(BVPair_t(a, node->getSecondRightChild(b)));
     }
   }
-}
-
-/** Recurse function for self collision
- * Make sure node is set correctly so that the first and second tree are the same
- */
-void distanceRecurse(DistanceTraversalNodeBase* node, int b1, int b2, BVHFrontList* front_list)
-{
-  bool l1 = node->isFirstNodeLeaf(b1);
-  bool l2 = node->isSecondNodeLeaf(b2);
-
-  if(l1 && l2)
-  {
-    updateFrontList(front_list, b1, b2);
-
-    node->leafComputeDistance(b1, b2);
-    return;
-  }
+  subtrees.insert(subtrees.end(), pairs.begin() + (std::ptrdiff_t)head,
+                  pairs.end());
 
-  int a1, a2, c1, c2;
+  CollisionSubtreesTask task(nodes, subtrees, result.numContacts());
+  pool.parallelFor(subtrees.size(), task);
 
-  if(node->firstOverSecond(b1, b2))
-  {
-    a1 = node->getFirstLeftChild(b1);
-    a2 = b2;
-    c1 = node->getFirstRightChild(b1);
-    c2 = b2;
-  }
-  else
+  const CollisionRequest& request = node->request;
+  for(std::size_t i = 0; i < subtrees.size(); ++i)
   {
-    a1 = b1;
-    a2 = node->getSecondLeftChild(b2);
-    c1 = b1;
-    c2 = node->getSecondRightChild(b2);
-  }
-
-  FCL_REAL d1 = node->BVDistanceLowerBound(a1, a2);
-  FCL_REAL d2 = node->BVDistanceLowerBound(c1, c2);
-
-  if(d2 < d1)
-  {
-    if(!node->canStop(d2))
-      distanceRecurse(node, c1, c2, front_list);
-    else
-      updateFrontList(front_list, c1, c2);
-
-    if(!node->canStop(d1))
-      distanceRecurse(node, a1, a2, front_list);
-    else
-      updateFrontList(front_list, a1, a2);
-  }
-  else
-  {
-    if(!node->canStop(d1))
-      distanceRecurse(node, a1, a2, front_list);
-    else
-      updateFrontList(front_list, a1, a2);
-
-    if(!node->canStop(d2))
-      distanceRecurse(node, c1, c2, front_list);
-    else
-      updateFrontList(front_list, c1, c2);
+    if(task.sqrDistLowerBounds[i] < sqrDistLowerBound)
+      sqrDistLowerBound = task.sqrDistLowerBounds[i];
+    const CollisionResult& r = task.results[i];
+    for(std::size_t j = 0; j < r.numContacts() &&
+          result.numContacts() < request.num_max_contacts; ++j)
+      result.addContact(r.getContact(j));
   }
+  for(std::size_t i = 0; i < nodes.size(); ++i)
+    nodes[i]->result = &result;
 }
 
-
-/** @brief Bounding volume test structure */
-struct BVT
-{
-  /** @brief distance between bvs */
-  FCL_REAL d;
-
-  /** @brief bv indices for a pair of bvs in two models */
-  int b1, b2;
-};
-
-/** @brief Comparer between two BVT */
-struct BVT_Comparer
-{
-  bool operator() (const BVT& lhs, const BVT& rhs) const
-  {
-    return lhs.d > rhs.d;
-  }
-};
-
-struct BVTQ
-{
-  BVTQ() : qsize(2) {}
-
-  bool empty() const
-  {
-    return pq.empty();
-  }
-
-  size_t size() const
-  {
-    return pq.size();
-  }
-
-  const BVT& top() const
-  {
-    return pq.top();
-  }
-
-  void push(const BVT& x)
-  {
-    pq.push(x);
-  }
-
-  void pop()
-  {
-    pq.pop();
-  }
-
-  bool full() const
-  {
-    return (pq.size() + 1 >= qsize);
-  }
-
-  std::priority_queue<BVT, std::vector<BVT>, BVT_Comparer> pq;
-
-  /** @brief Queue size */
-  unsigned int qsize;
-};
-
-
-void distanceQueueRecurse(DistanceTraversalNodeBase* node, int b1, int b2, BVHFrontList* front_list, int qsize)
+void distanceParallel(const std::vector<DistanceTraversalNodeBase*>& nodes,
+                      ThreadPool& pool, int qsize)
 {
-  BVTQ bvtq;
-  bvtq.qsize = qsize;
-
-  BVT min_test;
-  min_test.b1 = b1;
-  min_test.b2 = b2;
-
-  while(1)
+  DistanceTraversalNodeBase* node = nodes[0];
+  DistanceResult& result = *node->result;
+  const std::size_t target = subtreesPerThread * pool.size();
+
+  // Breadth first expansion of the bounding volume test tree, see
+  // collisionParallel. The subtrees that cannot improve the distance found by
+  // preprocess are pruned.
+  std::vector<BVT> pairs, subtrees;
+  BVT root;
+  root.b1 = root.b2 = 0;
+  root.d = node->BVDistanceLowerBound(0, 0);
+  pairs.push_back(root);
+  std::size_t head = 0;
+  while(head < pairs.size() && pairs.size() - head + subtrees.size() < target)
   {
-    bool l1 = node->isFirstNodeLeaf(min_test.b1);
-    bool l2 = node->isSecondNodeLeaf(min_test.b2);
+    const BVT bvt = pairs[head];
+    ++head;
 
-    if(l1 && l2)
+    if(node->isFirstNodeLeaf(bvt.b1) && node->isSecondNodeLeaf(bvt.b2))
     {
-      updateFrontList(front_list, min_test.b1, min_test.b2);
-
-      node->leafComputeDistance(min_test.b1, min_test.b2);
+      subtrees.push_back(bvt);
+      continue;
     }
-    else if(bvtq.full())
+    BVT c1 (bvt), c2 (bvt);
+    if(node->firstOverSecond(bvt.b1, bvt.b2))
     {
-      // queue should not get two more tests, recur
-
-      distanceQueueRecurse(node, min_test.b1, min_test.b2, front_list, qsize);
+      c1.b1 = node->getFirstLeftChild(bvt.b1);
+      c2.b1 = node->getFirstRightChild(bvt.b1);
     }
     else
     {
-      // queue capacity is not full yet
-      BVT bvt1, bvt2;
-
-      if(node->firstOverSecond(min_test.b1, min_test.b2))
-      {
-        int c1 = node->getFirstLeftChild(min_test.b1);
-        int c2 = node->getFirstRightChild(min_test.b1);
-        bvt1.b1 = c1;
-        bvt1.b2 = min_test.b2;
-        bvt1.d = node->BVDistanceLowerBound(bvt1.b1, bvt1.b2);
-
-        bvt2.b1 = c2;
-        bvt2.b2 = min_test.b2;
-        bvt2.d = node->BVDistanceLowerBound(bvt2.b1, bvt2.b2);
-      }
-      else
-      {
-        int c1 = node->getSecondLeftChild(min_test.b2);
-        int c2 = node->getSecondRightChild(min_test.b2);
-        bvt1.b1 = min_test.b1;
-        bvt1.b2 = c1;
-        bvt1.d = node->BVDistanceLowerBound(bvt1.b1, bvt1.b2);
-
-        bvt2.b1 = min_test.b1;
-        bvt2.b2 = c2;
-        bvt2.d = node->BVDistanceLowerBound(bvt2.b1, bvt2.b2);
-      }
-
-      bvtq.push(bvt1);
-      bvtq.push(bvt2);
-    }
-
-    if(bvtq.empty())
-      break;
-    else
-    {
-      min_test = bvtq.top();
-      bvtq.pop();
-
-      if(node->canStop(min_test.d))
-      {
-        updateFrontList(front_list, min_test.b1, min_test.b2);
-        break;
-      }
+      c1.b2 = node->getSecondLeftChild(bvt.b2);
+      c2.b2 = node->getSecondRightChild(bvt.b2);
     }
+    c1.d = node->BVDistanceLowerBound(c1.b1, c1.b2);
+    c2.d = node->BVDistanceLowerBound(c2.b1, c2.b2);
+    if(!node->canStop(c1.d)) pairs.push_back(c1);
+    if(!node->canStop(c2.d)) pairs.push_back(c2);
   }
-}
-
-void propagateBVHFrontListCollisionRecurse
-(CollisionTraversalNodeBase* node, const CollisionRequest& /*request*/,
- CollisionResult& result, BVHFrontList* front_list)
-{
-  FCL_REAL sqrDistLowerBound = -1,
-    sqrDistLowerBound1 = 0, sqrDistLowerBound2 = 0;
-  BVHFrontList::iterator front_iter;
-  BVHFrontList append;
-  for(front_iter = front_list->begin(); front_iter != front_list->end(); ++front_iter)
+  subtrees.insert(subtrees.end(), pairs.begin() + (std::ptrdiff_t)head,
+                  pairs.end());
+
+  // ThreadPool::parallelFor gives a contiguous range of indices to each
+  // thread: deal the subtrees sorted by increasing lower bound to the
+  // ranges, so that each thread starts with the most promising ones.
+  std::sort(subtrees.begin(), subtrees.end(), details::closer);
+  const std::size_t n = subtrees.size(), num_threads = pool.size();
+  std::vector<std::size_t> next(num_threads);
+  for(std::size_t t = 0; t < num_threads; ++t)
+    next[t] = n * t / num_threads;
+  std::vector<BVT> dealt(n);
+  std::size_t t = 0;
+  for(std::size_t i = 0; i < n; ++i, t = (t + 1) % num_threads)
   {
-    int b1 = front_iter->left;
-    int b2 = front_iter->right;
-    bool l1 = node->isFirstNodeLeaf(b1);
-    bool l2 = node->isSecondNodeLeaf(b2);
-
-    if(l1 & l2)
-    {
-      front_iter->valid = false; // the front node is no longer valid, in collideRecurse will add again.
-      collisionRecurse(node, b1, b2, &append, sqrDistLowerBound);
-    }
-    else
-    {
-      if(!node->BVDisjoints(b1, b2, sqrDistLowerBound)) {
-        front_iter->valid = false;
-        if(node->firstOverSecond(b1, b2)) {
-          int c1 = node->getFirstLeftChild(b1);
-          int c2 = node->getFirstRightChild(b2);
-
-          collisionRecurse(node, c1, b2, front_list, sqrDistLowerBound1);
-          collisionRecurse(node, c2, b2, front_list, sqrDistLowerBound2);
-          sqrDistLowerBound = std::min (sqrDistLowerBound1,
-					  sqrDistLowerBound2);
-        } else {
-          int c1 = node->getSecondLeftChild(b2);
-          int c2 = node->getSecondRightChild(b2);
-
-          collisionRecurse(node, b1, c1, front_list, sqrDistLowerBound1);
-          collisionRecurse(node, b1, c2, front_list, sqrDistLowerBound2);
-          sqrDistLowerBound = std::min (sqrDistLowerBound1,
-					  sqrDistLowerBound2);
-        }
-      }
-    }
-    result.distance_lower_bound = sqrt (sqrDistLowerBound);
+    while(next[t] == n * (t + 1) / num_threads) t = (t + 1) % num_threads;
+    dealt[next[t]++] = subtrees[i];
   }
 
-
-  // clean the old front list (remove invalid node)
-  for(front_iter = front_list->begin(); front_iter != front_list->end();)
+  // Each thread keeps its own result, and prunes with the distance shared
+  // by all the threads, which is updated after every leaf test.
   {
-    if(!front_iter->valid)
-      front_iter = front_list->erase(front_iter);
-    else
-      ++front_iter;
+    SharedMinDistance shared (nodes, result.min_distance);
+    DistanceSubtreesTask task(nodes, dealt, result, qsize);
+    pool.parallelFor(n, task);
   }
 
-  for(front_iter = append.begin(); front_iter != append.end(); ++front_iter)
-  {
-    front_list->push_back(*front_iter);
-  }
+  for(std::size_t i = 0; i < nodes.size(); ++i)
+    nodes[i]->result = &result;
 }
 
-
 }
 
 } // namespace hpp
@@ -40,8 +40,10 @@
 
 /// @cond INTERNAL
 
+#include <hpp/fcl/fwd.hh>
 #include <hpp/fcl/BVH/BVH_front.h>
 #include <queue>
+#include <vector>
 #include "traversal_node_base.h"
 #include "traversal_node_bvhs.h"
 
@@ -54,27 +56,78 @@ namespace fcl
 /// @param node collision node,
 /// @param b1, b2 ids of bounding volume nodes for object 1 and object 2
 /// @retval sqrDistLowerBound squared lower bound on distance between objects.
-void collisionRecurse(CollisionTraversalNodeBase* node, int b1, int b2,
+///
+/// The traversal functions are templated on the type of node. When Node is
+/// CollisionTraversalNodeBase or DistanceTraversalNodeBase, the methods of
+/// the node are called through virtual dispatch. Otherwise, Node must be the
+/// dynamic type of node: its methods are called directly, so that they can
+/// be inlined in the traversal. See details::TraversalCalls.
+template<typename Node>
+void collisionRecurse(Node* node, int b1, int b2,
 		      BVHFrontList* front_list, FCL_REAL& sqrDistLowerBound);
 
-void collisionNonRecurse(CollisionTraversalNodeBase* node,
+template<typename Node>
+void collisionNonRecurse(Node* node,
 		         BVHFrontList* front_list, FCL_REAL& sqrDistLowerBound);
 
 /// @brief Recurse function for distance
-void distanceRecurse(DistanceTraversalNodeBase* node, int b1, int b2, BVHFrontList* front_list);
+template<typename Node>
+void distanceRecurse(Node* node, int b1, int b2, BVHFrontList* front_list);
 
 /// @brief Recurse function for distance, using queue acceleration
-void distanceQueueRecurse(DistanceTraversalNodeBase* node, int b1, int b2, BVHFrontList* front_list, int qsize);
+template<typename Node>
+void distanceQueueRecurse(Node* node, int b1, int b2, BVHFrontList* front_list, int qsize);
 
-/// @brief Recurse function for front list propagation
+/// @brief Collision traversal shared among the threads of a pool
+///
+/// The bounding volume test tree is expanded breadth first on the calling
+/// thread until it provides enough independent subtrees, which are then
+/// traversed by collisionRecurse on the threads of the pool.
+/// @param nodes one node per thread of pool, all initialized on the same
+///        objects. Their result is modified during the traversal.
+/// @param result the contacts of the subtrees are added in the order of the
+///        subtrees, until request.num_max_contacts is reached.
+/// @retval sqrDistLowerBound squared lower bound on distance between objects.
+void collisionParallel(const std::vector<CollisionTraversalNodeBase*>& nodes,
+                       ThreadPool& pool, CollisionResult& result,
+                       FCL_REAL& sqrDistLowerBound);
+
+/// @brief Distance traversal shared among the threads of a pool
+///
+/// The subtrees of the bounding volume test tree are traversed by increasing
+/// lower bound. The best distance found so far is published in an atomic
+/// after every leaf test, and every thread prunes its recursion with it.
+/// @param nodes one node per thread of pool, all initialized on the same
+///        objects. The result of nodes[0] receives the minimal distance, the
+///        result of the other nodes is modified during the traversal.
+/// @param qsize see distanceQueueRecurse, distanceRecurse is used if it is
+///        not greater than 2.
+void distanceParallel(const std::vector<DistanceTraversalNodeBase*>& nodes,
+                      ThreadPool& pool, int qsize);
+
+/// @brief Collision traversal starting from the front of a previous query
+///
+/// Each node of the front is traversed by collisionRecurse, front_list is
+/// replaced by the front of this traversal.
+/// @retval sqrDistLowerBound squared lower bound on distance between objects.
+template<typename Node>
 void propagateBVHFrontListCollisionRecurse
-  (CollisionTraversalNodeBase* node, const CollisionRequest& request,
-   CollisionResult& result, BVHFrontList* front_list);
+  (Node* node, BVHFrontList* front_list, FCL_REAL& sqrDistLowerBound);
+
+/// @brief Distance traversal starting from the front of a previous query
+///
+/// The nodes of the front are visited by increasing lower bound on the
+/// distance and traversed by distanceRecurse unless they can be pruned.
+/// front_list is replaced by the front of this traversal.
+template<typename Node>
+void propagateBVHFrontListDistanceRecurse(Node* node, BVHFrontList* front_list);
 
 }
 
 } // namespace hpp
 
+#include "details/traversal_recurse.hxx"
+
 /// @endcond
 
 #endif
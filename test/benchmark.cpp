@@ -16,6 +16,11 @@
 
 #include <boost/filesystem.hpp>
 
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/thread_pool.h>
+#include <hpp/fcl/BVH/BVH_wide.h>
+
 #include "../src/traversal/traversal_node_setup.h"
 #include "../src/traversal/traversal_node_bvhs.h"
 #include "../src/collision_node.h"
@@ -29,7 +34,6 @@
 
 using namespace hpp::fcl;
 
-bool verbose = false;
 FCL_REAL DELTA = 0.001;
 
 template<typename BV>
@@ -39,21 +43,40 @@ void makeModel (const std::vector<Vec3f>& vertices, const std::vector<Triangle>&
 template<typename BV, typename TraversalNode>
 double distance (const std::vector<Transform3f>& tf,
                const BVHModel<BV>& m1, const BVHModel<BV>& m2,
-               bool verbose);
+               int& num_bv_tests);
 
 template<typename BV, typename TraversalNode>
 double collide (const std::vector<Transform3f>& tf,
                const BVHModel<BV>& m1, const BVHModel<BV>& m2,
-               bool verbose);
+               int& num_bv_tests);
 
 template<typename BV>
 double run (const std::vector<Transform3f>& tf,
-    const BVHModel<BV> (&models)[2][3], int split_method,
+    const BVHModel<BV> (&models)[2][4], int split_method,
           const char* sm_name);
 
 template <typename BV> struct traits {
 };
 
+double leafKernels (std::size_t n);
+
+double wideBVH (const std::vector<Transform3f>& tf,
+                const BVHModel<AABB>& m1, const BVHModel<AABB>& m2);
+
+template<typename BV>
+double compactLayout (const std::vector<Transform3f>& tf,
+    const BVHModel<BV>& m1, const BVHModel<BV>& m2, const char* prefix);
+
+double batchScaling (const std::vector<Transform3f>& tf,
+                     const BVHModelPtr_t& env, const BVHModelPtr_t& rob);
+
+double frontCache (const std::vector<Transform3f>& tf,
+    const BVHModel<OBBRSS>& m1, const BVHModel<OBBRSS>& m2);
+
+double gjkCache (std::size_t n);
+
+double largeConvex (std::size_t n);
+
 template <> struct traits <RSS> {
   typedef MeshCollisionTraversalNodeRSS CollisionTraversalNode;
   typedef MeshDistanceTraversalNodeRSS  DistanceTraversalNode;
@@ -89,7 +112,7 @@ void makeModel (const std::vector<Vec3f>& vertices, const std::vector<Triangle>&
 template<typename BV, typename TraversalNode>
 double distance (const std::vector<Transform3f>& tf,
                const BVHModel<BV>& m1, const BVHModel<BV>& m2,
-               bool verbose)
+               int& num_bv_tests)
 {
   Transform3f pose2;
 
@@ -97,25 +120,27 @@ double distance (const std::vector<Transform3f>& tf,
   DistanceRequest request(true);
   TraversalNode node;
 
-  node.enable_statistics = verbose;
+  node.enable_statistics = true;
 
   Timer timer;
   timer.start();
 
   for (std::size_t i = 0; i < tf.size(); ++i) {
+    local_result.clear();
     if(!initialize(node, m1, tf[i], m2, pose2, request, local_result))
       std::cout << "initialize error" << std::endl;
 
     distance(&node, NULL);
   }
   timer.stop();
+  num_bv_tests = node.num_bv_tests;
   return timer.getElapsedTimeInMicroSec();
 }
 
 template<typename BV, typename TraversalNode>
 double collide (const std::vector<Transform3f>& tf,
                const BVHModel<BV>& m1, const BVHModel<BV>& m2,
-               bool verbose)
+               int& num_bv_tests)
 {
   Transform3f pose2;
 
@@ -123,7 +148,7 @@ double collide (const std::vector<Transform3f>& tf,
   CollisionRequest request;
   TraversalNode node (request);
 
-  node.enable_statistics = verbose;
+  node.enable_statistics = true;
 
   Timer timer;
   timer.start();
@@ -138,36 +163,364 @@ double collide (const std::vector<Transform3f>& tf,
   }
 
   timer.stop();
+  num_bv_tests = node.num_bv_tests;
   return timer.getElapsedTimeInMicroSec();
 }
 
 template<typename BV>
 double run (const std::vector<Transform3f>& tf,
-          const BVHModel<BV> (&models)[2][3], int split_method,
+          const BVHModel<BV> (&models)[2][4], int split_method,
           const char* prefix)
 {
+  int col_tests, dist_tests;
   double col  = collide <BV, typename traits<BV>::CollisionTraversalNode>
-    (tf, models[0][split_method], models[1][split_method], verbose);
+    (tf, models[0][split_method], models[1][split_method], col_tests);
   double dist = distance<BV, typename traits<BV>::DistanceTraversalNode>
-    (tf, models[0][split_method], models[1][split_method], verbose);
+    (tf, models[0][split_method], models[1][split_method], dist_tests);
 
-  std::cout << prefix << " (" << col << ", " << dist << ")\n";
+  std::cout << prefix << " (" << col << ", " << dist << ")"
+    << "\tBV tests (" << col_tests << ", " << dist_tests << ")\n";
   return col + dist;
 }
 
 template<>
 double run<OBB> (const std::vector<Transform3f>& tf,
-                 const BVHModel<OBB> (&models)[2][3], int split_method,
+                 const BVHModel<OBB> (&models)[2][4], int split_method,
                  const char* prefix)
 {
+  int col_tests;
   double col  = collide <OBB, typename traits<OBB>::CollisionTraversalNode>
-    (tf, models[0][split_method], models[1][split_method], verbose);
+    (tf, models[0][split_method], models[1][split_method], col_tests);
   double dist = 0;
 
-  std::cout << prefix << " (\t" << col << ", \tNaN)\n";
+  std::cout << prefix << " (\t" << col << ", \tNaN)"
+    << "\tBV tests (" << col_tests << ", NaN)\n";
   return col + dist;
 }
 
+/// Compare the collision traversal on the BV nodes and on the compact
+/// layout of the models.
+template<typename BV>
+double compactLayout (const std::vector<Transform3f>& tf,
+    const BVHModel<BV>& m1, const BVHModel<BV>& m2, const char* prefix)
+{
+  BVHModel<BV> c1 (m1), c2 (m2);
+  c1.buildCompactLayout();
+  c2.buildCompactLayout();
+
+  int tests, compact_tests;
+  double col = collide <BV, typename traits<BV>::CollisionTraversalNode>
+    (tf, m1, m2, tests);
+  double compact = collide <BV, typename traits<BV>::CollisionTraversalNode>
+    (tf, c1, c2, compact_tests);
+
+  std::cout << prefix << " BV nodes (" << sizeof(BVNode<BV>) << " bytes), "
+    << "compact layout (" << sizeof(CompactBVNode<BV>) << " bytes):\t("
+    << col << ", " << compact << "), speed up " << col / compact << "\n";
+  c1.memUsage(1);
+  return col + compact;
+}
+
+/// Compare the traversals calling the methods of the nodes through virtual
+/// dispatch and directly.
+template<typename BV>
+double staticDispatch (const std::vector<Transform3f>& tf,
+    const BVHModel<BV>& m1, const BVHModel<BV>& m2, const char* prefix)
+{
+  CollisionRequest request (NO_REQUEST, 100000);
+  typename traits<BV>::CollisionTraversalNode col_node (request);
+  DistanceRequest drequest;
+  typename traits<BV>::DistanceTraversalNode dist_node;
+  Timer timer;
+
+  double times[4];
+  for (int k = 0; k < 4; ++k) {
+    timer.start();
+    for (std::size_t i = 0; i < tf.size(); ++i) {
+      if (k < 2) {
+        CollisionResult result;
+        initialize(col_node, m1, tf[i], m2, Transform3f(), result);
+        if (k == 0)
+          collide(static_cast<CollisionTraversalNodeBase*>(&col_node),
+                  request, result);
+        else
+          collide(&col_node, request, result);
+      } else {
+        DistanceResult result;
+        initialize(dist_node, m1, tf[i], m2, Transform3f(), drequest, result);
+        if (k == 2)
+          distance(static_cast<DistanceTraversalNodeBase*>(&dist_node));
+        else
+          distance(&dist_node);
+      }
+    }
+    timer.stop();
+    times[k] = timer.getElapsedTimeInMicroSec();
+  }
+
+  std::cout << prefix << " virtual / static calls, collision:\t("
+    << times[0] << ", " << times[1] << "), distance:\t(" << times[2] << ", "
+    << times[3] << ")\n";
+  return times[0] + times[1] + times[2] + times[3];
+}
+
+/// Compare the queries through the public API from the roots and from the
+/// front of the previous query, along sequences of small motions starting
+/// at each transform of tf.
+double frontCache (const std::vector<Transform3f>& tf,
+    const BVHModel<OBBRSS>& m1, const BVHModel<OBBRSS>& m2)
+{
+  const int steps = 50;
+  const Vec3f step (1, -.5, .5);
+  Timer timer;
+
+  double times[4];
+  for (int k = 0; k < 4; ++k) {
+    BVHFront front;
+    CollisionRequest request (CONTACT, 100000);
+    DistanceRequest drequest;
+    if (k % 2 == 1) {
+      request.front = &front;
+      drequest.front = &front;
+    }
+    timer.start();
+    for (std::size_t i = 0; i < tf.size(); ++i) {
+      Transform3f pose (tf[i]);
+      front.clear();
+      for (int j = 0; j < steps; ++j) {
+        pose.setTranslation (pose.getTranslation () + step);
+        if (k < 2) {
+          CollisionResult result;
+          collide (&m1, Transform3f(), &m2, pose, request, result);
+        } else {
+          DistanceResult result;
+          distance (&m1, Transform3f(), &m2, pose, drequest, result);
+        }
+      }
+    }
+    timer.stop();
+    times[k] = timer.getElapsedTimeInMicroSec();
+  }
+
+  std::cout << "OBBRSS small motions without / with front, collision:\t("
+    << times[0] << ", " << times[1] << "), speed up " << times[0] / times[1]
+    << ", distance:\t(" << times[2] << ", " << times[3] << "), speed up "
+    << times[2] / times[3] << "\n";
+  return times[0] + times[1] + times[2] + times[3];
+}
+
+/// Compare the distance between shapes computed by GJK from the initial
+/// guess and from the simplex of the previous query, along sequences of
+/// small motions.
+double gjkCache (std::size_t n)
+{
+  const int steps = 50;
+  const Vec3f step (.01, -.005, .005);
+  FCL_REAL extents[] = {-2, -2, -2, 2, 2, 2};
+  std::vector<Transform3f> tf;
+  generateRandomTransforms(extents, tf, n);
+  Cylinder cylinder (1, 2);
+  Cone cone (1, 2);
+  Capsule capsule (.5, 2);
+  Box box (1, 2, 3);
+  Timer timer;
+
+  double times[4];
+  for (int k = 0; k < 4; ++k) {
+    GJKCache cache;
+    DistanceRequest request;
+    if (k % 2 == 1) request.gjk_cache = &cache;
+    const CollisionGeometry* o1 = &cylinder;
+    const CollisionGeometry* o2 = &cone;
+    if (k >= 2) { o1 = &box; o2 = &capsule; }
+    timer.start();
+    for (std::size_t i = 0; i < tf.size(); ++i) {
+      Transform3f pose (tf[i]);
+      cache.clear();
+      for (int j = 0; j < steps; ++j) {
+        pose.setTranslation (pose.getTranslation () + step);
+        DistanceResult result;
+        distance (o1, Transform3f(), o2, pose, request, result);
+      }
+    }
+    timer.stop();
+    times[k] = timer.getElapsedTimeInMicroSec();
+  }
+
+  std::cout << "GJK small motions without / with cache, cylinder-cone:\t("
+    << times[0] << ", " << times[1] << "), speed up " << times[0] / times[1]
+    << ", box-capsule:\t(" << times[2] << ", " << times[3] << "), speed up "
+    << times[2] / times[3] << "\n";
+  return times[0] + times[1] + times[2] + times[3];
+}
+
+/// Compare the distance between large convex polytopes computed by GJK
+/// without and with the lookup table of support starts.
+double largeConvex (std::size_t n)
+{
+  FCL_REAL extents[] = {-3, -3, -3, 3, 3, 3};
+  std::vector<Transform3f> tf;
+  generateRandomTransforms(extents, tf, n);
+  boost::shared_ptr<ConvexBase> c1 (makeConvexSphere (1, 40, 50)),
+                                c2 (makeConvexSphere (1, 40, 50));
+  std::vector<unsigned int> starts1 (c1->support_starts),
+                            starts2 (c2->support_starts);
+  Timer timer;
+
+  double times[2];
+  for (int k = 0; k < 2; ++k) {
+    if (k == 0) {
+      c1->support_starts.clear ();
+      c2->support_starts.clear ();
+    } else {
+      c1->support_starts = starts1;
+      c2->support_starts = starts2;
+    }
+    DistanceRequest request;
+    timer.start();
+    for (std::size_t i = 0; i < tf.size(); ++i) {
+      DistanceResult result;
+      distance (c1.get (), Transform3f(), c2.get (), tf[i], request, result);
+    }
+    timer.stop();
+    times[k] = timer.getElapsedTimeInMicroSec();
+  }
+
+  std::cout << "GJK on convex polytopes of " << c1->num_points
+    << " points without / with support lookup:\t(" << times[0] << ", "
+    << times[1] << "), speed up " << times[0] / times[1] << "\n";
+  return times[0] + times[1];
+}
+
+/// Compare the collision traversal of binary and wide hierarchies of AABB,
+/// between two meshes and between a mesh and a box.
+double wideBVH (const std::vector<Transform3f>& tf,
+                const BVHModel<AABB>& m1, const BVHModel<AABB>& m2)
+{
+  WideBVH w1 (m1), w2 (m2);
+  Box box (50, 20, 100);
+  CollisionRequest request;
+  Timer timer;
+
+  double times[4];
+  for (int k = 0; k < 4; ++k) {
+    timer.start();
+    for (std::size_t i = 0; i < tf.size(); ++i) {
+      CollisionResult result;
+      switch (k) {
+        case 0: collide (&m1, Transform3f(), &m2, tf[i], request, result); break;
+        case 1: collide (w1, Transform3f(), w2, tf[i], request, result); break;
+        case 2: collide (&m1, Transform3f(), &box, tf[i], request, result); break;
+        case 3: collide (w1, Transform3f(), &box, tf[i], request, result); break;
+      }
+    }
+    timer.stop();
+    times[k] = timer.getElapsedTimeInMicroSec();
+  }
+
+  std::cout << "AABB binary / wide hierarchy, mesh-mesh:\t(" << times[0] << ", "
+    << times[1] << "), mesh-box:\t(" << times[2] << ", " << times[3] << ")\n";
+  return times[0] + times[1] + times[2] + times[3];
+}
+
+/// Compare the triangle-triangle kernels used in the leaves of the
+/// mesh-mesh collision traversal.
+double leafKernels (std::size_t n)
+{
+  std::vector<Vec3f> P (3*n), Q (3*n);
+  for (std::size_t i = 0; i < 3*n; ++i) {
+    P[i] = Vec3f::Random();
+    Q[i] = Vec3f::Random() + Vec3f::Random() / 2;
+  }
+
+  Transform3f tf;
+  GJKSolver solver;
+  std::size_t n_gjk = 0, n_dist = 0, n_inter = 0;
+  Timer timer;
+
+  timer.start();
+  for (std::size_t i = 0; i < 3*n; i += 3) {
+    TriangleP tri1 (P[i], P[i+1], P[i+2]);
+    TriangleP tri2 (Q[i], Q[i+1], Q[i+2]);
+    Vec3f p1, p2, normal;
+    FCL_REAL distance;
+    solver.shapeDistance (tri1, tf, tri2, tf, distance, p1, p2, normal);
+    if (distance <= 0) ++n_gjk;
+  }
+  timer.stop();
+  double gjk = timer.getElapsedTimeInMicroSec();
+
+  timer.start();
+  for (std::size_t i = 0; i < 3*n; i += 3) {
+    Vec3f p1, p2;
+    if (TriangleDistance::sqrTriDistance (P[i], P[i+1], P[i+2],
+          Q[i], Q[i+1], Q[i+2], p1, p2) == 0) ++n_dist;
+  }
+  timer.stop();
+  double dist = timer.getElapsedTimeInMicroSec();
+
+  timer.start();
+  for (std::size_t i = 0; i < 3*n; i += 3) {
+    FCL_REAL sqrDistLowerBound;
+    if (Intersect::intersectTriangles (P[i], P[i+1], P[i+2],
+          Q[i], Q[i+1], Q[i+2], sqrDistLowerBound)) ++n_inter;
+  }
+  timer.stop();
+  double inter = timer.getElapsedTimeInMicroSec();
+
+  std::cout << "Triangle pairs (GJK, sqrTriDistance, intersectTriangles):\t("
+    << gjk << ", " << dist << ", " << inter << ")\n"
+    << "Intersecting pairs:\t(" << n_gjk << ", " << n_dist << ", "
+    << n_inter << ")\n";
+  return gjk + dist + inter;
+}
+
+/// Time the parallel collision and distance of many pairs of objects
+/// with 1 to N threads, N being the number of hardware threads.
+double batchScaling (const std::vector<Transform3f>& tf,
+                     const BVHModelPtr_t& env, const BVHModelPtr_t& rob)
+{
+  CollisionObject env_obj (env);
+  std::vector<CollisionObject*> objs (tf.size());
+  std::vector<CollisionObjectPair> pairs (tf.size());
+  for (std::size_t i = 0; i < tf.size(); ++i) {
+    objs[i] = new CollisionObject (rob, tf[i]);
+    pairs[i] = CollisionObjectPair (&env_obj, objs[i]);
+  }
+
+  CollisionRequest crequest;
+  DistanceRequest drequest (true);
+  std::vector<CollisionResult> cresults;
+  std::vector<DistanceResult> dresults;
+  std::size_t max_threads =
+    std::max (1u, boost::thread::hardware_concurrency());
+  double total = 0, col1 = 0, dist1 = 0;
+  Timer timer;
+
+  for (std::size_t n = 1; n <= max_threads; ++n) {
+    ThreadPool pool (n);
+
+    timer.start();
+    collide (pairs, crequest, cresults, pool);
+    timer.stop();
+    double col = timer.getElapsedTimeInMicroSec();
+
+    timer.start();
+    distance (pairs, drequest, dresults, pool);
+    timer.stop();
+    double dist = timer.getElapsedTimeInMicroSec();
+
+    if (n == 1) { col1 = col; dist1 = dist; }
+    std::cout << "Batch of " << pairs.size() << " pairs - " << n
+      << " threads:\t (" << col << ", " << dist << "), speed up ("
+      << col1 / col << ", " << dist1 / dist << ")\n";
+    total += col + dist;
+  }
+
+  for (std::size_t i = 0; i < objs.size(); ++i)
+    delete objs[i];
+  return total;
+}
 
 int main (int, char*[])
 {
@@ -178,37 +531,45 @@ int main (int, char*[])
   loadOBJFile((path / "rob.obj").string().c_str(), p2, t2);
 
   // Make models
-  BVHModel<RSS> ms_rss[2][3];
+  BVHModel<RSS> ms_rss[2][4];
   makeModel (p1, t1, SPLIT_METHOD_MEAN     , ms_rss[0][SPLIT_METHOD_MEAN     ]);
   makeModel (p1, t1, SPLIT_METHOD_BV_CENTER, ms_rss[0][SPLIT_METHOD_BV_CENTER]);
   makeModel (p1, t1, SPLIT_METHOD_MEDIAN   , ms_rss[0][SPLIT_METHOD_MEDIAN   ]);
+  makeModel (p1, t1, SPLIT_METHOD_SAH      , ms_rss[0][SPLIT_METHOD_SAH      ]);
   makeModel (p2, t2, SPLIT_METHOD_MEAN     , ms_rss[1][SPLIT_METHOD_MEAN     ]);
   makeModel (p2, t2, SPLIT_METHOD_BV_CENTER, ms_rss[1][SPLIT_METHOD_BV_CENTER]);
   makeModel (p2, t2, SPLIT_METHOD_MEDIAN   , ms_rss[1][SPLIT_METHOD_MEDIAN   ]);
+  makeModel (p2, t2, SPLIT_METHOD_SAH      , ms_rss[1][SPLIT_METHOD_SAH      ]);
 
-  BVHModel<kIOS> ms_kios[2][3];
+  BVHModel<kIOS> ms_kios[2][4];
   makeModel (p1, t1, SPLIT_METHOD_MEAN     , ms_kios[0][SPLIT_METHOD_MEAN     ]);
   makeModel (p1, t1, SPLIT_METHOD_BV_CENTER, ms_kios[0][SPLIT_METHOD_BV_CENTER]);
   makeModel (p1, t1, SPLIT_METHOD_MEDIAN   , ms_kios[0][SPLIT_METHOD_MEDIAN   ]);
+  makeModel (p1, t1, SPLIT_METHOD_SAH      , ms_kios[0][SPLIT_METHOD_SAH      ]);
   makeModel (p2, t2, SPLIT_METHOD_MEAN     , ms_kios[1][SPLIT_METHOD_MEAN     ]);
   makeModel (p2, t2, SPLIT_METHOD_BV_CENTER, ms_kios[1][SPLIT_METHOD_BV_CENTER]);
   makeModel (p2, t2, SPLIT_METHOD_MEDIAN   , ms_kios[1][SPLIT_METHOD_MEDIAN   ]);
+  makeModel (p2, t2, SPLIT_METHOD_SAH      , ms_kios[1][SPLIT_METHOD_SAH      ]);
 
-  BVHModel<OBB> ms_obb[2][3];
+  BVHModel<OBB> ms_obb[2][4];
   makeModel (p1, t1, SPLIT_METHOD_MEAN     , ms_obb[0][SPLIT_METHOD_MEAN     ]);
   makeModel (p1, t1, SPLIT_METHOD_BV_CENTER, ms_obb[0][SPLIT_METHOD_BV_CENTER]);
   makeModel (p1, t1, SPLIT_METHOD_MEDIAN   , ms_obb[0][SPLIT_METHOD_MEDIAN   ]);
+  makeModel (p1, t1, SPLIT_METHOD_SAH      , ms_obb[0][SPLIT_METHOD_SAH      ]);
   makeModel (p2, t2, SPLIT_METHOD_MEAN     , ms_obb[1][SPLIT_METHOD_MEAN     ]);
   makeModel (p2, t2, SPLIT_METHOD_BV_CENTER, ms_obb[1][SPLIT_METHOD_BV_CENTER]);
   makeModel (p2, t2, SPLIT_METHOD_MEDIAN   , ms_obb[1][SPLIT_METHOD_MEDIAN   ]);
+  makeModel (p2, t2, SPLIT_METHOD_SAH      , ms_obb[1][SPLIT_METHOD_SAH      ]);
 
-  BVHModel<OBBRSS> ms_obbrss[2][3];
+  BVHModel<OBBRSS> ms_obbrss[2][4];
   makeModel (p1, t1, SPLIT_METHOD_MEAN     , ms_obbrss[0][SPLIT_METHOD_MEAN     ]);
   makeModel (p1, t1, SPLIT_METHOD_BV_CENTER, ms_obbrss[0][SPLIT_METHOD_BV_CENTER]);
   makeModel (p1, t1, SPLIT_METHOD_MEDIAN   , ms_obbrss[0][SPLIT_METHOD_MEDIAN   ]);
+  makeModel (p1, t1, SPLIT_METHOD_SAH      , ms_obbrss[0][SPLIT_METHOD_SAH      ]);
   makeModel (p2, t2, SPLIT_METHOD_MEAN     , ms_obbrss[1][SPLIT_METHOD_MEAN     ]);
   makeModel (p2, t2, SPLIT_METHOD_BV_CENTER, ms_obbrss[1][SPLIT_METHOD_BV_CENTER]);
   makeModel (p2, t2, SPLIT_METHOD_MEDIAN   , ms_obbrss[1][SPLIT_METHOD_MEDIAN   ]);
+  makeModel (p2, t2, SPLIT_METHOD_SAH      , ms_obbrss[1][SPLIT_METHOD_SAH      ]);
 
   std::vector<Transform3f> transforms; // t0
   FCL_REAL extents[] = {-3000, -3000, -3000, 3000, 3000, 3000};
@@ -220,18 +581,50 @@ int main (int, char*[])
   total_time += RUN_CASE(RSS, transforms, ms_rss, SPLIT_METHOD_MEAN);
   total_time += RUN_CASE(RSS, transforms, ms_rss, SPLIT_METHOD_BV_CENTER);
   total_time += RUN_CASE(RSS, transforms, ms_rss, SPLIT_METHOD_MEDIAN);
+  total_time += RUN_CASE(RSS, transforms, ms_rss, SPLIT_METHOD_SAH);
 
   total_time += RUN_CASE(kIOS, transforms, ms_kios, SPLIT_METHOD_MEAN);
   total_time += RUN_CASE(kIOS, transforms, ms_kios, SPLIT_METHOD_BV_CENTER);
   total_time += RUN_CASE(kIOS, transforms, ms_kios, SPLIT_METHOD_MEDIAN);
+  total_time += RUN_CASE(kIOS, transforms, ms_kios, SPLIT_METHOD_SAH);
 
   total_time += RUN_CASE(OBB, transforms, ms_obb, SPLIT_METHOD_MEAN);
   total_time += RUN_CASE(OBB, transforms, ms_obb, SPLIT_METHOD_BV_CENTER);
   total_time += RUN_CASE(OBB, transforms, ms_obb, SPLIT_METHOD_MEDIAN);
+  total_time += RUN_CASE(OBB, transforms, ms_obb, SPLIT_METHOD_SAH);
 
   total_time += RUN_CASE(OBBRSS, transforms, ms_obbrss, SPLIT_METHOD_MEAN);
   total_time += RUN_CASE(OBBRSS, transforms, ms_obbrss, SPLIT_METHOD_BV_CENTER);
   total_time += RUN_CASE(OBBRSS, transforms, ms_obbrss, SPLIT_METHOD_MEDIAN);
+  total_time += RUN_CASE(OBBRSS, transforms, ms_obbrss, SPLIT_METHOD_SAH);
+
+  total_time += compactLayout (transforms, ms_obbrss[0][SPLIT_METHOD_MEAN],
+      ms_obbrss[1][SPLIT_METHOD_MEAN], "OBBRSS");
+  total_time += compactLayout (transforms, ms_obb[0][SPLIT_METHOD_MEAN],
+      ms_obb[1][SPLIT_METHOD_MEAN], "OBB");
+  total_time += compactLayout (transforms, ms_rss[0][SPLIT_METHOD_MEAN],
+      ms_rss[1][SPLIT_METHOD_MEAN], "RSS");
+
+  BVHModel<AABB> ms_aabb[2];
+  makeModel (p1, t1, SPLIT_METHOD_MEAN, ms_aabb[0]);
+  makeModel (p2, t2, SPLIT_METHOD_MEAN, ms_aabb[1]);
+  total_time += staticDispatch (transforms, ms_obbrss[0][SPLIT_METHOD_MEAN],
+      ms_obbrss[1][SPLIT_METHOD_MEAN], "OBBRSS");
+  total_time += staticDispatch (transforms, ms_rss[0][SPLIT_METHOD_MEAN],
+      ms_rss[1][SPLIT_METHOD_MEAN], "RSS");
+  total_time += wideBVH (transforms, ms_aabb[0], ms_aabb[1]);
+  total_time += frontCache (std::vector<Transform3f> (transforms.begin(),
+        transforms.begin() + 200), ms_obbrss[0][SPLIT_METHOD_MEAN],
+      ms_obbrss[1][SPLIT_METHOD_MEAN]);
+
+  total_time += leafKernels (n * 10);
+  total_time += gjkCache (n / 10);
+  total_time += largeConvex (n);
+
+  BVHModelPtr_t env (new BVHModel<OBBRSS> (ms_obbrss[0][SPLIT_METHOD_MEAN]));
+  BVHModelPtr_t rob (new BVHModel<OBBRSS> (ms_obbrss[1][SPLIT_METHOD_MEAN]));
+  total_time += batchScaling (std::vector<Transform3f> (transforms.begin(),
+        transforms.begin() + 1000), env, rob);
 
   std::cout << "\n\nTotal time: " << total_time << std::endl;
 }
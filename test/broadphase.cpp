@@ -41,18 +41,11 @@
 #include <boost/test/unit_test.hpp>
 #include <boost/utility/binary.hpp>
 
-#include <hpp/fcl/config.h>
 #include <hpp/fcl/broadphase/broadphase.h>
 #include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
 #include <hpp/fcl/math/transform.h>
 #include "utility.h"
 
-#if USE_GOOGLEHASH
-#include <sparsehash/sparse_hash_map>
-#include <sparsehash/dense_hash_map>
-#include <hash_map>
-#endif
-
 #include <boost/math/constants/constants.hpp>
 #include <iostream>
 #include <iomanip>
@@ -97,22 +90,14 @@ void broad_phase_self_distance_test(double env_scale, std::size_t env_size, bool
 /// @brief test for broad phase update
 void broad_phase_update_collision_test(double env_scale, std::size_t env_size, std::size_t query_size, std::size_t num_max_contacts = 1, bool exhaustive = false, bool use_mesh = false);
 
-FCL_REAL DELTA = 0.01;
+/// @brief test that the sweep and prune manager reports the changes of the overlapping pairs
+void broad_phase_sap_pairs_test(double env_scale, std::size_t env_size, std::size_t n_steps);
 
+/// @brief Fill managers with all the broadphase managers to compare, the first one is the reference
+void generateManagers(std::vector<BroadPhaseCollisionManager*>& managers);
 
-#if USE_GOOGLEHASH
-template<typename U, typename V>
-struct GoogleSparseHashTable : public google::sparse_hash_map<U, V, std::tr1::hash<size_t>, std::equal_to<size_t> > {};
+FCL_REAL DELTA = 0.01;
 
-template<typename U, typename V>
-struct GoogleDenseHashTable : public google::dense_hash_map<U, V, std::tr1::hash<size_t>, std::equal_to<size_t> >
-{
-  GoogleDenseHashTable() : google::dense_hash_map<U, V, std::tr1::hash<size_t>, std::equal_to<size_t> >()
-  {
-    this->set_empty_key(NULL);
-  }
-};
-#endif
 
 /// check the update, only return collision or not
 BOOST_AUTO_TEST_CASE(test_core_bf_broad_phase_update_collision_binary)
@@ -195,6 +180,13 @@ BOOST_AUTO_TEST_CASE(test_core_bf_broad_phase_collision)
   broad_phase_collision_test(2000, 1000, 1000, 10, false);
 }
 
+/// check the overlapping pairs created and destroyed by the sweep and prune update
+BOOST_AUTO_TEST_CASE(test_core_sap_broad_phase_update_pairs)
+{
+  broad_phase_sap_pairs_test(200, 100, 20);
+  broad_phase_sap_pairs_test(2000, 1000, 10);
+}
+
 /// check broad phase update, in mesh, only return collision or not
 BOOST_AUTO_TEST_CASE(test_core_mesh_bf_broad_phase_update_collision_mesh_binary)
 {
@@ -286,6 +278,20 @@ BOOST_AUTO_TEST_CASE(test_core_mesh_bf_broad_phase_collision_mesh_exhaustive)
 #endif
 }
 
+void generateManagers(std::vector<BroadPhaseCollisionManager*>& managers)
+{
+  managers.push_back(new NaiveCollisionManager());
+
+  for(int level = 0; level < 3; ++level)
+  {
+    DynamicAABBTreeCollisionManager* m = new DynamicAABBTreeCollisionManager();
+    m->tree_init_level = level;
+    managers.push_back(m);
+  }
+
+  managers.push_back(new SaPCollisionManager());
+}
+
 void generateEnvironments(std::vector<CollisionObject*>& env, double env_scale, std::size_t n)
 {
   FCL_REAL extents[] = {-env_scale, env_scale, -env_scale, env_scale, -env_scale, env_scale};
@@ -498,37 +504,7 @@ void broad_phase_collision_test(double env_scale, std::size_t env_size, std::siz
 
   std::vector<BroadPhaseCollisionManager*> managers;
   
-  managers.push_back(new NaiveCollisionManager());
-  managers.push_back(new SSaPCollisionManager());
-  managers.push_back(new SaPCollisionManager());
-  managers.push_back(new IntervalTreeCollisionManager());
-  
-  Vec3f lower_limit, upper_limit;
-  SpatialHashingCollisionManager<>::computeBound(env, lower_limit, upper_limit);
-  // FCL_REAL ncell_per_axis = std::pow((FCL_REAL)env_size / 10, 1 / 3.0);
-  FCL_REAL ncell_per_axis = 20;
-  FCL_REAL cell_size = std::min(std::min((upper_limit[0] - lower_limit[0]) / ncell_per_axis, (upper_limit[1] - lower_limit[1]) / ncell_per_axis), (upper_limit[2] - lower_limit[2]) / ncell_per_axis);
-  // managers.push_back(new SpatialHashingCollisionManager<>(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash> >(cell_size, lower_limit, upper_limit));
-#if USE_GOOGLEHASH
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleSparseHashTable> >(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleDenseHashTable> >(cell_size, lower_limit, upper_limit));
-#endif
-  managers.push_back(new DynamicAABBTreeCollisionManager());
-
-  managers.push_back(new DynamicAABBTreeCollisionManager_Array());
-
-  {
-    DynamicAABBTreeCollisionManager* m = new DynamicAABBTreeCollisionManager();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
-
-  {
-    DynamicAABBTreeCollisionManager_Array* m = new DynamicAABBTreeCollisionManager_Array();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
+  generateManagers(managers);
 
   ts.resize(managers.size());
   timers.resize(managers.size());
@@ -687,34 +663,7 @@ void broad_phase_self_distance_test(double env_scale, std::size_t env_size, bool
   
   std::vector<BroadPhaseCollisionManager*> managers;
   
-  managers.push_back(new NaiveCollisionManager());
-  managers.push_back(new SSaPCollisionManager());
-  managers.push_back(new SaPCollisionManager());
-  managers.push_back(new IntervalTreeCollisionManager());
-  
-  Vec3f lower_limit, upper_limit;
-  SpatialHashingCollisionManager<>::computeBound(env, lower_limit, upper_limit);
-  FCL_REAL cell_size = std::min(std::min((upper_limit[0] - lower_limit[0]) / 5, (upper_limit[1] - lower_limit[1]) / 5), (upper_limit[2] - lower_limit[2]) / 5);
-  // managers.push_back(new SpatialHashingCollisionManager<>(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash> >(cell_size, lower_limit, upper_limit));
-#if USE_GOOGLEHASH
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleSparseHashTable> >(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleDenseHashTable> >(cell_size, lower_limit, upper_limit));
-#endif
-  managers.push_back(new DynamicAABBTreeCollisionManager());
-  managers.push_back(new DynamicAABBTreeCollisionManager_Array());
-
-  {
-    DynamicAABBTreeCollisionManager* m = new DynamicAABBTreeCollisionManager();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
-
-  {
-    DynamicAABBTreeCollisionManager_Array* m = new DynamicAABBTreeCollisionManager_Array();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
+  generateManagers(managers);
 
   ts.resize(managers.size());
   timers.resize(managers.size());
@@ -830,34 +779,7 @@ void broad_phase_distance_test(double env_scale, std::size_t env_size, std::size
 
   std::vector<BroadPhaseCollisionManager*> managers;
 
-  managers.push_back(new NaiveCollisionManager());
-  managers.push_back(new SSaPCollisionManager());
-  managers.push_back(new SaPCollisionManager());
-  managers.push_back(new IntervalTreeCollisionManager());
-  
-  Vec3f lower_limit, upper_limit;
-  SpatialHashingCollisionManager<>::computeBound(env, lower_limit, upper_limit);
-  FCL_REAL cell_size = std::min(std::min((upper_limit[0] - lower_limit[0]) / 20, (upper_limit[1] - lower_limit[1]) / 20), (upper_limit[2] - lower_limit[2])/20);
-  // managers.push_back(new SpatialHashingCollisionManager<>(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash> >(cell_size, lower_limit, upper_limit));
-#if USE_GOOGLEHASH
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleSparseHashTable> >(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleDenseHashTable> >(cell_size, lower_limit, upper_limit));
-#endif
-  managers.push_back(new DynamicAABBTreeCollisionManager());
-  managers.push_back(new DynamicAABBTreeCollisionManager_Array());
-
-  {
-    DynamicAABBTreeCollisionManager* m = new DynamicAABBTreeCollisionManager();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
-
-  {
-    DynamicAABBTreeCollisionManager_Array* m = new DynamicAABBTreeCollisionManager_Array();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
+  generateManagers(managers);
 
   ts.resize(managers.size());
   timers.resize(managers.size());
@@ -959,36 +881,7 @@ void broad_phase_update_collision_test(double env_scale, std::size_t env_size, s
 
   std::vector<BroadPhaseCollisionManager*> managers;
   
-  managers.push_back(new NaiveCollisionManager());
-  managers.push_back(new SSaPCollisionManager());
-
-  
-  managers.push_back(new SaPCollisionManager());
-  managers.push_back(new IntervalTreeCollisionManager());
-  
-  Vec3f lower_limit, upper_limit;
-  SpatialHashingCollisionManager<>::computeBound(env, lower_limit, upper_limit);
-  FCL_REAL cell_size = std::min(std::min((upper_limit[0] - lower_limit[0]) / 20, (upper_limit[1] - lower_limit[1]) / 20), (upper_limit[2] - lower_limit[2])/20);
-  // managers.push_back(new SpatialHashingCollisionManager<>(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash> >(cell_size, lower_limit, upper_limit));
-#if USE_GOOGLEHASH
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleSparseHashTable> >(cell_size, lower_limit, upper_limit));
-  managers.push_back(new SpatialHashingCollisionManager<SparseHashTable<AABB, CollisionObject*, SpatialHash, GoogleDenseHashTable> >(cell_size, lower_limit, upper_limit));
-#endif
-  managers.push_back(new DynamicAABBTreeCollisionManager());
-  managers.push_back(new DynamicAABBTreeCollisionManager_Array());
-
-  {
-    DynamicAABBTreeCollisionManager* m = new DynamicAABBTreeCollisionManager();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
-
-  {
-    DynamicAABBTreeCollisionManager_Array* m = new DynamicAABBTreeCollisionManager_Array();
-    m->tree_init_level = 2;
-    managers.push_back(m);
-  }
+  generateManagers(managers);
 
   ts.resize(managers.size());
   timers.resize(managers.size());
@@ -1021,13 +914,9 @@ void broad_phase_update_collision_test(double env_scale, std::size_t env_size, s
     FCL_REAL rand_angle_z = 2 * (rand() / (FCL_REAL)RAND_MAX - 0.5) * delta_angle_max;
     FCL_REAL rand_trans_z = 2 * (rand() / (FCL_REAL)RAND_MAX - 0.5) * delta_trans_max;
 
-    Quaternion3f q1, q2, q3;
-    q1.fromAxisAngle(Vec3f(1, 0, 0), rand_angle_x);
-    q2.fromAxisAngle(Vec3f(0, 1, 0), rand_angle_y);
-    q3.fromAxisAngle(Vec3f(0, 0, 1), rand_angle_z);
-    Quaternion3f q = q1 * q2 * q3;
-    Matrix3f dR;
-    q.toRotation(dR);
+    Matrix3f dR ((AngleAxis(rand_angle_x, UnitX)
+                * AngleAxis(rand_angle_y, UnitY)
+                * AngleAxis(rand_angle_z, UnitZ)).toRotationMatrix());
     Vec3f dT(rand_trans_x, rand_trans_y, rand_trans_z);
     
     Matrix3f R = env[i]->getRotation();
@@ -1178,3 +1067,72 @@ void broad_phase_update_collision_test(double env_scale, std::size_t env_size, s
 
 
 
+
+void broad_phase_sap_pairs_test(double env_scale, std::size_t env_size, std::size_t n_steps)
+{
+  typedef SaPCollisionManager::ObjectPair ObjectPair;
+  typedef SaPCollisionManager::ObjectPairSet ObjectPairSet;
+
+  std::vector<CollisionObject*> env;
+  generateEnvironments(env, env_scale, env_size);
+
+  SaPCollisionManager manager;
+  manager.registerObjects(env);
+
+  FCL_REAL delta_trans_max = 0.05 * env_scale;
+  for(std::size_t step = 0; step < n_steps; ++step)
+  {
+    ObjectPairSet pairs (manager.getOverlappingPairs());
+
+    // move one object out of two
+    std::vector<CollisionObject*> moved;
+    for(std::size_t i = step % 2; i < env.size(); i += 2)
+    {
+      Vec3f dT(2 * (rand() / (FCL_REAL)RAND_MAX - 0.5) * delta_trans_max,
+               2 * (rand() / (FCL_REAL)RAND_MAX - 0.5) * delta_trans_max,
+               2 * (rand() / (FCL_REAL)RAND_MAX - 0.5) * delta_trans_max);
+      env[i]->setTranslation(env[i]->getTranslation() + dT);
+      env[i]->computeAABB();
+      moved.push_back(env[i]);
+    }
+
+    std::vector<ObjectPair> created, destroyed;
+    manager.update(moved, created, destroyed);
+
+    for(std::size_t i = 0; i < created.size(); ++i)
+      BOOST_CHECK(pairs.insert(created[i]).second);
+    for(std::size_t i = 0; i < destroyed.size(); ++i)
+      BOOST_CHECK(pairs.erase(destroyed[i]) == 1);
+
+    ObjectPairSet expected;
+    for(std::size_t i = 0; i < env.size(); ++i)
+    {
+      for(std::size_t j = i + 1; j < env.size(); ++j)
+      {
+        if(env[i]->getAABB().overlap(env[j]->getAABB()))
+          expected.insert(env[i] < env[j] ? ObjectPair(env[i], env[j]) : ObjectPair(env[j], env[i]));
+      }
+    }
+
+    BOOST_CHECK(pairs == expected);
+    BOOST_CHECK(manager.getOverlappingPairs() == expected);
+  }
+
+  // removing objects also removes their pairs
+  for(std::size_t i = 0; i < env.size(); i += 3)
+    manager.unregisterObject(env[i]);
+  ObjectPairSet expected;
+  for(std::size_t i = 0; i < env.size(); ++i)
+  {
+    for(std::size_t j = i + 1; j < env.size(); ++j)
+    {
+      if(i % 3 != 0 && j % 3 != 0 && env[i]->getAABB().overlap(env[j]->getAABB()))
+        expected.insert(env[i] < env[j] ? ObjectPair(env[i], env[j]) : ObjectPair(env[j], env[i]));
+    }
+  }
+  BOOST_CHECK(manager.getOverlappingPairs() == expected);
+  BOOST_CHECK(manager.size() == env.size() - (env.size() + 2) / 3);
+
+  for(std::size_t i = 0; i < env.size(); ++i)
+    delete env[i];
+}
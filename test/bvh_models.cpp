@@ -50,7 +50,9 @@
 #include "hpp/fcl/shape/geometric_shapes.h"
 #include <hpp/fcl/mesh_loader/assimp.h>
 #include <hpp/fcl/mesh_loader/loader.h>
+#include <hpp/fcl/thread_pool.h>
 #include "utility.h"
+#include <fstream>
 #include <iostream>
 
 using namespace hpp::fcl;
@@ -296,6 +298,71 @@ void testLoadPolyhedron ()
   BOOST_CHECK_EQUAL (geom, geom2);
 }
 
+template<class BoundingVolume>
+void testCachedMeshLoader ()
+{
+  namespace fs = boost::filesystem;
+  fs::path path(TEST_RESOURCES_DIR);
+  std::string env = (path / "env.obj").string(),
+              rob = (path / "rob.obj").string();
+
+  typedef BVHModel<BoundingVolume> Polyhedron_t;
+  const NODE_TYPE bvType = Polyhedron_t().getNodeType();
+  Vec3f scale (1, 1, 1);
+
+  // Concurrent loads of the same file return the same model.
+  ThreadPool pool (4);
+  std::vector<std::string> filenames (8, env);
+  filenames[3] = filenames[6] = rob;
+  std::vector<Vec3f> scales (filenames.size(), scale);
+
+  CachedMeshLoader loader (bvType);
+  std::vector<BVHModelPtr_t> models = loader.loadMany (filenames, scales, pool);
+  BOOST_REQUIRE_EQUAL (models.size(), filenames.size());
+  for (std::size_t i = 0; i < models.size(); ++i) {
+    BOOST_REQUIRE (models[i]);
+    BOOST_CHECK_EQUAL (models[i], models[filenames[i] == env ? 0 : 3]);
+  }
+  BOOST_CHECK (models[0] != models[3]);
+  BOOST_CHECK_EQUAL (loader.cache().size(), 2);
+
+  scales.pop_back();
+  BOOST_CHECK_THROW (loader.loadMany (filenames, scales, pool),
+      std::invalid_argument);
+
+  // The models saved on disk by a loader are loaded by another one.
+  fs::path directory (fs::temp_directory_path () / fs::unique_path ());
+  fs::create_directory (directory);
+
+  CachedMeshLoader writer (bvType);
+  writer.setCacheDirectory (directory.string());
+  boost::shared_ptr<Polyhedron_t> P1 = boost::dynamic_pointer_cast<Polyhedron_t>
+    (writer.load (env, scale));
+  BOOST_REQUIRE (P1);
+  BOOST_CHECK (P1->ownStorage());
+  BOOST_CHECK_EQUAL (std::distance (fs::directory_iterator (directory),
+        fs::directory_iterator ()), 1);
+
+  CachedMeshLoader reader (bvType);
+  reader.setCacheDirectory (directory.string());
+  boost::shared_ptr<Polyhedron_t> P2 = boost::dynamic_pointer_cast<Polyhedron_t>
+    (reader.load (env, scale));
+  BOOST_REQUIRE (P2);
+  BOOST_CHECK (!P2->ownStorage());
+  BOOST_CHECK_EQUAL (P1->num_tris    , P2->num_tris);
+  BOOST_CHECK_EQUAL (P1->num_vertices, P2->num_vertices);
+  BOOST_CHECK_EQUAL (P1->getNumBVs() , P2->getNumBVs());
+  for (int i = 0; i < P1->num_vertices; ++i)
+    BOOST_CHECK (P1->vertices[i] == P2->vertices[i]);
+
+  // Another scale is another model.
+  reader.load (env, Vec3f (2, 2, 2));
+  BOOST_CHECK_EQUAL (std::distance (fs::directory_iterator (directory),
+        fs::directory_iterator ()), 2);
+
+  fs::remove_all (directory);
+}
+
 template<class BoundingVolume>
 void testLoadGerardBauzil ()
 {
@@ -333,6 +400,39 @@ BOOST_AUTO_TEST_CASE(load_polyhedron)
   testLoadPolyhedron<KDOP<24> >();
 }
 
+BOOST_AUTO_TEST_CASE(cached_mesh_loader)
+{
+  testCachedMeshLoader<AABB>();
+  testCachedMeshLoader<OBBRSS>();
+  testCachedMeshLoader<KDOP<16> >();
+}
+
+BOOST_AUTO_TEST_CASE(cache_file_name)
+{
+  // The name of a model on disk only depends on the content of the file, the
+  // scale and the bounding volume type, so that it is the same on every
+  // platform.
+  namespace fs = boost::filesystem;
+  fs::path directory (fs::temp_directory_path () / fs::unique_path ());
+  fs::create_directories (directory / "cache");
+  std::string triangle = (directory / "triangle.obj").string();
+  {
+    std::ofstream file (triangle.c_str(), std::ios::binary);
+    file << "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+  }
+
+  CachedMeshLoader loader (BV_OBBRSS);
+  loader.setCacheDirectory ((directory / "cache").string());
+  BOOST_REQUIRE (loader.load (triangle, Vec3f (1, 1, 1)));
+  fs::directory_iterator file (directory / "cache");
+  BOOST_REQUIRE (file != fs::directory_iterator ());
+  BOOST_CHECK_EQUAL (file->path().filename().string(),
+      "v1-2d7988300571cae1-20-3ff0000000000000-3ff0000000000000-"
+      "3ff0000000000000-5.hppfcl");
+
+  fs::remove_all (directory);
+}
+
 BOOST_AUTO_TEST_CASE (gerard_bauzil)
 {
   testLoadGerardBauzil<OBB>();
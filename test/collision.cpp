@@ -48,8 +48,11 @@
 #include <boost/assign/list_of.hpp>
 
 #include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/BVH/BVH_wide.h>
 #include <hpp/fcl/BV/BV.h>
 #include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
 #include <hpp/fcl/narrowphase/narrowphase.h>
 #include <hpp/fcl/mesh_loader/assimp.h>
 
@@ -225,7 +228,7 @@ bool bs_hp = false;
 
 typedef std::vector<Contact> Contacts_t;
 typedef boost::mpl::vector<OBB, RSS, KDOP<24>, KDOP<18>, KDOP<16>, kIOS, OBBRSS> BVs_t;
-std::vector<SplitMethodType> splitMethods = boost::assign::list_of (SPLIT_METHOD_MEAN)(SPLIT_METHOD_MEDIAN)(SPLIT_METHOD_BV_CENTER);
+std::vector<SplitMethodType> splitMethods = boost::assign::list_of (SPLIT_METHOD_MEAN)(SPLIT_METHOD_MEDIAN)(SPLIT_METHOD_BV_CENTER)(SPLIT_METHOD_SAH);
 
 typedef boost::chrono::high_resolution_clock clock_type;
 typedef clock_type::duration duration_type;
@@ -261,13 +264,6 @@ template<typename BV, bool Oriented, bool recursive>
 struct traits : base_traits
 {};
 
-template<size_t N, bool recursive>
-struct traits<KDOP<N>, Oriented, recursive> : base_traits
-{
-  enum { IS_IMPLEMENTED = false
-  };
-};
-
 struct mesh_mesh_run_test
 {
   mesh_mesh_run_test (const std::vector<Transform3f>& _transforms,
@@ -641,3 +637,362 @@ BOOST_AUTO_TEST_CASE(mesh_mesh_benchmark)
   bench_stream = NULL;
   ofs.close();
 }
+
+BOOST_AUTO_TEST_CASE(batched_collide)
+{
+  std::vector<Vec3f> points;
+  std::vector<Triangle> triangles;
+  boost::filesystem::path path(TEST_RESOURCES_DIR);
+  loadOBJFile((path / "rob.obj").string().c_str(), points, triangles);
+
+  BVHModel<OBBRSS> rob;
+  rob.beginModel();
+  rob.addSubModel(points, triangles);
+  rob.endModel();
+  Box box (200, 200, 200);
+
+  // Move the box through the robot.
+  std::vector<Transform3f> tfs (200);
+  Quaternion3f q (Eigen::AngleAxisd (0.3, Vec3f (1, 2, 3).normalized()));
+  for (std::size_t i = 0; i < tfs.size(); ++i)
+    tfs[i] = Transform3f (q, Vec3f (0, 0, 1000 - 10 * (FCL_REAL)i));
+
+  CollisionRequest request (CONTACT, 10);
+  std::vector<CollisionResult> results;
+  std::size_t first = collide (&box, tfs, &rob, Transform3f(), request, results);
+  BOOST_CHECK_EQUAL (results.size(), tfs.size());
+  BOOST_CHECK (first < tfs.size());
+
+  std::vector<CollisionResult> results2;
+  std::size_t first2 = collide (&box, tfs, &rob, Transform3f(), request, results2, true);
+  BOOST_CHECK_EQUAL (first2, first);
+  BOOST_CHECK_EQUAL (results2.size(), first + 1);
+
+  for (std::size_t i = 0; i < tfs.size(); ++i) {
+    CollisionResult result;
+    collide (&box, tfs[i], &rob, Transform3f(), request, result);
+    BOOST_CHECK_EQUAL (result.isCollision(), results[i].isCollision());
+    BOOST_CHECK_EQUAL (result.numContacts(), results[i].numContacts());
+    if (i < first) BOOST_CHECK (!result.isCollision());
+    if (i == first) BOOST_CHECK (result.isCollision());
+    for (std::size_t j = 0; j < result.numContacts(); ++j) {
+      BOOST_CHECK (result.getContact(j).o1 == &box);
+      BOOST_CHECK (results[i].getContact(j).o1 == &box);
+      BOOST_CHECK_EQUAL (result.getContact(j).b2, results[i].getContact(j).b2);
+    }
+  }
+}
+
+template<typename BV>
+void checkCompactLayout(const std::vector<Transform3f>& tfs)
+{
+  std::vector<Vec3f> p1, p2;
+  std::vector<Triangle> t1, t2;
+  boost::filesystem::path path(TEST_RESOURCES_DIR);
+  loadOBJFile((path / "env.obj").string().c_str(), p1, t1);
+  loadOBJFile((path / "rob.obj").string().c_str(), p2, t2);
+
+  BVHModel<BV> env, rob;
+  env.beginModel(); env.addSubModel(p1, t1); env.endModel();
+  rob.beginModel(); rob.addSubModel(p2, t2); rob.endModel();
+  BVHModel<BV> env_compact (env), rob_compact (rob);
+  env_compact.buildCompactLayout();
+  rob_compact.buildCompactLayout();
+  BOOST_REQUIRE (env_compact.getCompactBVs() != NULL);
+  for (int i = 0; i < env.getNumBVs(); ++i)
+    BOOST_CHECK_EQUAL (env_compact.getCompactBVs()[i].first_child,
+                       env.getBV(i).first_child);
+
+  // The bounding volumes may be larger, which does not change the contacts
+  // but may change the order in which they are found.
+  CollisionRequest request (CONTACT, num_max_contacts);
+  request.enable_distance_lower_bound = true;
+  for (std::size_t i = 0; i < tfs.size(); ++i) {
+    CollisionResult result, result_compact;
+    collide (&env, Transform3f(), &rob, tfs[i], request, result);
+    collide (&env_compact, Transform3f(), &rob_compact, tfs[i], request,
+             result_compact);
+    std::vector<Contact> contacts, contacts_compact;
+    result.getContacts (contacts);
+    result_compact.getContacts (contacts_compact);
+    std::sort (contacts.begin(), contacts.end());
+    std::sort (contacts_compact.begin(), contacts_compact.end());
+    BOOST_REQUIRE_EQUAL (contacts_compact.size(), contacts.size());
+    for (std::size_t j = 0; j < contacts.size(); ++j) {
+      BOOST_CHECK_EQUAL (contacts_compact[j].b1, contacts[j].b1);
+      BOOST_CHECK_EQUAL (contacts_compact[j].b2, contacts[j].b2);
+    }
+    if (!result.isCollision()) {
+      DistanceResult dresult;
+      FCL_REAL d = distance (&env, Transform3f(), &rob, tfs[i],
+                             DistanceRequest(), dresult);
+      BOOST_CHECK (result_compact.distance_lower_bound <= d + 1e-6);
+    }
+  }
+
+  // The layout follows the refit of the hierarchy.
+  std::vector<Vec3f> moved (p2);
+  for (std::size_t i = 0; i < moved.size(); ++i)
+    moved[i] += Vec3f (10, 0, 0);
+  rob.beginReplaceModel(); rob.replaceSubModel(moved); rob.endReplaceModel();
+  rob_compact.beginReplaceModel(); rob_compact.replaceSubModel(moved);
+  rob_compact.endReplaceModel();
+  for (std::size_t i = 0; i < tfs.size(); ++i) {
+    CollisionResult result, result_compact;
+    collide (&env, Transform3f(), &rob, tfs[i], request, result);
+    collide (&env_compact, Transform3f(), &rob_compact, tfs[i], request,
+             result_compact);
+    BOOST_CHECK_EQUAL (result_compact.numContacts(), result.numContacts());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(float_bounding_volumes)
+{
+  for (int i = 0; i < 1000; ++i) {
+    Vec3f a (Vec3f::Random() * 1000), b (a + Vec3f::Random());
+    AABB aabb (a, b);
+    AABB faabb (FloatAABB (aabb).toAABB());
+    BOOST_CHECK (faabb.contain (aabb));
+
+    // A thin box far from the origin.
+    OBB obb;
+    obb.axes = Eigen::Quaterniond (Eigen::Vector4d::Random().normalized())
+      .toRotationMatrix();
+    obb.To = a;
+    obb.extent = Vec3f (1e-3, .1, 1).cwiseProduct (Vec3f::Random().cwiseAbs());
+    OBB fobb (FloatOBB (obb).toOBB());
+    for (int j = 0; j < 8; ++j) {
+      Vec3f u ((j & 1) ? 1 : -1, (j & 2) ? 1 : -1, (j & 4) ? 1 : -1);
+      Vec3f corner (obb.To + obb.axes * obb.extent.cwiseProduct (u));
+      // Express the corner in the frame of fobb as OBB::contain does.
+      Vec3f local (fobb.axes.transpose() * (corner - fobb.To));
+      BOOST_CHECK ((local.cwiseAbs() - fobb.extent).maxCoeff() <= 0);
+    }
+  }
+}
+
+// Distance between two OBB, b2 being in configuration (R0, T0) in the frame
+// of b1.
+FCL_REAL boxDistance (const Matrix3f& R0, const Vec3f& T0, const OBB& b1,
+                      const OBB& b2)
+{
+  Box box1 (2 * b1.extent), box2 (2 * b2.extent);
+  Transform3f tf1 (b1.axes, b1.To), tf2 (R0 * b2.axes, R0 * b2.To + T0);
+  DistanceResult result;
+  return distance (&box1, tf1, &box2, tf2, DistanceRequest(), result);
+}
+
+BOOST_AUTO_TEST_CASE(float_bounding_volume_tests)
+{
+  // Boxes far from the origin and a few units apart: the single precision
+  // tests only separate disjoint boxes, by less than their distance.
+  CollisionRequest request (DISTANCE_LOWER_BOUND, 1);
+  request.break_distance = 0;
+  int num_disjoint = 0, num_overlapping = 0;
+  for (int i = 0; i < 2000; ++i) {
+    OBB b1, b2;
+    b1.axes.setIdentity();
+    b2.axes.setIdentity();
+    b1.To = Vec3f::Random() * 1000;
+    b2.To = Vec3f::Random() * 1000;
+    b1.extent = Vec3f::Random().cwiseAbs();
+    b2.extent = Vec3f::Random().cwiseAbs();
+    Matrix3f R0 (Matrix3f::Identity());
+    bool aligned = i % 4 < 2, identity = i % 2 == 0;
+    if (!aligned) {
+      b1.axes = Eigen::Quaterniond (Eigen::Vector4d::Random().normalized())
+        .toRotationMatrix();
+      b2.axes = Eigen::Quaterniond (Eigen::Vector4d::Random().normalized())
+        .toRotationMatrix();
+    }
+    if (!identity)
+      R0 = Eigen::Quaterniond (Eigen::Vector4d::Random().normalized())
+        .toRotationMatrix();
+    // Put the center of b2 close to the one of b1.
+    Vec3f T0 (b1.To + Vec3f::Random() * 2 - R0 * b2.To);
+    if (identity) {
+      b2.To += T0;
+      T0.setZero();
+    }
+
+    FCL_REAL d = boxDistance (R0, T0, b1, b2), sqrDistLowerBound;
+    bool overlapping, overlapping_lb;
+    if (aligned) {
+      FloatAABB f1 (AABB (b1.To - b1.extent, b1.To + b1.extent)),
+                f2 (AABB (b2.To - b2.extent, b2.To + b2.extent));
+      overlapping = identity ? f1.overlap (f2) : overlap (R0, T0, f1, f2);
+      overlapping_lb = identity ?
+        f1.overlap (f2, request, sqrDistLowerBound) :
+        overlap (R0, T0, f1, f2, request, sqrDistLowerBound);
+    } else {
+      FloatOBB f1 (b1), f2 (b2);
+      overlapping = identity ? f1.overlap (f2) : overlap (R0, T0, f1, f2);
+      overlapping_lb = identity ?
+        f1.overlap (f2, request, sqrDistLowerBound) :
+        overlap (R0, T0, f1, f2, request, sqrDistLowerBound);
+    }
+
+    if (!overlapping) BOOST_CHECK (d > 0);
+    if (overlapping_lb) ++num_overlapping;
+    else {
+      ++num_disjoint;
+      BOOST_CHECK (std::sqrt (sqrDistLowerBound) <= d + 1e-6);
+    }
+  }
+  BOOST_CHECK (num_disjoint > 200);
+  BOOST_CHECK (num_overlapping > 200);
+}
+
+BOOST_AUTO_TEST_CASE(compact_layout)
+{
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-200, -200, -200, 200, 200, 200};
+  generateRandomTransforms(extents, transforms, 20);
+
+  checkCompactLayout<OBBRSS>(transforms);
+  checkCompactLayout<OBB>(transforms);
+  checkCompactLayout<RSS>(transforms);
+  checkCompactLayout<AABB>(transforms);
+  checkCompactLayout<kIOS>(transforms);
+}
+
+void checkSameContacts (const CollisionResult& result,
+                        const CollisionResult& result_ref)
+{
+  std::vector<Contact> contacts, contacts_ref;
+  result.getContacts (contacts);
+  result_ref.getContacts (contacts_ref);
+  std::sort (contacts.begin(), contacts.end());
+  std::sort (contacts_ref.begin(), contacts_ref.end());
+  BOOST_REQUIRE_EQUAL (contacts.size(), contacts_ref.size());
+  for (std::size_t j = 0; j < contacts.size(); ++j) {
+    BOOST_CHECK_EQUAL (contacts[j].b1, contacts_ref[j].b1);
+    BOOST_CHECK_EQUAL (contacts[j].b2, contacts_ref[j].b2);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(wide_bvh)
+{
+  std::vector<Vec3f> p1, p2;
+  std::vector<Triangle> t1, t2;
+  boost::filesystem::path path(TEST_RESOURCES_DIR);
+  loadOBJFile((path / "env.obj").string().c_str(), p1, t1);
+  loadOBJFile((path / "rob.obj").string().c_str(), p2, t2);
+
+  BVHModel<AABB> env, rob;
+  env.beginModel(); env.addSubModel(p1, t1); env.endModel();
+  rob.beginModel(); rob.addSubModel(p2, t2); rob.endModel();
+  WideBVH wide_env (env), wide_rob (rob);
+  // Each node has at least two children, but the root.
+  BOOST_CHECK (wide_env.getNumNodes() <= (std::size_t)env.getNumBVs() / 2);
+
+  std::vector<Transform3f> tfs;
+  FCL_REAL extents[] = {-200, -200, -200, 200, 200, 200};
+  generateRandomTransforms(extents, tfs, 20);
+
+  Box box (50, 20, 100);
+  Capsule capsule (10, 50);
+  Cylinder cylinder (30, 40);
+  const CollisionGeometry* shapes[] = { &box, &capsule, &cylinder };
+
+  CollisionRequest request (CONTACT, num_max_contacts);
+  std::size_t num_collisions = 0;
+  for (std::size_t i = 0; i < tfs.size(); ++i) {
+    CollisionResult result, result_ref;
+    collide (&env, tfs[i], &rob, tfs[(i + 1) % tfs.size()], request,
+             result_ref);
+    collide (wide_env, tfs[i], wide_rob, tfs[(i + 1) % tfs.size()], request,
+             result);
+    checkSameContacts (result, result_ref);
+    if (result_ref.isCollision()) ++num_collisions;
+
+    for (std::size_t j = 0; j < 3; ++j) {
+      CollisionResult sresult, sresult_ref;
+      collide (&env, Transform3f(), shapes[j], tfs[i], request, sresult_ref);
+      collide (wide_env, Transform3f(), shapes[j], tfs[i], request, sresult);
+      checkSameContacts (sresult, sresult_ref);
+      if (sresult_ref.isCollision()) ++num_collisions;
+    }
+  }
+  BOOST_CHECK (num_collisions > 0);
+
+  // Early stop.
+  request.num_max_contacts = 1;
+  for (std::size_t i = 0; i < tfs.size(); ++i) {
+    CollisionResult result, result_ref;
+    collide (&env, Transform3f(), &rob, tfs[i], request, result_ref);
+    collide (wide_env, Transform3f(), wide_rob, tfs[i], request, result);
+    BOOST_CHECK_EQUAL (result.numContacts(), result_ref.numContacts());
+  }
+
+  // The distance lower bounds, computed in single precision, are lower
+  // bounds of the distances.
+  BVHModel<OBBRSS> env_rss, rob_rss;
+  env_rss.beginModel(); env_rss.addSubModel(p1, t1); env_rss.endModel();
+  rob_rss.beginModel(); rob_rss.addSubModel(p2, t2); rob_rss.endModel();
+  request = CollisionRequest (DISTANCE_LOWER_BOUND, 1);
+  std::size_t num_disjoint = 0;
+  for (std::size_t i = 0; i < tfs.size(); ++i) {
+    const Transform3f& tf2 = tfs[(i + 1) % tfs.size()];
+    CollisionResult result;
+    DistanceResult dresult;
+    collide (wide_env, tfs[i], wide_rob, tf2, request, result);
+    if (!result.isCollision()) {
+      ++num_disjoint;
+      distance (&env_rss, tfs[i], &rob_rss, tf2, DistanceRequest(), dresult);
+      BOOST_CHECK (result.distance_lower_bound <= dresult.min_distance + 1e-6);
+    }
+
+    for (std::size_t j = 0; j < 3; ++j) {
+      CollisionResult sresult;
+      DistanceResult sdresult;
+      collide (wide_env, Transform3f(), shapes[j], tfs[i], request, sresult);
+      if (sresult.isCollision()) continue;
+      ++num_disjoint;
+      distance (&env_rss, Transform3f(), shapes[j], tfs[i], DistanceRequest(),
+                sdresult);
+      BOOST_CHECK (sresult.distance_lower_bound <=
+                   sdresult.min_distance + 1e-6);
+    }
+  }
+  BOOST_CHECK (num_disjoint > 0);
+}
+
+BOOST_AUTO_TEST_CASE(mesh_mesh_security_margin)
+{
+  // A vertex of the second triangle is closer to the first one than the
+  // rounding errors of the triangle kernel: the triangles are considered as
+  // intersecting but GJK computes a positive distance.
+  std::vector<Vec3f> p1, p2;
+  std::vector<Triangle> t (1, Triangle (0, 1, 2));
+  p1.push_back (Vec3f (0, 0, 0));
+  p1.push_back (Vec3f (1, 0, 0));
+  p1.push_back (Vec3f (0, 1, 0));
+  p2.push_back (Vec3f (.2, .2, 1e-15));
+  p2.push_back (Vec3f (.3, .2, 1));
+  p2.push_back (Vec3f (.2, .3, 1));
+  BVHModel<OBBRSS> tri1, tri2;
+  tri1.beginModel(); tri1.addSubModel (p1, t); tri1.endModel();
+  tri2.beginModel(); tri2.addSubModel (p2, t); tri2.endModel();
+
+  CollisionRequest request (CONTACT, 1);
+  request.security_margin = 0.01;
+  Transform3f tf1 (Vec3f (1, 2, 3)), tf2 (Vec3f (1, 2, 3));
+  CollisionResult result;
+  collide (&tri1, tf1, &tri2, tf2, request, result);
+  BOOST_REQUIRE_EQUAL (result.numContacts(), 1);
+  const Contact& contact (result.getContact (0));
+  BOOST_CHECK (contact.penetration_depth < 0);
+  BOOST_CHECK (contact.normal.isApprox (Vec3f (0, 0, 1)));
+  BOOST_CHECK (contact.pos.isApprox (Vec3f (1.2, 2.2, 3), 1e-12));
+
+  // When the contact points are not requested, the contacts are still
+  // fully initialized.
+  request.enable_contact = false;
+  result.clear();
+  collide (&tri1, tf1, &tri2, tf2, request, result);
+  BOOST_REQUIRE_EQUAL (result.numContacts(), 1);
+  BOOST_CHECK (result.getContact (0).normal.isZero());
+  BOOST_CHECK (result.getContact (0).pos.isZero());
+  BOOST_CHECK (result.getContact (0).penetration_depth <= 0);
+}
@@ -43,6 +43,9 @@
 #include <hpp/fcl/shape/convex.h>
 #include <hpp/fcl/collision.h>
 #include <hpp/fcl/distance.h>
+#include <hpp/fcl/narrowphase/gjk.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
 
 #include "utility.h"
 
@@ -238,3 +241,138 @@ BOOST_AUTO_TEST_CASE(compare_convex_box)
     compareShapeDistance    (box, convex_box, tf1, tf2);
   }
 }
+
+BOOST_AUTO_TEST_CASE(convex_support)
+{
+  using details::MinkowskiDiff;
+  boost::shared_ptr<ConvexBase> convex (makeConvexSphere (1, 40, 50));
+  BOOST_CHECK (!convex->support_starts.empty ());
+  Box box (.1, .1, .1);
+  MinkowskiDiff md;
+  md.set (convex.get (), &box);
+
+  srand (0);
+  Vec3f dir (Vec3f::Random ());
+  for (int i = 0; i < 1000; ++i) {
+    // Successive directions are close to each other, as in GJK.
+    if (i % 100 == 0) dir = Vec3f::Random ();
+    else              dir += .1 * Vec3f::Random ();
+
+    FCL_REAL maxdot = -std::numeric_limits<FCL_REAL>::max();
+    for (int k = 0; k < convex->num_points; ++k)
+      maxdot = std::max (maxdot, convex->points[k].dot (dir));
+
+    Vec3f s0 (details::getSupport (convex.get (), dir, false)), s1, w1;
+    md.support (dir, false, s1, w1);
+    BOOST_CHECK_CLOSE (s0.dot (dir), maxdot, 1e-8);
+    BOOST_CHECK_CLOSE (s1.dot (dir), maxdot, 1e-8);
+  }
+}
+
+/// Check that all the points are inside the convex and that the faces of
+/// the convex are triangles of its points, oriented outward.
+void checkHull (const Convex<Triangle>& hull, const std::vector<Vec3f>& points,
+    FCL_REAL eps)
+{
+  for (int i = 0; i < hull.num_polygons; ++i) {
+    const Triangle& t = hull.polygons[i];
+    const Vec3f& a (hull.points[t[0]]);
+    Vec3f n ((hull.points[t[1]] - a).cross (hull.points[t[2]] - a));
+    BOOST_REQUIRE (n.norm () > 0);
+    n.normalize ();
+    for (std::size_t k = 0; k < points.size (); ++k)
+      BOOST_CHECK (n.dot (points[k] - a) <= eps);
+  }
+  for (int i = 0; i < hull.num_points; ++i)
+    BOOST_CHECK (std::find (points.begin (), points.end (), hull.points[i])
+                 != points.end ());
+}
+
+BOOST_AUTO_TEST_CASE(convex_hull)
+{
+  // Corners, points on the faces, on the edges and inside of a box.
+  std::vector<Vec3f> points;
+  for (int i = -2; i <= 2; ++i)
+    for (int j = -2; j <= 2; ++j)
+      for (int k = -2; k <= 2; ++k)
+        points.push_back (Vec3f (i, j, k));
+  boost::shared_ptr<ConvexBase> box (ConvexBase::convexHull (
+        points.data (), (int)points.size ()));
+  const Convex<Triangle>& hull (static_cast<const Convex<Triangle>&> (*box));
+  BOOST_CHECK_EQUAL (hull.num_points, 8);
+  BOOST_CHECK_EQUAL (hull.num_polygons, 12);
+  checkHull (hull, points, 1e-12);
+  BOOST_CHECK_CLOSE (hull.computeVolume (), 64, 1e-8);
+  // 3 edges of the box and the diagonals of the faces.
+  for (int i = 0; i < hull.num_points; ++i)
+    BOOST_CHECK (hull.neighbors[i].count () >= 3
+                 && hull.neighbors[i].count () <= 6);
+
+  // All the points of a convex polytope are on its hull.
+  boost::shared_ptr<ConvexBase> sphere (makeConvexSphere (1, 10, 20));
+  points.assign (sphere->points, sphere->points + sphere->num_points);
+  boost::shared_ptr<ConvexBase> sphereHull (ConvexBase::convexHull (
+        points.data (), (int)points.size ()));
+  BOOST_CHECK_EQUAL (sphereHull->num_points, sphere->num_points);
+  checkHull (static_cast<const Convex<Triangle>&> (*sphereHull), points, 1e-6);
+
+  srand (0);
+  points.resize (1000);
+  for (std::size_t i = 0; i < points.size (); ++i)
+    points[i] = Vec3f::Random ();
+  boost::shared_ptr<ConvexBase> random (ConvexBase::convexHull (
+        points.data (), (int)points.size ()));
+  BOOST_CHECK (random->num_points < 200);
+  checkHull (static_cast<const Convex<Triangle>&> (*random), points, 1e-6);
+
+  // The points are in a plane.
+  points.resize (4);
+  for (std::size_t i = 0; i < points.size (); ++i)
+    points[i] = Vec3f (i, i % 2, 0);
+  BOOST_CHECK_THROW (ConvexBase::convexHull (points.data (),
+        (int)points.size ()), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(convex_hull_coplanar_points)
+{
+  // Points on the faces of a rotated box, moved by less than the tolerance.
+  // Hiding the faces almost in the plane of a new point folded new faces
+  // over them.
+  srand (2);
+  Quaternion3f q (Eigen::Vector4d::Random ().normalized ());
+  std::vector<Vec3f> points (3000);
+  for (std::size_t i = 0; i < points.size (); ++i) {
+    Vec3f p (Vec3f::Random ());
+    p[rand () % 3] = (rand () % 2) ? 1 : -1;
+    points[i] = q * p + 1e-6 * Vec3f::Random ();
+  }
+  boost::shared_ptr<ConvexBase> box (ConvexBase::convexHull (
+        points.data (), (int)points.size ()));
+  const Convex<Triangle>& hull (static_cast<const Convex<Triangle>&> (*box));
+  Vec3f center (Vec3f::Zero ());
+  for (int i = 0; i < hull.num_points; ++i) center += hull.points[i];
+  center /= hull.num_points;
+  for (int i = 0; i < hull.num_polygons; ++i) {
+    const Triangle& t = hull.polygons[i];
+    const Vec3f& a (hull.points[t[0]]);
+    Vec3f n ((hull.points[t[1]] - a).cross (hull.points[t[2]] - a));
+    BOOST_CHECK (n.dot (a - center) > 0);
+  }
+  for (int i = 0; i < 100; ++i) {
+    Vec3f dir (Vec3f::Random ().normalized ());
+    FCL_REAL hull_max = - std::numeric_limits<FCL_REAL>::max (),
+             points_max = hull_max;
+    for (int k = 0; k < hull.num_points; ++k)
+      hull_max = std::max (hull_max, hull.points[k].dot (dir));
+    for (std::size_t k = 0; k < points.size (); ++k)
+      points_max = std::max (points_max, points[k].dot (dir));
+    BOOST_CHECK (hull_max >= points_max - 1e-5);
+  }
+
+  BVHModel<OBBRSS> model;
+  generateBVHModel (model, Box (1, 2, 3), Transform3f ());
+  model.buildConvexRepresentation (false, true);
+  BOOST_REQUIRE (model.convex);
+  BOOST_CHECK_EQUAL (model.convex->num_points, 8);
+  BOOST_CHECK_CLOSE (model.convex->computeVolume (), 6, 1e-8);
+}
@@ -42,6 +42,8 @@
 #include <boost/timer.hpp>
 #include <boost/filesystem.hpp>
 
+#include <hpp/fcl/distance.h>
+
 #include "../src/traversal/traversal_node_bvhs.h"
 #include "../src/traversal/traversal_node_setup.h"
 #include "../src/collision_node.h"
@@ -124,6 +126,11 @@ BOOST_AUTO_TEST_CASE(mesh_distance)
     BOOST_CHECK(fabs(res.distance - res_now.distance) < DELTA);
     BOOST_CHECK(fabs(res.distance) < DELTA || (res.distance > 0 && nearlyEqual(res.p1, res_now.p1) && nearlyEqual(res.p2, res_now.p2)));
 
+    distance_Test_Oriented<RSS, MeshDistanceTraversalNodeRSS>(transforms[i], p1, t1, p2, t2, SPLIT_METHOD_SAH, 2, res_now, verbose);
+
+    BOOST_CHECK(fabs(res.distance - res_now.distance) < DELTA);
+    BOOST_CHECK(fabs(res.distance) < DELTA || (res.distance > 0 && nearlyEqual(res.p1, res_now.p1) && nearlyEqual(res.p2, res_now.p2)));
+
     distance_Test_Oriented<RSS, MeshDistanceTraversalNodeRSS>(transforms[i], p1, t1, p2, t2, SPLIT_METHOD_MEAN, 20, res_now, verbose);
 
     BOOST_CHECK(fabs(res.distance - res_now.distance) < DELTA);
@@ -184,6 +191,11 @@ BOOST_AUTO_TEST_CASE(mesh_distance)
     BOOST_CHECK(fabs(res.distance - res_now.distance) < DELTA);
     BOOST_CHECK(fabs(res.distance) < DELTA || (res.distance > 0 && nearlyEqual(res.p1, res_now.p1) && nearlyEqual(res.p2, res_now.p2)));
 
+    distance_Test_Oriented<OBBRSS, MeshDistanceTraversalNodeOBBRSS>(transforms[i], p1, t1, p2, t2, SPLIT_METHOD_SAH, 2, res_now, verbose);
+    
+    BOOST_CHECK(fabs(res.distance - res_now.distance) < DELTA);
+    BOOST_CHECK(fabs(res.distance) < DELTA || (res.distance > 0 && nearlyEqual(res.p1, res_now.p1) && nearlyEqual(res.p2, res_now.p2)));
+
     distance_Test_Oriented<OBBRSS, MeshDistanceTraversalNodeOBBRSS>(transforms[i], p1, t1, p2, t2, SPLIT_METHOD_MEAN, 20, res_now, verbose);
     
     BOOST_CHECK(fabs(res.distance - res_now.distance) < DELTA);
@@ -215,6 +227,11 @@ BOOST_AUTO_TEST_CASE(mesh_distance)
     BOOST_CHECK(fabs(res.distance - res_now.distance) < DELTA);
     BOOST_CHECK(fabs(res.distance) < DELTA || (res.distance > 0 && nearlyEqual(res.p1, res_now.p1) && nearlyEqual(res.p2, res_now.p2)));
 
+    distance_Test<OBB>(transforms[i], p1, t1, p2, t2, SPLIT_METHOD_SAH, 2, res_now, verbose);
+
+    BOOST_CHECK(fabs(res.distance - res_now.distance) < DELTA);
+    BOOST_CHECK(fabs(res.distance) < DELTA || (res.distance > 0 && nearlyEqual(res.p1, res_now.p1) && nearlyEqual(res.p2, res_now.p2)));
+
     distance_Test<OBB>(transforms[i], p1, t1, p2, t2, SPLIT_METHOD_MEAN, 20, res_now, verbose);
 
     BOOST_CHECK(fabs(res.distance - res_now.distance) < DELTA);
@@ -462,3 +479,48 @@ bool collide_Test_OBB(const Transform3f& tf,
 }
 
 
+
+BOOST_AUTO_TEST_CASE(batched_distance)
+{
+  std::vector<Vec3f> points;
+  std::vector<Triangle> triangles;
+  boost::filesystem::path path(TEST_RESOURCES_DIR);
+  loadOBJFile((path / "rob.obj").string().c_str(), points, triangles);
+
+  BVHModel<OBBRSS> rob;
+  rob.beginModel();
+  rob.addSubModel(points, triangles);
+  rob.endModel();
+  Capsule capsule (50, 200);
+
+  // Move the capsule toward the robot.
+  std::vector<Transform3f> tfs (100);
+  for (std::size_t i = 0; i < tfs.size(); ++i)
+    tfs[i] = Transform3f (Vec3f (0, 0, 1000 - 10 * (FCL_REAL)i));
+
+  DistanceRequest request (true);
+  std::vector<DistanceResult> results;
+  FCL_REAL dmin = distance (&capsule, tfs, &rob, Transform3f(), request, results);
+  BOOST_CHECK_EQUAL (results.size(), tfs.size());
+
+  // GJK is initialized differently, the distances are equal up to the GJK
+  // tolerance. The penetration depths computed by EPA may differ.
+  for (std::size_t i = 0; i < tfs.size(); ++i) {
+    DistanceResult result;
+    FCL_REAL d = distance (&capsule, tfs[i], &rob, Transform3f(), request, result);
+    BOOST_CHECK (results[i].o1 == &capsule);
+    BOOST_CHECK (results[i].o2 == &rob);
+    BOOST_CHECK (dmin <= results[i].min_distance);
+    if (d > 0) {
+      BOOST_CHECK_CLOSE (d, results[i].min_distance, 1e-4);
+      BOOST_CHECK_CLOSE ((results[i].nearest_points[0] - results[i].nearest_points[1]).norm(),
+                         d, 1e-4);
+    } else
+      BOOST_CHECK (results[i].min_distance <= 0);
+  }
+  BOOST_CHECK (dmin <= 0);
+
+  distance (&capsule, tfs, &rob, Transform3f(), request, results, true);
+  BOOST_CHECK (results.size() < tfs.size());
+  BOOST_CHECK (results.back().min_distance <= 0);
+}
@@ -40,11 +40,15 @@
 #define BOOST_TEST_DYN_LINK
 #include <boost/test/unit_test.hpp>
 #include <boost/utility/binary.hpp>
+#include <algorithm>
 
 #include "../src/traversal/traversal_node_bvhs.h"
 #include "../src/traversal/traversal_node_setup.h"
 #include <../src/collision_node.h>
 #include <../src/BVH/BV_splitter.h>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
 #include "utility.h"
 
 #include "fcl_resources/config.h"
@@ -52,6 +56,103 @@
 
 using namespace hpp::fcl;
 
+/// Pairs of primitives in contact, in a canonical order
+std::vector<std::pair<int, int> > contactPairs(const CollisionResult& result)
+{
+  std::vector<std::pair<int, int> > pairs;
+  for(std::size_t i = 0; i < result.numContacts(); ++i)
+    pairs.push_back(std::make_pair(result.getContact(i).b1,
+                                   result.getContact(i).b2));
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+/// The distance is unique when the objects do not collide. Otherwise, the
+/// penetration depth depends on the first pair of primitives found in
+/// collision.
+void checkDistance(const DistanceResult& result,
+                   const DistanceResult& result_front)
+{
+  if(result.min_distance > 0)
+    BOOST_CHECK_CLOSE(result.min_distance, result_front.min_distance, 1e-6);
+  else
+    BOOST_CHECK(result_front.min_distance <= 0);
+}
+
+// Queries through the public API with a BVHFront in the request must give
+// the same results as without, along sequences of small motions.
+BOOST_AUTO_TEST_CASE(front_list_request)
+{
+  std::vector<Vec3f> p1, p2;
+  std::vector<Triangle> t1, t2;
+  boost::filesystem::path path(TEST_RESOURCES_DIR);
+  loadOBJFile((path / "env.obj").string().c_str(), p1, t1);
+  loadOBJFile((path / "rob.obj").string().c_str(), p2, t2);
+
+  BVHModel<OBBRSS> m1, m2;
+  m1.beginModel(); m1.addSubModel(p1, t1); m1.endModel();
+  m2.beginModel(); m2.addSubModel(p2, t2); m2.endModel();
+  Box box(100, 200, 300);
+
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-3000, -3000, 0, 3000, 3000, 3000};
+  std::size_t n = 10;
+  generateRandomTransforms(extents, transforms, n);
+
+  BVHFront front, front_box;
+  const Vec3f step(2, -1, 1);
+  const Transform3f pose1;
+  for(std::size_t i = 0; i < transforms.size(); ++i)
+  {
+    Transform3f pose2 (transforms[i]);
+    for(int k = 0; k < 20; ++k)
+    {
+      pose2.setTranslation(pose2.getTranslation() + step);
+
+      CollisionRequest request (CONTACT, std::numeric_limits<int>::max());
+      CollisionResult result, result_front;
+      collide(&m1, pose1, &m2, pose2, request, result);
+      request.front = &front;
+      collide(&m1, pose1, &m2, pose2, request, result_front);
+      BOOST_CHECK(contactPairs(result) == contactPairs(result_front));
+
+      DistanceRequest drequest (true);
+      DistanceResult dresult, dresult_front;
+      distance(&m1, pose1, &m2, pose2, drequest, dresult);
+      drequest.front = &front;
+      distance(&m1, pose1, &m2, pose2, drequest, dresult_front);
+      checkDistance(dresult, dresult_front);
+
+      result.clear(); result_front.clear();
+      request.front = NULL;
+      collide(&m1, pose1, &box, pose2, request, result);
+      request.front = &front_box;
+      collide(&m1, pose1, &box, pose2, request, result_front);
+      BOOST_CHECK(contactPairs(result) == contactPairs(result_front));
+
+      DistanceResult dresult_box, dresult_box_front;
+      drequest.front = NULL;
+      distance(&m1, pose1, &box, pose2, drequest, dresult_box);
+      drequest.front = &front_box;
+      distance(&m1, pose1, &box, pose2, drequest, dresult_box_front);
+      checkDistance(dresult_box, dresult_box_front);
+    }
+    front.clear();
+    front_box.clear();
+  }
+
+  // The front is reset when the pair of objects changes.
+  CollisionRequest request (CONTACT, std::numeric_limits<int>::max());
+  CollisionResult result, result_front;
+  collide(&m1, pose1, &box, transforms[0], request, result);
+  request.front = &front;
+  collide(&m1, pose1, &m2, transforms[0], request, result_front);
+  result_front.clear();
+  collide(&m1, pose1, &box, transforms[0], request, result_front);
+  BOOST_CHECK(contactPairs(result) == contactPairs(result_front));
+}
+
+
 template<typename BV>
 bool collide_front_list_Test(const Transform3f& tf1, const Transform3f& tf2,
                              const std::vector<Vec3f>& vertices1, const std::vector<Triangle>& triangles1,
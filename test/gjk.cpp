@@ -43,6 +43,7 @@
 
 #include <hpp/fcl/narrowphase/narrowphase.h>
 #include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/thread_pool.h>
 #include "../src/math/tools.h"
 
 using hpp::fcl::GJKSolver;
@@ -288,3 +289,151 @@ BOOST_AUTO_TEST_CASE(distance_triangle_triangle_1)
   std::cerr << "-- No collisions -------------------------" << std::endl;
   std::cerr << "Total / average time gjk: " << totalTimeGjkNoColl << ", " << FCL_REAL(totalTimeGjkNoColl) / FCL_REAL(CLOCKS_PER_SEC*(N-nCol)) << "s" << std::endl;
 }
+
+BOOST_AUTO_TEST_CASE(epa_workspace_reuse)
+{
+  using hpp::fcl::Cylinder;
+  using hpp::fcl::Cone;
+
+  Cylinder cylinder (1, 2);
+  Cone cone (1, 2);
+  GJKSolver solver;
+  Transform3f tf1;
+  std::size_t nCol = 0;
+  srand (0);
+  for (std::size_t i = 0; i < 1000; ++i) {
+    Transform3f tf2 (Quaternion3f (vector4_t::Random ().normalized ()),
+                     Vec3f::Random ());
+    if (i == 500) solver.epa_max_face_num = 256;
+    GJKSolver copy (solver), fresh;
+    fresh.epa_max_face_num = solver.epa_max_face_num;
+
+    Vec3f c0, c1, c2, n0, n1, n2;
+    FCL_REAL d0, d1, d2;
+    bool col0 = solver.shapeIntersect (cylinder, tf1, cone, tf2, &c0, &d0, &n0);
+    bool col1 = copy.shapeIntersect (cylinder, tf1, cone, tf2, &c1, &d1, &n1);
+    bool col2 = fresh.shapeIntersect (cylinder, tf1, cone, tf2, &c2, &d2, &n2);
+    BOOST_CHECK_EQUAL (col0, col2);
+    BOOST_CHECK_EQUAL (col1, col2);
+    if (!col2) continue;
+    ++nCol;
+    BOOST_CHECK_EQUAL (d0, d2);
+    BOOST_CHECK_EQUAL (d1, d2);
+    BOOST_CHECK (c0 == c2 && n0 == n2);
+    BOOST_CHECK (c1 == c2 && n1 == n2);
+  }
+  BOOST_CHECK (nCol > 0);
+}
+
+BOOST_AUTO_TEST_CASE(gjk_warm_start)
+{
+  using hpp::fcl::Cylinder;
+  using hpp::fcl::Cone;
+  using hpp::fcl::details::GJK;
+  using hpp::fcl::details::MinkowskiDiff;
+
+  Cylinder cylinder (1, 2);
+  Cone cone (1, 2);
+  Transform3f tf1;
+  const Vec3f step (.01, -.005, .005);
+  unsigned int cold = 0, warm = 0;
+  srand (0);
+  for (std::size_t i = 0; i < 100; ++i) {
+    Transform3f tf2 (Quaternion3f (vector4_t::Random ().normalized ()),
+                     2 * Vec3f::Random ());
+    GJK::WarmStart warm_start;
+    for (std::size_t k = 0; k < 20; ++k) {
+      tf2.setTranslation (tf2.getTranslation () + step);
+      MinkowskiDiff shape;
+      shape.set (&cylinder, &cone, tf1, tf2);
+      GJK gjk0 (128, 1e-6), gjk1 (128, 1e-6);
+      GJK::Status s0 = gjk0.evaluate (shape, Vec3f (-1, 0, 0));
+      GJK::Status s1 = gjk1.evaluate (shape, Vec3f (-1, 0, 0), &warm_start);
+      gjk1.getWarmStart (warm_start);
+      BOOST_CHECK (s0 != GJK::Failed && s1 != GJK::Failed);
+      BOOST_CHECK_SMALL (gjk0.distance - gjk1.distance, 1e-4);
+      if (k == 0) continue;
+      cold += gjk0.getIterations ();
+      warm += gjk1.getIterations ();
+    }
+  }
+  BOOST_CHECK (warm < cold);
+  std::cerr << "GJK iterations without / with warm start: " << cold << " / "
+    << warm << std::endl;
+}
+
+BOOST_AUTO_TEST_CASE(gjk_solver_warm_start)
+{
+  using hpp::fcl::Cylinder;
+  using hpp::fcl::Cone;
+  using hpp::fcl::details::GJK;
+
+  Cylinder cylinder (1, 2);
+  Cone cone (1, 2);
+  Transform3f tf1, tf2 (Vec3f (3, .5, 0));
+  GJKSolver solver;
+  GJK::WarmStart warm_start;
+  for (std::size_t k = 0; k < 10; ++k) {
+    tf2.setTranslation (tf2.getTranslation () - Vec3f (.1, 0, 0));
+    FCL_REAL d0, d1;
+    Vec3f p0, p1, q0, q1, n0, n1;
+    solver.shapeDistance (cylinder, tf1, cone, tf2, d0, p0, q0, n0);
+    solver.shapeDistance (cylinder, tf1, cone, tf2, d1, p1, q1, n1,
+                          &warm_start);
+    BOOST_CHECK (warm_start.rank > 0);
+    BOOST_CHECK_SMALL (d0 - d1, 1e-4);
+  }
+}
+
+/// Penetration between a cylinder and a cone in several configurations
+struct PenetrationTask : hpp::fcl::ThreadPool::Task
+{
+  PenetrationTask (const GJKSolver& solver_,
+                   const std::vector<Transform3f>& tfs_) :
+    solver (solver_), tfs (tfs_), col (tfs_.size()), depth (tfs_.size()),
+    contact (tfs_.size()), normal (tfs_.size()), cylinder (1, 2), cone (1, 2)
+  {}
+
+  void run (std::size_t begin, std::size_t end, std::size_t)
+  {
+    for (std::size_t i = begin; i < end; ++i)
+      col[i] = solver.shapeIntersect (cylinder, Transform3f(), cone, tfs[i],
+                                      &contact[i], &depth[i], &normal[i]);
+  }
+
+  const GJKSolver& solver;
+  const std::vector<Transform3f>& tfs;
+  std::vector<char> col;
+  std::vector<FCL_REAL> depth;
+  std::vector<Vec3f> contact, normal;
+  hpp::fcl::Cylinder cylinder;
+  hpp::fcl::Cone cone;
+};
+
+BOOST_AUTO_TEST_CASE(epa_workspace_threads)
+{
+  // The threads share a const solver, each of them runs EPA in its own
+  // workspace.
+  const GJKSolver solver;
+  std::vector<Transform3f> tfs;
+  srand (0);
+  for (std::size_t i = 0; i < 2000; ++i)
+    tfs.push_back (Transform3f (Quaternion3f (vector4_t::Random ().normalized ()),
+                                Vec3f::Random ()));
+
+  PenetrationTask serial (solver, tfs), parallel (solver, tfs);
+  serial.run (0, tfs.size(), 0);
+  hpp::fcl::ThreadPool pool (4);
+  pool.parallelFor (tfs.size(), parallel, 7);
+
+  std::size_t nCol = 0;
+  for (std::size_t i = 0; i < tfs.size(); ++i) {
+    BOOST_CHECK_EQUAL (serial.col[i], parallel.col[i]);
+    if (!serial.col[i]) continue;
+    ++nCol;
+    BOOST_CHECK_EQUAL (serial.depth[i], parallel.depth[i]);
+    BOOST_CHECK (serial.contact[i] == parallel.contact[i]);
+    BOOST_CHECK (serial.normal[i] == parallel.normal[i]);
+  }
+  BOOST_CHECK (nCol > 0);
+}
@@ -0,0 +1,265 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_MODULE FCL_HFIELD
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <stdexcept>
+
+#include <hpp/fcl/hfield.h>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
+
+#include "utility.h"
+
+using namespace hpp::fcl;
+
+namespace
+{
+  HeightField terrain(int nx, int ny)
+  {
+    std::vector<FCL_REAL> heights ((std::size_t) nx * ny);
+    for(int j = 0; j < ny; ++j)
+    {
+      for(int i = 0; i < nx; ++i)
+      {
+        const FCL_REAL x = -1 + 2. * i / (nx - 1), y = -1 + 2. * j / (ny - 1);
+        heights[(std::size_t) (i + nx * j)] = .1 * std::sin(3 * x) * std::cos(4 * y);
+      }
+    }
+    return HeightField(2, 2, nx, ny, heights);
+  }
+
+  /// @brief the same triangles in a mesh
+  template<typename BV>
+  void triangulate(const HeightField& hfield, BVHModel<BV>& model)
+  {
+    model.beginModel();
+    for(int id = 0; id < hfield.getNumTriangles(); ++id)
+    {
+      Vec3f P1, P2, P3;
+      hfield.getTriangle(id, P1, P2, P3);
+      model.addTriangle(P1, P2, P3);
+    }
+    model.endModel();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(hfield_hierarchy)
+{
+  BOOST_CHECK_THROW(HeightField(1, 1, 1, 2, std::vector<FCL_REAL>(2)),
+                    std::invalid_argument);
+  BOOST_CHECK_THROW(HeightField(1, 1, 2, 2, std::vector<FCL_REAL>(3)),
+                    std::invalid_argument);
+
+  // Odd numbers of cells, so that some nodes have less than 4 children.
+  const HeightField hfield (terrain(20, 13));
+  BOOST_CHECK_EQUAL(hfield.getNodeType(), GEOM_HFIELD);
+  BOOST_CHECK_EQUAL(hfield.getNumTriangles(), 2 * 19 * 12);
+  BOOST_CHECK_EQUAL(hfield.getLevelSize(0, 0), 19);
+  BOOST_CHECK_EQUAL(hfield.getLevelSize(0, 1), 12);
+  const int top = hfield.getNumLevels() - 1;
+  BOOST_CHECK_EQUAL(top, 5);
+  BOOST_CHECK_EQUAL(hfield.getLevelSize(top, 0), 1);
+  BOOST_CHECK_EQUAL(hfield.getLevelSize(top, 1), 1);
+  BOOST_CHECK(hfield.getPoint(19, 12).isApprox(Vec3f(1, 1, hfield.getHeight(19, 12))));
+
+  // Each triangle is in the box of its cell, and each node in the box of
+  // its parent, which are tight.
+  for(int id = 0; id < hfield.getNumTriangles(); ++id)
+  {
+    const int cell = id / 2;
+    AABB bv, tri;
+    hfield.getNodeBV(0, cell % 19, cell / 19, bv);
+    Vec3f P1, P2, P3;
+    hfield.getTriangle(id, P1, P2, P3);
+    tri += P1; tri += P2; tri += P3;
+    BOOST_CHECK(bv.contain(tri));
+    BOOST_CHECK((P2 - P1).cross(P3 - P1)[2] > 0);
+  }
+  for(int level = 1; level <= top; ++level)
+  {
+    for(int j = 0; j < hfield.getLevelSize(level, 1); ++j)
+    {
+      for(int i = 0; i < hfield.getLevelSize(level, 0); ++i)
+      {
+        AABB parent, children;
+        hfield.getNodeBV(level, i, j, parent);
+        for(int b = 2 * j; b < std::min(2 * j + 2, hfield.getLevelSize(level - 1, 1)); ++b)
+        {
+          for(int a = 2 * i; a < std::min(2 * i + 2, hfield.getLevelSize(level - 1, 0)); ++a)
+          {
+            AABB child;
+            hfield.getNodeBV(level - 1, a, b, child);
+            children += child;
+          }
+        }
+        BOOST_CHECK(parent.min_.isApprox(children.min_));
+        BOOST_CHECK(parent.max_.isApprox(children.max_));
+      }
+    }
+  }
+  BOOST_CHECK(hfield.aabb_local.max_.isApprox(Vec3f(1, 1, .1), .05));
+}
+
+BOOST_AUTO_TEST_CASE(hfield_shape_queries)
+{
+  const HeightField hfield (terrain(41, 41));
+  BVHModel<OBBRSS> mesh;
+  triangulate(hfield, mesh);
+
+  std::vector<ShapeBase*> shapes;
+  shapes.push_back(new Sphere(.1));
+  shapes.push_back(new Capsule(.05, .2));
+  shapes.push_back(new Box(.2, .1, .3));
+  shapes.push_back(new Cylinder(.1, .2));
+  shapes.push_back(new Cone(.1, .2));
+  shapes.push_back(new Halfspace(Vec3f(0, 0, 1), 0));
+  shapes.push_back(new Plane(Vec3f(0, 0, 1), 0));
+
+  FCL_REAL extents[] = { -1, -1, -.3, 1, 1, .3 };
+  std::vector<Transform3f> transforms;
+  generateRandomTransforms(extents, transforms, 100);
+  int n_collisions = 0;
+  for(std::size_t s = 0; s < shapes.size(); ++s)
+  {
+    for(std::size_t i = 0; i < transforms.size(); ++i)
+    {
+      const Transform3f& tf = transforms[i];
+      CollisionRequest collision_request (CONTACT, 10);
+      CollisionResult expected_collision, collision, swapped_collision;
+      collide(&mesh, Transform3f(), shapes[s], tf, collision_request, expected_collision);
+      collide(&hfield, Transform3f(), shapes[s], tf, collision_request, collision);
+      collide(shapes[s], tf, &hfield, Transform3f(), collision_request, swapped_collision);
+      BOOST_CHECK_EQUAL(collision.isCollision(), expected_collision.isCollision());
+      BOOST_CHECK_EQUAL(collision.numContacts(), swapped_collision.numContacts());
+      if(collision.isCollision())
+      {
+        ++n_collisions;
+        BOOST_CHECK(collision.getContact(0).o1 == &hfield);
+        BOOST_CHECK(swapped_collision.getContact(0).o2 == &hfield);
+        BOOST_CHECK(collision.getContact(0).penetration_depth >= 0);
+      }
+
+      DistanceRequest request (true);
+      DistanceResult expected, result, swapped;
+      distance(&mesh, Transform3f(), shapes[s], tf, request, expected);
+      distance(&hfield, Transform3f(), shapes[s], tf, request, result);
+      distance(shapes[s], tf, &hfield, Transform3f(), request, swapped);
+      BOOST_CHECK(result.o1 == &hfield);
+      BOOST_CHECK(swapped.o2 == &hfield);
+      BOOST_CHECK_CLOSE(swapped.min_distance, result.min_distance, 1e-6);
+      if(std::fabs(result.min_distance) > 1e-3)
+        BOOST_CHECK_EQUAL(result.min_distance < 0, collision.isCollision());
+      // The distance between a mesh and a plane misses the triangles
+      // crossing the plane: the plane is only checked for collision.
+      if(expected.min_distance > 1e-3 &&
+         shapes[s]->getNodeType() != GEOM_PLANE)
+      {
+        BOOST_CHECK_SMALL(result.min_distance - expected.min_distance, 1e-6);
+        BOOST_CHECK(result.b1 >= 0 && result.b1 < hfield.getNumTriangles());
+        BOOST_CHECK(swapped.normal.isApprox(-result.normal));
+      }
+    }
+  }
+  BOOST_CHECK(n_collisions > 0);
+
+  for(std::size_t s = 0; s < shapes.size(); ++s) delete shapes[s];
+}
+
+template<typename BV>
+void testMeshQueries()
+{
+  const HeightField hfield (terrain(41, 41));
+  BVHModel<OBBRSS> mesh;
+  triangulate(hfield, mesh);
+
+  // The mesh queries only support meshes with the same bounding volumes:
+  // the reference is computed with OBBRSS.
+  const Sphere sphere (.15);
+  BVHModel<BV> sphere_mesh;
+  BVHModel<OBBRSS> reference;
+  generateBVHModel(sphere_mesh, sphere, Transform3f(), 16, 16);
+  generateBVHModel(reference, sphere, Transform3f(), 16, 16);
+
+  FCL_REAL extents[] = { -1, -1, -.3, 1, 1, .3 };
+  std::vector<Transform3f> transforms;
+  generateRandomTransforms(extents, transforms, 100);
+  int n_collisions = 0;
+  for(std::size_t i = 0; i < transforms.size(); ++i)
+  {
+    const Transform3f& tf = transforms[i];
+    DistanceResult expected, result, swapped;
+    distance(&mesh, Transform3f(), &reference, tf, DistanceRequest(true), expected);
+    distance(&hfield, Transform3f(), &sphere_mesh, tf, DistanceRequest(true), result);
+    distance(&sphere_mesh, tf, &hfield, Transform3f(), DistanceRequest(true), swapped);
+    BOOST_CHECK_SMALL(result.min_distance - expected.min_distance, 1e-6);
+    BOOST_CHECK_SMALL(swapped.min_distance - result.min_distance, 1e-6);
+    if(expected.min_distance > 0)
+    {
+      BOOST_CHECK(result.b2 >= 0 && result.b2 < sphere_mesh.num_tris);
+      BOOST_CHECK_SMALL((result.nearest_points[1] - result.nearest_points[0]).norm()
+                        - result.min_distance, 1e-6);
+    }
+
+    CollisionRequest request (CONTACT, 10);
+    CollisionResult expected_collision, collision, swapped_collision;
+    collide(&mesh, Transform3f(), &reference, tf, request, expected_collision);
+    collide(&hfield, Transform3f(), &sphere_mesh, tf, request, collision);
+    collide(&sphere_mesh, tf, &hfield, Transform3f(), request, swapped_collision);
+    BOOST_CHECK_EQUAL(collision.isCollision(), expected_collision.isCollision());
+    BOOST_CHECK_EQUAL(collision.numContacts(), swapped_collision.numContacts());
+    if(collision.isCollision())
+    {
+      ++n_collisions;
+      BOOST_CHECK(collision.numContacts() <= 10);
+      BOOST_CHECK(collision.getContact(0).o1 == &hfield);
+      BOOST_CHECK(swapped_collision.getContact(0).o2 == &hfield);
+      BOOST_CHECK(collision.getContact(0).penetration_depth >= 0);
+    }
+  }
+  BOOST_CHECK(n_collisions > 0);
+}
+
+BOOST_AUTO_TEST_CASE(hfield_mesh_queries)
+{
+  testMeshQueries<OBBRSS>();
+  testMeshQueries<AABB>();
+  testMeshQueries<RSS>();
+  testMeshQueries<KDOP<18> >();
+}
@@ -163,3 +163,167 @@ BOOST_AUTO_TEST_CASE (OCTREE)
     }
   }
 }
+
+void checkCompiledNodes (const OcTree& octree, const OcTree::OcTreeNode* node,
+                         const OcTree::CompiledNode* compiled,
+                         const hpp::fcl::AABB& bv)
+{
+  BOOST_CHECK (octree.getNodeBV (compiled).min_.isApprox (bv.min_));
+  BOOST_CHECK (octree.getNodeBV (compiled).max_.isApprox (bv.max_));
+  BOOST_CHECK_EQUAL (octree.isNodeOccupied (node),
+                     octree.isNodeOccupied (compiled));
+  BOOST_CHECK_EQUAL (octree.isNodeFree (node), octree.isNodeFree (compiled));
+  BOOST_REQUIRE_EQUAL (octree.nodeHasChildren (node),
+                       octree.nodeHasChildren (compiled));
+  if (!octree.nodeHasChildren (node)) return;
+  for (unsigned int i = 0; i < 8; ++i) {
+    BOOST_REQUIRE_EQUAL (octree.nodeChildExists (node, i),
+                         octree.nodeChildExists (compiled, i));
+    if (!octree.nodeChildExists (node, i)) continue;
+    hpp::fcl::AABB child_bv;
+    hpp::fcl::computeChildBV (bv, i, child_bv);
+    checkCompiledNodes (octree, octree.getNodeChild (node, i),
+                        octree.getNodeChild (compiled, i), child_bv);
+  }
+}
+
+BOOST_AUTO_TEST_CASE (compiled_octree)
+{
+  FCL_REAL resolution (10.);
+  std::vector<Vec3f> pRob;
+  std::vector<Triangle> tRob;
+  boost::filesystem::path path(TEST_RESOURCES_DIR);
+  loadOBJFile((path / "rob.obj").string().c_str(), pRob, tRob);
+  BVHModel <OBBRSS> robMesh;
+  makeMesh (pRob, tRob, robMesh);
+
+  // Occupied and free cells around random points
+  octomap::OcTreePtr_t tree (new octomap::OcTree (resolution));
+  std::vector<Transform3f> points;
+  FCL_REAL point_extents[] = {-1000, -1000, 0, 1000, 1000, 1000};
+  generateRandomTransforms(point_extents, points, 200);
+  for (std::size_t i=0; i<points.size(); ++i) {
+    const Vec3f& p (points [i].getTranslation ());
+    for (int dx = 0; dx < 4; ++dx)
+      for (int dy = 0; dy < 4; ++dy)
+        for (int dz = 0; dz < 4; ++dz)
+          tree->updateNode (octomap::point3d
+                            ((float) (p [0] + dx * resolution),
+                             (float) (p [1] + dy * resolution),
+                             (float) (p [2] + dz * resolution)), i % 4 != 0);
+  }
+  tree->updateInnerOccupancy ();
+
+  OcTree octree (tree);
+  OcTree compiled (octree);
+  BOOST_CHECK (!compiled.isCompiled ());
+  BOOST_CHECK (compiled.getCompiledRoot () == NULL);
+  BOOST_CHECK_EQUAL (compiled.getCompiledSize (), std::size_t (0));
+  compiled.compile ();
+  BOOST_REQUIRE (compiled.isCompiled ());
+  BOOST_CHECK (!octree.isCompiled ());
+  BOOST_CHECK_EQUAL (compiled.getCompiledSize (), octree.getTree ()->size ());
+  checkCompiledNodes (compiled, compiled.getRoot (),
+                      compiled.getCompiledRoot (), compiled.getRootBV ());
+
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-2000, -2000, 0, 2000, 2000, 2000};
+  std::size_t N = 200;
+  generateRandomTransforms(extents, transforms, 2*N);
+
+  hpp::fcl::Sphere sphere (100);
+  CollisionRequest request (hpp::fcl::CONTACT, 10);
+  hpp::fcl::DistanceRequest drequest;
+  for (std::size_t i=0; i<N; ++i) {
+    const Transform3f& tf1 (transforms [2*i]);
+    const Transform3f& tf2 (transforms [2*i+1]);
+
+    CollisionResult result, cresult;
+    hpp::fcl::collide (&robMesh, tf1, &octree, tf2, request, result);
+    hpp::fcl::collide (&robMesh, tf1, &compiled, tf2, request, cresult);
+    BOOST_CHECK_EQUAL (result.numContacts (), cresult.numContacts ());
+
+    result.clear (); cresult.clear ();
+    hpp::fcl::collide (&sphere, tf1, &octree, tf2, request, result);
+    hpp::fcl::collide (&sphere, tf1, &compiled, tf2, request, cresult);
+    BOOST_CHECK_EQUAL (result.numContacts (), cresult.numContacts ());
+
+    result.clear (); cresult.clear ();
+    hpp::fcl::collide (&octree, tf1, &octree, tf2, request, result);
+    hpp::fcl::collide (&compiled, tf1, &octree, tf2, request, cresult);
+    BOOST_CHECK_EQUAL (result.numContacts (), cresult.numContacts ());
+
+    hpp::fcl::DistanceResult dresult, dcresult;
+    hpp::fcl::distance (&sphere, tf1, &octree, tf2, drequest, dresult);
+    hpp::fcl::distance (&sphere, tf1, &compiled, tf2, drequest, dcresult);
+    BOOST_CHECK_SMALL (dresult.min_distance - dcresult.min_distance, 1e-6);
+  }
+}
+
+BOOST_AUTO_TEST_CASE (update_octree)
+{
+  FCL_REAL resolution (10.);
+  octomap::OcTreePtr_t tree (new octomap::OcTree (resolution));
+  tree->enableChangeDetection (true);
+
+  std::vector<Transform3f> points;
+  FCL_REAL point_extents[] = {-1000, -1000, 0, 1000, 1000, 1000};
+  generateRandomTransforms(point_extents, points, 400);
+  for (std::size_t i=0; i<points.size() / 2; ++i) {
+    const Vec3f& p (points [i].getTranslation ());
+    tree->updateNode (octomap::point3d
+                      ((float) p [0], (float) p [1], (float) p [2]), true);
+  }
+
+  OcTree octree (tree);
+  octree.compile ();
+  OcTree copy (octree);
+  std::size_t size = octree.getCompiledSize ();
+  BOOST_CHECK_EQUAL (size, tree->size ());
+
+  hpp::fcl::Sphere sphere (100);
+  hpp::fcl::DistanceRequest drequest;
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-2000, -2000, 0, 2000, 2000, 2000};
+  generateRandomTransforms(extents, transforms, 20);
+
+  for (std::size_t round = 0; round < 8; ++round) {
+    tree->resetChangeDetection ();
+    // Occupy new cells, and free cells until the blocks of free cells are
+    // pruned.
+    for (std::size_t i = points.size() / 2; i < points.size(); ++i) {
+      if ((i + round) % 4 != 0) continue;
+      const Vec3f& p (points [i].getTranslation ());
+      tree->updateNode (octomap::point3d
+                        ((float) p [0], (float) p [1], (float) p [2]), true);
+    }
+    for (std::size_t i = 0; i < points.size() / 2; i += 8) {
+      const Vec3f& p (points [i].getTranslation ());
+      for (int dx = 0; dx < 2; ++dx)
+        for (int dy = 0; dy < 2; ++dy)
+          for (int dz = 0; dz < 2; ++dz)
+            tree->updateNode (octomap::point3d
+                              ((float) (p [0] + dx * resolution),
+                               (float) (p [1] + dy * resolution),
+                               (float) (p [2] + dz * resolution)), false);
+    }
+    octree.update (tree->changedKeysBegin (), tree->changedKeysEnd ());
+
+    BOOST_CHECK_EQUAL (octree.getCompiledSize (), tree->size ());
+    checkCompiledNodes (octree, octree.getRoot (), octree.getCompiledRoot (),
+                        octree.getRootBV ());
+
+    OcTree compiled (tree);
+    compiled.compile ();
+    for (std::size_t i=0; i<transforms.size(); ++i) {
+      hpp::fcl::DistanceResult dresult, dcresult;
+      hpp::fcl::distance (&sphere, transforms [i], &octree, Transform3f (),
+                          drequest, dresult);
+      hpp::fcl::distance (&sphere, transforms [i], &compiled, Transform3f (),
+                          drequest, dcresult);
+      BOOST_CHECK_EQUAL (dresult.min_distance, dcresult.min_distance);
+    }
+  }
+  // The copy keeps its snapshot.
+  BOOST_CHECK_EQUAL (copy.getCompiledSize (), size);
+}
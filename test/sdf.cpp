@@ -0,0 +1,390 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define BOOST_TEST_MODULE FCL_SDF
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <hpp/fcl/sdf.h>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
+#ifdef HPP_FCL_HAVE_OCTOMAP
+#include <hpp/fcl/octree.h>
+#endif
+
+#include "utility.h"
+
+using namespace hpp::fcl;
+
+namespace
+{
+  /// signed distance to a box centered at the origin
+  FCL_REAL boxDistance(const Vec3f& half_side, const Vec3f& p)
+  {
+    const Vec3f q (p.cwiseAbs() - half_side);
+    return q.cwiseMax(0).norm() + std::min(q.maxCoeff(), (FCL_REAL) 0);
+  }
+
+  Vec3f randomPoint(FCL_REAL extent)
+  {
+    return extent * Vec3f::Random();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(sdf_of_mesh)
+{
+  const Box box (1, .6, .4);
+  BVHModel<OBBRSS> mesh;
+  generateBVHModel(mesh, box, Transform3f());
+  const FCL_REAL resolution = .02;
+  const SignedDistanceField sdf (mesh, resolution, .2);
+  BOOST_CHECK_EQUAL(sdf.getNodeType(), GEOM_SDF);
+  BOOST_CHECK(sdf.aabb_local.contain(Vec3f(.7, .5, .4)));
+
+  const Vec3f grid_half_side (.5 * (sdf.aabb_local.max_ - sdf.aabb_local.min_));
+  for(int i = 0; i < 1000; ++i)
+  {
+    const Vec3f p (grid_half_side.cwiseProduct(Vec3f::Random()));
+    BOOST_CHECK_SMALL(sdf.distance(p) - boxDistance(box.halfSide, p), resolution);
+  }
+
+  // the gradient is the one of the interpolated distance, also outside of
+  // the grid
+  for(int i = 0; i < 1000; ++i)
+  {
+    const Vec3f p (randomPoint(1));
+    Vec3f gradient, numerical;
+    sdf.distance(p, gradient);
+    const FCL_REAL eps = 1e-7;
+    for(int k = 0; k < 3; ++k)
+    {
+      Vec3f dp (Vec3f::Zero());
+      dp[k] = eps;
+      numerical[k] = (sdf.distance(p + dp) - sdf.distance(p - dp)) / (2 * eps);
+    }
+    BOOST_CHECK_SMALL((gradient - numerical).norm(), 1e-5);
+  }
+
+  // outside of the grid
+  BOOST_CHECK_CLOSE(sdf.distance(Vec3f(2, 0, 0)), 1.5, 1e-6);
+
+  BOOST_CHECK_THROW(SignedDistanceField(Vec3f::Zero(), resolution, 2, 2, 2,
+                                        std::vector<FCL_REAL>(7)),
+                    std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(sdf_shape_queries)
+{
+  const Box box (1, .6, .4);
+  BVHModel<OBBRSS> mesh;
+  generateBVHModel(mesh, box, Transform3f());
+  const FCL_REAL resolution = .02;
+  const SignedDistanceField sdf (mesh, resolution, .3);
+
+  std::vector<ShapeBase*> shapes;
+  shapes.push_back(new Sphere(.1));
+  shapes.push_back(new Capsule(.05, .2));
+  shapes.push_back(new Box(.2, .1, .3));
+  shapes.push_back(new Cylinder(.1, .2));
+  shapes.push_back(new Cone(.1, .2));
+
+  FCL_REAL extents[] = { -.8, -.6, -.5, .8, .6, .5 };
+  std::vector<Transform3f> transforms;
+  generateRandomTransforms(extents, transforms, 100);
+  int n_collisions = 0;
+  for(std::size_t s = 0; s < shapes.size(); ++s)
+  {
+    for(std::size_t i = 0; i < transforms.size(); ++i)
+    {
+      const Transform3f& tf = transforms[i];
+      DistanceRequest request (true);
+      DistanceResult expected;
+      distance(&box, Transform3f(), shapes[s], tf, request, expected);
+      if(expected.min_distance <= 2 * resolution) continue;
+
+      DistanceResult result;
+      distance(&sdf, Transform3f(), shapes[s], tf, request, result);
+      BOOST_CHECK_SMALL(result.min_distance - expected.min_distance, 2 * resolution);
+      BOOST_CHECK_SMALL(boxDistance(box.halfSide, result.nearest_points[0]), 2 * resolution);
+      BOOST_CHECK_CLOSE((result.nearest_points[1] - result.nearest_points[0]).norm(),
+                        result.min_distance, 1e-6);
+      BOOST_CHECK(result.o1 == &sdf);
+
+      DistanceResult swapped;
+      distance(shapes[s], tf, &sdf, Transform3f(), request, swapped);
+      BOOST_CHECK_CLOSE(swapped.min_distance, result.min_distance, 1e-6);
+      BOOST_CHECK(swapped.o2 == &sdf);
+      BOOST_CHECK(swapped.nearest_points[0].isApprox(result.nearest_points[1]));
+      BOOST_CHECK(swapped.normal.isApprox(-result.normal));
+    }
+
+    for(std::size_t i = 0; i < transforms.size(); ++i)
+    {
+      const Transform3f& tf = transforms[i];
+      CollisionRequest request;
+      CollisionResult expected, result, swapped;
+      collide(&box, Transform3f(), shapes[s], tf, request, expected);
+      collide(&sdf, Transform3f(), shapes[s], tf, request, result);
+      collide(shapes[s], tf, &sdf, Transform3f(), request, swapped);
+      BOOST_CHECK_EQUAL(result.isCollision(), swapped.isCollision());
+
+      DistanceResult distance_result;
+      distance(&box, Transform3f(), shapes[s], tf, DistanceRequest(), distance_result);
+      if(std::fabs(distance_result.min_distance) < 2 * resolution) continue;
+      BOOST_CHECK_EQUAL(result.isCollision(), expected.isCollision());
+      if(result.isCollision())
+      {
+        ++n_collisions;
+        BOOST_CHECK(result.getContact(0).normal.isApprox(-swapped.getContact(0).normal));
+      }
+    }
+  }
+  BOOST_CHECK(n_collisions > 0);
+
+  for(std::size_t s = 0; s < shapes.size(); ++s) delete shapes[s];
+}
+
+template<typename BV>
+void testMeshQueries()
+{
+  const Box box (1, .6, .4);
+  BVHModel<OBBRSS> mesh;
+  generateBVHModel(mesh, box, Transform3f());
+  const FCL_REAL resolution = .02;
+  const SignedDistanceField sdf (mesh, resolution, .3);
+
+  const Sphere sphere (.15);
+  BVHModel<BV> sphere_mesh;
+  generateBVHModel(sphere_mesh, sphere, Transform3f(), 16, 16);
+
+  FCL_REAL extents[] = { -.8, -.6, -.5, .8, .6, .5 };
+  std::vector<Transform3f> transforms;
+  generateRandomTransforms(extents, transforms, 100);
+  int n_collisions = 0;
+  for(std::size_t i = 0; i < transforms.size(); ++i)
+  {
+    const Transform3f& tf = transforms[i];
+    DistanceResult expected;
+    distance(&box, Transform3f(), &sphere_mesh, tf, DistanceRequest(), expected);
+
+    if(expected.min_distance > 2 * resolution)
+    {
+      DistanceResult result, swapped;
+      distance(&sdf, Transform3f(), &sphere_mesh, tf, DistanceRequest(true), result);
+      BOOST_CHECK_SMALL(result.min_distance - expected.min_distance, 2 * resolution);
+      BOOST_CHECK(result.b2 >= 0 && result.b2 < sphere_mesh.num_tris);
+      distance(&sphere_mesh, tf, &sdf, Transform3f(), DistanceRequest(true), swapped);
+      BOOST_CHECK_CLOSE(swapped.min_distance, result.min_distance, 1e-6);
+      BOOST_CHECK_EQUAL(swapped.b1, result.b2);
+    }
+
+    CollisionRequest request (CONTACT, 10);
+    CollisionResult result, swapped;
+    collide(&sdf, Transform3f(), &sphere_mesh, tf, request, result);
+    collide(&sphere_mesh, tf, &sdf, Transform3f(), request, swapped);
+    BOOST_CHECK_EQUAL(result.numContacts(), swapped.numContacts());
+    if(std::fabs(expected.min_distance) > 2 * resolution)
+      BOOST_CHECK_EQUAL(result.isCollision(), expected.min_distance < 0);
+    if(result.isCollision())
+    {
+      ++n_collisions;
+      BOOST_CHECK(result.numContacts() <= 10);
+      BOOST_CHECK(result.getContact(0).o1 == &sdf);
+      BOOST_CHECK(swapped.getContact(0).o2 == &sdf);
+      BOOST_CHECK(result.getContact(0).penetration_depth >= 0);
+    }
+  }
+  BOOST_CHECK(n_collisions > 0);
+}
+
+BOOST_AUTO_TEST_CASE(sdf_mesh_queries)
+{
+  testMeshQueries<OBBRSS>();
+  testMeshQueries<AABB>();
+  testMeshQueries<RSS>();
+}
+
+namespace
+{
+  /// Three disjoint boxes, whose field is not convex
+  struct ThreeBoxes
+  {
+    ThreeBoxes() : box (.4, .3, .2)
+    {
+      poses[0] = Transform3f(Vec3f(-.5, 0, 0));
+      poses[1] = Transform3f(Vec3f(.5, .1, 0));
+      poses[2] = Transform3f(Quaternion3f(Eigen::AngleAxisd(.5, Vec3f::UnitZ())),
+                             Vec3f(0, .5, .1));
+      mesh.beginModel();
+      for(int i = 0; i < 3; ++i)
+      {
+        BVHModel<OBBRSS> part;
+        generateBVHModel(part, box, poses[i]);
+        mesh.addSubModel(std::vector<Vec3f>(part.vertices, part.vertices + part.num_vertices),
+                         std::vector<Triangle>(part.tri_indices, part.tri_indices + part.num_tris));
+      }
+      mesh.endModel();
+    }
+
+    /// exact distance between the boxes and an object
+    FCL_REAL distance(const CollisionGeometry* o, const Transform3f& tf) const
+    {
+      FCL_REAL d = std::numeric_limits<FCL_REAL>::max();
+      for(int i = 0; i < 3; ++i)
+      {
+        DistanceResult result;
+        hpp::fcl::distance(&box, poses[i], o, tf, DistanceRequest(), result);
+        d = std::min(d, result.min_distance);
+      }
+      return d;
+    }
+
+    Box box;
+    Transform3f poses[3];
+    BVHModel<OBBRSS> mesh;
+  };
+}
+
+// The minimum of a field which is not convex is not missed.
+BOOST_AUTO_TEST_CASE(sdf_non_convex_shape_queries)
+{
+  const ThreeBoxes boxes;
+  const FCL_REAL resolution = .02;
+  const SignedDistanceField sdf (boxes.mesh, resolution, .3);
+
+  std::vector<ShapeBase*> shapes;
+  shapes.push_back(new Box(.8, .03, .03));
+  shapes.push_back(new Capsule(.02, .8));
+
+  FCL_REAL extents[] = { -1, -.5, -.5, 1, 1, .5 };
+  std::vector<Transform3f> transforms;
+  generateRandomTransforms(extents, transforms, 300);
+  int n_collisions = 0, n_free = 0;
+  for(std::size_t s = 0; s < shapes.size(); ++s)
+  {
+    for(std::size_t i = 0; i < transforms.size(); ++i)
+    {
+      const Transform3f& tf = transforms[i];
+      const FCL_REAL expected = boxes.distance(shapes[s], tf);
+      if(std::fabs(expected) < 2 * resolution) continue;
+
+      CollisionResult collision;
+      collide(&sdf, Transform3f(), shapes[s], tf, CollisionRequest(), collision);
+      BOOST_CHECK_EQUAL(collision.isCollision(), expected < 0);
+      if(expected < 0) ++n_collisions;
+      // outside of the grid, the field overestimates the distance
+      else if(expected < .25)
+      {
+        ++n_free;
+        DistanceResult result;
+        hpp::fcl::distance(&sdf, Transform3f(), shapes[s], tf, DistanceRequest(), result);
+        BOOST_CHECK_SMALL(result.min_distance - expected, 2 * resolution);
+      }
+    }
+  }
+  BOOST_CHECK(n_collisions > 0 && n_free > 0);
+
+  for(std::size_t s = 0; s < shapes.size(); ++s) delete shapes[s];
+}
+
+// The bounding volumes of an elongated mesh are far from spheres, which
+// makes the bounds of the field on them sensitive to their center.
+template<typename BV>
+void testStickQueries(const ThreeBoxes& boxes, const SignedDistanceField& sdf,
+                      const std::vector<Transform3f>& transforms)
+{
+  const Box stick (1.5, .02, .02);
+  BVHModel<BV> mesh;
+  generateBVHModel(mesh, stick, Transform3f());
+  const FCL_REAL resolution = sdf.getResolution();
+  int n_collisions = 0;
+  for(std::size_t i = 0; i < transforms.size(); ++i)
+  {
+    const Transform3f& tf = transforms[i];
+    const FCL_REAL expected = boxes.distance(&stick, tf);
+    if(std::fabs(expected) < 2 * resolution) continue;
+
+    CollisionResult collision;
+    collide(&sdf, Transform3f(), &mesh, tf, CollisionRequest(), collision);
+    BOOST_CHECK_EQUAL(collision.isCollision(), expected < 0);
+    if(expected < 0)
+    {
+      ++n_collisions;
+      continue;
+    }
+    if(expected > .25) continue;
+    DistanceResult result;
+    hpp::fcl::distance(&sdf, Transform3f(), &mesh, tf, DistanceRequest(), result);
+    BOOST_CHECK_SMALL(result.min_distance - expected, 2 * resolution);
+  }
+  BOOST_CHECK(n_collisions > 0);
+}
+
+BOOST_AUTO_TEST_CASE(sdf_elongated_mesh_queries)
+{
+  const ThreeBoxes boxes;
+  const SignedDistanceField sdf (boxes.mesh, .02, .3);
+  FCL_REAL extents[] = { -1, -.5, -.5, 1, 1, .5 };
+  std::vector<Transform3f> transforms;
+  generateRandomTransforms(extents, transforms, 300);
+  testStickQueries<RSS>(boxes, sdf, transforms);
+  testStickQueries<OBBRSS>(boxes, sdf, transforms);
+  testStickQueries<OBB>(boxes, sdf, transforms);
+  testStickQueries<AABB>(boxes, sdf, transforms);
+}
+
+#ifdef HPP_FCL_HAVE_OCTOMAP
+BOOST_AUTO_TEST_CASE(sdf_of_octree)
+{
+  const FCL_REAL resolution = .05;
+  boost::shared_ptr<octomap::OcTree> tree (new octomap::OcTree(resolution));
+  for(FCL_REAL x = -.275; x < .3; x += resolution)
+    for(FCL_REAL y = -.275; y < .3; y += resolution)
+      for(FCL_REAL z = -.275; z < .3; z += resolution)
+        tree->updateNode(octomap::point3d((float) x, (float) y, (float) z), true);
+  tree->updateInnerOccupancy();
+  const OcTree octree (tree);
+
+  const SignedDistanceField sdf (octree, resolution, .2);
+  const Vec3f half_side (.3, .3, .3);
+  for(int i = 0; i < 1000; ++i)
+  {
+    const Vec3f p (randomPoint(.5));
+    BOOST_CHECK_SMALL(sdf.distance(p) - boxDistance(half_side, p), resolution);
+  }
+}
+#endif
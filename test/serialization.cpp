@@ -0,0 +1,229 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#define BOOST_TEST_MODULE FCL_SERIALIZATION
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include <hpp/fcl/serialization.h>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include <hpp/fcl/shape/convex.h>
+#include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
+
+#include "utility.h"
+#include "fcl_resources/config.h"
+
+using namespace hpp::fcl;
+namespace fs = boost::filesystem;
+
+/// Save and load a geometry through a temporary file.
+CollisionGeometryPtr_t saveAndLoad(const CollisionGeometry& geometry)
+{
+  fs::path filename (fs::temp_directory_path () / fs::unique_path ());
+  saveBinary (geometry, filename.string ());
+  CollisionGeometryPtr_t loaded (loadBinary (filename.string ()));
+  // The mapping stays valid once the file is removed.
+  fs::remove (filename);
+  return loaded;
+}
+
+/// Queries on the loaded geometries must give the same results as on the
+/// saved ones.
+void compareQueries(const CollisionGeometry* a1, const CollisionGeometry* a2,
+                    const CollisionGeometry* b1, const CollisionGeometry* b2)
+{
+  std::vector<Transform3f> transforms;
+  FCL_REAL extents[] = {-3000, -3000, 0, 3000, 3000, 3000};
+  generateRandomTransforms (extents, transforms, 100);
+
+  std::size_t nCol = 0;
+  for (std::size_t i = 0; i < transforms.size (); ++i) {
+    CollisionRequest request (CONTACT, 10);
+    CollisionResult ra, rb;
+    collide (a1, Transform3f (), a2, transforms[i], request, ra);
+    collide (b1, Transform3f (), b2, transforms[i], request, rb);
+    BOOST_CHECK_EQUAL (ra.numContacts (), rb.numContacts ());
+    if (ra.isCollision ()) ++nCol;
+
+    DistanceRequest drequest;
+    DistanceResult da, db;
+    distance (a1, Transform3f (), a2, transforms[i], drequest, da);
+    distance (b1, Transform3f (), b2, transforms[i], drequest, db);
+    BOOST_CHECK_EQUAL (da.min_distance, db.min_distance);
+  }
+  BOOST_CHECK (nCol > 0);
+}
+
+BOOST_AUTO_TEST_CASE(bvh_model)
+{
+  std::vector<Vec3f> p1, p2;
+  std::vector<Triangle> t1, t2;
+  fs::path path (TEST_RESOURCES_DIR);
+  loadOBJFile ((path / "env.obj").string ().c_str (), p1, t1);
+  loadOBJFile ((path / "rob.obj").string ().c_str (), p2, t2);
+
+  BVHModel<OBBRSS> m1, m2;
+  m1.beginModel (); m1.addSubModel (p1, t1); m1.endModel ();
+  m2.beginModel (); m2.addSubModel (p2, t2); m2.endModel ();
+  m1.computeLocalAABB ();
+  m2.computeLocalAABB ();
+
+  CollisionGeometryPtr_t l1 (saveAndLoad (m1)), l2 (saveAndLoad (m2));
+  BOOST_REQUIRE_EQUAL (l1->getNodeType (), BV_OBBRSS);
+  const BVHModel<OBBRSS>& loaded =
+    static_cast<const BVHModel<OBBRSS>&> (*l1);
+  BOOST_CHECK (!loaded.ownStorage ());
+  BOOST_CHECK_EQUAL (loaded.num_vertices, m1.num_vertices);
+  BOOST_CHECK_EQUAL (loaded.num_tris, m1.num_tris);
+  BOOST_CHECK_EQUAL (loaded.getNumBVs (), m1.getNumBVs ());
+  BOOST_CHECK (loaded.aabb_local.min_ == m1.aabb_local.min_);
+  BOOST_CHECK (loaded.aabb_local.max_ == m1.aabb_local.max_);
+
+  compareQueries (&m1, &m2, l1.get (), l2.get ());
+
+  // The storage of a loaded model cannot be modified in place.
+  BVHModel<OBBRSS>& model = static_cast<BVHModel<OBBRSS>&> (*l2);
+  BOOST_CHECK_EQUAL (model.beginUpdateModel (), BVH_ERR_UNSUPPORTED_FUNCTION);
+}
+
+BOOST_AUTO_TEST_CASE(convex)
+{
+  std::vector<Vec3f> points;
+  std::vector<Triangle> triangles;
+  fs::path path (TEST_RESOURCES_DIR);
+  loadOBJFile ((path / "rob.obj").string ().c_str (), points, triangles);
+  boost::shared_ptr<ConvexBase> convex (ConvexBase::convexHull (
+        points.data (), (int)points.size ()));
+  convex->computeLocalAABB ();
+
+  CollisionGeometryPtr_t loaded (saveAndLoad (*convex));
+  BOOST_REQUIRE_EQUAL (loaded->getNodeType (), GEOM_CONVEX);
+  const Convex<Triangle>& c (static_cast<const Convex<Triangle>&> (*loaded));
+  BOOST_CHECK_EQUAL (c.num_points, convex->num_points);
+
+  compareQueries (convex.get (), convex.get (), loaded.get (), loaded.get ());
+}
+
+BOOST_AUTO_TEST_CASE(invalid_file)
+{
+  fs::path path (TEST_RESOURCES_DIR);
+  BOOST_CHECK_THROW (loadBinary ((path / "env.obj").string ()),
+                     std::runtime_error);
+  BOOST_CHECK_THROW (loadBinary ((path / "no_such_file").string ()),
+                     std::runtime_error);
+  Box box (1, 1, 1);
+  BOOST_CHECK_THROW (saveBinary (box, "box"), std::invalid_argument);
+}
+
+/// Replace the bytes of the file which are equal to the n bytes of before
+/// by after, and check that the file cannot be loaded anymore.
+void checkCorruption(const std::string& filename, const void* before,
+                     const void* after, std::size_t n)
+{
+  std::string data;
+  {
+    std::ifstream is (filename.c_str (), std::ios::binary);
+    data.assign (std::istreambuf_iterator<char> (is),
+                 std::istreambuf_iterator<char> ());
+  }
+  std::size_t pos = data.find (std::string (
+        static_cast<const char*> (before), n));
+  BOOST_REQUIRE (pos != std::string::npos);
+  std::string corrupted (data);
+  corrupted.replace (pos, n, static_cast<const char*> (after), n);
+  {
+    std::ofstream os (filename.c_str (), std::ios::binary | std::ios::trunc);
+    os.write (corrupted.data (), (std::streamsize)corrupted.size ());
+  }
+  BOOST_CHECK_THROW (loadBinary (filename), std::runtime_error);
+  std::ofstream os (filename.c_str (), std::ios::binary | std::ios::trunc);
+  os.write (data.data (), (std::streamsize)data.size ());
+}
+
+BOOST_AUTO_TEST_CASE(corrupted_file)
+{
+  BVHModel<OBBRSS> model;
+  generateBVHModel (model, Box (1, 2, 3), Transform3f ());
+  fs::path filename (fs::temp_directory_path () / fs::unique_path ());
+  saveBinary (model, filename.string ());
+  BOOST_CHECK_NO_THROW (loadBinary (filename.string ()));
+
+  // Index of a vertex of a triangle.
+  std::vector<Triangle> triangles (model.tri_indices,
+                                   model.tri_indices + model.num_tris);
+  triangles[3][1] = (std::size_t)model.num_vertices;
+  checkCorruption (filename.string (), model.tri_indices, &triangles[0],
+                   sizeof (Triangle) * triangles.size ());
+
+  // Number of primitives, in the header of the section of the primitive
+  // indices.
+  boost::uint64_t section[2] = { (boost::uint64_t)model.num_tris,
+                                 sizeof (unsigned int) };
+  boost::uint64_t corrupted_section[2] = { section[0] - 1, section[1] };
+  checkCorruption (filename.string (), section, corrupted_section,
+                   sizeof (section));
+
+  // Primitive index, the primitive of a leaf being its first primitive.
+  std::vector<unsigned int> primitives ((std::size_t)model.num_tris);
+  for (int i = 0; i < model.getNumBVs (); ++i)
+    if (model.getBV (i).isLeaf ())
+      primitives[model.getBV (i).first_primitive] =
+        (unsigned int)model.getBV (i).primitiveId ();
+  std::vector<unsigned int> corrupted_primitives (primitives);
+  corrupted_primitives[5] = (unsigned int)model.num_tris;
+  checkCorruption (filename.string (), &primitives[0],
+                   &corrupted_primitives[0],
+                   sizeof (unsigned int) * primitives.size ());
+
+  // Child of a node, and primitive of a leaf.
+  BVNode<OBBRSS> node (model.getBV (0));
+  node.first_child = model.getNumBVs ();
+  checkCorruption (filename.string (), &model.getBV (0), &node, sizeof (node));
+  node.first_child = 0;
+  checkCorruption (filename.string (), &model.getBV (0), &node, sizeof (node));
+  int leaf = 0;
+  while (!model.getBV (leaf).isLeaf ()) ++leaf;
+  node = model.getBV (leaf);
+  node.first_child = - model.num_tris - 1;
+  checkCorruption (filename.string (), &model.getBV (leaf), &node,
+                   sizeof (node));
+
+  fs::remove (filename);
+}
@@ -0,0 +1,336 @@
+/*
+ * Software License Agreement (BSD License)
+ *
+ *  Copyright (c) 2019, LAAS-CNRS
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   * Redistributions of source code must retain the above copyright
+ *     notice, this list of conditions and the following disclaimer.
+ *   * Redistributions in binary form must reproduce the above
+ *     copyright notice, this list of conditions and the following
+ *     disclaimer in the documentation and/or other materials provided
+ *     with the distribution.
+ *   * Neither the name of Open Source Robotics Foundation nor the names of its
+ *     contributors may be used to endorse or promote products derived
+ *     from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *  COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#define BOOST_TEST_MODULE FCL_THREAD_POOL
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <boost/filesystem.hpp>
+
+#include <hpp/fcl/thread_pool.h>
+#include <hpp/fcl/collision.h>
+#include <hpp/fcl/distance.h>
+#include <hpp/fcl/shape/geometric_shapes.h>
+#include <hpp/fcl/shape/geometric_shape_to_BVH_model.h>
+#include <hpp/fcl/BVH/BVH_model.h>
+#include "../src/BVH/BV_splitter.h"
+#include "utility.h"
+#include "fcl_resources/config.h"
+
+using namespace hpp::fcl;
+
+struct CountTask : ThreadPool::Task
+{
+  CountTask(std::size_t n, std::size_t num_threads) :
+    count(n, 0), valid_thread_ids(true), num_threads(num_threads) {}
+
+  void run(std::size_t begin, std::size_t end, std::size_t thread_id)
+  {
+    if(thread_id >= num_threads) valid_thread_ids = false;
+    for(std::size_t i = begin; i < end; ++i)
+      ++count[i];
+  }
+
+  std::vector<int> count;
+  bool valid_thread_ids;
+  std::size_t num_threads;
+};
+
+struct ThrowTask : ThreadPool::Task
+{
+  void run(std::size_t begin, std::size_t end, std::size_t)
+  {
+    if(begin <= 500 && 500 < end)
+      throw std::runtime_error("index 500");
+  }
+};
+
+BOOST_AUTO_TEST_CASE(parallel_for)
+{
+  for(std::size_t num_threads = 1; num_threads <= 4; ++num_threads)
+  {
+    ThreadPool pool(num_threads);
+    BOOST_CHECK_EQUAL(pool.size(), num_threads);
+    for(std::size_t k = 0; k < 50; ++k)
+    {
+      std::size_t n = 1 + 97 * k, grain = 1 + k % 5;
+      CountTask task(n, num_threads);
+      pool.parallelFor(n, task, grain);
+      BOOST_CHECK(task.valid_thread_ids);
+      for(std::size_t i = 0; i < n; ++i)
+        BOOST_CHECK_EQUAL(task.count[i], 1);
+    }
+
+    ThrowTask throw_task;
+    BOOST_CHECK_THROW(pool.parallelFor(1000, throw_task), std::runtime_error);
+
+    // The pool is still usable after an exception.
+    CountTask task(10, num_threads);
+    pool.parallelFor(10, task);
+    for(std::size_t i = 0; i < 10; ++i)
+      BOOST_CHECK_EQUAL(task.count[i], 1);
+  }
+}
+
+struct SumReduction
+{
+  typedef double Result;
+
+  double operator()(std::size_t begin, std::size_t end) const
+  {
+    double sum = 0;
+    for(std::size_t i = begin; i < end; ++i)
+      sum += values[i];
+    return sum;
+  }
+
+  void merge(double& sum, const double& other) const { sum += other; }
+
+  std::vector<double> values;
+};
+
+BOOST_AUTO_TEST_CASE(parallel_reduce)
+{
+  SumReduction reduction;
+  for(std::size_t i = 0; i < 10000; ++i)
+    reduction.values.push_back(std::pow(-1.1, (double)(i % 300)) / (double)(i + 1));
+
+  // A floating point sum depends on the order of the terms, but not on the
+  // number of threads since the chunks are fixed.
+  double sum = reduce(reduction, reduction.values.size(), 64, NULL);
+  for(std::size_t num_threads = 1; num_threads <= 4; ++num_threads)
+  {
+    ThreadPool pool(num_threads);
+    for(int k = 0; k < 10; ++k)
+      BOOST_CHECK_EQUAL(reduce(reduction, reduction.values.size(), 64, &pool),
+                        sum);
+    BOOST_CHECK_EQUAL(reduce(reduction, 10, 64, &pool), reduction(0, 10));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(batched_pairs)
+{
+  std::vector<CollisionObject*> objs;
+  FCL_REAL extents[] = {-50, -50, -50, 50, 50, 50};
+  std::vector<Transform3f> transforms;
+  std::size_t n = 200;
+  generateRandomTransforms(extents, transforms, n);
+
+  boost::shared_ptr<Box> box(new Box(20, 10, 10));
+  boost::shared_ptr<Sphere> sphere(new Sphere(10));
+  boost::shared_ptr<Capsule> capsule(new Capsule(5, 20));
+  boost::shared_ptr<BVHModel<OBBRSS> > mesh(new BVHModel<OBBRSS>);
+  generateBVHModel(*mesh, Sphere(10), Transform3f(), 16, 16);
+  for(std::size_t i = 0; i < n; ++i)
+  {
+    switch(i % 4)
+    {
+    case 0: objs.push_back(new CollisionObject(box, transforms[i])); break;
+    case 1: objs.push_back(new CollisionObject(sphere, transforms[i])); break;
+    case 2: objs.push_back(new CollisionObject(capsule, transforms[i])); break;
+    default: objs.push_back(new CollisionObject(mesh, transforms[i])); break;
+    }
+    objs.back()->computeAABB();
+  }
+
+  std::vector<CollisionObjectPair> pairs;
+  for(std::size_t i = 0; i < n; ++i)
+    for(std::size_t j = i + 1; j < n; j += 7)
+      pairs.push_back(CollisionObjectPair(objs[i], objs[j]));
+
+  CollisionRequest crequest(CONTACT, 4);
+  DistanceRequest drequest(true);
+  std::vector<CollisionResult> cresults_ref(pairs.size());
+  std::vector<DistanceResult> dresults_ref(pairs.size());
+  std::size_t num_collisions = 0;
+  FCL_REAL min_distance = std::numeric_limits<FCL_REAL>::max();
+  for(std::size_t i = 0; i < pairs.size(); ++i)
+  {
+    if(collide(pairs[i].first, pairs[i].second, crequest, cresults_ref[i]) > 0)
+      ++num_collisions;
+    min_distance = std::min(min_distance,
+        distance(pairs[i].first, pairs[i].second, drequest, dresults_ref[i]));
+  }
+  BOOST_CHECK(num_collisions > 0);
+
+  for(std::size_t num_threads = 1; num_threads <= 4; num_threads += 3)
+  {
+    ThreadPool pool(num_threads);
+    std::vector<CollisionResult> cresults;
+    std::vector<DistanceResult> dresults;
+    BOOST_CHECK_EQUAL(collide(pairs, crequest, cresults, pool), num_collisions);
+    BOOST_CHECK_EQUAL(distance(pairs, drequest, dresults, pool), min_distance);
+    BOOST_REQUIRE_EQUAL(cresults.size(), pairs.size());
+    BOOST_REQUIRE_EQUAL(dresults.size(), pairs.size());
+    for(std::size_t i = 0; i < pairs.size(); ++i)
+    {
+      BOOST_CHECK_EQUAL(cresults[i].numContacts(), cresults_ref[i].numContacts());
+      for(std::size_t j = 0; j < cresults[i].numContacts(); ++j)
+        BOOST_CHECK(cresults[i].getContact(j) == cresults_ref[i].getContact(j));
+      BOOST_CHECK_EQUAL(dresults[i].min_distance, dresults_ref[i].min_distance);
+    }
+  }
+
+  for(std::size_t i = 0; i < objs.size(); ++i)
+    delete objs[i];
+}
+
+template<typename BV>
+void checkParallelMeshQueries(ThreadPool& pool, bool with_distance)
+{
+  std::vector<Vec3f> p1, p2;
+  std::vector<Triangle> t1, t2;
+  boost::filesystem::path path(TEST_RESOURCES_DIR);
+  loadOBJFile((path / "env.obj").string().c_str(), p1, t1);
+  loadOBJFile((path / "rob.obj").string().c_str(), p2, t2);
+
+  BVHModel<BV> env, rob;
+  env.beginModel(); env.addSubModel(p1, t1); env.endModel();
+  rob.beginModel(); rob.addSubModel(p2, t2); rob.endModel();
+
+  FCL_REAL extents[] = {-200, -200, -200, 200, 200, 200};
+  std::vector<Transform3f> transforms;
+  generateRandomTransforms(extents, transforms, 20);
+
+  std::size_t num_collisions = 0;
+  for(std::size_t i = 0; i < transforms.size(); ++i)
+  {
+    const Transform3f& tf = transforms[i];
+
+    // All the contacts: the same ones are found, in another order.
+    CollisionRequest request(NO_REQUEST, 100000);
+    CollisionResult result_ref, result;
+    collide(&env, Transform3f(), &rob, tf, request, result_ref);
+    collide(&env, Transform3f(), &rob, tf, request, result, pool);
+    std::vector<Contact> contacts_ref, contacts;
+    result_ref.getContacts(contacts_ref);
+    result.getContacts(contacts);
+    std::sort(contacts_ref.begin(), contacts_ref.end());
+    std::sort(contacts.begin(), contacts.end());
+    BOOST_REQUIRE_EQUAL(contacts.size(), contacts_ref.size());
+    for(std::size_t j = 0; j < contacts.size(); ++j)
+    {
+      BOOST_CHECK_EQUAL(contacts[j].b1, contacts_ref[j].b1);
+      BOOST_CHECK_EQUAL(contacts[j].b2, contacts_ref[j].b2);
+    }
+    if(result_ref.isCollision()) ++num_collisions;
+
+    // A limited number of contacts.
+    request.num_max_contacts = 3;
+    result.clear();
+    collide(&env, Transform3f(), &rob, tf, request, result, pool);
+    BOOST_CHECK_EQUAL(result.numContacts(),
+                      std::min<std::size_t>(3, result_ref.numContacts()));
+
+    if(!with_distance) continue;
+    DistanceRequest drequest(true);
+    DistanceResult dresult_ref, dresult;
+    FCL_REAL d_ref = distance(&env, Transform3f(), &rob, tf, drequest, dresult_ref);
+    FCL_REAL d = distance(&env, Transform3f(), &rob, tf, drequest, dresult, pool);
+    BOOST_CHECK_CLOSE(d, d_ref, 1e-8);
+    BOOST_CHECK_CLOSE(dresult.min_distance, dresult_ref.min_distance, 1e-8);
+    if(d_ref > 0)
+      BOOST_CHECK_CLOSE((dresult.nearest_points[0] - dresult.nearest_points[1]).norm(),
+                        d_ref, 1e-6);
+  }
+  BOOST_CHECK(num_collisions > 0);
+}
+
+BOOST_AUTO_TEST_CASE(parallel_mesh_queries)
+{
+  ThreadPool pool(4);
+  checkParallelMeshQueries<OBBRSS>(pool, true);
+  checkParallelMeshQueries<RSS>(pool, true);
+  checkParallelMeshQueries<AABB>(pool, true);
+  checkParallelMeshQueries<KDOP<18> >(pool, false);
+}
+
+template<typename BV>
+void checkParallelBuild(ThreadPool& pool, SplitMethodType split_method)
+{
+  std::vector<Vec3f> points;
+  std::vector<Triangle> triangles;
+  boost::filesystem::path path(TEST_RESOURCES_DIR);
+  loadOBJFile((path / "env.obj").string().c_str(), points, triangles);
+
+  BVHModel<BV> model_ref, model;
+  model_ref.bv_splitter.reset(new BVSplitter<BV>(split_method));
+  model.bv_splitter.reset(new BVSplitter<BV>(split_method));
+  model_ref.beginModel(); model_ref.addSubModel(points, triangles);
+  model.beginModel(); model.addSubModel(points, triangles);
+  BOOST_REQUIRE_EQUAL(model_ref.endModel(), BVH_OK);
+  BOOST_REQUIRE_EQUAL(model.endModel(pool), BVH_OK);
+
+  // Leaves store the index of their triangle in first_child.
+  BOOST_REQUIRE_EQUAL(model.getNumBVs(), model_ref.getNumBVs());
+  for(int i = 0; i < model.getNumBVs(); ++i)
+  {
+    const BVNode<BV>& node = model.getBV(i);
+    const BVNode<BV>& node_ref = model_ref.getBV(i);
+    BOOST_CHECK_EQUAL(node.first_child, node_ref.first_child);
+    BOOST_CHECK_EQUAL(node.first_primitive, node_ref.first_primitive);
+    BOOST_CHECK_EQUAL(node.num_primitives, node_ref.num_primitives);
+    BOOST_CHECK(node.getCenter() == node_ref.getCenter());
+    BOOST_CHECK_EQUAL(node.bv.size(), node_ref.bv.size());
+  }
+}
+
+BOOST_AUTO_TEST_CASE(parallel_bvh_build)
+{
+  ThreadPool pool(4);
+  SplitMethodType split_methods[] = { SPLIT_METHOD_MEAN, SPLIT_METHOD_MEDIAN,
+    SPLIT_METHOD_BV_CENTER, SPLIT_METHOD_SAH };
+  for(int i = 0; i < 4; ++i)
+  {
+    checkParallelBuild<OBBRSS>(pool, split_methods[i]);
+    checkParallelBuild<RSS>(pool, split_methods[i]);
+    checkParallelBuild<OBB>(pool, split_methods[i]);
+    checkParallelBuild<AABB>(pool, split_methods[i]);
+  }
+  checkParallelBuild<KDOP<24> >(pool, SPLIT_METHOD_MEAN);
+  checkParallelBuild<kIOS>(pool, SPLIT_METHOD_MEAN);
+
+  // The nodes at the top of the hierarchy are fitted by chunks of
+  // primitivesPerChunk triangles, whatever the number of threads.
+  for(std::size_t num_threads = 1; num_threads <= 3; ++num_threads)
+  {
+    ThreadPool other_pool(num_threads);
+    checkParallelBuild<OBBRSS>(other_pool, SPLIT_METHOD_MEAN);
+    checkParallelBuild<kIOS>(other_pool, SPLIT_METHOD_MEDIAN);
+  }
+}
@@ -1,6 +1,7 @@
 #include "utility.h"
 #include <hpp/fcl/collision.h>
 #include <hpp/fcl/distance.h>
+#include <hpp/fcl/shape/convex.h>
 #include <cstdio>
 #include <cstddef>
 #include <fstream>
@@ -409,8 +410,12 @@ bool defaultDistanceFunction(CollisionObject* o1, CollisionObject* o2, void* cda
 
   if(cdata->done) { dist = result.min_distance; return true; }
 
-  distance(o1, o2, request, result);
-  
+  // Some shape - shape distance functions overwrite the result instead of
+  // updating it, so compute the distance of this pair separately.
+  DistanceResult pair_result;
+  distance(o1, o2, request, pair_result);
+  result.update(pair_result);
+
   dist = result.min_distance;
 
   if(dist <= 0) return true; // in collision or in touch
@@ -458,6 +463,10 @@ std::string getNodeTypeName(NODE_TYPE node_type)
     return std::string("GEOM_TRIANGLE");
   else if (node_type == GEOM_OCTREE)
     return std::string("GEOM_OCTREE");
+  else if (node_type == GEOM_SDF)
+    return std::string("GEOM_SDF");
+  else if (node_type == GEOM_HFIELD)
+    return std::string("GEOM_HFIELD");
   else
     return std::string("invalid");
 }
@@ -480,6 +489,45 @@ Quaternion3f makeQuat(FCL_REAL w, FCL_REAL x, FCL_REAL y, FCL_REAL z)
   return q;
 }
 
+boost::shared_ptr<ConvexBase> makeConvexSphere(FCL_REAL radius, int nrings,
+                                               int nsegments)
+{
+  const FCL_REAL pi = boost::math::constants::pi<FCL_REAL>();
+  int num_points = nrings * nsegments + 2;
+  Vec3f* points = new Vec3f[num_points];
+  points[0] = Vec3f(0, 0, radius);
+  points[num_points - 1] = Vec3f(0, 0, -radius);
+  for (int i = 0; i < nrings; ++i) {
+    FCL_REAL theta = pi * (i + 1) / (nrings + 1);
+    for (int j = 0; j < nsegments; ++j) {
+      FCL_REAL phi = 2 * pi * j / nsegments;
+      points[1 + i * nsegments + j] = radius * Vec3f (
+          std::sin(theta) * std::cos(phi),
+          std::sin(theta) * std::sin(phi),
+          std::cos(theta));
+    }
+  }
+
+  int num_triangles = 2 * nrings * nsegments;
+  Triangle* triangles = new Triangle[num_triangles];
+  Triangle* t = triangles;
+  for (int j = 0; j < nsegments; ++j) {
+    int k = (j + 1) % nsegments;
+    (t++)->set(0, 1 + j, 1 + k);
+    int last = 1 + (nrings - 1) * nsegments;
+    (t++)->set(num_points - 1, last + k, last + j);
+    for (int i = 0; i + 1 < nrings; ++i) {
+      int a = 1 + i * nsegments, b = a + nsegments;
+      (t++)->set(a + j, b + j, b + k);
+      (t++)->set(a + j, b + k, a + k);
+    }
+  }
+  assert (t == triangles + num_triangles);
+
+  return boost::shared_ptr<ConvexBase> (new Convex<Triangle> (true,
+        points, num_points, triangles, num_triangles));
+}
+
 std::ostream& operator<< (std::ostream& os, const Transform3f& tf)
 {
   return os << "[ " <<
@@ -182,6 +182,13 @@ std::string getGJKSolverName(GJKSolverType solver_type);
 
 Quaternion3f makeQuat(FCL_REAL w, FCL_REAL x, FCL_REAL y, FCL_REAL z);
 
+class ConvexBase;
+
+/// @brief Build a convex polytope inscribed in a sphere, made of nrings rings
+///        of nsegments points each between two poles.
+boost::shared_ptr<ConvexBase> makeConvexSphere(FCL_REAL radius, int nrings,
+                                               int nsegments);
+
 std::ostream& operator<< (std::ostream& os, const Transform3f& tf);
 
 }